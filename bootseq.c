@@ -0,0 +1,265 @@
+// SPDX-License-Identifier: MIT
+// Boot phase timestamps and a dependency-driven init sequence.
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "bootseq.h"
+
+#if defined(__linux__)
+// Host build for testing: core 1 is a thread
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+static __thread int host_core_id;
+
+static int smp_get_core_id(void)
+{
+  return host_core_id;
+}
+
+static void *host_secondary(void *task)
+{
+  host_core_id = 1;
+  ((void (*)(void))task)();
+  return NULL;
+}
+
+static void smp_start_secondary_core(int cpuid, void (*task)(void), void *stack,
+                                     uint32_t stack_size)
+{
+  pthread_t thread;
+
+  (void)cpuid;
+  (void)stack;
+  (void)stack_size;
+  pthread_create(&thread, NULL, host_secondary, (void *)task);
+  pthread_detach(thread);
+}
+
+static void smp_stop_secondary_core(int cpuid)
+{
+  (void)cpuid;
+}
+
+static uint64_t sys_get_tick(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t sys_tick_to_usec(uint64_t tick)
+{
+  return tick / 1000;
+}
+
+#define smp_send_event()     do { } while (0)
+#define smp_wait_for_event() sched_yield()
+#define mmu_flush_dcache()   do { } while (0)
+#else
+#include "mmu.h"
+#include "smp.h"
+#include "system.h"
+#endif
+
+static const struct boot_step *boot_steps;
+static int boot_count;
+static uint32_t boot_async_mask;
+static volatile uint32_t boot_done_mask;
+static volatile uint32_t boot_claimed_mask;
+static volatile int boot_secondary_state;  // 0 idle, 1 running, 2 parked
+
+static struct boot_phase phases[BOOT_MAX_PHASES];
+static volatile uint32_t num_phases;
+
+static uint8_t boot_stack[BOOT_STACK_SIZE] __attribute__((aligned(8)));
+
+static int phase_add(const char *name, uint64_t start)
+{
+  uint32_t n = __atomic_fetch_add(&num_phases, 1, __ATOMIC_RELAXED);
+
+  if (n >= BOOT_MAX_PHASES)
+    return -1;
+
+  phases[n].name  = name;
+  phases[n].start = start;
+  phases[n].end   = start;
+  phases[n].core  = smp_get_core_id();
+  return n;
+}
+
+void boot_mark(const char *name)
+{
+  phase_add(name, sys_get_tick());
+}
+
+int boot_phase_begin(const char *name)
+{
+  return phase_add(name, sys_get_tick());
+}
+
+void boot_phase_end(int phase)
+{
+  if (phase >= 0)
+    phases[phase].end = sys_get_tick();
+}
+
+uint32_t boot_done(void)
+{
+  return __atomic_load_n(&boot_done_mask, __ATOMIC_ACQUIRE);
+}
+
+static int step_ready(int n)
+{
+  return (boot_steps[n].after & ~boot_done()) == 0;
+}
+
+static void step_run(int n)
+{
+  int phase = boot_phase_begin(boot_steps[n].name);
+
+  boot_steps[n].init();
+  boot_phase_end(phase);
+
+  __atomic_or_fetch(&boot_done_mask, BOOT_STEP(n), __ATOMIC_RELEASE);
+  smp_send_event();
+}
+
+// Claims and runs the ready steps of one kind; returns the number run.
+static int steps_run_ready(uint32_t flags)
+{
+  int ran = 0;
+
+  for (int n = 0; n < boot_count; n++) {
+    if ((boot_steps[n].flags & BOOT_ASYNC) != flags || !step_ready(n))
+      continue;
+    if (__atomic_fetch_or(&boot_claimed_mask, BOOT_STEP(n), __ATOMIC_ACQ_REL) &
+        BOOT_STEP(n))
+      continue;
+    step_run(n);
+    ran++;
+  }
+
+  return ran;
+}
+
+static void boot_secondary(void)
+{
+  while ((boot_done() & boot_async_mask) != boot_async_mask) {
+    if (!steps_run_ready(BOOT_ASYNC))
+      smp_wait_for_event();
+  }
+
+  // Core 0 puts this core back into reset once it sees the parked state,
+  // so nothing may be left in its L1.
+  mmu_flush_dcache();
+  __atomic_store_n(&boot_secondary_state, 2, __ATOMIC_RELEASE);
+  smp_send_event();
+  for (;;)
+    smp_wait_for_event();
+}
+
+// Releases core 1 once the asynchronous steps are done, so the application
+// can start its own work there.
+static void boot_secondary_stop(void)
+{
+  if (__atomic_load_n(&boot_secondary_state, __ATOMIC_ACQUIRE) == 2) {
+    smp_stop_secondary_core(1);
+    boot_secondary_state = 0;
+  }
+}
+
+void boot_run(const struct boot_step *steps, int count)
+{
+  uint32_t sync_mask = 0;
+
+  boot_steps        = steps;
+  boot_count        = count;
+  boot_async_mask   = 0;
+  boot_done_mask    = 0;
+  boot_claimed_mask = 0;
+
+  for (int n = 0; n < count; n++) {
+    if (steps[n].flags & BOOT_ASYNC)
+      boot_async_mask |= BOOT_STEP(n);
+    else
+      sync_mask |= BOOT_STEP(n);
+  }
+
+  if (boot_async_mask) {
+    boot_secondary_state = 1;
+    smp_start_secondary_core(1, boot_secondary, boot_stack, sizeof(boot_stack));
+  }
+
+  while ((boot_done() & sync_mask) != sync_mask) {
+    if (!steps_run_ready(0))
+      smp_wait_for_event();  // a synchronous step waits for an async one
+  }
+
+  boot_secondary_stop();
+}
+
+uint32_t boot_wait(uint32_t mask)
+{
+  while ((boot_done() & mask) != mask)
+    smp_wait_for_event();
+
+  boot_secondary_stop();
+  return boot_done();
+}
+
+int boot_get_phases(const struct boot_phase **p)
+{
+  uint32_t n = __atomic_load_n(&num_phases, __ATOMIC_ACQUIRE);
+
+  *p = phases;
+  return n < BOOT_MAX_PHASES ? n : BOOT_MAX_PHASES;
+}
+
+void boot_report(void)
+{
+  const struct boot_phase *p;
+  int n = boot_get_phases(&p);
+  uint8_t order[BOOT_MAX_PHASES];
+
+  if (n == 0)
+    return;
+
+  // Insertion sort by start time; both cores add phases.
+  for (int i = 0; i < n; i++) {
+    int j = i;
+    while (j > 0 && p[order[j - 1]].start > p[i].start) {
+      order[j] = order[j - 1];
+      j--;
+    }
+    order[j] = i;
+  }
+
+  uint64_t t0 = p[order[0]].start;
+  uint64_t last = t0;
+
+  printf("boot phase                 core   start ms  duration ms\n");
+  for (int i = 0; i < n; i++) {
+    const struct boot_phase *ph = &p[order[i]];
+    uint32_t start = sys_tick_to_usec(ph->start - t0);
+    uint32_t len   = sys_tick_to_usec(ph->end - ph->start);
+
+    if (ph->end > last)
+      last = ph->end;
+
+    if (ph->end == ph->start) {
+      printf("%-26s %4d %6lu.%03lu            -\n", ph->name, ph->core,
+             (unsigned long)(start / 1000), (unsigned long)(start % 1000));
+    } else {
+      printf("%-26s %4d %6lu.%03lu %8lu.%03lu\n", ph->name, ph->core,
+             (unsigned long)(start / 1000), (unsigned long)(start % 1000),
+             (unsigned long)(len / 1000), (unsigned long)(len % 1000));
+    }
+  }
+
+  uint32_t total = sys_tick_to_usec(last - t0);
+  printf("boot total %lu.%03lu ms\n", (unsigned long)(total / 1000),
+         (unsigned long)(total % 1000));
+}
@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: MIT
+// Boot phase timestamps and a dependency-driven init sequence.
+//
+// Every init step names the steps it has to run after. Core 0 runs the
+// synchronous steps in dependency order; asynchronous steps run on core 1
+// as soon as their dependencies are done, and may still be running when
+// boot_run() returns. Use boot_wait() before touching what they set up;
+// it also puts core 1 back into reset once the asynchronous steps are done,
+// so call it before starting anything else on core 1.
+//
+// Timestamps are raw arch timer ticks, so phases can be recorded before
+// the timer is calibrated; boot_report() converts them.
+
+#ifndef BOOTSEQ_H_
+#define BOOTSEQ_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define BOOT_MAX_STEPS   32
+#define BOOT_MAX_PHASES  48
+#define BOOT_STACK_SIZE  0x4000
+
+#define BOOT_STEP(n) (1UL << (n))
+
+// Step flags
+#define BOOT_ASYNC       (1 << 0)  // may run on core 1
+
+struct boot_step {
+  const char *name;
+  void (*init)(void);
+  uint32_t after;  // BOOT_STEP() mask of the steps that must be done first
+  uint32_t flags;
+};
+
+struct boot_phase {
+  const char *name;
+  uint64_t start;  // arch timer ticks
+  uint64_t end;    // == start for boot_mark()
+  int core;
+};
+
+// Runs steps[0 .. count - 1]; returns when all synchronous steps are done.
+void boot_run(const struct boot_step *steps, int count);
+// Waits until all steps in mask are done; returns the done mask.
+uint32_t boot_wait(uint32_t mask);
+uint32_t boot_done(void);
+
+// Records a point in time, e.g. "first DMX frame".
+void boot_mark(const char *name);
+// Records a phase outside of the step table, returns a handle for
+// boot_phase_end().
+int boot_phase_begin(const char *name);
+void boot_phase_end(int phase);
+
+int boot_get_phases(const struct boot_phase **phases);
+// Prints all phases relative to the first one, in order of start time.
+void boot_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // BOOTSEQ_H_
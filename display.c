@@ -11,10 +11,14 @@
 #include "uart.h"
 #include "util.h"
 
+#include "arm/memfunc.h"
+
 int display_is_digital;
 
 static uint32_t *framebuffer1 = 0;
 static uint32_t *framebuffer2 = 0;
+static void *framebuffer_mem[2];
+static int framebuffer_wc = 0;
 
 volatile uint32_t *display_active_buffer;
 volatile uint32_t *display_visible_buffer;
@@ -145,12 +149,49 @@ int display_init(const struct display_phys_mode_t *mode)
   }
 }
 
+int display_fb_write_combine = 0;
+
+// Write-combining framebuffers need sections of their own, so that the
+// attribute change does not hit unrelated heap data.
+static uint32_t fb_alloc_bytes(void)
+{
+  return (dsp.fb_bytes + MMU_SECTION_SIZE - 1) & ~(MMU_SECTION_SIZE - 1);
+}
+
+static uint32_t *fb_alloc(int n)
+{
+  uint32_t *fb;
+
+  if (!framebuffer_wc) {
+    framebuffer_mem[n] = calloc(1, dsp.fb_bytes);
+    return (uint32_t *)framebuffer_mem[n];
+  }
+
+  framebuffer_mem[n] = malloc(fb_alloc_bytes() + MMU_SECTION_SIZE);
+  if (!framebuffer_mem[n])
+    return 0;
+
+  fb = (uint32_t *)(((uint32_t)framebuffer_mem[n] + MMU_SECTION_SIZE - 1) &
+                    ~(MMU_SECTION_SIZE - 1));
+  mmu_set_region(fb, fb_alloc_bytes(), MMU_WRITE_COMBINE);
+  arm_memset(fb, 0, dsp.fb_bytes);
+  return fb;
+}
+
+static void fb_free(int n, uint32_t *fb)
+{
+  if (fb && framebuffer_wc)
+    mmu_set_region(fb, fb_alloc_bytes(), MMU_WRITE_BACK);
+  free(framebuffer_mem[n]);
+  framebuffer_mem[n] = 0;
+}
+
 // Allocates frame buffers and configures the display engine
 // to scale from the given resolution to the HDMI resolution.
 void display_set_mode(int x, int y, int ovx, int ovy)
 {
-  free(framebuffer1);
-  free(framebuffer2);
+  fb_free(0, framebuffer1);
+  fb_free(1, framebuffer2);
 
   dsp.ovx       = ovx;
   dsp.ovy       = ovy;
@@ -160,8 +201,9 @@ void display_set_mode(int x, int y, int ovx, int ovy)
   dsp.fb_height = y + ovy;
   dsp.fb_bytes  = (x + ovx * 2) * (y + ovy) * 4;
 
-  framebuffer1 = (uint32_t *)calloc(1, dsp.fb_bytes);
-  framebuffer2 = (uint32_t *)calloc(1, dsp.fb_bytes);
+  framebuffer_wc = display_fb_write_combine;
+  framebuffer1   = fb_alloc(0);
+  framebuffer2   = fb_alloc(1);
 
   display_active_buffer = framebuffer1;
 
@@ -176,10 +218,13 @@ int display_single_buffer = 0;
 void display_swap_buffers()
 {
   // Make sure whatever is in the active buffer is committed to memory.
-  // XXX: using a clean (c10) instead of a flush (c14) does not seem to do
-  // anything on the H3 (in fact, the data seems to be lost altogether). Not
-  // sure what is going on there...
-  mmu_flush_dcache();
+  // XXX: using a clean by set/way (c10) instead of a flush (c14) did not
+  // seem to do anything on the H3 (in fact, the data seemed to be lost
+  // altogether), so this flushes by address as well.
+  if (framebuffer_wc)
+    asm volatile("dsb" : : : "memory");
+  else
+    mmu_flush_dcache_range((const void *)display_active_buffer, dsp.fb_bytes);
 
   if (display_single_buffer)
     display_active_buffer = framebuffer1;
@@ -209,5 +254,5 @@ void display_swap_buffers()
 
 void display_clear_active_buffer(void)
 {
-  memset((void *)display_active_buffer, 0, dsp.fb_bytes);
+  arm_memset((void *)display_active_buffer, 0, dsp.fb_bytes);
 }
@@ -336,6 +336,9 @@ void display_clear_active_buffer(void);
 void display_enable_filter(int onoff);
 
 extern int display_single_buffer;
+// Map the framebuffers write-combining (uncached) instead of write-back.
+// Takes effect with the next display_set_mode().
+extern int display_fb_write_combine;
 
 extern volatile uint32_t *display_active_buffer;
 extern volatile uint32_t *display_visible_buffer;
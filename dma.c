@@ -46,7 +46,10 @@ void dma_memcpy(void *dest, void *src, int size, int channel)
 
   DMA_EN_REG(channel)        = 0;
   DMA_DESC_ADDR_REG(channel) = (uint32_t)&memcpy_desc;
-  mmu_flush_dcache();
+  // The descriptor is uncached. Commit the source, and make sure no dirty
+  // destination lines get written back over the transfer.
+  mmu_clean_dcache_range(src, size);
+  mmu_flush_dcache_range(dest, size);
   DMA_EN_REG(channel) = 1;
 }
 
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: MIT
+//
+// Host test of the boot sequence in bootseq.c; core 1 is a thread.
+//
+// The step table mixes synchronous steps with asynchronous ones, one of
+// them slow like a USB bus scan. The test checks that every step runs
+// exactly once, after its dependencies and on the right core, that
+// boot_run() returns while the slow step is still running, and that
+// boot_wait() only returns once the steps it waits for are done.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "bootseq.h"
+
+enum { STEP_CLOCKS, STEP_UART, STEP_USB, STEP_NETWORK, STEP_SDCARD,
+       STEP_KEYBOARD, STEP_DISPLAY, NUM_STEPS };
+
+#define CHECK(c)                                                   \
+  do {                                                             \
+    if (!(c)) {                                                    \
+      printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c);           \
+      errors++;                                                    \
+    }                                                              \
+  } while (0)
+
+static int errors;
+
+static volatile uint32_t num_runs;
+static int run_order[NUM_STEPS];
+static int run_count[NUM_STEPS];
+
+static void step(int n, long usec)
+{
+  struct timespec ts = { usec / 1000000, (usec % 1000000) * 1000 };
+
+  nanosleep(&ts, NULL);
+  run_order[n] = __atomic_fetch_add(&num_runs, 1, __ATOMIC_SEQ_CST);
+  __atomic_fetch_add(&run_count[n], 1, __ATOMIC_SEQ_CST);
+}
+
+static void clocks_init(void)   { step(STEP_CLOCKS, 1000); }
+static void uart_init(void)     { step(STEP_UART, 2000); }
+static void usb_init(void)      { step(STEP_USB, 30000); }
+static void network_init(void)  { step(STEP_NETWORK, 1000); }
+static void sdcard_init(void)   { step(STEP_SDCARD, 5000); }
+static void keyboard_init(void) { step(STEP_KEYBOARD, 1000); }
+static void display_init(void)  { step(STEP_DISPLAY, 1000); }
+
+static const struct boot_step steps[NUM_STEPS] = {
+  [STEP_CLOCKS]   = { "clocks", clocks_init, 0, 0 },
+  [STEP_UART]     = { "uart", uart_init, BOOT_STEP(STEP_CLOCKS), 0 },
+  [STEP_USB]      = { "usb", usb_init, BOOT_STEP(STEP_UART), BOOT_ASYNC },
+  [STEP_NETWORK]  = { "network", network_init, BOOT_STEP(STEP_UART), 0 },
+  [STEP_SDCARD]   = { "sdcard", sdcard_init, BOOT_STEP(STEP_CLOCKS), BOOT_ASYNC },
+  [STEP_KEYBOARD] = { "keyboard", keyboard_init, BOOT_STEP(STEP_USB), BOOT_ASYNC },
+  [STEP_DISPLAY]  = { "display", display_init, BOOT_STEP(STEP_NETWORK), 0 },
+};
+
+static int step_core(const char *name)
+{
+  const struct boot_phase *p;
+  int n = boot_get_phases(&p);
+
+  for (int i = 0; i < n; i++) {
+    if (p[i].name == name)
+      return p[i].core;
+  }
+
+  return -1;
+}
+
+int main(void)
+{
+  const uint32_t sync_mask = BOOT_STEP(STEP_CLOCKS) | BOOT_STEP(STEP_UART) |
+                             BOOT_STEP(STEP_NETWORK) | BOOT_STEP(STEP_DISPLAY);
+
+  boot_mark("reset");
+  boot_run(steps, NUM_STEPS);
+
+  uint32_t done = boot_done();
+  CHECK((done & sync_mask) == sync_mask);
+  // The 30 ms USB scan overlaps the synchronous steps.
+  CHECK(!(done & BOOT_STEP(STEP_USB)));
+
+  boot_mark("main");
+  done = boot_wait(BOOT_STEP(STEP_KEYBOARD) | BOOT_STEP(STEP_SDCARD));
+  CHECK((done & BOOT_STEP(STEP_KEYBOARD)) && (done & BOOT_STEP(STEP_USB)));
+  CHECK(done == BOOT_STEP(NUM_STEPS) - 1);
+  CHECK(num_runs == NUM_STEPS);
+
+  for (int n = 0; n < NUM_STEPS; n++) {
+    CHECK(run_count[n] == 1);
+    for (int m = 0; m < NUM_STEPS; m++) {
+      if (steps[n].after & BOOT_STEP(m))
+        CHECK(run_order[m] < run_order[n]);
+    }
+    CHECK(step_core(steps[n].name) == ((steps[n].flags & BOOT_ASYNC) ? 1 : 0));
+  }
+
+  boot_report();
+
+  if (errors) {
+    printf("FAILED: %d errors\n", errors);
+    return EXIT_FAILURE;
+  }
+
+  puts("PASSED");
+  return EXIT_SUCCESS;
+}
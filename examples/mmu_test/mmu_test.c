@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: MIT
+//
+// Host test of the page table code in mmu.c. The host build keeps the table
+// in mmu_host_table and calls the TLB and barrier hooks below.
+//
+// The test checks that the default map decodes to the table mmu_init() used
+// to build section by section, that supersections are fully replicated, that
+// mmu_set_region() splits and re-merges supersections bit-identically, and
+// that every descriptor it changes goes break-before-make: invalid, TLB
+// invalidate by MVA, barrier, and only then the new descriptor.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "mmu.h"
+
+#define SUPER (1 << 18)
+
+// Section attributes as encoded by mmu.c.
+#define ATTRS_SO (3 << 10 | 2)
+#define ATTRS_DEVICE (3 << 10 | 1 << 2 | 2)
+#define ATTRS_WC (1 << 16 | 1 << 12 | 3 << 10 | 2)
+#define ATTRS_WB (1 << 16 | 1 << 12 | 3 << 10 | 3 << 2 | 2)
+
+#define CHECK(c)                                                   \
+  do {                                                             \
+    if (!(c)) {                                                    \
+      printf("FAIL %s:%d %s\n", __FILE__, __LINE__, #c);           \
+      errors++;                                                    \
+    }                                                              \
+  } while (0)
+
+extern uint32_t mmu_host_table[MMU_TABLE_ENTRIES];
+
+static int errors;
+
+// Per MiB: 1 after a TLB invalidate of an invalid entry, 2 once a barrier
+// followed while the entry was still invalid.
+static uint8_t bbm_state[MMU_TABLE_ENTRIES];
+static uint32_t tlb_invalidates;
+
+void mmu_host_tlbimvais(uint32_t mva)
+{
+  uint32_t n = mva >> 20;
+
+  tlb_invalidates++;
+  CHECK((mva & (MMU_SECTION_SIZE - 1)) == 0);
+  CHECK(mmu_host_table[n] == 0);
+  bbm_state[n] = 1;
+}
+
+void mmu_host_dsb(void)
+{
+  for (uint32_t n = 0; n < MMU_TABLE_ENTRIES; n++) {
+    if (bbm_state[n] == 1 && mmu_host_table[n] == 0)
+      bbm_state[n] = 2;
+  }
+}
+
+// The table mmu_init() built before regions and supersections.
+static uint32_t old_entry(uint32_t n)
+{
+  if (n == 0 || (n >= 0x400 && n < 0x410) || (n >= 0x420 && n < 0xc00))
+    return (n << 20) | ATTRS_WB;
+  if (n >= 0x410 && n < 0x420)
+    return (n << 20) | ATTRS_WC;
+  return (n << 20) | ATTRS_SO;
+}
+
+// Decodes an entry to the section descriptor of the MiB it maps.
+static uint32_t decode(const uint32_t *table, uint32_t n)
+{
+  uint32_t desc = table[n];
+
+  if (desc & SUPER) {
+    CHECK((desc >> 24) == (n >> 4));
+    CHECK(((desc >> 20) & 0xf) == 0);
+    return (n << 20) | (desc & 0x000fffff & ~SUPER);
+  }
+
+  CHECK((desc >> 20) == n);
+  return desc;
+}
+
+static void check_replicated(const uint32_t *table)
+{
+  for (uint32_t g = 0; g < MMU_TABLE_ENTRIES / 16; g++) {
+    if (!(table[g * 16] & SUPER))
+      continue;
+    for (uint32_t i = 1; i < 16; i++)
+      CHECK(table[g * 16 + i] == table[g * 16]);
+  }
+}
+
+// Runs mmu_set_region() and checks that exactly the changed descriptors
+// went break-before-make. Returns the number of changed descriptors.
+static uint32_t set_region(uint32_t start, uint32_t size, uint32_t attr)
+{
+  static uint32_t before[MMU_TABLE_ENTRIES];
+  uint32_t changed = 0;
+
+  memcpy(before, mmu_host_table, sizeof(before));
+  memset(bbm_state, 0, sizeof(bbm_state));
+  tlb_invalidates = 0;
+
+  CHECK(mmu_set_region((void *)(uintptr_t)start, size, attr) == 0);
+
+  for (uint32_t n = 0; n < MMU_TABLE_ENTRIES; n++) {
+    if (mmu_host_table[n] != before[n]) {
+      CHECK(bbm_state[n] == 2);
+      changed++;
+    } else {
+      CHECK(bbm_state[n] == 0);
+    }
+  }
+
+  CHECK(tlb_invalidates == changed);
+  check_replicated(mmu_host_table);
+
+  return changed;
+}
+
+static void test_default_map(void)
+{
+  mmu_init();
+
+  for (uint32_t n = 0; n < MMU_TABLE_ENTRIES; n++)
+    CHECK(decode(mmu_host_table, n) == old_entry(n));
+
+  // The MiB of SRAM shares its group with strongly ordered space.
+  CHECK(mmu_host_table[0] == old_entry(0));
+  CHECK(mmu_host_table[0x400] & SUPER);
+  check_replicated(mmu_host_table);
+}
+
+static void test_set_region(void)
+{
+  static uint32_t saved[MMU_TABLE_ENTRIES];
+
+  mmu_init();
+  memcpy(saved, mmu_host_table, sizeof(saved));
+
+  // 3 MiB write-combining inside a supersection splits all of it.
+  CHECK(set_region(0x50300000, 0x00300000, MMU_WRITE_COMBINE) == 16);
+  CHECK(!(mmu_host_table[0x500] & SUPER));
+  for (uint32_t n = 0x500; n < 0x510; n++) {
+    uint32_t expected = (n >= 0x503 && n < 0x506) ? ((n << 20) | ATTRS_WC)
+                                                  : old_entry(n);
+    CHECK(decode(mmu_host_table, n) == expected);
+  }
+
+  // Back to write-back merges it again.
+  CHECK(set_region(0x50300000, 0x00300000, MMU_WRITE_BACK) == 16);
+  CHECK(memcmp(saved, mmu_host_table, sizeof(saved)) == 0);
+
+  // Sections only: just the one descriptor changes.
+  CHECK(set_region(0x00200000, MMU_SECTION_SIZE, MMU_DEVICE) == 1);
+  CHECK(mmu_host_table[2] == ((2u << 20) | ATTRS_DEVICE));
+  CHECK(set_region(0x00200000, MMU_SECTION_SIZE, MMU_STRONGLY_ORDERED) == 1);
+  CHECK(memcmp(saved, mmu_host_table, sizeof(saved)) == 0);
+
+  // A whole supersection changing attributes, spanning two groups.
+  CHECK(set_region(0x60000000, 0x02000000, MMU_WRITE_THROUGH) == 32);
+  CHECK(mmu_host_table[0x600] & SUPER);
+  CHECK(mmu_host_table[0x610] & SUPER);
+  CHECK(set_region(0x60000000, 0x02000000, MMU_WRITE_BACK) == 32);
+  CHECK(memcmp(saved, mmu_host_table, sizeof(saved)) == 0);
+
+  // Nothing changes, nothing is invalidated.
+  CHECK(set_region(0x40000000, 0x01000000, MMU_WRITE_BACK) == 0);
+
+  // Bad ranges leave the table alone.
+  CHECK(mmu_set_region((void *)0x40080000, MMU_SECTION_SIZE, MMU_DEVICE) == -1);
+  CHECK(mmu_set_region((void *)0x40000000, 0, MMU_DEVICE) == -1);
+  CHECK(mmu_set_region((void *)0xfff00000, 0x00200000, MMU_DEVICE) == -1);
+  CHECK(memcmp(saved, mmu_host_table, sizeof(saved)) == 0);
+}
+
+static void test_build_table(void)
+{
+  static uint32_t table[MMU_TABLE_ENTRIES];
+
+  const struct mmu_region bad[] = {
+    { 0x40080000, MMU_SECTION_SIZE, MMU_WRITE_BACK },
+    { 0xfff00000, 0x00200000, MMU_WRITE_BACK },
+    { 0x40000000, 0, MMU_WRITE_BACK },
+  };
+  for (uint32_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++)
+    CHECK(mmu_build_table(table, &bad[i], 1) == -1);
+
+  // Empty map: all strongly ordered supersections.
+  CHECK(mmu_build_table(table, NULL, 0) == MMU_TABLE_ENTRIES / 16);
+
+  // The last region wins; a broken 16 MiB run stays sections.
+  const struct mmu_region regions[] = {
+    { 0x40000000, 0x02000000, MMU_WRITE_BACK },
+    { 0x40800000, MMU_SECTION_SIZE, MMU_DEVICE },
+  };
+  CHECK(mmu_build_table(table, regions, 2) == MMU_TABLE_ENTRIES / 16 - 1);
+  CHECK(table[0x408] == ((0x408u << 20) | ATTRS_DEVICE));
+  CHECK(table[0x410] & SUPER);
+}
+
+int main(void)
+{
+  test_default_map();
+  test_set_region();
+  test_build_table();
+
+  if (errors) {
+    printf("FAILED: %d errors\n", errors);
+    return EXIT_FAILURE;
+  }
+
+  puts("PASSED");
+  return EXIT_SUCCESS;
+}
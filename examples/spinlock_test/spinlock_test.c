@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: MIT
+//
+// Host stress test of the locks in spinlock.c, built on the GCC atomic
+// builtins under __linux__.
+//
+// 2, 3 and 4 threads increment a shared counter 200000 times each under the
+// test-and-set lock, the ticket lock and the MCS lock; the counter must be
+// exact. Ticket wrap-around from 0xfffe and trylock on a held lock are
+// checked as well. Built twice, with and without SPINLOCK_STATS.
+//
+// The ns per acquisition are only meaningful on a host with at least 4 CPUs:
+// a preempted waiter stalls a fair lock for everyone queued behind it.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "spinlock.h"
+
+#define ITERATIONS   200000
+#define MAX_THREADS  4
+
+enum lock_kind { LOCK_TAS, LOCK_TICKET, LOCK_MCS };
+
+static const char *const s_names[] = { "tas", "ticket", "mcs" };
+
+static spinlock_t s_tas;
+static ticket_lock_t s_ticket = TICKET_LOCK_INIT;
+static mcs_lock_t s_mcs = MCS_LOCK_INIT;
+
+static volatile unsigned long s_counter;
+static enum lock_kind s_kind;
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void *worker(void *arg) {
+  (void)arg;
+
+  for (int i = 0; i < ITERATIONS; i++) {
+    struct mcs_node node;
+
+    switch (s_kind) {
+    case LOCK_TAS:
+      spin_lock(&s_tas);
+      break;
+    case LOCK_TICKET:
+      ticket_lock(&s_ticket);
+      break;
+    case LOCK_MCS:
+      mcs_lock(&s_mcs, &node);
+      break;
+    }
+
+    // Read-modify-write that loses updates without mutual exclusion
+    const unsigned long counter = s_counter;
+    s_counter = counter + 1;
+
+    switch (s_kind) {
+    case LOCK_TAS:
+      spin_unlock(&s_tas);
+      break;
+    case LOCK_TICKET:
+      ticket_unlock(&s_ticket);
+      break;
+    case LOCK_MCS:
+      mcs_unlock(&s_mcs, &node);
+      break;
+    }
+  }
+
+  return NULL;
+}
+
+int main(void) {
+  int errors = 0;
+
+  for (s_kind = LOCK_TAS; s_kind <= LOCK_MCS; s_kind++) {
+    for (int threads = 2; threads <= MAX_THREADS; threads++) {
+      pthread_t thread[MAX_THREADS];
+
+      s_counter = 0;
+
+      const double start = now_ns();
+
+      for (int i = 0; i < threads; i++) {
+        pthread_create(&thread[i], NULL, worker, NULL);
+      }
+
+      for (int i = 0; i < threads; i++) {
+        pthread_join(thread[i], NULL);
+      }
+
+      const double elapsed = now_ns() - start;
+      const int ok = s_counter == (unsigned long)threads * ITERATIONS;
+
+      errors += !ok;
+
+      printf("%-6s %d threads: counter %s, %.1f ns/acquisition\n", s_names[s_kind],
+             threads, ok ? "ok" : "WRONG", elapsed / (threads * ITERATIONS));
+    }
+  }
+
+#ifdef SPINLOCK_STATS
+  printf("ticket: acquisitions %u, contended %u, max wait %u\n", s_ticket.stats.acquisitions,
+         s_ticket.stats.contended, s_ticket.stats.max_wait_cycles);
+  printf("mcs:    acquisitions %u, contended %u, max wait %u\n", s_mcs.stats.acquisitions,
+         s_mcs.stats.contended, s_mcs.stats.max_wait_cycles);
+
+  errors += s_ticket.stats.acquisitions != (2 + 3 + 4) * ITERATIONS;
+  errors += s_mcs.stats.acquisitions != (2 + 3 + 4) * ITERATIONS;
+#endif
+
+  ticket_lock_t wrap = TICKET_LOCK_INIT;
+  wrap.slock = 0xFFFEFFFE;
+
+  for (int i = 0; i < 5; i++) {
+    ticket_lock(&wrap);
+    if (ticket_trylock(&wrap)) {
+      puts("ticket_trylock succeeded on a held lock");
+      errors++;
+    }
+    ticket_unlock(&wrap);
+  }
+
+  if (wrap.slock != 0x00030003) {
+    printf("ticket wrap-around: %08x\n", wrap.slock);
+    errors++;
+  }
+
+  if (!ticket_trylock(&wrap)) {
+    puts("ticket_trylock failed on a free lock");
+    errors++;
+  }
+
+  if (errors != 0) {
+    printf("FAILED: %d errors\n", errors);
+    return EXIT_FAILURE;
+  }
+
+  puts("PASSED");
+  return EXIT_SUCCESS;
+}
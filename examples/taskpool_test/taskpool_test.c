@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: MIT
+//
+// Host test and benchmark of the task pool. Under __linux__ taskpool.c runs
+// on pthreads: threads stand in for the cores, sched_yield for wfe.
+//
+// - parallel_for encoding 8 WS28xx pixel ports of 680 pixels, compared
+//   with a serial encode
+// - parallel_for over 1000 indices, grain 0: every index runs exactly once
+// - 20 nested groups of 10 tasks each, spawned from tasks
+//
+// Usage: taskpool_test [cores]
+// The speedup is only meaningful on a host with at least that many CPUs.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "taskpool.h"
+
+#define PORTS        8
+#define PIXELS       680
+#define RUNS         2000
+
+static uint8_t s_in[PORTS][PIXELS * 3];
+static uint8_t s_out[PORTS][PIXELS * 3 * 4];
+static uint8_t s_ref[PORTS][PIXELS * 3 * 4];
+
+static volatile uint32_t s_counter[1000];
+static uint32_t s_leaves;
+
+static double now_us(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+}
+
+// WS2812 over SPI: 4 SPI bits per data bit
+static void encode(uint8_t *out, const uint8_t *in, int n) {
+  for (int i = 0; i < n; i++) {
+    uint8_t b = in[i];
+    for (int k = 0; k < 4; k++) {
+      uint8_t v = 0;
+      for (int j = 0; j < 2; j++) {
+        v <<= 4;
+        v |= (b & 0x80) ? 0xE : 0x8;
+        b <<= 1;
+      }
+      *out++ = v;
+    }
+  }
+}
+
+static void encode_ports(void *arg, uint32_t begin, uint32_t end) {
+  (void)arg;
+  for (uint32_t port = begin; port < end; port++) {
+    encode(s_out[port], s_in[port], PIXELS * 3);
+  }
+}
+
+static void count_indices(void *arg, uint32_t begin, uint32_t end) {
+  (void)arg;
+  for (uint32_t i = begin; i < end; i++) {
+    __atomic_add_fetch(&s_counter[i], 1, __ATOMIC_RELAXED);
+  }
+}
+
+static void leaf(void *arg) {
+  (void)arg;
+  __atomic_add_fetch(&s_leaves, 1, __ATOMIC_RELAXED);
+}
+
+static void node(void *arg) {
+  struct task_group group;
+  task_group_init(&group);
+  for (int i = 0; i < 10; i++) {
+    task_spawn(&group, leaf, arg);
+  }
+  task_group_wait(&group);
+}
+
+int main(int argc, char **argv) {
+  const int cores = argc > 1 ? atoi(argv[1]) : TASKPOOL_MAX_CORES;
+  int errors = 0;
+
+  taskpool_init(cores);
+
+  for (int port = 0; port < PORTS; port++) {
+    for (int i = 0; i < PIXELS * 3; i++) {
+      s_in[port][i] = (uint8_t)(port * 31 + i * 7);
+    }
+  }
+
+  encode_ports(NULL, 0, PORTS);
+  memcpy(s_ref, s_out, sizeof(s_out));
+
+  for (int run = 0; run < RUNS; run++) {
+    memset(s_out, 0, sizeof(s_out));
+    parallel_for(encode_ports, NULL, 0, PORTS, 1);
+    errors += memcmp(s_out, s_ref, sizeof(s_out)) != 0;
+  }
+
+  for (int run = 0; run < 1000; run++) {
+    parallel_for(count_indices, NULL, 0, 1000, 0);
+  }
+
+  for (int i = 0; i < 1000; i++) {
+    errors += s_counter[i] != 1000;
+  }
+
+  for (int run = 0; run < 200; run++) {
+    struct task_group group;
+    task_group_init(&group);
+    for (int i = 0; i < 20; i++) {
+      task_spawn(&group, node, NULL);
+    }
+    task_group_wait(&group);
+  }
+
+  errors += s_leaves != 200 * 20 * 10;
+
+  double start = now_us();
+  for (int run = 0; run < RUNS; run++) {
+    encode_ports(NULL, 0, PORTS);
+  }
+  const double serial = (now_us() - start) / RUNS;
+
+  start = now_us();
+  for (int run = 0; run < RUNS; run++) {
+    parallel_for(encode_ports, NULL, 0, PORTS, 1);
+  }
+  const double parallel = (now_us() - start) / RUNS;
+
+  struct taskpool_stats stats;
+  taskpool_get_stats(&stats);
+
+  printf("cores %d: 8 ports serial %.0f us, parallel %.0f us, speedup %.2f\n",
+         cores, serial, parallel, serial / parallel);
+
+  for (int core = 0; core < cores; core++) {
+    printf(" core %d: executed %u, stolen %u, inlined %u\n", core,
+           stats.executed[core], stats.stolen[core], stats.inlined[core]);
+  }
+
+  if (errors != 0) {
+    printf("FAILED: %d errors\n", errors);
+    return EXIT_FAILURE;
+  }
+
+  puts("PASSED");
+  return EXIT_SUCCESS;
+}
@@ -80,7 +80,7 @@ static inline void icache_sync(unsigned long addr, size_t len)
 	//icache_inval_range(start, end);
 
 	// This works ok on v7.
-	mmu_flush_dcache();
+	mmu_clean_dcache_range((const void *)start, end - start);
 	asm volatile ("mcr p15, 0, %0, c7, c5, 0" : : "r" (0)); // iciallu
 	asm volatile ("isb");
 }
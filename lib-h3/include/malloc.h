@@ -0,0 +1,69 @@
+/**
+ * @file malloc.h
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef MALLOC_H_
+#define MALLOC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct mem_stats {
+	size_t heap_size;		///< heap_low .. heap_top
+	size_t heap_used;		///< Chunks carved so far, excluding the static arena
+	size_t heap_peak;
+	size_t static_used;		///< Static arena
+	size_t in_use;			///< Chunks handed out, including blocks held in the core caches
+	size_t in_use_peak;
+	size_t free_large;		///< Free chunks waiting for reuse
+	size_t free_large_max;	///< Largest free chunk
+	size_t free_cached;		///< Small blocks held in the core caches
+	uint32_t malloc_count;
+	uint32_t free_count;
+	uint32_t cache_hits;
+	uint32_t failed;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Allocations between begin and end come from the static arena and are never
+ * released. Use this for buffers that live as long as the firmware.
+ * The mode is per core, call both from thread context only.
+ */
+extern void mem_static_begin(void);
+extern void mem_static_end(void);
+
+extern void mem_get_stats(struct mem_stats *stats);
+extern void mem_info(void);
+
+extern size_t get_allocated(void *p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MALLOC_H_ */
@@ -29,6 +29,16 @@
 #include <ctype.h>
 #include <stddef.h>
 
+#include "arm/memfunc.h"
+
+/*
+ * Small constant sizes are expanded inline, everything else goes to the
+ * word loops in lib-arm. These stay on the core registers, as memcpy, memset
+ * and memcmp are also used in IRQ/FIQ handlers. Thread context code can call
+ * the NEON arm_memcpy/arm_memset/arm_memcmp explicitly.
+ */
+#define STRING_INLINE_MAX	16
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -39,6 +49,10 @@ inline static int memcmp(const void *s1, const void *s2, size_t n) {
 	unsigned char u1, u2;
 	unsigned char *t1, *t2;
 
+	if (!(__builtin_constant_p(n) && (n <= STRING_INLINE_MAX))) {
+		return arm_memcmp_scalar(s1, s2, n);
+	}
+
 	t1 = (unsigned char *) s1;
 	t2 = (unsigned char *) s2;
 
@@ -57,6 +71,10 @@ inline static void* memcpy(void *__restrict__ dest, const void *__restrict__ src
 	char *dp = (char *) dest;
 	const char *sp = (const char *) src;
 
+	if (!(__builtin_constant_p(n) && (n <= STRING_INLINE_MAX))) {
+		return arm_memcpy_scalar(dest, src, n);
+	}
+
 	while (n-- != (size_t) 0) {
 		*dp++ = *sp++;
 	}
@@ -90,6 +108,10 @@ inline static void *memmove(/*@only@*/void *dst, const void *src, size_t n) {
 inline static void *memset(/*@only@*/void *dest, int c, size_t n) {
 	char *dp = (char *) dest;
 
+	if (!(__builtin_constant_p(n) && (n <= STRING_INLINE_MAX))) {
+		return arm_memset_scalar(dest, c, n);
+	}
+
 	while (n-- != (size_t) 0) {
 		*dp++ = (char) c;
 	}
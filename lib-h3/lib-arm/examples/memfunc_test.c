@@ -0,0 +1,199 @@
+/**
+ * @file memfunc_test.c
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Host conformance test and benchmark for src/memfunc.c and the lib-c
+ * memcpy/memset, against the host libc.
+ *
+ * - every length 0..599 and 1024..1040, 2048 with destination and source
+ *   alignments 0..15; the bytes around the destination must be untouched
+ * - compare with a mismatch at the first, middle and last byte, and equal
+ * - compare-and-copy: the copy and the changed flag
+ *
+ * On the host (no NEON) the arm_* functions are the word loops.
+ * The NEON memfunc.S needs an ARMv7 target.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "arm/memfunc.h"
+
+extern void *lib_memcpy(void *, const void *, size_t);
+extern void *lib_memset(void *, int, size_t);
+
+#define BUFFER_SIZE		4096
+#define GUARD			32
+
+static uint8_t s_dst[BUFFER_SIZE] __attribute__((aligned(16)));
+static uint8_t s_ref[BUFFER_SIZE] __attribute__((aligned(16)));
+static uint8_t s_src[BUFFER_SIZE] __attribute__((aligned(16)));
+static unsigned s_errors;
+static unsigned s_cases;
+
+#define CHECK(cond, ...)	do { if (!(cond)) { if (s_errors++ < 10) { printf(__VA_ARGS__); } } } while (0)
+
+static uint32_t s_seed = 12345;
+static size_t s_window;		/* Bytes of the buffers used by the current length */
+
+static int sign(int n) {
+	return (n > 0) - (n < 0);
+}
+
+static uint32_t xorshift32(void) {
+	s_seed ^= s_seed << 13;
+	s_seed ^= s_seed >> 17;
+	s_seed ^= s_seed << 5;
+	return s_seed;
+}
+
+static void fill_random(void) {
+	for (size_t i = 0; i < s_window; i += 4) {
+		const uint32_t d = xorshift32();
+		const uint32_t s = xorshift32();
+		memcpy(&s_dst[i], &d, 4);
+		memcpy(&s_src[i], &s, 4);
+	}
+
+	memcpy(s_ref, s_dst, s_window);
+}
+
+typedef void *(*copy_t)(void *, const void *, size_t);
+typedef void *(*set_t)(void *, int, size_t);
+typedef int (*compare_t)(const void *, const void *, size_t);
+
+static void test_length(size_t n, uint32_t da, uint32_t sa) {
+	static const struct {
+		const char *name;
+		copy_t copy;
+		set_t set;
+		compare_t compare;
+	} funcs[] = {
+		{ "arm", arm_memcpy, arm_memset, arm_memcmp },
+		{ "scalar", arm_memcpy_scalar, arm_memset_scalar, arm_memcmp_scalar },
+		{ "lib-c", lib_memcpy, lib_memset, NULL }
+	};
+
+	uint8_t *pDst = &s_dst[GUARD + da];
+	uint8_t *pRef = &s_ref[GUARD + da];
+	const uint8_t *pSrc = &s_src[GUARD + sa];
+
+	s_window = (GUARD + 16 + n + GUARD + 3) & ~(size_t) 3;
+
+	for (uint32_t f = 0; f < sizeof(funcs) / sizeof(funcs[0]); f++) {
+		fill_random();
+		CHECK(funcs[f].copy(pDst, pSrc, n) == pDst, "%s_memcpy n=%zu: wrong return value\n", funcs[f].name, n);
+		memcpy(pRef, pSrc, n);
+		CHECK(memcmp(s_dst, s_ref, s_window) == 0, "%s_memcpy n=%zu da=%u sa=%u\n", funcs[f].name, n, da, sa);
+
+		fill_random();
+		CHECK(funcs[f].set(pDst, 0x1A5, n) == pDst, "%s_memset n=%zu: wrong return value\n", funcs[f].name, n);
+		memset(pRef, 0xA5, n);
+		CHECK(memcmp(s_dst, s_ref, s_window) == 0, "%s_memset n=%zu da=%u\n", funcs[f].name, n, da);
+
+		if (funcs[f].compare != NULL) {
+			memcpy(pDst, pSrc, n);
+			CHECK(funcs[f].compare(pDst, pSrc, n) == 0, "%s_memcmp n=%zu da=%u sa=%u: equal\n", funcs[f].name, n, da, sa);
+
+			if (n != 0) {
+				const size_t at[3] = { 0, n / 2, n - 1 };
+
+				for (uint32_t i = 0; i < 3; i++) {
+					pDst[at[i]] ^= 0x80;
+					CHECK(sign(funcs[f].compare(pDst, pSrc, n)) == sign(memcmp(pDst, pSrc, n)), "%s_memcmp n=%zu da=%u sa=%u: mismatch at %zu\n", funcs[f].name, n, da, sa, at[i]);
+					pDst[at[i]] ^= 0x80;
+				}
+			}
+		}
+
+		s_cases++;
+	}
+
+	fill_random();
+
+	if ((n != 0) && (n & 1)) {
+		memcpy(pDst, pSrc, n);
+		pDst[n / 2] ^= 0x01;
+		memcpy(s_ref, s_dst, s_window);
+	}
+
+	const int changed = memcmp(pDst, pSrc, n) != 0;
+	memcpy(pRef, pSrc, n);
+
+	CHECK(arm_memcmpcpy(pDst, pSrc, n) == changed, "arm_memcmpcpy n=%zu da=%u sa=%u: changed flag\n", n, da, sa);
+	CHECK(memcmp(s_dst, s_ref, s_window) == 0, "arm_memcmpcpy n=%zu da=%u sa=%u: copy\n", n, da, sa);
+
+	s_cases++;
+}
+
+static double bench_ns(copy_t copy, size_t n, uint32_t iterations) {
+	struct timespec start, end;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for (uint32_t i = 0; i < iterations; i++) {
+		copy(s_dst, s_src, n);
+		__asm__ volatile ("" ::: "memory");
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	return ((double) (end.tv_sec - start.tv_sec) * 1e9 + (double) (end.tv_nsec - start.tv_nsec)) / iterations;
+}
+
+int main(void) {
+	for (uint32_t da = 0; da < 16; da++) {
+		for (uint32_t sa = 0; sa < 16; sa++) {
+			for (size_t n = 0; n < 600; n++) {
+				test_length(n, da, sa);
+			}
+
+			for (size_t n = 1024; n <= 1040; n++) {
+				test_length(n, da, sa);
+			}
+
+			test_length(2048, da, sa);
+		}
+	}
+
+	printf("%u cases\n", s_cases);
+
+	const uint32_t iterations = 1000000;
+
+	for (size_t n = 64; n <= 2048; n *= 4) {
+		printf("copy %4zu bytes: arm %6.1f ns, libc %6.1f ns\n", n, bench_ns(arm_memcpy, n, iterations), bench_ns(memcpy, n, iterations));
+	}
+
+	if (s_errors != 0) {
+		printf("FAILED: %u errors\n", s_errors);
+		return EXIT_FAILURE;
+	}
+
+	puts("PASSED");
+	return EXIT_SUCCESS;
+}
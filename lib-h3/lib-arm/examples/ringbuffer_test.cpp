@@ -0,0 +1,230 @@
+/**
+ * @file ringbuffer_test.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Host stress test and benchmark of arm/ringbuffer.h on pthreads.
+ *
+ *  spsc   : 5M items through a 1024 entry ring, must arrive in order
+ *  mpsc   : 3 producers, the order per producer must be kept
+ *  triple : 5M publishes of a 64-byte frame, the reader must never see a
+ *           torn frame or a frame older than the previous one
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <atomic>
+
+#include "arm/ringbuffer.h"
+
+namespace test {
+static constexpr uint32_t COUNT = 5000000;
+static constexpr uint32_t PRODUCERS = 3;
+}  // namespace test
+
+struct Frame {
+	uint32_t nSequence;
+	uint32_t aData[15];
+};
+
+static ring::Spsc<uint32_t, 1024> s_Spsc;
+static ring::Mpsc<uint64_t, 1024> s_Mpsc;
+static ring::TripleBuffer<Frame> s_TripleBuffer;
+static std::atomic<bool> s_bPublished { false };
+
+static double now_s() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+}
+
+static void *spsc_producer(__attribute__((unused)) void *pArg) {
+	for (uint32_t i = 0; i < test::COUNT;) {
+		if (s_Spsc.Push(i)) {
+			i++;
+		} else {
+			sched_yield();
+		}
+	}
+
+	return nullptr;
+}
+
+static void *mpsc_producer(void *pArg) {
+	const auto nId = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pArg));
+
+	for (uint32_t i = 0; i < test::COUNT / test::PRODUCERS;) {
+		if (s_Mpsc.Push((nId << 32) | i)) {
+			i++;
+		} else {
+			sched_yield();
+		}
+	}
+
+	return nullptr;
+}
+
+static void *triple_producer(__attribute__((unused)) void *pArg) {
+	for (uint32_t nSequence = 1; nSequence <= test::COUNT; nSequence++) {
+		auto& frame = s_TripleBuffer.GetBack();
+
+		frame.nSequence = nSequence;
+		for (uint32_t k = 0; k < 15; k++) {
+			frame.aData[k] = nSequence * k;
+		}
+
+		s_TripleBuffer.Publish();
+	}
+
+	s_bPublished = true;
+	return nullptr;
+}
+
+static uint32_t test_spsc() {
+	uint32_t nErrors = 0;
+	pthread_t thread;
+
+	const auto fStart = now_s();
+	pthread_create(&thread, nullptr, spsc_producer, nullptr);
+
+	for (uint32_t nExpected = 0; nExpected < test::COUNT;) {
+		uint32_t nItem;
+
+		if (s_Spsc.Pop(nItem)) {
+			nErrors += (nItem != nExpected);
+			nExpected++;
+		} else {
+			sched_yield();
+		}
+	}
+
+	pthread_join(thread, nullptr);
+
+	printf("spsc   : %u items, %u errors, %.1f Mops/s\n", test::COUNT, nErrors, test::COUNT / (now_s() - fStart) / 1e6);
+	return nErrors;
+}
+
+static uint32_t test_mpsc() {
+	uint32_t nErrors = 0;
+	pthread_t threads[test::PRODUCERS];
+	uint32_t nNext[test::PRODUCERS] = {};
+	uint32_t nReceived = 0;
+
+	const auto fStart = now_s();
+
+	for (uint32_t i = 0; i < test::PRODUCERS; i++) {
+		pthread_create(&threads[i], nullptr, mpsc_producer, reinterpret_cast<void *>(static_cast<uintptr_t>(i)));
+	}
+
+	while (nReceived < (test::COUNT / test::PRODUCERS) * test::PRODUCERS) {
+		uint64_t nItem;
+
+		if (s_Mpsc.Pop(nItem)) {
+			const auto nId = static_cast<uint32_t>(nItem >> 32);
+			const auto nIndex = static_cast<uint32_t>(nItem);
+
+			if ((nId >= test::PRODUCERS) || (nIndex != nNext[nId])) {
+				nErrors++;
+			} else {
+				nNext[nId] = nIndex + 1;
+			}
+
+			nReceived++;
+		} else {
+			sched_yield();
+		}
+	}
+
+	for (uint32_t i = 0; i < test::PRODUCERS; i++) {
+		pthread_join(threads[i], nullptr);
+	}
+
+	printf("mpsc   : %u producers, %u items, %u errors, %.1f Mops/s\n", test::PRODUCERS, nReceived, nErrors, nReceived / (now_s() - fStart) / 1e6);
+	return nErrors;
+}
+
+static uint32_t test_triple() {
+	uint32_t nErrors = 0;
+	uint32_t nLast = 0;
+	uint32_t nReads = 0;
+	uint32_t nFresh = 0;
+	pthread_t thread;
+
+	pthread_create(&thread, nullptr, triple_producer, nullptr);
+
+	for (;;) {
+		const auto bDone = s_bPublished.load();
+
+		if (s_TripleBuffer.Update()) {
+			nFresh++;
+		} else if (bDone) {
+			break;
+		}
+
+		const auto& frame = s_TripleBuffer.GetFront();
+
+		if (frame.nSequence < nLast) {
+			nErrors++;
+		}
+
+		for (uint32_t k = 0; k < 15; k++) {
+			if (frame.aData[k] != frame.nSequence * k) {
+				nErrors++;
+				break;
+			}
+		}
+
+		nLast = frame.nSequence;
+		nReads++;
+	}
+
+	pthread_join(thread, nullptr);
+
+	if (nLast != test::COUNT) {
+		nErrors++;
+	}
+
+	printf("triple : %u publishes, %u reads, %u fresh, last %u, %u torn or backwards\n", test::COUNT, nReads, nFresh, nLast, nErrors);
+	return nErrors;
+}
+
+int main() {
+	uint32_t nErrors = 0;
+
+	nErrors += test_spsc();
+	nErrors += test_mpsc();
+	nErrors += test_triple();
+
+	if (nErrors != 0) {
+		printf("FAILED: %u errors\n", nErrors);
+		return EXIT_FAILURE;
+	}
+
+	puts("PASSED");
+	return EXIT_SUCCESS;
+}
@@ -60,11 +60,6 @@ extern bool arm_install_handler(unsigned routine, unsigned *vector);
 extern void arm_dump_vector_table(void);
 extern void arm_dump_page_table(void);
 
-/**
- * Copy 8 words = 32 bytes
- */
-extern void *memcpy_blk(void *, const void *, size_t);
-
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,75 @@
+/**
+ * @file memfunc.h
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ARM_MEMFUNC_H_
+#define ARM_MEMFUNC_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * NEON block primitives (scalar fallback without NEON).
+ * Inputs below 16 bytes take a byte path, larger ones are moved
+ * in 16/64 byte blocks with the destination aligned to 16 bytes.
+ *
+ * The IRQ/FIQ entry does not save the NEON registers:
+ * call these from thread context only.
+ */
+
+extern void *arm_memcpy(void *__restrict__ dst, const void *__restrict__ src, size_t n);
+extern void *arm_memset(void *dst, int c, size_t n);
+extern int arm_memcmp(const void *s1, const void *s2, size_t n);
+
+/**
+ * Copy src to dst and report whether dst was different.
+ * For change detection: one pass instead of memcmp followed by memcpy.
+ * @return 0 when dst was already equal to src, 1 otherwise
+ */
+extern int arm_memcmpcpy(void *__restrict__ dst, const void *__restrict__ src, size_t n);
+
+/*
+ * Word loops on the core registers only, safe in IRQ/FIQ handlers.
+ * The libc memcpy, memset and memcmp use these.
+ * Anything that may run in IRQ/FIQ context must stay in this group:
+ * it may not touch the VFP/NEON registers, with or without __ARM_NEON__.
+ */
+
+extern void *arm_memcpy_scalar(void *__restrict__ dst, const void *__restrict__ src, size_t n);
+extern void *arm_memset_scalar(void *dst, int c, size_t n);
+extern int arm_memcmp_scalar(const void *s1, const void *s2, size_t n);
+
+/**
+ * Copy 8 words = 32 bytes per block (ldm/stm)
+ */
+extern void *memcpy_blk(void *, const void *, size_t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARM_MEMFUNC_H_ */
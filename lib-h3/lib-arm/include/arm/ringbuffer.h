@@ -0,0 +1,257 @@
+/**
+ * @file ringbuffer.h
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ARM_RINGBUFFER_H_
+#define ARM_RINGBUFFER_H_
+
+/**
+ * Lock-free hand-off between cores, or between a FIQ/IRQ handler and the main loop.
+ *
+ * Spsc<T, N>       : single producer, single consumer ring
+ * Mpsc<T, N>       : multiple producers, single consumer ring
+ * TripleBuffer<T>  : "latest value" mailbox, neither side ever waits
+ *
+ * The indices are accessed with __atomic acquire/release, which on ARMv7 is a plain
+ * load/store plus a dmb. Producer and consumer state live on separate cache lines.
+ * N must be a power of 2.
+ */
+
+#include <stdint.h>
+
+namespace ring {
+static constexpr uint32_t CACHE_LINE_SIZE = 64;
+
+template<typename T, uint32_t N>
+class Spsc {
+	static_assert((N != 0) && ((N & (N - 1)) == 0), "N must be a power of 2");
+public:
+	Spsc() : m_nTail(0), m_nHeadCached(0), m_nHead(0), m_nTailCached(0) {
+	}
+
+	/**
+	 * Producer side
+	 */
+	bool Push(const T& Item) {
+		const auto nTail = m_nTail;
+
+		if ((nTail - m_nHeadCached) == N) {
+			m_nHeadCached = __atomic_load_n(&m_nHead, __ATOMIC_ACQUIRE);
+			if ((nTail - m_nHeadCached) == N) {
+				return false;
+			}
+		}
+
+		m_Buffer[nTail & (N - 1)] = Item;
+		__atomic_store_n(&m_nTail, nTail + 1, __ATOMIC_RELEASE);
+
+		return true;
+	}
+
+	/**
+	 * Consumer side
+	 */
+	bool Pop(T& Item) {
+		const auto nHead = m_nHead;
+
+		if (nHead == m_nTailCached) {
+			m_nTailCached = __atomic_load_n(&m_nTail, __ATOMIC_ACQUIRE);
+			if (nHead == m_nTailCached) {
+				return false;
+			}
+		}
+
+		Item = m_Buffer[nHead & (N - 1)];
+		__atomic_store_n(&m_nHead, nHead + 1, __ATOMIC_RELEASE);
+
+		return true;
+	}
+
+	/**
+	 * Either side, the result is a snapshot
+	 */
+	uint32_t Size() const {
+		return __atomic_load_n(&m_nTail, __ATOMIC_ACQUIRE) - __atomic_load_n(&m_nHead, __ATOMIC_ACQUIRE);
+	}
+
+	bool IsEmpty() const {
+		return Size() == 0;
+	}
+
+	static constexpr uint32_t Capacity() {
+		return N;
+	}
+
+private:
+	alignas(CACHE_LINE_SIZE) uint32_t m_nTail;			///< Written by the producer
+	uint32_t m_nHeadCached;
+	alignas(CACHE_LINE_SIZE) uint32_t m_nHead;			///< Written by the consumer
+	uint32_t m_nTailCached;
+	alignas(CACHE_LINE_SIZE) T m_Buffer[N];
+};
+
+/**
+ * Bounded queue with a sequence number per slot (D. Vyukov).
+ * Producers claim a slot with a CAS on the tail, the consumer never writes the tail.
+ */
+template<typename T, uint32_t N>
+class Mpsc {
+	static_assert((N != 0) && ((N & (N - 1)) == 0), "N must be a power of 2");
+public:
+	Mpsc() : m_nTail(0), m_nHead(0) {
+		for (uint32_t i = 0; i < N; i++) {
+			m_Cells[i].nSequence = i;
+		}
+	}
+
+	/**
+	 * Producer side, any core or handler
+	 */
+	bool Push(const T& Item) {
+		auto nTail = __atomic_load_n(&m_nTail, __ATOMIC_RELAXED);
+		struct Cell *pCell;
+
+		for (;;) {
+			pCell = &m_Cells[nTail & (N - 1)];
+			const auto nSequence = __atomic_load_n(&pCell->nSequence, __ATOMIC_ACQUIRE);
+			const auto nDiff = static_cast<int32_t>(nSequence - nTail);
+
+			if (nDiff == 0) {
+				if (__atomic_compare_exchange_n(&m_nTail, &nTail, nTail + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+					break;
+				}
+			} else if (nDiff < 0) {
+				return false;
+			} else {
+				nTail = __atomic_load_n(&m_nTail, __ATOMIC_RELAXED);
+			}
+		}
+
+		pCell->Item = Item;
+		__atomic_store_n(&pCell->nSequence, nTail + 1, __ATOMIC_RELEASE);
+
+		return true;
+	}
+
+	/**
+	 * Consumer side
+	 */
+	bool Pop(T& Item) {
+		const auto nHead = m_nHead;
+		auto *pCell = &m_Cells[nHead & (N - 1)];
+
+		if (__atomic_load_n(&pCell->nSequence, __ATOMIC_ACQUIRE) != (nHead + 1)) {
+			return false;
+		}
+
+		Item = pCell->Item;
+		__atomic_store_n(&pCell->nSequence, nHead + N, __ATOMIC_RELEASE);
+		m_nHead = nHead + 1;
+
+		return true;
+	}
+
+	/**
+	 * Consumer side
+	 */
+	bool IsEmpty() const {
+		return __atomic_load_n(&m_Cells[m_nHead & (N - 1)].nSequence, __ATOMIC_ACQUIRE) != (m_nHead + 1);
+	}
+
+	static constexpr uint32_t Capacity() {
+		return N;
+	}
+
+private:
+	struct Cell {
+		uint32_t nSequence;
+		T Item;
+	};
+
+	alignas(CACHE_LINE_SIZE) uint32_t m_nTail;			///< Shared by the producers
+	alignas(CACHE_LINE_SIZE) uint32_t m_nHead;			///< Consumer only
+	alignas(CACHE_LINE_SIZE) struct Cell m_Cells[N];
+};
+
+/**
+ * The producer always owns a back buffer and the consumer always owns a front buffer.
+ * Publish() exchanges the back buffer with the middle one, Update() exchanges the front
+ * buffer with the middle one when it holds a newer value. Frames published faster than
+ * the consumer picks them up are overwritten, never queued.
+ */
+template<typename T>
+class TripleBuffer {
+	static constexpr uint32_t INDEX_MASK = 0x3;
+	static constexpr uint32_t FRESH = 0x4;
+public:
+	TripleBuffer() : m_nBack(0), m_nMiddle(1), m_nFront(2) {
+	}
+
+	/**
+	 * Not thread safe, to be called before the hand-off starts
+	 */
+	T& Get(uint32_t nIndex) {
+		return m_Buffer[nIndex & INDEX_MASK];
+	}
+
+	/**
+	 * Producer side
+	 */
+	T& GetBack() {
+		return m_Buffer[m_nBack];
+	}
+
+	void Publish() {
+		const auto nPrevious = __atomic_exchange_n(&m_nMiddle, m_nBack | FRESH, __ATOMIC_ACQ_REL);
+		m_nBack = nPrevious & INDEX_MASK;
+	}
+
+	/**
+	 * Consumer side
+	 */
+	bool Update() {
+		if ((__atomic_load_n(&m_nMiddle, __ATOMIC_RELAXED) & FRESH) == 0) {
+			return false;
+		}
+
+		const auto nPrevious = __atomic_exchange_n(&m_nMiddle, m_nFront, __ATOMIC_ACQ_REL);
+		m_nFront = nPrevious & INDEX_MASK;
+
+		return true;
+	}
+
+	T& GetFront() {
+		return m_Buffer[m_nFront];
+	}
+
+private:
+	alignas(CACHE_LINE_SIZE) uint32_t m_nBack;			///< Producer only
+	alignas(CACHE_LINE_SIZE) uint32_t m_nMiddle;		///< Shared, bit 2 is set when not yet consumed
+	alignas(CACHE_LINE_SIZE) uint32_t m_nFront;			///< Consumer only
+	alignas(CACHE_LINE_SIZE) T m_Buffer[3];
+};
+
+}  // namespace ring
+
+#endif /* ARM_RINGBUFFER_H_ */
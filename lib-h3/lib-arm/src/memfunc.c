@@ -0,0 +1,162 @@
+/**
+ * @file memfunc.c
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/*
+ * Word loops on the core registers. These back the libc memcpy, memset and
+ * memcmp, which are also called from IRQ/FIQ handlers, and are the arm_*
+ * functions on the targets without NEON (ARMv6).
+ * See memfunc.S for the NEON implementation
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "arm/memfunc.h"
+
+/*
+ * The loops below must not be turned into calls to memcpy/memset,
+ * nor be vectorized into the NEON registers
+ */
+#pragma GCC optimize ("no-tree-loop-distribute-patterns", "no-tree-vectorize")
+
+#define ALIGNED(a,b)	(((((uintptr_t)(a)) | ((uintptr_t)(b))) & 0x3) == 0)
+
+void *arm_memcpy_scalar(void *__restrict__ dst, const void *__restrict__ src, size_t n) {
+	uint8_t *pDst = (uint8_t *) dst;
+	const uint8_t *pSrc = (const uint8_t *) src;
+
+	if ((n >= 16) && ALIGNED(pDst, pSrc)) {
+		uint32_t *pDst32 = (uint32_t *) pDst;
+		const uint32_t *pSrc32 = (const uint32_t *) pSrc;
+
+		for (; n >= 16; n -= 16) {
+			pDst32[0] = pSrc32[0];
+			pDst32[1] = pSrc32[1];
+			pDst32[2] = pSrc32[2];
+			pDst32[3] = pSrc32[3];
+			pDst32 += 4;
+			pSrc32 += 4;
+		}
+
+		pDst = (uint8_t *) pDst32;
+		pSrc = (const uint8_t *) pSrc32;
+	}
+
+	while (n-- != 0) {
+		*pDst++ = *pSrc++;
+	}
+
+	return dst;
+}
+
+void *arm_memset_scalar(void *dst, int c, size_t n) {
+	uint8_t *pDst = (uint8_t *) dst;
+
+	while ((n != 0) && (((uintptr_t) pDst & 0x3) != 0)) {
+		*pDst++ = (uint8_t) c;
+		n--;
+	}
+
+	if (n >= 4) {
+		uint32_t *pDst32 = (uint32_t *) pDst;
+		const uint32_t nFill = 0x01010101U * (uint8_t) c;
+
+		for (; n >= 4; n -= 4) {
+			*pDst32++ = nFill;
+		}
+
+		pDst = (uint8_t *) pDst32;
+	}
+
+	while (n-- != 0) {
+		*pDst++ = (uint8_t) c;
+	}
+
+	return dst;
+}
+
+int arm_memcmp_scalar(const void *s1, const void *s2, size_t n) {
+	const uint8_t *p1 = (const uint8_t *) s1;
+	const uint8_t *p2 = (const uint8_t *) s2;
+
+	if (ALIGNED(p1, p2)) {
+		for (; n >= 4; n -= 4, p1 += 4, p2 += 4) {
+			if (*(const uint32_t *) p1 != *(const uint32_t *) p2) {
+				break;
+			}
+		}
+	}
+
+	for (; n != 0; n--, p1++, p2++) {
+		if (*p1 != *p2) {
+			return *p1 - *p2;
+		}
+	}
+
+	return 0;
+}
+
+#if !defined (__ARM_NEON__)
+
+void *arm_memcpy(void *__restrict__ dst, const void *__restrict__ src, size_t n) {
+	return arm_memcpy_scalar(dst, src, n);
+}
+
+void *arm_memset(void *dst, int c, size_t n) {
+	return arm_memset_scalar(dst, c, n);
+}
+
+int arm_memcmp(const void *s1, const void *s2, size_t n) {
+	return arm_memcmp_scalar(s1, s2, n);
+}
+
+int arm_memcmpcpy(void *__restrict__ dst, const void *__restrict__ src, size_t n) {
+	uint8_t *pDst = (uint8_t *) dst;
+	const uint8_t *pSrc = (const uint8_t *) src;
+	uint32_t nDiff = 0;
+
+	if (ALIGNED(pDst, pSrc)) {
+		uint32_t *pDst32 = (uint32_t *) pDst;
+		const uint32_t *pSrc32 = (const uint32_t *) pSrc;
+
+		for (; n >= 4; n -= 4) {
+			nDiff |= *pDst32 ^ *pSrc32;
+			*pDst32++ = *pSrc32++;
+		}
+
+		pDst = (uint8_t *) pDst32;
+		pSrc = (const uint8_t *) pSrc32;
+	}
+
+	while (n-- != 0) {
+		nDiff |= (uint32_t) (*pDst ^ *pSrc);
+		*pDst++ = *pSrc++;
+	}
+
+	return nDiff != 0;
+}
+
+#endif
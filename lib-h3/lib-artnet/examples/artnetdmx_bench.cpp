@@ -0,0 +1,171 @@
+/**
+ * @file artnetdmx_bench.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Cost of ArtNetNode::Run for an ArtDmx packet, with the in-memory
+ * NetworkReplay instead of a socket.
+ *
+ * The node has 8 pages (32 output ports). For 1, 4 and 32 enabled output
+ * ports, every enabled port receives ArtDmx packets in turn with one slot
+ * changed per packet:
+ *
+ *  hit  : the packet is for an enabled port and is sent to the output
+ *  miss : the packet is for a universe that is not enabled
+ *
+ * The port state sizes are printed first.
+ *
+ * Usage: artnetdmx_bench [packets]
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <initializer_list>
+
+#include "hardware.h"
+#include "networkreplay.h"
+#include "ledblink.h"
+
+#include "artnetnode.h"
+#include "packets.h"
+
+#include "lightset.h"
+
+namespace bench {
+static constexpr uint8_t PAGES = 8;
+static constexpr uint32_t FROM_IP = 0x0200000A;	// 10.0.0.2
+}  // namespace bench
+
+class FrameCounter: public LightSet {
+public:
+	void Start(__attribute__((unused)) uint8_t nPort) override {
+	}
+
+	void Stop(__attribute__((unused)) uint8_t nPort) override {
+	}
+
+	void SetData(__attribute__((unused)) uint8_t nPort, __attribute__((unused)) const uint8_t *pData, __attribute__((unused)) uint16_t nLength) override {
+		m_nFrames++;
+	}
+
+	uint32_t GetFrames() {
+		const auto nFrames = m_nFrames;
+		m_nFrames = 0;
+		return nFrames;
+	}
+
+private:
+	uint32_t m_nFrames { 0 };
+};
+
+static uint64_t now_ns() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static void build_packet(struct TArtDmx *pArtDmx) {
+	memset(pArtDmx, 0, sizeof(struct TArtDmx));
+	memcpy(pArtDmx->Id, "Art-Net", 8);
+	pArtDmx->OpCode = OP_DMX;
+	pArtDmx->ProtVerLo = ArtNet::PROTOCOL_REVISION;
+	pArtDmx->LengthHi = (ArtNet::DMX_LENGTH >> 8);
+	pArtDmx->Length = (ArtNet::DMX_LENGTH & 0xFF);
+}
+
+static double run_packets(ArtNetNode& node, NetworkReplay& nw, struct TArtDmx *pArtDmx, const uint16_t *pPortAddress, uint32_t nPortAddresses, uint32_t nPackets) {
+	const auto nStart = now_ns();
+
+	for (uint32_t i = 0; i < nPackets; i++) {
+		pArtDmx->PortAddress = pPortAddress[i % nPortAddresses];
+		pArtDmx->Data[i % ArtNet::DMX_LENGTH]++;
+		pArtDmx->Sequence++;
+
+		nw.Queue(pArtDmx, sizeof(struct TArtDmx), bench::FROM_IP);
+		node.Run();
+	}
+
+	return static_cast<double>(now_ns() - nStart) / nPackets;
+}
+
+static void run(NetworkReplay& nw, FrameCounter& counter, uint32_t nEnabled, uint32_t nPackets) {
+	ArtNetNode node(3, bench::PAGES);
+
+	node.SetOutput(&counter);
+
+	uint16_t aHit[ArtNet::MAX_PORTS * bench::PAGES];
+	uint16_t aMiss[ArtNet::MAX_PORTS * bench::PAGES];
+
+	for (uint8_t nPage = 0; nPage < bench::PAGES; nPage++) {
+		node.SetNetSwitch(0, nPage);
+		node.SetSubnetSwitch(nPage, nPage);
+	}
+
+	for (uint32_t nPortIndex = 0; nPortIndex < nEnabled; nPortIndex++) {
+		const auto nPage = nPortIndex / ArtNet::MAX_PORTS;
+		node.SetUniverseSwitch(static_cast<uint8_t>(nPortIndex), ARTNET_OUTPUT_PORT, static_cast<uint8_t>(nPortIndex % ArtNet::MAX_PORTS));
+		aHit[nPortIndex] = static_cast<uint16_t>((nPage << 4) | (nPortIndex % ArtNet::MAX_PORTS));
+		aMiss[nPortIndex] = static_cast<uint16_t>(0x7F00 | nPortIndex);
+	}
+
+	node.Start();
+	nw.GetSent();
+
+	struct TArtDmx artDmx;
+	build_packet(&artDmx);
+
+	// Warm up: the first packet on a port takes the merge state machine through its first state
+	run_packets(node, nw, &artDmx, aHit, nEnabled, nEnabled);
+	counter.GetFrames();
+
+	const auto fHit = run_packets(node, nw, &artDmx, aHit, nEnabled, nPackets);
+	const auto nFrames = counter.GetFrames();
+	const auto fMiss = run_packets(node, nw, &artDmx, aMiss, nEnabled, nPackets);
+
+	node.Stop();
+
+	printf("enabled %2u  hit %7.1f ns/packet (output %u of %u)  miss %7.1f ns/packet\n", nEnabled, fHit, nFrames, nPackets, fMiss);
+}
+
+int main(int argc, char **argv) {
+	const auto nPackets = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 1000000;
+
+	Hardware hw;
+	NetworkReplay nw;
+	LedBlink lb;
+
+	printf("TOutputPort %zu bytes x %u = %zu, TOutputPortBuffer %zu bytes per enabled port\n",
+			sizeof(struct TOutputPort), ARTNET_NODE_MAX_PORTS_OUTPUT, sizeof(struct TOutputPort) * ARTNET_NODE_MAX_PORTS_OUTPUT, sizeof(struct TOutputPortBuffer));
+
+	FrameCounter counter;
+
+	for (const uint32_t nEnabled : { 1, 4, 32 }) {
+		run(nw, counter, nEnabled, nPackets);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,195 @@
+/**
+ * @file artnetdmxin_test.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Behaviour test of the DMX input rate limiting in ArtNetNode::HandleDmxIn,
+ * with NetworkReplay and the simulated clock. Run() is polled every 1 ms.
+ *
+ *  static     : an unchanged 44 Hz input is only refreshed at the keep-alive period
+ *  burst      : 10 changes within the minimum interval give one ArtDmx at once,
+ *               the latest frame follows when the interval has passed
+ *  continuous : a change every 1 ms is limited to one ArtDmx per minimum interval
+ *  no refresh : a keep-alive of 0 disables the refresh
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hardware.h"
+#include "networkreplay.h"
+#include "ledblink.h"
+#include "simclock.h"
+
+#include "artnetnode.h"
+#include "artnetdmx.h"
+#include "packets.h"
+
+namespace test {
+static constexpr uint32_t MIN_INTERVAL = 20;
+static constexpr uint32_t KEEP_ALIVE = 1000;
+static constexpr uint32_t START_MILLIS = 100000;
+}  // namespace test
+
+static unsigned s_nErrors;
+
+#define CHECK(cond, ...)	do { if (!(cond)) { if (s_nErrors++ < 10) { printf(__VA_ARGS__); } } } while (0)
+
+class DmxInput final: public ArtNetDmx {
+public:
+	void Start(__attribute__((unused)) uint8_t nPort) override {
+	}
+
+	void Stop(__attribute__((unused)) uint8_t nPort) override {
+	}
+
+	const uint8_t *Handler(__attribute__((unused)) uint8_t nPort, uint16_t& nLength, uint32_t &nUpdatesPerSecond) override {
+		nUpdatesPerSecond = 44;
+
+		if (!m_bIsNew) {
+			return nullptr;
+		}
+
+		m_bIsNew = false;
+		nLength = sizeof(m_aData);
+		return m_aData;
+	}
+
+	void Deliver(uint8_t nValue) {
+		memset(m_aData, nValue, sizeof(m_aData));
+		m_bIsNew = true;
+	}
+
+private:
+	uint8_t m_aData[512];
+	bool m_bIsNew { false };
+};
+
+struct Sent {
+	uint32_t nCount;
+	uint32_t nMinGapMillis;
+	uint32_t nLastMillis;
+	uint8_t nLastValue;
+	uint8_t nLastSequence;
+};
+
+static uint32_t s_nMillis = test::START_MILLIS;
+
+/*
+ * Runs nMillis of 1 ms polls. deliver is called before every poll, it returns
+ * the value of a new frame or -1 when the input has nothing new.
+ */
+template<typename F>
+static Sent run(ArtNetNode& node, NetworkReplay& nw, DmxInput& input, uint32_t nMillis, F deliver) {
+	Sent sent;
+	memset(&sent, 0, sizeof(Sent));
+	sent.nMinGapMillis = UINT32_MAX;
+
+	nw.GetSent();
+
+	for (uint32_t i = 0; i < nMillis; i++, s_nMillis++) {
+		SimClockSet(s_nMillis);
+
+		const auto nValue = deliver(i);
+
+		if (nValue >= 0) {
+			input.Deliver(static_cast<uint8_t>(nValue));
+		}
+
+		node.Run();
+
+		if (nw.GetSent() != 0) {
+			if (sent.nCount != 0) {
+				const auto nGap = s_nMillis - sent.nLastMillis;
+				sent.nMinGapMillis = nGap < sent.nMinGapMillis ? nGap : sent.nMinGapMillis;
+			}
+
+			uint32_t nToIp;
+			const auto *pArtDmx = reinterpret_cast<const struct TArtDmx *>(nw.GetLastSent(nToIp));
+
+			sent.nCount++;
+			sent.nLastMillis = s_nMillis;
+			sent.nLastValue = pArtDmx->Data[0];
+			sent.nLastSequence = pArtDmx->Sequence;
+		}
+	}
+
+	return sent;
+}
+
+int main() {
+	SimClockSet(s_nMillis);
+
+	Hardware hw;
+	NetworkReplay nw;
+	LedBlink lb;
+	DmxInput input;
+
+	ArtNetNode node;
+
+	node.SetArtNetDmx(&input);
+	node.SetUniverseSwitch(0, ARTNET_INPUT_PORT, 1);
+	node.SetDmxInMinInterval(test::MIN_INTERVAL);
+	node.SetDmxInKeepAlive(test::KEEP_ALIVE);
+	node.Start();
+
+	// 44 Hz, always the same frame: the first is sent, then once per keep-alive
+	auto sent = run(node, nw, input, 5000, [](uint32_t i) { return (i % 23) == 0 ? 1 : -1; });
+	printf("static     : %u ArtDmx in 5 s\n", sent.nCount);
+	CHECK(sent.nCount == 5, "static: %u sent, expected 5\n", sent.nCount);
+	CHECK(sent.nMinGapMillis == test::KEEP_ALIVE, "static: refreshed after %u ms\n", sent.nMinGapMillis);
+
+	// Burst of 10 changes, 1 ms apart
+	const auto nSequence = sent.nLastSequence;
+	sent = run(node, nw, input, 100, [](uint32_t i) { return i < 10 ? static_cast<int>(10 + i) : -1; });
+	printf("burst      : %u ArtDmx, %u ms apart\n", sent.nCount, sent.nMinGapMillis);
+	CHECK(sent.nCount == 2, "burst: %u sent, expected 2\n", sent.nCount);
+	CHECK(sent.nMinGapMillis == test::MIN_INTERVAL, "burst: %u ms apart\n", sent.nMinGapMillis);
+	CHECK(sent.nLastValue == 19, "burst: last frame %u, expected 19\n", sent.nLastValue);
+	CHECK(sent.nLastSequence == static_cast<uint8_t>(nSequence + 2), "burst: sequence %u after %u\n", sent.nLastSequence, nSequence);
+
+	// A change every 1 ms for 1 s
+	sent = run(node, nw, input, 1000, [](uint32_t i) { return static_cast<int>(i & 0xFF); });
+	printf("continuous : %u ArtDmx in 1 s, at least %u ms apart\n", sent.nCount, sent.nMinGapMillis);
+	CHECK(sent.nMinGapMillis >= test::MIN_INTERVAL, "continuous: %u ms apart\n", sent.nMinGapMillis);
+	CHECK((sent.nCount >= 1000 / test::MIN_INTERVAL - 1) && (sent.nCount <= 1000 / test::MIN_INTERVAL), "continuous: %u sent\n", sent.nCount);
+
+	// No keep-alive: only the first frame, it differs from the last continuous one
+	node.SetDmxInKeepAlive(0);
+	sent = run(node, nw, input, 3000, [](uint32_t i) { return (i % 23) == 0 ? 1 : -1; });
+	printf("no refresh : %u ArtDmx in 3 s\n", sent.nCount);
+	CHECK(sent.nCount == 1, "no refresh: %u sent, expected 1\n", sent.nCount);
+
+	node.Stop();
+
+	if (s_nErrors != 0) {
+		printf("FAILED: %u errors\n", s_nErrors);
+		return EXIT_FAILURE;
+	}
+
+	puts("PASSED");
+	return EXIT_SUCCESS;
+}
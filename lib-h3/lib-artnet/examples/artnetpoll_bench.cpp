@@ -0,0 +1,155 @@
+/**
+ * @file artnetpoll_bench.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Cost of ArtNetNode::Run for an ArtPoll packet, with the in-memory
+ * NetworkReplay instead of a socket.
+ *
+ * The node has 8 pages with all 32 output ports enabled, so each ArtPoll is
+ * answered with 8 ArtPollReply packets (SendTo only counts them):
+ *
+ *  cached  : the per-page reply templates are valid, only the status and
+ *            the report counter are patched
+ *  rebuild : the short name is set before every poll, so the templates are
+ *            rebuilt for every poll
+ *
+ * Then checks that the cached replies follow an address change of the Network.
+ *
+ * Usage: artnetpoll_bench [polls]
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hardware.h"
+#include "networkreplay.h"
+#include "ledblink.h"
+
+#include "artnetnode.h"
+#include "packets.h"
+
+namespace bench {
+static constexpr uint8_t PAGES = 8;
+static constexpr uint32_t FROM_IP = 0x0200000A;	// 10.0.0.2
+}  // namespace bench
+
+static uint64_t now_ns() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static void fill_poll(struct TArtPoll& artPoll) {
+	memset(&artPoll, 0, sizeof(struct TArtPoll));
+	memcpy(artPoll.Id, "Art-Net", 8);
+	artPoll.OpCode = OP_POLL;
+	artPoll.ProtVerLo = ArtNet::PROTOCOL_REVISION;
+}
+
+static void run(ArtNetNode& node, NetworkReplay& nw, const char *pMode, bool bRebuild, uint32_t nPolls) {
+	struct TArtPoll artPoll;
+	fill_poll(artPoll);
+
+	nw.GetSent();
+
+	const auto nStart = now_ns();
+
+	for (uint32_t i = 0; i < nPolls; i++) {
+		if (bRebuild) {
+			node.SetShortName("artnetpoll_bench");
+		}
+
+		nw.Queue(&artPoll, sizeof(struct TArtPoll), bench::FROM_IP);
+		node.Run();
+	}
+
+	const auto nElapsed = now_ns() - nStart;
+	const auto nSent = nw.GetSent();
+
+	printf("%-8s %7.1f ns/poll  %5.1f ns/reply  (%u replies for %u polls)\n", pMode,
+			static_cast<double>(nElapsed) / nPolls,
+			nSent == 0 ? 0.0 : static_cast<double>(nElapsed) / nSent,
+			nSent, nPolls);
+}
+
+static bool check_ip_change(ArtNetNode& node, NetworkReplay& nw) {
+	static constexpr uint32_t IP = 0x6402A8C0;			// 192.168.2.100
+	static constexpr uint32_t BROADCAST_IP = 0xFF02A8C0;	// 192.168.2.255
+
+	nw.SetIp(IP);
+	nw.SetNetmask(0x00FFFFFF);
+
+	struct TArtPoll artPoll;
+	fill_poll(artPoll);
+
+	nw.Queue(&artPoll, sizeof(struct TArtPoll), bench::FROM_IP);
+	node.Run();
+
+	uint32_t nToIp;
+	const auto *pPollReply = reinterpret_cast<const struct TArtPollReply *>(nw.GetLastSent(nToIp));
+	uint32_t nIp = 0;
+
+	if (pPollReply != nullptr) {
+		memcpy(&nIp, pPollReply->IPAddress, sizeof(nIp));
+	}
+
+	const auto bPassed = (nIp == IP) && (nToIp == BROADCAST_IP);
+
+	printf("ip change: %s\n", bPassed ? "PASSED" : "FAILED");
+	return bPassed;
+}
+
+int main(int argc, char **argv) {
+	const auto nPolls = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 200000;
+
+	Hardware hw;
+	NetworkReplay nw;
+	LedBlink lb;
+
+	ArtNetNode node(3, bench::PAGES);
+
+	for (uint8_t nPage = 0; nPage < bench::PAGES; nPage++) {
+		node.SetNetSwitch(0, nPage);
+		node.SetSubnetSwitch(nPage, nPage);
+	}
+
+	for (uint32_t nPortIndex = 0; nPortIndex < ArtNet::MAX_PORTS * bench::PAGES; nPortIndex++) {
+		node.SetUniverseSwitch(static_cast<uint8_t>(nPortIndex), ARTNET_OUTPUT_PORT, static_cast<uint8_t>(nPortIndex % ArtNet::MAX_PORTS));
+	}
+
+	node.Start();
+
+	run(node, nw, "cached", false, nPolls);
+	run(node, nw, "rebuild", true, nPolls);
+
+	const auto bPassed = check_ip_change(node, nw);
+
+	node.Stop();
+
+	return bPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file networkreplay.h
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef NETWORKREPLAY_H_
+#define NETWORKREPLAY_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include "network.h"
+
+/**
+ * In-memory network for the host benchmarks: RecvFrom returns the packet
+ * queued with Queue() once, SendTo only counts and keeps the last buffer.
+ */
+class NetworkReplay final: public Network {
+public:
+	NetworkReplay() {
+		const uint8_t aMacAddress[NETWORK_MAC_SIZE] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+		memcpy(m_aNetMacaddr, aMacAddress, NETWORK_MAC_SIZE);
+		m_nLocalIp = 0x0100000A;	// 10.0.0.1
+		m_nNetmask = 0x000000FF;	// 255.0.0.0
+		m_IsDhcpCapable = false;
+		strcpy(m_aHostName, "replay");
+		strcpy(m_aIfName, "replay");
+	}
+
+	int32_t Begin(__attribute__((unused)) uint16_t nPort) override {
+		return 0;
+	}
+
+	int32_t End(__attribute__((unused)) uint16_t nPort) override {
+		return 0;
+	}
+
+	void MacAddressCopyTo(uint8_t *pMacAddress) override {
+		memcpy(pMacAddress, m_aNetMacaddr, NETWORK_MAC_SIZE);
+	}
+
+	void JoinGroup(__attribute__((unused)) int32_t nHandle, __attribute__((unused)) uint32_t nIp) override {
+	}
+
+	void LeaveGroup(__attribute__((unused)) int32_t nHandle, __attribute__((unused)) uint32_t nIp) override {
+	}
+
+	uint16_t RecvFrom(__attribute__((unused)) int32_t nHandle, void *pBuffer, uint16_t nLength, uint32_t *pFromIp, uint16_t *pFromPort) override {
+		if (m_pPacket == nullptr) {
+			return 0;
+		}
+
+		const auto nBytes = m_nLength < nLength ? m_nLength : nLength;
+		memcpy(pBuffer, m_pPacket, nBytes);
+		*pFromIp = m_nFromIp;
+		*pFromPort = 6454;
+
+		m_pPacket = nullptr;
+
+		return nBytes;
+	}
+
+	void SendTo(__attribute__((unused)) int32_t nHandle, const void *pBuffer, __attribute__((unused)) uint16_t nLength, uint32_t nToIp, __attribute__((unused)) uint16_t nRemotePort) override {
+		m_nSent++;
+		m_pLastSent = pBuffer;
+		m_nLastToIp = nToIp;
+	}
+
+	void SetIp(uint32_t nIp) override {
+		m_nLocalIp = nIp;
+		NotifyIpChanged();
+	}
+
+	void SetNetmask(uint32_t nNetmask) override {
+		m_nNetmask = nNetmask;
+		NotifyIpChanged();
+	}
+
+	bool SetZeroconf() override {
+		return false;
+	}
+
+	bool EnableDhcp() override {
+		return false;
+	}
+
+	void Queue(const void *pPacket, uint16_t nLength, uint32_t nFromIp) {
+		m_pPacket = pPacket;
+		m_nLength = nLength;
+		m_nFromIp = nFromIp;
+	}
+
+	uint32_t GetSent() {
+		const auto nSent = m_nSent;
+		m_nSent = 0;
+		return nSent;
+	}
+
+	const void *GetLastSent(uint32_t& nToIp) const {
+		nToIp = m_nLastToIp;
+		return m_pLastSent;
+	}
+
+private:
+	const void *m_pPacket { nullptr };
+	uint16_t m_nLength { 0 };
+	uint32_t m_nFromIp { 0 };
+	uint32_t m_nSent { 0 };
+	const void *m_pLastSent { nullptr };
+	uint32_t m_nLastToIp { 0 };
+};
+
+#endif /* NETWORKREPLAY_H_ */
@@ -0,0 +1,51 @@
+/**
+ * @file simclock.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Simulated clock for the host tests. It replaces gettimeofday, so
+ * Hardware::Millis and Hardware::Micros return the time set with SimClockSet.
+ * This file must not include <sys/time.h>, which declares gettimeofday differently.
+ */
+
+#include <stdint.h>
+
+#include "simclock.h"
+
+static uint64_t s_nMicros;
+
+void SimClockSet(uint32_t nMillis) {
+	s_nMicros = static_cast<uint64_t>(nMillis) * 1000U;
+}
+
+struct SimTimeval {
+	long tv_sec;
+	long tv_usec;
+};
+
+extern "C" int gettimeofday(SimTimeval *pTimeval, __attribute__((unused)) void *pTimezone) {
+	pTimeval->tv_sec = static_cast<long>(s_nMicros / 1000000U);
+	pTimeval->tv_usec = static_cast<long>(s_nMicros % 1000000U);
+	return 0;
+}
@@ -1,8 +1,8 @@
 /**
- * @file memcpy_blk.S
+ * @file simclock.h
  *
  */
-/* Copyright (C) 2016 by Arjan van Vught mailto:info@raspberrypi-dmx.nl
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -23,21 +23,11 @@
  * THE SOFTWARE.
  */
 
-.macro FUNC name
-.text
-.code 32
-.global \name
-\name:
-.endm
+#ifndef SIMCLOCK_H_
+#define SIMCLOCK_H_
 
+#include <stdint.h>
 
-FUNC memcpy_blk
-	push 	{r4-r10,lr}
+void SimClockSet(uint32_t nMillis);
 
-.Lloop:
-	ldmia	r1!, {r3-r10}
-	stmia	r0!, {r3-r10}
-	subs	r2, #1
-	bne	.Lloop
-
-	pop 	{r4-r10,pc}
+#endif /* SIMCLOCK_H_ */
@@ -35,6 +35,9 @@ namespace artnet {
 static constexpr char NODE_ID[] = "Art-Net";			///< Array of 8 characters, the final character is a null termination. Value = A r t - N e t 0x00
 static constexpr auto MERGE_TIMEOUT_SECONDS = 10;
 static constexpr auto NETWORK_DATA_LOSS_TIMEOUT = 10;	///< Seconds
+static constexpr uint16_t DMX_IN_MIN_INTERVAL_MILLIS = 20;	///< 50 Hz, above the full DMX512 frame rate
+static constexpr uint16_t DMX_IN_KEEP_ALIVE_MILLIS = 1000;
+static constexpr uint32_t DIAG_QUEUE_SIZE = 8;				///< Pending ArtDiagData messages, power of 2
 }  // namespace artnet
 
 /**
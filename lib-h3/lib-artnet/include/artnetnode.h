@@ -30,6 +30,7 @@
 #define ARTNETNODE_H_
 
 #include <stdint.h>
+#include <stddef.h>
 #include <time.h>
 
 #include "artnet.h"
@@ -37,6 +38,8 @@
 
 #include "lightset.h"
 #include "ledblink.h"
+#include "cachelinealigned.h"
+#include "network.h"
 
 #include "artnettimecode.h"
 #include "artnettimesync.h"
@@ -129,39 +132,62 @@ struct TGenericPort {
 	uint8_t nStatus;
 };
 
-struct TOutputPort {
+/**
+ * Slot buffers, cache line aligned and only allocated for enabled output ports
+ */
+struct TOutputPortBuffer: public CacheLineAligned {
 	uint8_t data[ArtNet::DMX_LENGTH];	///< Data sent
-	uint16_t nLength;					///< Length of sent DMX data
 	uint8_t dataA[ArtNet::DMX_LENGTH];	///< The data received from Port A
-	uint32_t nMillisA;					///< The latest time of the data received from Port A
-	uint32_t ipA;						///< The IP address for port A
 	uint8_t dataB[ArtNet::DMX_LENGTH];	///< The data received from Port B
-	uint32_t nMillisB;					///< The latest time of the data received from Port B
+};
+
+/**
+ * The state scanned for every ArtDmx, kept compact
+ */
+struct TOutputPort {
+	TGenericPort port;					///< \ref TGenericPort
+	uint32_t ipA;						///< The IP address for port A
+	uint32_t nMillisA;					///< The latest time of the data received from Port A
 	uint32_t ipB;						///< The IP address for Port B
-	ArtNetMerge mergeMode;				///< \ref ArtNetMerge
-	bool IsDataPending;					///< ArtDMX received and waiting for ArtSync
+	uint32_t nMillisB;					///< The latest time of the data received from Port B
+	struct TOutputPortBuffer *pBuffer;	///< nullptr until the port is enabled
+	uint16_t nLength;					///< Length of sent DMX data
+	uint16_t nDirtyFirst;				///< First changed slot not yet sent
+	uint16_t nDirtyEnd;					///< One past the last changed slot not yet sent
 	bool bIsEnabled;					///< Is the port enabled ?
-	TGenericPort port;					///< \ref TGenericPort
+	bool IsDataPending;					///< ArtDMX received and waiting for ArtSync
+	ArtNetMerge mergeMode;				///< \ref ArtNetMerge
 	TPortProtocol tPortProtocol;		///< Art-Net 4
 };
 
+/**
+ * DMX input scheduler state. The ArtDmx buffer keeps the latest frame received
+ * with its header filled once, and is only allocated for enabled input ports
+ */
 struct TInputPort {
-	bool bIsEnabled;
-	TGenericPort port;
+	TGenericPort port;					///< \ref TGenericPort
+	uint32_t nDestinationIp;			///< Cached unicast or broadcast target
+	uint32_t nMillisSent;				///< The latest time an ArtDmx was sent
+	struct TArtDmx *pArtDmx;			///< nullptr until the port is enabled
+	uint16_t nLength;					///< Length of the latest frame, 0 when nothing received yet
 	uint8_t nSequence;
-	uint32_t nDestinationIp;
+	bool bIsEnabled;					///< Is the port enabled ?
+	bool bIsDirty;						///< The latest frame differs from the frame sent
+	bool bIsBroadcast;					///< nDestinationIp follows the node broadcast address
 };
 
-class ArtNetNode {
+class ArtNetNode: public NetworkIpObserver {
 public:
 	ArtNetNode(uint8_t nVersion = 3, uint8_t nPages = 1);
-	~ArtNetNode();
+	~ArtNetNode() override;
 
 	void Start();
 	void Stop();
 
 	void Run();
 
+	void IpChanged() override;
+
 	uint8_t GetVersion() {
 		return m_nVersion;
 	}
@@ -240,6 +266,10 @@ public:
 		return m_State.bDisableMergeTimeout;
 	}
 
+	/**
+	 * Queued, sent from Run() when there is no packet to handle.
+	 * The text must remain valid until then (a string literal).
+	 */
 	void SendDiag(const char *, TPriorityCodes);
 	void SendTimeCode(const struct TArtNetTimeCode *);
 
@@ -283,6 +313,27 @@ public:
 		return 0;
 	}
 
+	/**
+	 * A changed input frame is sent immediately when at least nMillis have passed since the previous ArtDmx,
+	 * otherwise it is held back and sent as soon as the interval expires
+	 */
+	void SetDmxInMinInterval(uint16_t nMillis) {
+		m_nDmxInMinIntervalMillis = nMillis;
+	}
+	uint16_t GetDmxInMinInterval() const {
+		return m_nDmxInMinIntervalMillis;
+	}
+
+	/**
+	 * Unchanged input frames are refreshed every nMillis, 0 disables the refresh
+	 */
+	void SetDmxInKeepAlive(uint16_t nMillis) {
+		m_nDmxInKeepAliveMillis = nMillis;
+	}
+	uint16_t GetDmxInKeepAlive() const {
+		return m_nDmxInKeepAliveMillis;
+	}
+
 	void SetArtNet4Handler(ArtNet4Handler *pArtNet4Handler);
 
 	void Print();
@@ -293,8 +344,10 @@ public:
 
 private:
 	void FillPollReply();
+	void BuildPollReplies();
 #if defined ( ENABLE_SENDDIAG )
 	void FillDiagData(void);
+	void HandleDiag();
 #endif
 
 	void GetType();
@@ -310,6 +363,7 @@ private:
 	void HandleRdm();
 	void HandleIpProg();
 	void HandleDmxIn();
+	void SendDmxIn(uint32_t nPortIndex);
 	void HandleTrigger();
 
 	uint16_t MakePortAddress(uint16_t, uint8_t nPage = 0);
@@ -317,6 +371,8 @@ private:
 	bool IsMergedDmxDataChanged(uint8_t, const uint8_t *, uint16_t);
 	void CheckMergeTimeouts(uint8_t);
 	bool IsDmxDataChanged(uint8_t, const uint8_t *, uint16_t);
+	void SetDirty(uint8_t nPortId, uint32_t nFirst, uint32_t nEnd);
+	void SendData(uint8_t nPortId);
 
 	void SendPollRelply(bool);
 	void SendTod(uint8_t nPortId = 0);
@@ -350,12 +406,22 @@ private:
 
 	struct TArtNetPacket m_ArtNetPacket;
 	struct TArtPollReply m_PollReply;
+	struct TArtPollReply *m_pPollReplies { nullptr };	///< Per page templates
+	bool m_bPollRepliesValid { false };
 #if defined ( ENABLE_SENDDIAG )
 	struct TArtDiagData m_DiagData;
+	struct TDiagQueue {
+		const char *pText;
+		TPriorityCodes nPriority;
+	} m_DiagQueue[artnet::DIAG_QUEUE_SIZE];
+	uint32_t m_nDiagQueueHead { 0 };
+	uint32_t m_nDiagQueueTail { 0 };
 #endif
 
 	struct TOutputPort m_OutputPorts[ARTNET_NODE_MAX_PORTS_OUTPUT];
 	struct TInputPort m_InputPorts[ARTNET_NODE_MAX_PORTS_INPUT];
+	uint16_t m_nDmxInMinIntervalMillis { artnet::DMX_IN_MIN_INTERVAL_MILLIS };
+	uint16_t m_nDmxInKeepAliveMillis { artnet::DMX_IN_KEEP_ALIVE_MILLIS };
 
 	bool m_bDirectUpdate { false };
 
@@ -30,7 +30,6 @@
 #define ARTNETPARAMS_H_
 
 #include <stdint.h>
-#include <time.h>
 
 #include "artnetnode.h"
 
@@ -50,7 +49,7 @@ struct TArtNetParams {
 	uint8_t aLongName[ArtNet::LONG_NAME_LENGTH];			///< 64	 94
 	uint16_t nMultiPortOptions;								///< 2	 96
 	uint8_t aOemValue[2];									///< 2	 98
-	time_t nNetworkTimeout;									///< 4	102
+	uint32_t nNetworkTimeout;								///< 4	102
 	uint8_t NotUsed4;										///< 1	103
 	uint8_t nUniversePort[ArtNet::MAX_PORTS];				///< 4	107
 	uint8_t nMergeMode;										///< 1	108
@@ -60,6 +59,8 @@ struct TArtNetParams {
 	uint8_t NotUsed5;										///< 1	118
 	uint8_t nDirection;										///< 1	119
 	uint32_t nDestinationIpPort[ArtNet::MAX_PORTS];			///< 16	135
+	uint16_t nInputMinInterval;								///< 2	137
+	uint16_t nInputKeepAlive;								///< 2	139
 }__attribute__((packed));
 
 
@@ -102,6 +103,8 @@ struct ArtnetParamsMask {
 	static constexpr auto PROTOCOL_D = (1U << 26);
 	static constexpr auto ENABLE_NO_CHANGE_OUTPUT = (1U << 27);
 	static constexpr auto DIRECTION = (1U << 28);
+	static constexpr auto INPUT_MIN_INTERVAL = (1U << 29);
+	static constexpr auto INPUT_KEEP_ALIVE = (1U << 30);
 };
 
 class ArtNetParamsStore {
@@ -151,7 +154,7 @@ public:
 		return m_tArtNetParams.tOutputType;
 	}
 
-	time_t GetNetworkTimeout() const {
+	uint32_t GetNetworkTimeout() const {
 		return m_tArtNetParams.nNetworkTimeout;
 	}
 
@@ -47,6 +47,8 @@ struct ArtNetParamsConst {
 	static const char PROTOCOL_PORT[ArtNet::MAX_PORTS][16];
 	static const char DIRECTION[];
 	static const char DESTINATION_IP_PORT[ArtNet::MAX_PORTS][24];
+	static const char INPUT_MIN_INTERVAL[];
+	static const char INPUT_KEEP_ALIVE[];
 };
 
 #endif /* ARTNETPARAMSCONST_H_ */
@@ -37,10 +37,10 @@
 void ArtNetNode::FillDiagData(void) {
 	memset(&m_DiagData, 0, sizeof (struct TArtDiagData));
 
-	memcpy(m_DiagData, NODE_ID, 8);
+	memcpy(m_DiagData.Id, artnet::NODE_ID, sizeof(m_DiagData.Id));
 	m_DiagData.OpCode = OP_DIAGDATA;
 	m_DiagData.ProtVerHi = 0;
-	m_DiagData.ProtVerLo = ARTNET_PROTOCOL_REVISION;
+	m_DiagData.ProtVerLo = ArtNet::PROTOCOL_REVISION;
 }
 
 void ArtNetNode::SendDiag(const char *text, TPriorityCodes nPriority) {
@@ -52,14 +52,41 @@ void ArtNetNode::SendDiag(const char *text, TPriorityCodes nPriority) {
 		return;
 	}
 
-	m_DiagData.Priority = nPriority;
+	if ((m_nDiagQueueHead - m_nDiagQueueTail) == artnet::DIAG_QUEUE_SIZE) {
+		return;
+	}
+
+	auto &entry = m_DiagQueue[m_nDiagQueueHead & (artnet::DIAG_QUEUE_SIZE - 1)];
+
+	entry.pText = text;
+	entry.nPriority = nPriority;
+
+	m_nDiagQueueHead++;
+}
+
+void ArtNetNode::HandleDiag() {
+	if (m_nDiagQueueHead == m_nDiagQueueTail) {
+		return;
+	}
+
+	const auto &entry = m_DiagQueue[m_nDiagQueueTail & (artnet::DIAG_QUEUE_SIZE - 1)];
+
+	m_nDiagQueueTail++;
+
+	m_DiagData.Priority = entry.nPriority;
+
+	auto *pText = reinterpret_cast<char *>(m_DiagData.Data);
+
+	strncpy(pText, entry.pText, sizeof m_DiagData.Data - 1);
+	pText[sizeof(m_DiagData.Data) - 1] = '\0';// Just be sure we have a last '\0'
+
+	const auto nLength = static_cast<uint16_t>(strlen(pText) + 1);// Text length including the '\0'
 
-	strncpy(m_DiagData.Data, text, sizeof m_DiagData.Data - 1);
-	m_DiagData.Data[sizeof(m_DiagData.Data) - 1] = '\0';// Just be sure we have a last '\0'
-	m_DiagData.LengthLo = strlen(m_DiagData.Data) + 1;// Text length including the '\0'
+	m_DiagData.LengthHi = static_cast<uint8_t>(nLength >> 8);
+	m_DiagData.LengthLo = static_cast<uint8_t>(nLength & 0xFF);
 
-	const uint16_t nSize = sizeof(struct TArtDiagData) - sizeof(m_DiagData.Data) + m_DiagData.LengthLo;
+	const uint16_t nSize = sizeof(struct TArtDiagData) - sizeof(m_DiagData.Data) + nLength;
 
-	Network::Get()->SendTo(m_nHandle, &m_DiagData, nSize, m_State.IPAddressDiagSend, ARTNET_UDP_PORT);
+	Network::Get()->SendTo(m_nHandle, &m_DiagData, nSize, m_State.IPAddressDiagSend, ArtNet::UDP_PORT);
 }
 #endif
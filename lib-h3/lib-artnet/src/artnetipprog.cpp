@@ -69,19 +69,8 @@ void ArtNetNode::HandleIpProg() {
 
 	memcpy(ip.u8, &m_pIpProgReply->ProgIpHi, ArtNet::IP_SIZE);
 
+	// Normally already done by the Network observer
 	if (ip.u32 != m_Node.IPAddressLocal) {
-		// Update Node network details
-		m_Node.IPAddressLocal = Network::Get()->GetIp();
-		m_Node.IPAddressBroadcast = m_Node.IPAddressLocal | ~(Network::Get()->GetNetmask());
-		m_Node.Status2 = (m_Node.Status2 & (~(ArtNetStatus2::IP_DHCP))) | (Network::Get()->IsDhcpUsed() ? ArtNetStatus2::IP_DHCP : ArtNetStatus2::IP_MANUALY);
-		// Update PollReply for new IPAddress
-		memcpy(m_PollReply.IPAddress, &m_pIpProgReply->ProgIpHi, ArtNet::IP_SIZE);
-		if (m_nVersion > 3) {
-			memcpy(m_PollReply.BindIp, &m_pIpProgReply->ProgIpHi, ArtNet::IP_SIZE);
-		}
-
-		if (m_State.SendArtPollReplyOnChange) {
-			SendPollRelply(true);
-		}
+		IpChanged();
 	}
 }
@@ -86,6 +86,7 @@ ArtNetNode::ArtNetNode(uint8_t nVersion, uint8_t nPages) :
 	m_Node.IPAddressBroadcast = m_Node.IPAddressLocal | ~(Network::Get()->GetNetmask());
 	m_Node.IPAddressTimeCode = m_Node.IPAddressBroadcast;
 	Network::Get()->MacAddressCopyTo(m_Node.MACAddressLocal);
+	Network::Get()->AddIpObserver(this);
 	m_Node.Status1 = STATUS1_INDICATOR_NORMAL_MODE | STATUS1_PAP_FRONT_PANEL;
 	m_Node.Status2 = ArtNetStatus2::PORT_ADDRESS_15BIT | (m_nVersion > 3 ? ArtNetStatus2::SACN_ABLE_TO_SWITCH : ArtNetStatus2::SACN_NO_SWITCH);
 
@@ -102,6 +103,7 @@ ArtNetNode::ArtNetNode(uint8_t nVersion, uint8_t nPages) :
 	for (uint32_t i = 0; i < (ARTNET_NODE_MAX_PORTS_INPUT); i++) {
 		memset(&m_InputPorts[i], 0 , sizeof(struct TInputPort));
 		m_InputPorts[i].nDestinationIp = m_Node.IPAddressBroadcast;
+		m_InputPorts[i].bIsBroadcast = true;
 		m_InputPorts[i].port.nStatus = PORT_IN_STATUS_DISABLED_MASK;
 	}
 
@@ -115,6 +117,9 @@ ArtNetNode::ArtNetNode(uint8_t nVersion, uint8_t nPages) :
 
 	SetOemValue(ArtNetConst::OEM_ID);
 
+	m_pPollReplies = new struct TArtPollReply[m_nPages];
+	assert(m_pPollReplies != nullptr);
+
 	uint8_t nSysNameLenght;
 	const auto *pSysName = Hardware::Get()->GetSysName(nSysNameLenght);
 	strncpy(m_aSysName, pSysName, (sizeof m_aSysName) - 1);
@@ -124,6 +129,8 @@ ArtNetNode::ArtNetNode(uint8_t nVersion, uint8_t nPages) :
 ArtNetNode::~ArtNetNode() {
 	Stop();
 
+	Network::Get()->RemoveIpObserver(this);
+
 	if (m_pTodData != nullptr) {
 		delete m_pTodData;
 	}
@@ -135,13 +142,29 @@ ArtNetNode::~ArtNetNode() {
 	if (m_pTimeCodeData != nullptr) {
 		delete m_pTimeCodeData;
 	}
+
+	if (m_pPollReplies != nullptr) {
+		delete[] m_pPollReplies;
+	}
+
+	for (uint32_t i = 0; i < ARTNET_NODE_MAX_PORTS_OUTPUT; i++) {
+		if (m_OutputPorts[i].pBuffer != nullptr) {
+			delete m_OutputPorts[i].pBuffer;
+		}
+	}
+
+	for (uint32_t i = 0; i < ARTNET_NODE_MAX_PORTS_INPUT; i++) {
+		if (m_InputPorts[i].pArtDmx != nullptr) {
+			delete m_InputPorts[i].pArtDmx;
+		}
+	}
 }
 
 void ArtNetNode::Start() {
 	m_Node.Status2 = (m_Node.Status2 & ~(ArtNetStatus2::IP_DHCP)) | (Network::Get()->IsDhcpUsed() ? ArtNetStatus2::IP_DHCP : ArtNetStatus2::IP_MANUALY);
 	m_Node.Status2 = (m_Node.Status2 & ~(ArtNetStatus2::DHCP_CAPABLE)) | (Network::Get()->IsDhcpCapable() ? ArtNetStatus2::DHCP_CAPABLE : 0);
 
-	FillPollReply();
+	m_bPollRepliesValid = false;
 #if defined ( ENABLE_SENDDIAG )
 	FillDiagData();
 #endif
@@ -206,6 +229,8 @@ int ArtNetNode::SetUniverseSwitch(uint8_t nPortIndex, TArtNetPortDir dir, uint8_
 	assert(nPortIndex < (ArtNet::MAX_PORTS * m_nPages));
 	assert(dir <= ARTNET_DISABLE_PORT);
 
+	m_bPollRepliesValid = false;
+
 	if (dir == ARTNET_DISABLE_PORT) {
 
 		if (nPortIndex < ARTNET_NODE_MAX_PORTS_OUTPUT) {
@@ -232,6 +257,19 @@ int ArtNetNode::SetUniverseSwitch(uint8_t nPortIndex, TArtNetPortDir dir, uint8_
 			assert(m_State.nActiveInputPorts <= ArtNet::MAX_PORTS);
 		}
 
+		if (m_InputPorts[nPortIndex].pArtDmx == nullptr) {
+			auto *pArtDmx = new TArtDmx;
+			assert(pArtDmx != nullptr);
+
+			memset(pArtDmx, 0, sizeof(struct TArtDmx));
+			memcpy(pArtDmx->Id, artnet::NODE_ID, sizeof(pArtDmx->Id));
+			pArtDmx->OpCode = OP_DMX;
+			pArtDmx->ProtVerLo = ArtNet::PROTOCOL_REVISION;
+			pArtDmx->Physical = nPortIndex;
+
+			m_InputPorts[nPortIndex].pArtDmx = pArtDmx;
+		}
+
 		m_InputPorts[nPortIndex].bIsEnabled = true;
 		m_InputPorts[nPortIndex].port.nStatus = 0;
 		m_InputPorts[nPortIndex].port.nDefaultAddress = nAddress & 0x0F;// Universe : Bits 3-0
@@ -251,6 +289,12 @@ int ArtNetNode::SetUniverseSwitch(uint8_t nPortIndex, TArtNetPortDir dir, uint8_
 			assert(m_State.nActiveOutputPorts <= (ArtNet::MAX_PORTS * m_nPages));
 		}
 
+		if (m_OutputPorts[nPortIndex].pBuffer == nullptr) {
+			m_OutputPorts[nPortIndex].pBuffer = new TOutputPortBuffer;
+			assert(m_OutputPorts[nPortIndex].pBuffer != nullptr);
+			memset(m_OutputPorts[nPortIndex].pBuffer, 0, sizeof(struct TOutputPortBuffer));
+		}
+
 		m_OutputPorts[nPortIndex].bIsEnabled = true;
 		m_OutputPorts[nPortIndex].port.nDefaultAddress = nAddress & 0x0F;// Universe : Bits 3-0
 		m_OutputPorts[nPortIndex].port.nPortAddress = MakePortAddress(nAddress, (nPortIndex / ArtNet::MAX_PORTS));
@@ -304,6 +348,7 @@ void ArtNetNode::SetSubnetSwitch(uint8_t nAddress, uint8_t nPage) {
 	assert(nPage < ArtNet::MAX_PAGES);
 
 	m_Node.SubSwitch[nPage] = nAddress;
+	m_bPollRepliesValid = false;
 
 	const uint32_t nPortIndexStart = nPage * ArtNet::MAX_PORTS;
 
@@ -328,6 +373,7 @@ void ArtNetNode::SetNetSwitch(uint8_t nAddress, uint8_t nPage) {
 	assert(nPage < ArtNet::MAX_PAGES);
 
 	m_Node.NetSwitch[nPage] = nAddress;
+	m_bPollRepliesValid = false;
 
 	const uint32_t nPortIndexStart = nPage * ArtNet::MAX_PORTS;
 
@@ -441,7 +487,7 @@ void ArtNetNode::SetShortName(const char *pShortName) {
 	strncpy(m_Node.ShortName, pShortName, ArtNet::SHORT_NAME_LENGTH - 1);
 	m_Node.ShortName[ArtNet::SHORT_NAME_LENGTH - 1] = '\0';
 
-	memcpy(m_PollReply.ShortName, m_Node.ShortName, ArtNet::SHORT_NAME_LENGTH);
+	m_bPollRepliesValid = false;
 
 	if (m_State.status == ARTNET_ON) {
 		if (m_pArtNetStore != nullptr) {
@@ -459,7 +505,7 @@ void ArtNetNode::SetLongName(const char *pLongName) {
 	strncpy(m_Node.LongName, pLongName, ArtNet::LONG_NAME_LENGTH - 1);
 	m_Node.LongName[ArtNet::LONG_NAME_LENGTH - 1] = '\0';
 
-	memcpy(m_PollReply.LongName, m_Node.LongName, ArtNet::LONG_NAME_LENGTH);
+	m_bPollRepliesValid = false;
 
 	if (m_State.status == ARTNET_ON) {
 		if (m_pArtNetStore != nullptr) {
@@ -476,6 +522,38 @@ void ArtNetNode::SetOemValue(const uint8_t *pOem) {
 
 	m_Node.Oem[0] = pOem[0];
 	m_Node.Oem[1] = pOem[1];
+
+	m_bPollRepliesValid = false;
+}
+
+/**
+ * The node keeps copies of the network details, and the poll replies are built from them.
+ * Called by the Network when the address changes, for example after a DHCP renewal.
+ */
+void ArtNetNode::IpChanged() {
+	const auto nBroadcastIp = m_Node.IPAddressBroadcast;
+
+	m_Node.IPAddressLocal = Network::Get()->GetIp();
+	m_Node.IPAddressBroadcast = m_Node.IPAddressLocal | ~(Network::Get()->GetNetmask());
+
+	if (m_Node.IPAddressTimeCode == nBroadcastIp) {
+		m_Node.IPAddressTimeCode = m_Node.IPAddressBroadcast;
+	}
+
+	// Input ports without a unicast destination follow the broadcast address
+	for (uint32_t i = 0; i < ARTNET_NODE_MAX_PORTS_INPUT; i++) {
+		if (m_InputPorts[i].bIsBroadcast) {
+			m_InputPorts[i].nDestinationIp = m_Node.IPAddressBroadcast;
+		}
+	}
+
+	m_Node.Status2 = (m_Node.Status2 & (~(ArtNetStatus2::IP_DHCP))) | (Network::Get()->IsDhcpUsed() ? ArtNetStatus2::IP_DHCP : ArtNetStatus2::IP_MANUALY);
+	// Update PollReply for new IPAddress
+	m_bPollRepliesValid = false;
+
+	if ((m_State.status == ARTNET_ON) && m_State.SendArtPollReplyOnChange && (m_Node.IPAddressLocal != 0)) {
+		SendPollRelply(true);
+	}
 }
 
 void ArtNetNode::FillPollReply() {
@@ -517,24 +595,68 @@ void ArtNetNode::FillPollReply() {
 	m_PollReply.NumPortsLo = 4; // Default
 }
 
+/**
+ * The per page templates hold everything that only changes with the node configuration.
+ */
+void ArtNetNode::BuildPollReplies() {
+	FillPollReply();
+
+	for (uint32_t nPage = 0; nPage < m_nPages; nPage++) {
+		auto &pollReply = m_pPollReplies[nPage];
+
+		memcpy(&pollReply, &m_PollReply, sizeof(struct TArtPollReply));
+
+		pollReply.NetSwitch = m_Node.NetSwitch[nPage];
+		pollReply.SubSwitch = m_Node.SubSwitch[nPage];
+		pollReply.BindIndex = static_cast<uint8_t>(nPage + 1);
+
+		const uint32_t nPortIndexStart = nPage * ArtNet::MAX_PORTS;
+
+		uint32_t NumPortsLo = 0;
+
+		for (uint32_t nPortIndex = nPortIndexStart; nPortIndex < (nPortIndexStart + ArtNet::MAX_PORTS); nPortIndex++) {
+			if (m_OutputPorts[nPortIndex].bIsEnabled) {
+				pollReply.PortTypes[nPortIndex - nPortIndexStart] = ARTNET_ENABLE_OUTPUT | ARTNET_PORT_DMX;
+				NumPortsLo++;
+			}
+
+			pollReply.SwOut[nPortIndex - nPortIndexStart] = m_OutputPorts[nPortIndex].port.nDefaultAddress;
+
+			if (nPortIndex < ArtNet::MAX_PORTS) {
+				if (m_InputPorts[nPortIndex].bIsEnabled) {
+					pollReply.PortTypes[nPortIndex - nPortIndexStart] |= ARTNET_ENABLE_INPUT | ARTNET_PORT_DMX;
+					NumPortsLo++;
+				}
+
+				pollReply.SwIn[nPortIndex - nPortIndexStart] = m_InputPorts[nPortIndex].port.nDefaultAddress;
+			}
+		}
+
+		pollReply.NumPortsLo = static_cast<uint8_t>(NumPortsLo);
+		assert(NumPortsLo <= 4);
+
+		snprintf(reinterpret_cast<char*>(pollReply.NodeReport), ArtNet::REPORT_LENGTH, "%04x [%04d] %s AvV", static_cast<int>(m_State.reportCode), static_cast<int>(m_State.ArtPollReplyCount), m_aSysName);
+	}
+
+	m_bPollRepliesValid = true;
+}
+
 void ArtNetNode::SendPollRelply(bool bResponse) {
 	if (!bResponse && m_State.status == ARTNET_ON) {
 		m_State.ArtPollReplyCount++;
 	}
 
-	m_PollReply.Status1 = m_Node.Status1;
+	if (!m_bPollRepliesValid) {
+		BuildPollReplies();
+	}
 
 	for (uint32_t nPage = 0; nPage < m_nPages; nPage++) {
+		auto &pollReply = m_pPollReplies[nPage];
 
-		m_PollReply.NetSwitch = m_Node.NetSwitch[nPage];
-		m_PollReply.SubSwitch = m_Node.SubSwitch[nPage];
-
-		m_PollReply.BindIndex = nPage + 1;
+		pollReply.Status1 = m_Node.Status1;
 
 		const uint32_t nPortIndexStart = nPage * ArtNet::MAX_PORTS;
 
-		uint32_t NumPortsLo = 0;
-
 		for (uint32_t nPortIndex = nPortIndexStart; nPortIndex < (nPortIndexStart + ArtNet::MAX_PORTS); nPortIndex++) {
 			uint8_t nStatus = m_OutputPorts[nPortIndex].port.nStatus;
 
@@ -567,42 +689,60 @@ void ArtNetNode::SendPollRelply(bool bResponse) {
 
 			m_OutputPorts[nPortIndex].port.nStatus = nStatus;
 
-			if (m_OutputPorts[nPortIndex].bIsEnabled) {
-				m_PollReply.PortTypes[nPortIndex - nPortIndexStart] = ARTNET_ENABLE_OUTPUT | ARTNET_PORT_DMX;
-				NumPortsLo++;
+			pollReply.GoodOutput[nPortIndex - nPortIndexStart] = nStatus;
+
+			if (nPortIndex < ArtNet::MAX_PORTS) {
+				pollReply.GoodInput[nPortIndex - nPortIndexStart] = m_InputPorts[nPortIndex].port.nStatus;
 			}
+		}
 
-			m_PollReply.GoodOutput[nPortIndex - nPortIndexStart] = m_OutputPorts[nPortIndex].port.nStatus;
-			m_PollReply.SwOut[nPortIndex - nPortIndexStart] = m_OutputPorts[nPortIndex].port.nDefaultAddress;
+		// Patch the [%04d] counter, the layout only changes beyond 9999
+		auto nCount = m_State.ArtPollReplyCount;
 
-			if (nPortIndex < ArtNet::MAX_PORTS) {
-				if (m_InputPorts[nPortIndex].bIsEnabled) {
-					m_PollReply.PortTypes[nPortIndex - nPortIndexStart] |= ARTNET_ENABLE_INPUT | ARTNET_PORT_DMX;
-					NumPortsLo++;
-				}
+		if (nCount <= 9999) {
+			auto *pCount = &pollReply.NodeReport[9];
 
-				m_PollReply.GoodInput[nPortIndex - nPortIndexStart] = m_InputPorts[nPortIndex].port.nStatus;
-				m_PollReply.SwIn[nPortIndex - nPortIndexStart] = m_InputPorts[nPortIndex].port.nDefaultAddress;
+			for (uint32_t i = 0; i < 4; i++) {
+				*pCount-- = static_cast<uint8_t>('0' + (nCount % 10));
+				nCount /= 10;
 			}
-
+		} else {
+			snprintf(reinterpret_cast<char*>(pollReply.NodeReport), ArtNet::REPORT_LENGTH, "%04x [%04d] %s AvV", static_cast<int>(m_State.reportCode), static_cast<int>(m_State.ArtPollReplyCount), m_aSysName);
 		}
 
-		m_PollReply.NumPortsLo = NumPortsLo;
-		assert(NumPortsLo <= 4);
+		Network::Get()->SendTo(m_nHandle, &pollReply, sizeof(struct TArtPollReply), m_Node.IPAddressBroadcast, ArtNet::UDP_PORT);
+	}
 
-		snprintf(reinterpret_cast<char*>(m_PollReply.NodeReport), ArtNet::REPORT_LENGTH, "%04x [%04d] %s AvV", static_cast<int>(m_State.reportCode), static_cast<int>(m_State.ArtPollReplyCount), m_aSysName);
+	m_State.IsChanged = false;
+}
 
-		Network::Get()->SendTo(m_nHandle, &m_PollReply, sizeof(struct TArtPollReply), m_Node.IPAddressBroadcast, ArtNet::UDP_PORT);
+void ArtNetNode::SetDirty(uint8_t nPortId, uint32_t nFirst, uint32_t nEnd) {
+	auto &port = m_OutputPorts[nPortId];
+
+	if (port.nDirtyFirst >= port.nDirtyEnd) {
+		port.nDirtyFirst = static_cast<uint16_t>(nFirst);
+		port.nDirtyEnd = static_cast<uint16_t>(nEnd);
+		return;
 	}
 
-	m_State.IsChanged = false;
+	port.nDirtyFirst = static_cast<uint16_t>(std::min(nFirst, static_cast<uint32_t>(port.nDirtyFirst)));
+	port.nDirtyEnd = static_cast<uint16_t>(std::max(nEnd, static_cast<uint32_t>(port.nDirtyEnd)));
+}
+
+void ArtNetNode::SendData(uint8_t nPortId) {
+	auto &port = m_OutputPorts[nPortId];
+
+	m_pLightSet->SetDataRange(nPortId, port.pBuffer->data, port.nLength, port.nDirtyFirst, port.nDirtyEnd);
+
+	port.nDirtyFirst = 0;
+	port.nDirtyEnd = 0;
 }
 
 bool ArtNetNode::IsDmxDataChanged(uint8_t nPortId, const uint8_t *pData, uint16_t nLength) {
 	bool isChanged = false;
 
 	const uint8_t *pSrc = pData;
-	uint8_t *pDst = m_OutputPorts[nPortId].data;
+	uint8_t *pDst = m_OutputPorts[nPortId].pBuffer->data;
 
 	if (nLength != m_OutputPorts[nPortId].nLength) {
 		m_OutputPorts[nPortId].nLength = nLength;
@@ -611,16 +751,28 @@ bool ArtNetNode::IsDmxDataChanged(uint8_t nPortId, const uint8_t *pData, uint16_
 			*pDst++ = *pSrc++;
 		}
 
+		SetDirty(nPortId, 0, nLength);
 		return true;
 	}
 
+	uint32_t nFirst = 0;
+	uint32_t nLast = 0;
+
 	for (uint32_t i = 0; i < nLength; i++) {
 		if (*pDst != *pSrc) {
-			isChanged = true;
+			if (!isChanged) {
+				nFirst = i;
+				isChanged = true;
+			}
+			nLast = i;
 		}
 		*pDst++ = *pSrc++;
 	}
 
+	if (isChanged) {
+		SetDirty(nPortId, nFirst, nLast + 1);
+	}
+
 	return isChanged;
 }
 
@@ -636,24 +788,37 @@ bool ArtNetNode::IsMergedDmxDataChanged(uint8_t nPortId, const uint8_t *pData, u
 
 
 	if (m_OutputPorts[nPortId].mergeMode == ArtNetMerge::HTP) {
+		auto *pBuffer = m_OutputPorts[nPortId].pBuffer;
 
 		if (nLength != m_OutputPorts[nPortId].nLength) {
 			m_OutputPorts[nPortId].nLength = nLength;
 			for (uint32_t i = 0; i < nLength; i++) {
-				uint8_t data = std::max(m_OutputPorts[nPortId].dataA[i], m_OutputPorts[nPortId].dataB[i]);
-				m_OutputPorts[nPortId].data[i] = data;
+				uint8_t data = std::max(pBuffer->dataA[i], pBuffer->dataB[i]);
+				pBuffer->data[i] = data;
 			}
+			SetDirty(nPortId, 0, nLength);
 			return true;
 		}
 
+		uint32_t nFirst = 0;
+		uint32_t nLast = 0;
+
 		for (uint32_t i = 0; i < nLength; i++) {
-			uint8_t data = std::max(m_OutputPorts[nPortId].dataA[i], m_OutputPorts[nPortId].dataB[i]);
-			if (data != m_OutputPorts[nPortId].data[i]) {
-				m_OutputPorts[nPortId].data[i] = data;
-				isChanged = true;
+			uint8_t data = std::max(pBuffer->dataA[i], pBuffer->dataB[i]);
+			if (data != pBuffer->data[i]) {
+				pBuffer->data[i] = data;
+				if (!isChanged) {
+					nFirst = i;
+					isChanged = true;
+				}
+				nLast = i;
 			}
 		}
 
+		if (isChanged) {
+			SetDirty(nPortId, nFirst, nLast + 1);
+		}
+
 		return isChanged;
 	} else {
 		return IsDmxDataChanged(nPortId, pData, nLength);
@@ -761,21 +926,21 @@ void ArtNetNode::HandleDmx() {
 #endif
 				m_OutputPorts[i].ipA = m_ArtNetPacket.IPAddressFrom;
 				m_OutputPorts[i].nMillisA = m_nCurrentPacketMillis;
-				memcpy(&m_OutputPorts[i].dataA, pArtDmx->Data, data_length);
+				memcpy(m_OutputPorts[i].pBuffer->dataA, pArtDmx->Data, data_length);
 				sendNewData = IsDmxDataChanged(i, pArtDmx->Data, data_length);
 			} else if (ipA == m_ArtNetPacket.IPAddressFrom && ipB == 0) {
 #if defined ( ENABLE_SENDDIAG )
 				SendDiag("2. continued transmission from the same ip (source A)", ARTNET_DP_LOW);
 #endif
 				m_OutputPorts[i].nMillisA = m_nCurrentPacketMillis;
-				memcpy(&m_OutputPorts[i].dataA, pArtDmx->Data, data_length);
+				memcpy(m_OutputPorts[i].pBuffer->dataA, pArtDmx->Data, data_length);
 				sendNewData = IsDmxDataChanged(i, pArtDmx->Data, data_length);
 			} else if (ipA == 0 && ipB == m_ArtNetPacket.IPAddressFrom) {
 #if defined ( ENABLE_SENDDIAG )
 				SendDiag("3. continued transmission from the same ip (source B)", ARTNET_DP_LOW);
 #endif
 				m_OutputPorts[i].nMillisB = m_nCurrentPacketMillis;
-				memcpy(&m_OutputPorts[i].dataB, pArtDmx->Data, data_length);
+				memcpy(m_OutputPorts[i].pBuffer->dataB, pArtDmx->Data, data_length);
 				sendNewData = IsDmxDataChanged(i, pArtDmx->Data, data_length);
 			} else if (ipA != m_ArtNetPacket.IPAddressFrom && ipB == 0) {
 #if defined ( ENABLE_SENDDIAG )
@@ -783,30 +948,30 @@ void ArtNetNode::HandleDmx() {
 #endif
 				m_OutputPorts[i].ipB = m_ArtNetPacket.IPAddressFrom;
 				m_OutputPorts[i].nMillisB = m_nCurrentPacketMillis;
-				memcpy(&m_OutputPorts[i].dataB, pArtDmx->Data, data_length);
-				sendNewData = IsMergedDmxDataChanged(i, m_OutputPorts[i].dataB, data_length);
+				memcpy(m_OutputPorts[i].pBuffer->dataB, pArtDmx->Data, data_length);
+				sendNewData = IsMergedDmxDataChanged(i, m_OutputPorts[i].pBuffer->dataB, data_length);
 			} else if (ipA == 0 && ipB != m_ArtNetPacket.IPAddressFrom) {
 #if defined ( ENABLE_SENDDIAG )
 				SendDiag("5. new source, start the merge", ARTNET_DP_LOW);
 #endif
 				m_OutputPorts[i].ipA = m_ArtNetPacket.IPAddressFrom;
 				m_OutputPorts[i].nMillisA = m_nCurrentPacketMillis;
-				memcpy(&m_OutputPorts[i].dataA, pArtDmx->Data, data_length);
-				sendNewData = IsMergedDmxDataChanged(i, m_OutputPorts[i].dataA, data_length);
+				memcpy(m_OutputPorts[i].pBuffer->dataA, pArtDmx->Data, data_length);
+				sendNewData = IsMergedDmxDataChanged(i, m_OutputPorts[i].pBuffer->dataA, data_length);
 			} else if (ipA == m_ArtNetPacket.IPAddressFrom && ipB != m_ArtNetPacket.IPAddressFrom) {
 #if defined ( ENABLE_SENDDIAG )
 				SendDiag("6. continue merge", ARTNET_DP_LOW);
 #endif
 				m_OutputPorts[i].nMillisA = m_nCurrentPacketMillis;
-				memcpy(&m_OutputPorts[i].dataA, pArtDmx->Data, data_length);
-				sendNewData = IsMergedDmxDataChanged(i, m_OutputPorts[i].dataA, data_length);
+				memcpy(m_OutputPorts[i].pBuffer->dataA, pArtDmx->Data, data_length);
+				sendNewData = IsMergedDmxDataChanged(i, m_OutputPorts[i].pBuffer->dataA, data_length);
 			} else if (ipA != m_ArtNetPacket.IPAddressFrom && ipB == m_ArtNetPacket.IPAddressFrom) {
 #if defined ( ENABLE_SENDDIAG )
 				SendDiag("7. continue merge", ARTNET_DP_LOW);
 #endif
 				m_OutputPorts[i].nMillisB = m_nCurrentPacketMillis;
-				memcpy(&m_OutputPorts[i].dataB, pArtDmx->Data, data_length);
-				sendNewData = IsMergedDmxDataChanged(i, m_OutputPorts[i].dataB, data_length);
+				memcpy(m_OutputPorts[i].pBuffer->dataB, pArtDmx->Data, data_length);
+				sendNewData = IsMergedDmxDataChanged(i, m_OutputPorts[i].pBuffer->dataB, data_length);
 			} else if (ipA == m_ArtNetPacket.IPAddressFrom && ipB == m_ArtNetPacket.IPAddressFrom) {
 #if defined ( ENABLE_SENDDIAG )
 				SendDiag("8. Source matches both buffers, this shouldn't be happening!", ARTNET_DP_LOW);
@@ -829,7 +994,7 @@ void ArtNetNode::HandleDmx() {
 #if defined ( ENABLE_SENDDIAG )
 					SendDiag("Send new data", ARTNET_DP_LOW);
 #endif
-					m_pLightSet->SetData(i, m_OutputPorts[i].data, m_OutputPorts[i].nLength);
+					SendData(i);
 
 					if(!m_IsLightSetRunning[i]) {
 						m_pLightSet->Start(i);
@@ -857,12 +1022,14 @@ void ArtNetNode::HandleSync() {
 	m_State.IsSynchronousMode = true;
 	m_State.nArtSyncMillis = Hardware::Get()->Millis();
 
+	m_pLightSet->BeginFrame();
+
 	for (uint32_t i = 0; i < (m_nPages * ArtNet::MAX_PORTS); i++) {
 		if  ((m_OutputPorts[i].tPortProtocol == PORT_ARTNET_ARTNET) &&  ((m_OutputPorts[i].IsDataPending) || (m_OutputPorts[i].bIsEnabled && m_bDirectUpdate) )) {
 #if defined ( ENABLE_SENDDIAG )
 			SendDiag("Send pending data", ARTNET_DP_LOW);
 #endif
-			m_pLightSet->SetData(i, m_OutputPorts[i].data, 	m_OutputPorts[i].nLength);
+			SendData(i);
 
 			if(!m_IsLightSetRunning[i]) {
 				m_pLightSet->Start(i);
@@ -872,6 +1039,8 @@ void ArtNetNode::HandleSync() {
 			m_OutputPorts[i].IsDataPending = false;
 		}
 	}
+
+	m_pLightSet->CommitFrame();
 }
 
 void ArtNetNode::HandleAddress() {
@@ -879,6 +1048,7 @@ void ArtNetNode::HandleAddress() {
 	uint8_t nPort = 0xFF;
 
 	m_State.reportCode = ARTNET_RCPOWEROK;
+	m_bPollRepliesValid = false;
 
 	if (pArtAddress->ShortName[0] != 0)  {
 		SetShortName(reinterpret_cast<const char*>(pArtAddress->ShortName));
@@ -979,12 +1149,16 @@ void ArtNetNode::HandleAddress() {
 	case ARTNET_PC_CLR_2:
 	case ARTNET_PC_CLR_3:
 		nPort = pArtAddress->Command & 0x3;
+		if (m_OutputPorts[nPort].pBuffer == nullptr) {
+			nPort = 0xFF;
+			break;
+		}
 		for (uint32_t i = 0; i < ArtNet::DMX_LENGTH; i++) {
-			m_OutputPorts[nPort].data[i] = 0;
+			m_OutputPorts[nPort].pBuffer->data[i] = 0;
 		}
 		m_OutputPorts[nPort].nLength = ArtNet::DMX_LENGTH;
 		if (m_OutputPorts[nPort].tPortProtocol == PORT_ARTNET_ARTNET) {
-			m_pLightSet->SetData(nPort, m_OutputPorts[nPort].data, m_OutputPorts[nPort].nLength);
+			m_pLightSet->SetData(nPort, m_OutputPorts[nPort].pBuffer->data, m_OutputPorts[nPort].nLength);
 		}
 		break;
 
@@ -1071,6 +1245,10 @@ void ArtNetNode::Run() {
 			}
 		}
 
+#if defined ( ENABLE_SENDDIAG )
+		HandleDiag();
+#endif
+
 		if (m_pArtNetDmx != nullptr) {
 			HandleDmxIn();
 
@@ -1103,7 +1281,9 @@ void ArtNetNode::Run() {
 		break;
 	case OP_DMX:
 		if (m_pLightSet != nullptr) {
+			m_pLightSet->BeginFrame();
 			HandleDmx();
+			m_pLightSet->CommitFrame();
 		}
 		break;
 	case OP_SYNC:
@@ -37,6 +37,10 @@
 #include "network.h"
 #include "hardware.h"
 
+#if defined (BARE_METAL)
+# include "arm/memfunc.h"
+#endif
+
 #include "debug.h"
 
 static uint32_t s_ReceivingMask = 0;
@@ -45,53 +49,85 @@ void ArtNetNode::SetDestinationIp(uint8_t nPortIndex, uint32_t nDestinationIp) {
 	if (nPortIndex < ARTNET_NODE_MAX_PORTS_INPUT) {
 		if (Network::Get()->IsValidIp(nDestinationIp)) {
 			m_InputPorts[nPortIndex].nDestinationIp = nDestinationIp;
+			m_InputPorts[nPortIndex].bIsBroadcast = false;
 		} else {
 			m_InputPorts[nPortIndex].nDestinationIp = m_Node.IPAddressBroadcast;
+			m_InputPorts[nPortIndex].bIsBroadcast = true;
 		}
 
 		DEBUG_PRINTF("m_nDestinationIp=" IPSTR, IP2STR(m_InputPorts[nPortIndex].nDestinationIp));
 	}
 }
 
-void ArtNetNode::HandleDmxIn() {
-	struct TArtDmx tArtDmx;
+void ArtNetNode::SendDmxIn(uint32_t nPortIndex) {
+	auto &inputPort = m_InputPorts[nPortIndex];
+	auto *pArtDmx = inputPort.pArtDmx;
 
-	memcpy(tArtDmx.Id, artnet::NODE_ID, sizeof m_PollReply.Id);
-	tArtDmx.OpCode = OP_DMX;
-	tArtDmx.ProtVerHi = 0;
-	tArtDmx.ProtVerLo = ArtNet::PROTOCOL_REVISION;
+	pArtDmx->Sequence = 1 + inputPort.nSequence++;
+	pArtDmx->PortAddress = inputPort.port.nPortAddress;
+	pArtDmx->LengthHi = (inputPort.nLength & 0xFF00) >> 8;
+	pArtDmx->Length = (inputPort.nLength & 0xFF);
 
-	for (uint32_t i = 0; i < ArtNet::MAX_PORTS; i++) {
-		uint32_t nUpdatesPerSecond;
+	Network::Get()->SendTo(m_nHandle, pArtDmx, sizeof(struct TArtDmx), inputPort.nDestinationIp, ArtNet::UDP_PORT);
 
-		if (m_InputPorts[i].bIsEnabled){
-			uint16_t nLength;
-			const auto *pDmxData = m_pArtNetDmx->Handler(i, nLength, nUpdatesPerSecond);
+	inputPort.nMillisSent = m_nCurrentPacketMillis;
+	inputPort.bIsDirty = false;
+}
 
-			if (pDmxData != nullptr) {
-				tArtDmx.Sequence = 1 + m_InputPorts[i].nSequence++;
-				tArtDmx.Physical = i;
-				tArtDmx.PortAddress = m_InputPorts[i].port.nPortAddress;
-				tArtDmx.LengthHi = (nLength & 0xFF00) >> 8;
-				tArtDmx.Length = (nLength & 0xFF);
+/**
+ * A received frame only marks the port dirty when it differs from the latest frame.
+ * A dirty port is sent as soon as the minimum interval has passed, an unchanged port
+ * is refreshed at the keep-alive period for as long as DMX is being received.
+ */
+void ArtNetNode::HandleDmxIn() {
+	for (uint32_t i = 0; i < ARTNET_NODE_MAX_PORTS_INPUT; i++) {
+		auto &inputPort = m_InputPorts[i];
 
-				memcpy(tArtDmx.Data, pDmxData, nLength);
+		if (!inputPort.bIsEnabled) {
+			continue;
+		}
 
-				m_InputPorts[i].port.nStatus = GI_DATA_RECIEVED;
+		uint16_t nLength;
+		uint32_t nUpdatesPerSecond;
+		const auto *pDmxData = m_pArtNetDmx->Handler(i, nLength, nUpdatesPerSecond);
+
+		if (pDmxData != nullptr) {
+			auto *pData = inputPort.pArtDmx->Data;
+
+#if defined (BARE_METAL)
+			if ((arm_memcmpcpy(pData, pDmxData, nLength) != 0) || (nLength != inputPort.nLength)) {
+#else
+			if ((nLength != inputPort.nLength) || (memcmp(pData, pDmxData, nLength) != 0)) {
+				memcpy(pData, pDmxData, nLength);
+#endif
+				inputPort.nLength = nLength;
+				inputPort.bIsDirty = true;
+			}
 
-				Network::Get()->SendTo(m_nHandle, &tArtDmx, sizeof(struct TArtDmx), m_InputPorts[i].nDestinationIp, ArtNet::UDP_PORT);
+			inputPort.port.nStatus = GI_DATA_RECIEVED;
 
-				s_ReceivingMask = (1U << i);
-				m_State.bIsReceivingDmx = (s_ReceivingMask != 0);
-			} else {
-				if ((m_InputPorts[i].port.nStatus & GO_DATA_IS_BEING_TRANSMITTED) == GO_DATA_IS_BEING_TRANSMITTED) {
-					if (nUpdatesPerSecond == 0) {
-						m_InputPorts[i].port.nStatus = m_InputPorts[i].port.nStatus & ~GI_DATA_RECIEVED;
-						s_ReceivingMask &= ~(1U << i);
-						m_State.bIsReceivingDmx = (s_ReceivingMask != 0);
-					}
+			s_ReceivingMask |= (1U << i);
+			m_State.bIsReceivingDmx = true;
+		} else {
+			if ((inputPort.port.nStatus & GO_DATA_IS_BEING_TRANSMITTED) == GO_DATA_IS_BEING_TRANSMITTED) {
+				if (nUpdatesPerSecond == 0) {
+					inputPort.port.nStatus = inputPort.port.nStatus & ~GI_DATA_RECIEVED;
+					s_ReceivingMask &= ~(1U << i);
+					m_State.bIsReceivingDmx = (s_ReceivingMask != 0);
 				}
 			}
 		}
+
+		const auto nElapsedMillis = m_nCurrentPacketMillis - inputPort.nMillisSent;
+
+		if (inputPort.bIsDirty) {
+			if (nElapsedMillis >= m_nDmxInMinIntervalMillis) {
+				SendDmxIn(i);
+			}
+		} else if ((m_nDmxInKeepAliveMillis != 0) && ((inputPort.port.nStatus & GI_DATA_RECIEVED) == GI_DATA_RECIEVED)) {
+			if (nElapsedMillis >= m_nDmxInKeepAliveMillis) {
+				SendDmxIn(i);
+			}
+		}
 	}
 }
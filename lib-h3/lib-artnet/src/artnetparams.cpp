@@ -69,6 +69,8 @@ ArtNetParams::ArtNetParams(ArtNetParamsStore *pArtNetParamsStore): m_pArtNetPara
 	m_tArtNetParams.aOemValue[0] = ArtNetConst::OEM_ID[1];
 	m_tArtNetParams.aOemValue[1] = ArtNetConst::OEM_ID[0];
 	m_tArtNetParams.nDirection = ARTNET_OUTPUT_PORT;
+	m_tArtNetParams.nInputMinInterval = artnet::DMX_IN_MIN_INTERVAL_MILLIS;
+	m_tArtNetParams.nInputKeepAlive = artnet::DMX_IN_KEEP_ALIVE_MILLIS;
 
 	DEBUG_EXIT
 }
@@ -295,6 +297,28 @@ void ArtNetParams::callbackFunction(const char *pLine) {
 		}
 		return;
 	}
+
+	if (Sscan::Uint16(pLine, ArtNetParamsConst::INPUT_MIN_INTERVAL, nValue16) == Sscan::OK) {
+		if (nValue16 != artnet::DMX_IN_MIN_INTERVAL_MILLIS) {
+			m_tArtNetParams.nInputMinInterval = nValue16;
+			m_tArtNetParams.nSetList |= ArtnetParamsMask::INPUT_MIN_INTERVAL;
+		} else {
+			m_tArtNetParams.nInputMinInterval = artnet::DMX_IN_MIN_INTERVAL_MILLIS;
+			m_tArtNetParams.nSetList &= ~ArtnetParamsMask::INPUT_MIN_INTERVAL;
+		}
+		return;
+	}
+
+	if (Sscan::Uint16(pLine, ArtNetParamsConst::INPUT_KEEP_ALIVE, nValue16) == Sscan::OK) {
+		if (nValue16 != artnet::DMX_IN_KEEP_ALIVE_MILLIS) {
+			m_tArtNetParams.nInputKeepAlive = nValue16;
+			m_tArtNetParams.nSetList |= ArtnetParamsMask::INPUT_KEEP_ALIVE;
+		} else {
+			m_tArtNetParams.nInputKeepAlive = artnet::DMX_IN_KEEP_ALIVE_MILLIS;
+			m_tArtNetParams.nSetList &= ~ArtnetParamsMask::INPUT_KEEP_ALIVE;
+		}
+		return;
+	}
 }
 
 uint8_t ArtNetParams::GetUniverse(uint8_t nPort, bool& IsSet) {
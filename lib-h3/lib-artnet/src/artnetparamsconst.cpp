@@ -49,3 +49,5 @@ const char ArtNetParamsConst::PROTOCOL[] = "protocol";
 const char ArtNetParamsConst::PROTOCOL_PORT[ArtNet::MAX_PORTS][16] = { "protocol_port_a", "protocol_port_b", "protocol_port_c", "protocol_port_d" };
 const char ArtNetParamsConst::DIRECTION[] = "direction";
 const char ArtNetParamsConst::DESTINATION_IP_PORT[ArtNet::MAX_PORTS][24] = { "destination_ip_port_a", "destination_ip_port_b", "destination_ip_port_c", "destination_ip_port_d" };
+const char ArtNetParamsConst::INPUT_MIN_INTERVAL[] = "input_min_interval";
+const char ArtNetParamsConst::INPUT_KEEP_ALIVE[] = "input_keep_alive";
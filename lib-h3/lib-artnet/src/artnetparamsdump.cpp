@@ -127,6 +127,14 @@ void ArtNetParams::Dump() {
 			printf(" %s=" IPSTR "\n", ArtNetParamsConst::DESTINATION_IP_PORT[i], IP2STR(m_tArtNetParams.nDestinationIpPort[i]));
 		}
 	}
+
+	if (isMaskSet(ArtnetParamsMask::INPUT_MIN_INTERVAL)) {
+		printf(" %s=%d [ms]\n", ArtNetParamsConst::INPUT_MIN_INTERVAL, static_cast<int>(m_tArtNetParams.nInputMinInterval));
+	}
+
+	if (isMaskSet(ArtnetParamsMask::INPUT_KEEP_ALIVE)) {
+		printf(" %s=%d [%s]\n", ArtNetParamsConst::INPUT_KEEP_ALIVE, static_cast<int>(m_tArtNetParams.nInputKeepAlive), (m_tArtNetParams.nInputKeepAlive == 0) ? "Disabled" : "ms");
+	}
 #endif
 }
 
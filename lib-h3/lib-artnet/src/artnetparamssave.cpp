@@ -99,6 +99,8 @@ void ArtNetParams::Builder(const struct TArtNetParams *pArtNetParams, char *pBuf
 		}
 		builder.AddIpAddress(ArtNetParamsConst::DESTINATION_IP_PORT[i], m_tArtNetParams.nDestinationIpPort[i], isMaskMultiPortOptionsSet(ArtnetParamsMaskMultiPortOptions::DESTINATION_IP_A << i));
 	}
+	builder.Add(ArtNetParamsConst::INPUT_MIN_INTERVAL, m_tArtNetParams.nInputMinInterval, isMaskSet(ArtnetParamsMask::INPUT_MIN_INTERVAL));
+	builder.Add(ArtNetParamsConst::INPUT_KEEP_ALIVE, m_tArtNetParams.nInputKeepAlive, isMaskSet(ArtnetParamsMask::INPUT_KEEP_ALIVE));
 
 	nSize = builder.GetSize();
 
@@ -96,4 +96,12 @@ void ArtNetParams::Set(ArtNetNode *pArtNetNode) {
 	if (isMaskSet(ArtnetParamsMask::ENABLE_NO_CHANGE_OUTPUT)) {
 		pArtNetNode->SetDirectUpdate(true);
 	}
+
+	if (isMaskSet(ArtnetParamsMask::INPUT_MIN_INTERVAL)) {
+		pArtNetNode->SetDmxInMinInterval(m_tArtNetParams.nInputMinInterval);
+	}
+
+	if (isMaskSet(ArtnetParamsMask::INPUT_KEEP_ALIVE)) {
+		pArtNetNode->SetDmxInKeepAlive(m_tArtNetParams.nInputKeepAlive);
+	}
 }
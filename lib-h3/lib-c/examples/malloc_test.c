@@ -0,0 +1,312 @@
+/**
+ * @file malloc_test.c
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Host test and trace replay for src/malloc.c
+ *
+ * The allocator is built with its public functions renamed to lib_malloc,
+ * lib_free, lib_calloc and lib_realloc, on a heap defined here instead of by
+ * the linker script.
+ *
+ * - alignment and usable size for every request size up to 70000 bytes
+ * - calloc overflow and zero fill, realloc keeps the old contents
+ * - static arena: free() ignores the blocks and the arena never shrinks
+ * - a buffer that is freed and allocated again (a re-created driver) does not
+ *   grow the heap
+ * - freed large chunks are coalesced and handed back to the untouched area
+ * - replay of a synthetic trace modelled on the start-up allocations of the
+ *   pixel/DMX images followed by 2M ops of runtime churn, with pattern fill
+ *   and verify-on-free
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../include/malloc.h"
+
+extern void *lib_malloc(size_t);
+extern void lib_free(void *);
+extern void *lib_calloc(size_t, size_t);
+extern void *lib_realloc(void *, size_t);
+
+#define HEAP_SIZE		"11534336"		/* 11 MB */
+
+__asm__(
+	"	.bss\n"
+	"	.balign 64\n"
+	"	.globl heap_low\n"
+	"heap_low:\n"
+	"	.space " HEAP_SIZE "\n"
+	"	.globl heap_top\n"
+	"heap_top:\n"
+	"	.text\n");
+
+#define TRACE_SLOTS		512
+#define TRACE_OPS		2000000
+
+static unsigned s_errors;
+
+#define CHECK(cond, ...)	do { if (!(cond)) { if (s_errors++ < 10) { printf(__VA_ARGS__); } } } while (0)
+
+static uint32_t s_seed = 12345;
+
+static uint32_t xorshift32(void) {
+	s_seed ^= s_seed << 13;
+	s_seed ^= s_seed >> 17;
+	s_seed ^= s_seed << 5;
+	return s_seed;
+}
+
+static size_t heap_used(void) {
+	struct mem_stats stats;
+	mem_get_stats(&stats);
+	return stats.heap_used;
+}
+
+static void test_sizes(void) {
+	for (size_t size = 1; size <= 70000; size++) {
+		uint8_t *p = lib_malloc(size);
+
+		CHECK(p != NULL, "malloc(%zu) failed\n", size);
+		if (p == NULL) {
+			continue;
+		}
+
+		CHECK(((uintptr_t) p & 15) == 0, "malloc(%zu) = %p is not 16 byte aligned\n", size, (void *) p);
+		CHECK(get_allocated(p) >= size, "malloc(%zu): get_allocated %zu\n", size, get_allocated(p));
+
+		memset(p, 0xA5, size);
+		lib_free(p);
+	}
+}
+
+static void test_calloc_realloc(void) {
+	CHECK(lib_calloc(SIZE_MAX / 2, 4) == NULL, "calloc overflow not detected\n");
+
+	uint8_t *p = lib_malloc(1000);
+	memset(p, 0xFF, 1000);
+	lib_free(p);
+
+	p = lib_calloc(250, 4);
+	for (size_t i = 0; i < 1000; i++) {
+		CHECK(p[i] == 0, "calloc: byte %zu is not zero\n", i);
+	}
+
+	for (size_t i = 0; i < 1000; i++) {
+		p[i] = (uint8_t) i;
+	}
+
+	p = lib_realloc(p, 100000);
+	CHECK(p != NULL, "realloc failed\n");
+
+	for (size_t i = 0; i < 1000; i++) {
+		CHECK(p[i] == (uint8_t) i, "realloc: byte %zu lost\n", i);
+	}
+
+	lib_free(p);
+}
+
+static void test_static(void) {
+	struct mem_stats before, after;
+
+	mem_get_stats(&before);
+
+	mem_static_begin();
+	uint8_t *p = lib_malloc(4096);
+	mem_static_end();
+
+	CHECK(p != NULL, "static malloc failed\n");
+	memset(p, 0x5A, 4096);
+
+	lib_free(p);
+
+	uint8_t *q = lib_malloc(4096);
+	CHECK(q != p, "a static block was handed out again\n");
+	lib_free(q);
+
+	mem_get_stats(&after);
+	CHECK(after.static_used == before.static_used + 4096 + 16, "static arena %zu -> %zu\n", before.static_used, after.static_used);
+
+	for (size_t i = 0; i < 4096; i++) {
+		CHECK(p[i] == 0x5A, "static block byte %zu overwritten\n", i);
+	}
+}
+
+static void test_recreate(void) {
+	const size_t used = heap_used();
+
+	for (uint32_t i = 0; i < 1000; i++) {
+		void *p = lib_malloc(680 * 3 * 8);	// WS28xx buffer and blackout buffer
+		void *q = lib_malloc(680 * 3 * 8);
+		lib_free(q);
+		lib_free(p);
+	}
+
+	CHECK(heap_used() <= used + 2 * (680 * 3 * 8 + 16), "re-created buffers grow the heap %zu -> %zu\n", used, heap_used());
+}
+
+static void test_coalesce(void) {
+	const size_t used = heap_used();
+	void *p[16];
+
+	for (uint32_t i = 0; i < 16; i++) {
+		p[i] = lib_malloc(40000 + i * 1000);
+	}
+
+	// Free in an order that needs both forward and backward merges
+	for (uint32_t i = 0; i < 16; i += 2) {
+		lib_free(p[i]);
+	}
+
+	for (uint32_t i = 1; i < 16; i += 2) {
+		lib_free(p[i]);
+	}
+
+	CHECK(heap_used() == used, "large chunks not coalesced %zu -> %zu\n", used, heap_used());
+}
+
+static void replay_init(void) {
+	/* Start-up allocations of the pixel/DMX firmware images */
+	static const size_t init[] = {
+		680 * 3 * 8, 680 * 3 * 8, 8 * 680 * 3 * 8, 512 * 3, 512 * 3, 512 * 3, 512 * 3, 239 * 8, 2048, 2048,
+		1514 * 4, 1536, 3 * 256, 64 * 32 * 8 * 4, 64 * 32 * 8 * 4, 4096, 384, 96, 96, 530,
+		530, 530, 530, 8192, 1024, 200, 48, 48, 48, 24
+	};
+	size_t requested = 0;
+
+	for (uint32_t i = 0; i < sizeof(init) / sizeof(init[0]); i++) {
+		CHECK(lib_malloc(init[i]) != NULL, "init malloc(%zu) failed\n", init[i]);
+		requested += init[i];
+	}
+
+	printf("init   : %zu bytes requested, %zu bytes heap\n", requested, heap_used());
+}
+
+/*
+ * Runtime churn: remote config, RDM, TFTP, show file, occasional firmware-size buffer
+ */
+static void replay(int verify) {
+	static uint8_t *slots[TRACE_SLOTS];
+	static size_t sizes[TRACE_SLOTS];
+	size_t live = 0;
+	uint32_t ops = 0;
+	uint32_t failed = 0;
+
+	s_seed = 12345;
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for (uint32_t n = 0; n < TRACE_OPS; n++) {
+		const uint32_t k = xorshift32() % TRACE_SLOTS;
+
+		if (slots[k] != NULL) {
+			for (size_t i = 0; verify && (i < sizes[k]); i++) {
+				if (slots[k][i] != (uint8_t) k) {
+					CHECK(0, "corruption in slot %u at byte %zu\n", k, i);
+					break;
+				}
+			}
+
+			lib_free(slots[k]);
+			slots[k] = NULL;
+			live -= sizes[k];
+			ops++;
+			continue;
+		}
+
+		const uint32_t r = xorshift32() % 1000;
+		size_t size;
+
+		if (r < 600) {
+			size = 16 + xorshift32() % 240;
+		} else if (r < 850) {
+			size = 256 + xorshift32() % 1792;
+		} else if (r < 980) {
+			size = 2048 + xorshift32() % 2048;
+		} else if (r < 998) {
+			size = 8192 + xorshift32() % 57344;
+		} else {
+			size = (xorshift32() & 1) ? 600 * 1024 : 1200 * 1024;
+			if (live > 2 * 1024 * 1024) {
+				continue;
+			}
+		}
+
+		if ((slots[k] = lib_malloc(size)) == NULL) {
+			failed++;
+			continue;
+		}
+
+		if (verify) {
+			memset(slots[k], (uint8_t) k, size);
+		}
+
+		sizes[k] = size;
+		live += size;
+		ops++;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	for (uint32_t k = 0; k < TRACE_SLOTS; k++) {
+		lib_free(slots[k]);
+		slots[k] = NULL;
+	}
+
+	const double ns = ((double) (end.tv_sec - start.tv_sec) * 1e9 + (double) (end.tv_nsec - start.tv_nsec)) / ops;
+
+	struct mem_stats stats;
+	mem_get_stats(&stats);
+
+	CHECK(failed == 0, "replay: %u allocations failed\n", failed);
+
+	printf("%s: high-water %zu bytes, %u ops, %.1f ns/op, failed %u\n", verify ? "verify " : "replay ", stats.heap_peak, ops, ns, failed);
+}
+
+int main(void) {
+	replay_init();
+	replay(1);
+	replay(0);
+
+	test_sizes();
+	test_calloc_realloc();
+	test_static();
+	test_recreate();
+	test_coalesce();
+
+	mem_info();
+
+	if (s_errors != 0) {
+		printf("FAILED: %u errors\n", s_errors);
+		return EXIT_FAILURE;
+	}
+
+	puts("PASSED");
+	return EXIT_SUCCESS;
+}
@@ -8,7 +8,7 @@
  * Copyright (C) 2014-2016  R. Stange <rsta2@o2online.de>
  * https://github.com/rsta2/circle/blob/master/lib/alloc.cpp
  */
-/* Copyright (C) 2017-2018 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2017-2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -29,120 +29,466 @@
  * THE SOFTWARE.
  */
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wpointer-arith" 	// FIXME ignored "-Wpointer-arith"
-#pragma GCC diagnostic ignored "-Wpedantic" 		// FIXME ignored "-Wpedantic"
+/*
+ * Heap layout
+ *
+ *  heap_low                next_block             block_limit        heap_top
+ *     | chunks (in use/free) |        untouched        | static arena |
+ *
+ * Every chunk starts with a 16 byte header, so the data is 16 byte aligned.
+ *
+ * Small requests (<= SMALL_MAX) are rounded up to a size class: 16 byte steps
+ * up to 256 bytes, then 4 classes per power of two (a 3 KB request costs 3 KB).
+ * Freed small blocks go to the per-core cache of the freeing core first,
+ * then to the shared class list. They are not coalesced.
+ *
+ * Large requests are carved from binned free chunks with boundary tags.
+ * Freed large chunks are coalesced with their free neighbours and returned
+ * to the untouched area when they are at its edge.
+ *
+ * Between mem_static_begin() and mem_static_end() allocations come from the
+ * static arena at the top of the heap. These are never freed, free() ignores them.
+ * The static mode is kept per core.
+ *
+ * malloc and free mask IRQ and FIQ on the calling core. The core cache has no
+ * lock, and an interrupt handler that allocates must neither re-enter it nor
+ * spin on the heap lock held by the code it interrupted.
+ */
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdio.h>
+#include <malloc.h>
 #include <assert.h>
 
-#ifdef MEM_DEBUG
-#include <stdio.h>
+#if defined (__ARM_ARCH_7A__)
+# include "arm/spinlock.h"
+# define MAX_CORES	4
+#else
+# define MAX_CORES	1
 #endif
 
 extern unsigned char heap_low; /* Defined by the linker */
 extern unsigned char heap_top; /* Defined by the linker */
 
-#define BLOCK_MAGIC	0x424C4D43
+#define BLOCK_MAGIC		0x424C4D43
+
+#define ALIGNMENT		16U
+#define SMALL_MAX		(32U * 1024U)
+#define SMALL_CLASSES	(16U + 7U * 4U)		/* 16..256 step 16, then 4 per power of two up to 32K */
+#define LARGE_BINS		32U
+#define MIN_SPLIT		64U					/* Smallest remainder kept as a free chunk */
+#define CACHE_DEPTH		8U					/* Blocks per size class in a core cache */
+
+#define CLASS_LARGE		0xFFFF
+#define CLASS_STATIC	0xFFFE
+
+#define FLAG_FREE		(1U << 0)
+
+struct block_header {
+	uint32_t magic;
+	uint32_t size;			/* Chunk size including this header */
+	uint32_t prev_size;		/* Size of the physically previous chunk, 0 for the first chunk */
+	uint16_t size_class;	/* Small class index, CLASS_LARGE or CLASS_STATIC */
+	uint16_t flags;
+};
+
+struct free_block {
+	struct block_header header;
+	struct free_block *next;
+	struct free_block *prev;
+};
+
+struct core_cache {
+	struct free_block *list[SMALL_CLASSES];
+	uint8_t count[SMALL_CLASSES];
+	uint32_t malloc_count;
+	uint32_t free_count;
+	uint32_t hits;
+} __attribute__((aligned(64)));
+
+_Static_assert((sizeof(struct block_header) % ALIGNMENT) == 0, "block_header breaks the alignment");
 
 static unsigned char *next_block = &heap_low;
 static unsigned char *block_limit = &heap_top;
+static uint32_t last_size;			/* Size of the chunk just below next_block */
+
+static struct free_block *s_class_list[SMALL_CLASSES];
+static struct free_block *s_bins[LARGE_BINS];
+static struct core_cache s_core_cache[MAX_CORES];
+
+static volatile uint32_t s_lock;
+static int s_static_mode[MAX_CORES];
+
+static struct {
+	size_t in_use;
+	size_t peak_in_use;
+	size_t peak_heap;
+	uint32_t malloc_count;
+	uint32_t free_count;
+	uint32_t failed;
+	uint32_t class_blocks[SMALL_CLASSES];
+} s_stats;
+
+#if defined (__ARM_ARCH_7A__)
+static inline uint32_t core_id(void) {
+	uint32_t mpidr;
+	__asm__ volatile ("mrc p15, 0, %0, c0, c0, 5" : "=r" (mpidr));
+	return mpidr & 0x3;
+}
 
-struct block_header {
-	unsigned int magic;
-	unsigned int size ;
-	struct block_header *next;
-	unsigned char data[0];
-} PACKED;
-
-struct block_bucket {
-	unsigned int size;
-#ifdef MEM_DEBUG
-	unsigned int count;
-	unsigned int max_count;
+/*
+ * Exclusive loads are only reliable with the MMU on (normal memory).
+ * The secondary cores are started after the MMU is enabled, so early
+ * single core allocations can skip the lock.
+ */
+static inline uint32_t irq_save(void) {
+	uint32_t cpsr;
+	__asm__ volatile ("mrs %0, cpsr\n\tcpsid if" : "=r" (cpsr) :: "memory");
+	return cpsr;
+}
+
+static inline void irq_restore(uint32_t cpsr) {
+	__asm__ volatile ("msr cpsr_c, %0" :: "r" (cpsr) : "memory");
+}
+
+static inline int mmu_is_enabled(void) {
+	uint32_t sctlr;
+	__asm__ volatile ("mrc p15, 0, %0, c1, c0, 0" : "=r" (sctlr));
+	return (int) (sctlr & 0x1);
+}
+
+static inline void heap_lock(void) {
+	if (mmu_is_enabled()) {
+		spin_lock((void *) &s_lock);
+	}
+}
+
+static inline void heap_unlock(void) {
+	if (mmu_is_enabled()) {
+		spin_unlock((void *) &s_lock);
+	}
+}
+#else
+static inline uint32_t core_id(void) {
+	return 0;
+}
+
+static inline uint32_t irq_save(void) {
+	return 0;
+}
+
+static inline void irq_restore(__attribute__((unused)) uint32_t cpsr) {
+}
+
+static inline void heap_lock(void) {
+}
+
+static inline void heap_unlock(void) {
+}
 #endif
-	struct block_header *free_list;
-};
 
-static struct block_bucket s_block_bucket[] __attribute__((aligned(4))) = {{0x40, 0}, {0x400,0}, {0x1000,0}, {0x4000,0}, {0x40000,0}, {0x80000,0}, {0,0}};
+static inline uint32_t log2_floor(uint32_t n) {
+	return 31U - (uint32_t) __builtin_clz(n);
+}
+
+static uint32_t small_class(size_t size) {
+	if (size <= 256) {
+		return (uint32_t) ((size + 15) >> 4) - 1;
+	}
+
+	const uint32_t n = (uint32_t) size - 1;
+	const uint32_t log = log2_floor(n);	/* 8..14 */
+	const uint32_t sub = (n - (1U << log)) >> (log - 2);
+
+	return 16U + (log - 8U) * 4U + sub;
+}
+
+static uint32_t class_size(uint32_t index) {
+	if (index < 16) {
+		return (index + 1) << 4;
+	}
+
+	const uint32_t log = 8U + ((index - 16U) >> 2);
+	const uint32_t sub = (index - 16U) & 3U;
+
+	return (1U << log) + ((sub + 1) << (log - 2));
+}
+
+static inline uint32_t bin_index(uint32_t size) {
+	return log2_floor(size);
+}
+
+static inline struct block_header *next_chunk(struct block_header *header) {
+	return (struct block_header *) ((unsigned char *) header + header->size);
+}
+
+static void bin_insert(struct free_block *block) {
+	const uint32_t bin = bin_index(block->header.size);
+
+	block->header.flags = FLAG_FREE;
+	block->prev = 0;
+	block->next = s_bins[bin];
+
+	if (block->next != 0) {
+		block->next->prev = block;
+	}
+
+	s_bins[bin] = block;
+}
+
+static void bin_remove(struct free_block *block) {
+	if (block->prev != 0) {
+		block->prev->next = block->next;
+	} else {
+		s_bins[bin_index(block->header.size)] = block->next;
+	}
+
+	if (block->next != 0) {
+		block->next->prev = block->prev;
+	}
+
+	block->header.flags = 0;
+}
+
+/*
+ * Called with the lock held. total includes the header and is 16 byte aligned.
+ */
+static struct block_header *chunk_alloc(uint32_t total) {
+	struct block_header *header = 0;
+
+	for (uint32_t bin = bin_index(total); bin < LARGE_BINS; bin++) {
+		for (struct free_block *block = s_bins[bin]; block != 0; block = block->next) {
+			if (block->header.size >= total) {
+				bin_remove(block);
+				header = &block->header;
+				break;
+			}
+		}
+
+		if (header != 0) {
+			break;
+		}
+	}
+
+	if (header != 0) {
+		const uint32_t remainder = header->size - total;
+
+		if (remainder >= MIN_SPLIT) {
+			header->size = total;
+
+			struct block_header *split = next_chunk(header);
+			split->magic = BLOCK_MAGIC;
+			split->size = remainder;
+			split->prev_size = total;
+			split->size_class = CLASS_LARGE;
+
+			struct block_header *next = next_chunk(split);
+
+			if ((unsigned char *) next < next_block) {
+				next->prev_size = remainder;
+			} else {
+				last_size = remainder;
+			}
+
+			bin_insert((struct free_block *) split);
+		}
+
+		header->flags = 0;
+		return header;
+	}
+
+	if ((size_t) (block_limit - next_block) < total) {
+		return 0;
+	}
+
+	header = (struct block_header *) next_block;
+	header->magic = BLOCK_MAGIC;
+	header->size = total;
+	header->prev_size = last_size;
+	header->flags = 0;
+
+	last_size = total;
+	next_block += total;
+
+	const size_t heap = (size_t) (next_block - &heap_low);
+
+	if (heap > s_stats.peak_heap) {
+		s_stats.peak_heap = heap;
+	}
+
+	return header;
+}
+
+/*
+ * Called with the lock held.
+ */
+static void chunk_free(struct block_header *header) {
+	struct block_header *next = next_chunk(header);
+
+	if (((unsigned char *) next < next_block) && (next->flags & FLAG_FREE)) {
+		bin_remove((struct free_block *) next);
+		header->size += next->size;
+	}
+
+	if (header->prev_size != 0) {
+		struct block_header *prev = (struct block_header *) ((unsigned char *) header - header->prev_size);
+
+		if (prev->flags & FLAG_FREE) {
+			bin_remove((struct free_block *) prev);
+			prev->size += header->size;
+			header = prev;
+		}
+	}
+
+	next = next_chunk(header);
+
+	if ((unsigned char *) next == next_block) {
+		next_block = (unsigned char *) header;
+		last_size = header->prev_size;
+		return;
+	}
+
+	next->prev_size = header->size;
+	bin_insert((struct free_block *) header);
+}
+
+static inline struct block_header *get_header(void *p) {
+	return (struct block_header *) p - 1;
+}
+
+static inline void *get_data(struct block_header *header) {
+	return (void *) (header + 1);
+}
+
+static void *static_alloc(size_t size) {
+	const uint32_t total = (uint32_t) ((size + sizeof(struct block_header) + ALIGNMENT - 1) & ~(ALIGNMENT - 1));
+
+	heap_lock();
+
+	if ((size_t) (block_limit - next_block) < total) {
+		s_stats.failed++;
+		heap_unlock();
+		return NULL;
+	}
+
+	block_limit -= total;
+
+	struct block_header *header = (struct block_header *) block_limit;
+	header->magic = BLOCK_MAGIC;
+	header->size = total;
+	header->prev_size = 0;
+	header->size_class = CLASS_STATIC;
+	header->flags = 0;
+
+	heap_unlock();
+
+	return get_data(header);
+}
 
 size_t get_allocated(void *p) {
 	if (p == 0) {
 		return 0;
 	}
 
-	struct block_header *pBlockHeader = (struct block_header *) ((void *) p - sizeof(struct block_header));
+	struct block_header *pBlockHeader = get_header(p);
 
 	assert(pBlockHeader->magic == BLOCK_MAGIC);
 	if (pBlockHeader->magic != BLOCK_MAGIC) {
 		return 0;
 	}
 
-	return pBlockHeader->size;
+	return pBlockHeader->size - sizeof(struct block_header);
 }
 
-void *malloc(size_t size) {
-	struct block_bucket *bucket;
+/*
+ * Called with IRQ and FIQ masked.
+ */
+static void *heap_malloc(size_t size) {
 	struct block_header *header;
 
-	if (size == 0) {
+	if ((size == 0) || (size > (size_t) (&heap_top - &heap_low))) {
 		return NULL;
 	}
 
-	for (bucket = s_block_bucket; bucket->size > 0; bucket++) {
-		if (size <= bucket->size) {
-			size = bucket->size;
-#ifdef MEM_DEBUG
-			if (++bucket->count > bucket->max_count) {
-				bucket->max_count = bucket->count;
-			}
-#endif
-			break;
-		}
+	if (s_static_mode[core_id()]) {
+		return static_alloc(size);
 	}
 
-	if (bucket->size > 0 && (header = bucket->free_list) != 0) {
-		assert(header->magic == BLOCK_MAGIC);
-		bucket->free_list = header->next;
-	} else {
-		header = (struct block_header *) next_block;
+	if (size <= SMALL_MAX) {
+		const uint32_t index = small_class(size);
+		struct core_cache *cache = &s_core_cache[core_id()];
+		struct free_block *block = cache->list[index];
 
-		const size_t t1 = sizeof(struct block_header) + size;
-		const size_t t2 = (t1 + (size_t) 15) & ~(size_t) 15;
+		cache->malloc_count++;
 
-		unsigned char *next = next_block + t2;
+		if (block != 0) {
+			cache->list[index] = block->next;
+			cache->count[index]--;
+			cache->hits++;
+			return get_data(&block->header);
+		}
 
-		assert(((unsigned)header & (unsigned)3) == 0);
-		assert(((unsigned)next & (unsigned)3) == 0);
+		heap_lock();
 
-		if (next > block_limit) {
-			return NULL;
+		if ((block = s_class_list[index]) != 0) {
+			s_class_list[index] = block->next;
+			header = &block->header;
+		} else if ((header = chunk_alloc((uint32_t) sizeof(struct block_header) + class_size(index))) != 0) {
+			header->size_class = (uint16_t) index;
+			s_stats.class_blocks[index]++;
 		} else {
-			next_block = next;
+			s_stats.failed++;
+			heap_unlock();
+			return NULL;
+		}
+
+		s_stats.in_use += header->size;
+		if (s_stats.in_use > s_stats.peak_in_use) {
+			s_stats.peak_in_use = s_stats.in_use;
+		}
+
+		heap_unlock();
+	} else {
+		const uint32_t total = (uint32_t) ((size + sizeof(struct block_header) + ALIGNMENT - 1) & ~(ALIGNMENT - 1));
+
+		heap_lock();
+
+		s_stats.malloc_count++;
+
+		if ((header = chunk_alloc(total)) == 0) {
+			s_stats.failed++;
+			heap_unlock();
+			return NULL;
 		}
 
-		header->magic = BLOCK_MAGIC;
-		header->size = (unsigned) size;
+		header->size_class = CLASS_LARGE;
+
+		s_stats.in_use += header->size;
+		if (s_stats.in_use > s_stats.peak_in_use) {
+			s_stats.peak_in_use = s_stats.in_use;
+		}
+
+		heap_unlock();
 	}
 
-	header->next = 0;
 #ifdef MEM_DEBUG
 	printf("malloc: pBlockHeader = %p, size = %d\n", header, (int) size);
 #endif
 
-	assert(((unsigned)header->data & (unsigned)3) == 0);
-	return (void *)header->data;
+	assert(((uintptr_t) get_data(header) & (ALIGNMENT - 1)) == 0);
+	return get_data(header);
 }
 
-void free(void *p) {
-	struct block_bucket *bucket;
-
+/*
+ * Called with IRQ and FIQ masked.
+ */
+static void heap_free(void *p) {
 	if (p == 0) {
 		return;
 	}
 
-	struct block_header *header = (struct block_header *) ((void *) p - sizeof(struct block_header));
+	struct block_header *header = get_header(p);
 
 #ifdef MEM_DEBUG
 	printf("free: pBlockHeader = %p, pBlock = %p\n", header, p);
@@ -153,17 +499,55 @@ void free(void *p) {
 		return;
 	}
 
-	for (bucket = s_block_bucket; bucket->size > 0; bucket++) {
-		if (header->size == bucket->size) {
+	if (header->size_class == CLASS_STATIC) {
+		return;
+	}
 
-			header->next = bucket->free_list;
-			bucket->free_list = header;
-#ifdef MEM_DEBUG
-			bucket->count--;
-#endif
-			break;
+	if (header->size_class != CLASS_LARGE) {
+		const uint32_t index = header->size_class;
+		struct core_cache *cache = &s_core_cache[core_id()];
+		struct free_block *block = (struct free_block *) header;
+
+		cache->free_count++;
+
+		if (cache->count[index] < CACHE_DEPTH) {
+			block->next = cache->list[index];
+			cache->list[index] = block;
+			cache->count[index]++;
+			return;
 		}
+
+		heap_lock();
+
+		block->next = s_class_list[index];
+		s_class_list[index] = block;
+		s_stats.in_use -= header->size;
+
+		heap_unlock();
+		return;
 	}
+
+	heap_lock();
+
+	s_stats.free_count++;
+	s_stats.in_use -= header->size;
+	chunk_free(header);
+
+	heap_unlock();
+}
+
+void *malloc(size_t size) {
+	const uint32_t irq = irq_save();
+	void *p = heap_malloc(size);
+	irq_restore(irq);
+
+	return p;
+}
+
+void free(void *p) {
+	const uint32_t irq = irq_save();
+	heap_free(p);
+	irq_restore(irq);
 }
 
 void *calloc(size_t n, size_t size) {
@@ -176,13 +560,17 @@ void *calloc(size_t n, size_t size) {
 
 	total = n * size;
 
+	if ((total / n) != size) {
+		return NULL;
+	}
+
 	p = malloc(total);
 
 	if (p == NULL) {
 		return NULL;
 	}
 
-	assert(((unsigned)p & (unsigned)3) == 0);
+	assert(((uintptr_t)p & (uintptr_t)3) == 0);
 
 	uint32_t *dst32 = (uint32_t *) p;
 
@@ -197,7 +585,7 @@ void *calloc(size_t n, size_t size) {
 		*dst8++ = (uint8_t) 0;
 	}
 
-	assert(((void *)dst8 - (void *)p) == (n * size));
+	assert((size_t)(dst8 - (uint8_t *)p) == (n * size));
 
 	return (void *) p;
 }
@@ -224,13 +612,13 @@ void *realloc(void *ptr, size_t size) {
 	void *newblk = malloc(size);
 
 	if (newblk != NULL) {
-		assert(((unsigned )newblk & (unsigned )3) == 0);
-		assert(((unsigned )ptr & (unsigned )3) == 0);
+		assert(((uintptr_t)newblk & (uintptr_t)3) == 0);
+		assert(((uintptr_t)ptr & (uintptr_t)3) == 0);
 
 		const uint32_t *src32 = (const uint32_t *) ptr;
 		uint32_t *dst32 = (uint32_t *) newblk;
 
-		size_t count = size;
+		size_t count = current_size;
 
 		while (count >= 4) {
 			*dst32++ = *src32++;
@@ -244,7 +632,7 @@ void *realloc(void *ptr, size_t size) {
 			*dst8++ = *src8++;
 		}
 
-		assert(((void *)dst8 - (void *)newblk) == size);
+		assert((size_t)(dst8 - (uint8_t *)newblk) == current_size);
 
 		free(ptr);
 	}
@@ -252,22 +640,72 @@ void *realloc(void *ptr, size_t size) {
 	return newblk;
 }
 
+void mem_static_begin(void) {
+	s_static_mode[core_id()] = 1;
+}
+
+void mem_static_end(void) {
+	s_static_mode[core_id()] = 0;
+}
+
+void mem_get_stats(struct mem_stats *stats) {
+	assert(stats != 0);
+
+	const uint32_t irq = irq_save();
+	heap_lock();
+
+	stats->heap_size = (size_t) (&heap_top - &heap_low);
+	stats->heap_used = (size_t) (next_block - &heap_low);
+	stats->heap_peak = s_stats.peak_heap;
+	stats->static_used = (size_t) (&heap_top - block_limit);
+	stats->in_use = s_stats.in_use;
+	stats->in_use_peak = s_stats.peak_in_use;
+	stats->free_large = 0;
+	stats->free_large_max = 0;
+	stats->free_cached = 0;
+	stats->malloc_count = s_stats.malloc_count;
+	stats->free_count = s_stats.free_count;
+	stats->cache_hits = 0;
+	stats->failed = s_stats.failed;
+
+	for (uint32_t bin = 0; bin < LARGE_BINS; bin++) {
+		for (const struct free_block *block = s_bins[bin]; block != 0; block = block->next) {
+			stats->free_large += block->header.size;
+			if (block->header.size > stats->free_large_max) {
+				stats->free_large_max = block->header.size;
+			}
+		}
+	}
+
+	for (uint32_t core = 0; core < MAX_CORES; core++) {
+		const struct core_cache *cache = &s_core_cache[core];
+
+		stats->malloc_count += cache->malloc_count;
+		stats->free_count += cache->free_count;
+		stats->cache_hits += cache->hits;
+
+		for (uint32_t index = 0; index < SMALL_CLASSES; index++) {
+			stats->free_cached += (size_t) cache->count[index] * (class_size(index) + sizeof(struct block_header));
+		}
+	}
+
+	heap_unlock();
+	irq_restore(irq);
+}
+
 void mem_info(void) {
+	struct mem_stats stats;
+
+	mem_get_stats(&stats);
+
+	printf("Heap %u bytes, used %u (peak %u), static %u\n", (unsigned) stats.heap_size, (unsigned) stats.heap_used, (unsigned) stats.heap_peak, (unsigned) stats.static_used);
+	printf(" In use %u (peak %u), free large %u (largest %u), cached %u\n", (unsigned) stats.in_use, (unsigned) stats.in_use_peak, (unsigned) stats.free_large, (unsigned) stats.free_large_max, (unsigned) stats.free_cached);
+	printf(" malloc %u, free %u, cache hits %u, failed %u\n", (unsigned) stats.malloc_count, (unsigned) stats.free_count, (unsigned) stats.cache_hits, (unsigned) stats.failed);
+
 #ifdef MEM_DEBUG
-	struct block_bucket *pBucket;
-	struct block_header *pBlockHeader;
-	printf("s_pNextBlock = %p\n", next_block);
-
-	for (pBucket = s_block_bucket; pBucket->size > 0; pBucket++) {
-		printf("malloc(%d): %d blocks (max %d), FreeList %p\n", (unsigned) pBucket->size, (unsigned) pBucket->count, (unsigned) pBucket->max_count, pBucket->free_list);
-		if ((pBlockHeader = pBucket->free_list) != 0) {
-			while (1==1) {
-				printf("\t %p:%p size %d (%p)\n", pBlockHeader, pBlockHeader->data, pBlockHeader->size, pBlockHeader->next);
-				if (pBlockHeader->next == 0) {
-					break;
-				}
-				pBlockHeader = pBlockHeader->next;
-			}
+	for (uint32_t index = 0; index < SMALL_CLASSES; index++) {
+		if (s_stats.class_blocks[index] != 0) {
+			printf("malloc(%u): %u blocks\n", (unsigned) class_size(index), (unsigned) s_stats.class_blocks[index]);
 		}
 	}
 #endif
@@ -7,13 +7,14 @@
 #include <stddef.h>
 // #include <string.h>
 
+#include "arm/memfunc.h"
+
+/*
+ * Out-of-line memcpy for the calls generated by the compiler
+ * (structure assignments, loop idioms). Sources use the inline one in string.h
+ * Core registers only, the compiler also generates these calls in IRQ/FIQ handlers
+ */
 void *memcpy(void *dst, const void *src, size_t len)
 {
-	const char *s = src;
-	char *d = dst;
-
-	while (len--)
-		*d++ = *s++;
-
-	return dst;
+	return arm_memcpy_scalar(dst, src, len);
 }
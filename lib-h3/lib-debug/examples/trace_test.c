@@ -0,0 +1,293 @@
+/**
+ * @file trace_test.c
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Host test for src/trace.c (TRACE_CORES is 1 on the host).
+ *
+ * - wrap-around: many laps of the ring, a full ring drops and counts,
+ *   and the 32-bit head/tail counters wrapping
+ * - a claimed but unpublished slot stops the drain, also when the slot
+ *   still holds the sequence of the previous lap
+ * - concurrent writers (the threads stand in for interrupt handlers on
+ *   the same core) with a concurrent drain: every entry is either output,
+ *   in order per writer, or counted as dropped
+ *
+ * trace_drain() writes to stderr, which is captured in a temporary file.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "trace.h"
+
+#define WRITERS		4
+#define WRITER_ENTRIES	100000
+
+static unsigned s_errors;
+
+#define CHECK(cond, ...)	do { if (!(cond)) { if (s_errors++ < 10) { printf(__VA_ARGS__); } } } while (0)
+
+static FILE *s_pCapture;
+static int s_nStderr;
+
+static void capture_begin(void) {
+	fflush(stderr);
+	s_pCapture = tmpfile();
+	s_nStderr = dup(2);
+	dup2(fileno(s_pCapture), 2);
+}
+
+static void capture_end(void) {
+	fflush(stderr);
+	dup2(s_nStderr, 2);
+	close(s_nStderr);
+	rewind(s_pCapture);
+}
+
+static struct trace_ring *get_ring(void) {
+	uint32_t nSize;
+	return (struct trace_ring *) trace_get_rings(&nSize);
+}
+
+/*
+ * Drain everything and check the "w %u" entries continue from *pNext
+ */
+static uint32_t drain_sequential(uint32_t *pNext) {
+	char line[128];
+	uint32_t nLines = 0;
+
+	capture_begin();
+	const uint32_t nCount = trace_drain(UINT32_MAX);
+	capture_end();
+
+	while (fgets(line, sizeof(line), s_pCapture) != NULL) {
+		unsigned nCore, nValue;
+
+		if (sscanf(line, "%*u.%*u %u w %u", &nCore, &nValue) != 2) {
+			CHECK(0, "unexpected line: %s", line);
+			continue;
+		}
+
+		CHECK(nCore == 0, "core %u\n", nCore);
+		CHECK(nValue == *pNext, "expected %u, got %u\n", *pNext, nValue);
+		*pNext = nValue + 1;
+		nLines++;
+	}
+
+	fclose(s_pCapture);
+
+	CHECK(nCount == nLines, "drain returned %u, output %u lines\n", nCount, nLines);
+	return nLines;
+}
+
+static void test_wrap_around(void) {
+	uint32_t nWritten = 0;
+	uint32_t nNext = 0;
+	uint32_t i;
+
+	trace_init();
+
+	// 10 laps in batches that do not divide the ring
+	while (nWritten < 10 * TRACE_ENTRIES) {
+		for (i = 0; i < 100; i++) {
+			TRACE("w %u", nWritten++);
+		}
+		drain_sequential(&nNext);
+	}
+
+	CHECK(nNext == nWritten, "drained up to %u of %u\n", nNext, nWritten);
+	CHECK(trace_get_dropped() == 0, "dropped %u\n", trace_get_dropped());
+
+	// A full ring keeps the oldest entries
+	for (i = 0; i < TRACE_ENTRIES + 10; i++) {
+		TRACE("w %u", nWritten++);
+	}
+
+	CHECK(trace_get_dropped() == 10, "full ring dropped %u, expected 10\n", trace_get_dropped());
+	CHECK(drain_sequential(&nNext) == TRACE_ENTRIES, "full ring not drained\n");
+
+	// The 32-bit counters wrap
+	struct trace_ring *pRing = get_ring();
+	pRing->nHead = pRing->nTail = 0U - 100U;
+	nNext = nWritten;
+
+	for (i = 0; i < 3; i++) {
+		uint32_t j;
+		for (j = 0; j < 100; j++) {
+			TRACE("w %u", nWritten++);
+		}
+		drain_sequential(&nNext);
+	}
+
+	CHECK(nNext == nWritten, "counter wrap: drained up to %u of %u\n", nNext, nWritten);
+	CHECK(pRing->nHead == 200 && pRing->nTail == 200, "counter wrap: head %u tail %u\n", pRing->nHead, pRing->nTail);
+
+	printf("wrap-around: %u entries\n", nWritten);
+}
+
+static void test_unpublished(void) {
+	uint32_t nNext = 0;
+	uint32_t i;
+
+	trace_init();
+
+	// One lap, so every slot holds a sequence of the previous lap
+	for (i = 0; i < TRACE_ENTRIES; i++) {
+		TRACE("w %u", i);
+	}
+	drain_sequential(&nNext);
+
+	// A writer interrupted between claiming and publishing slot 0
+	struct trace_ring *pRing = get_ring();
+	const uint32_t nClaimed = pRing->nHead++;
+	struct trace_entry *pClaimed = &pRing->entry[nClaimed & (TRACE_ENTRIES - 1)];
+
+	TRACE("w %u", TRACE_ENTRIES + 1);
+
+	capture_begin();
+	const uint32_t nCount = trace_drain(UINT32_MAX);
+	capture_end();
+	fclose(s_pCapture);
+
+	CHECK(nCount == 0, "unpublished slot drained, %u entries\n", nCount);
+	CHECK(pRing->nTail == nClaimed, "tail moved past the unpublished slot\n");
+
+	// The writer completes
+	const struct trace_entry *pNext = &pRing->entry[(nClaimed + 1) & (TRACE_ENTRIES - 1)];
+	pClaimed->nFormat = pNext->nFormat;
+	pClaimed->nMicros = pNext->nMicros;
+	pClaimed->nArgs[0] = TRACE_ENTRIES;
+	__atomic_store_n(&pClaimed->nSequence, nClaimed + 1, __ATOMIC_RELEASE);
+
+	CHECK(drain_sequential(&nNext) == 2, "published slots not drained\n");
+	CHECK(nNext == TRACE_ENTRIES + 2, "expected up to %u, got %u\n", TRACE_ENTRIES + 2, nNext);
+
+	puts("unpublished: done");
+}
+
+static volatile int s_nWritersDone;
+
+static void *writer(void *pArg) {
+	const uint32_t nWriter = (uint32_t) (uintptr_t) pArg;
+	uint32_t i;
+
+	for (i = 0; i < WRITER_ENTRIES; i++) {
+		TRACE("t %u %u", nWriter, i);
+		// Give the drain a chance, otherwise the writers only fill and drop
+		if ((i & 15) == 15) {
+			sched_yield();
+		}
+	}
+
+	__atomic_fetch_add(&s_nWritersDone, 1, __ATOMIC_RELEASE);
+	return NULL;
+}
+
+static void *reader(void *pArg) {
+	uint32_t *pDrained = (uint32_t *) pArg;
+
+	for (;;) {
+		const int bDone = (__atomic_load_n(&s_nWritersDone, __ATOMIC_ACQUIRE) == WRITERS);
+		const uint32_t nCount = trace_drain(64);
+
+		*pDrained += nCount;
+
+		if (bDone && (nCount == 0)) {
+			break;
+		}
+	}
+
+	return NULL;
+}
+
+static void test_concurrent(void) {
+	pthread_t writers[WRITERS];
+	pthread_t drain;
+	uint32_t nDrained = 0;
+	uint32_t nNext[WRITERS] = { 0 };
+	uint32_t nLines = 0;
+	char line[128];
+	uintptr_t i;
+
+	trace_init();
+	s_nWritersDone = 0;
+
+	capture_begin();
+
+	pthread_create(&drain, NULL, reader, &nDrained);
+	for (i = 0; i < WRITERS; i++) {
+		pthread_create(&writers[i], NULL, writer, (void *) i);
+	}
+
+	for (i = 0; i < WRITERS; i++) {
+		pthread_join(writers[i], NULL);
+	}
+	pthread_join(drain, NULL);
+
+	capture_end();
+
+	while (fgets(line, sizeof(line), s_pCapture) != NULL) {
+		unsigned nWriter, nValue;
+
+		if ((sscanf(line, "%*u.%*u %*u t %u %u", &nWriter, &nValue) != 2) || (nWriter >= WRITERS)) {
+			CHECK(0, "torn or unexpected line: %s", line);
+			continue;
+		}
+
+		CHECK(nValue >= nNext[nWriter], "writer %u: %u after %u\n", nWriter, nValue, nNext[nWriter]);
+		nNext[nWriter] = nValue + 1;
+		nLines++;
+	}
+
+	fclose(s_pCapture);
+
+	const uint32_t nDropped = trace_get_dropped();
+	const struct trace_ring *pRing = get_ring();
+
+	CHECK(nLines == nDrained, "drain returned %u, output %u lines\n", nDrained, nLines);
+	CHECK(nLines + nDropped == WRITERS * WRITER_ENTRIES, "output %u + dropped %u != %u\n", nLines, nDropped, WRITERS * WRITER_ENTRIES);
+	CHECK(nLines > 0, "nothing drained\n");
+	CHECK(pRing->nHead == pRing->nTail, "head %u tail %u\n", pRing->nHead, pRing->nTail);
+
+	printf("concurrent: %u writers, %u output, %u dropped\n", WRITERS, nLines, nDropped);
+}
+
+int main(void) {
+	test_wrap_around();
+	test_unpublished();
+	test_concurrent();
+
+	if (s_errors != 0) {
+		printf("FAILED: %u errors\n", s_errors);
+		return 1;
+	}
+
+	puts("PASSED");
+	return 0;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file trace.h
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+/*
+ * Deferred binary logging.
+ *
+ * TRACE("format", a1, ...) stores the offset of the format string in the
+ * trace_fmt section, a micro seconds time stamp and up to TRACE_ARGS_MAX
+ * 32-bit integer arguments into a ring buffer of the calling core.
+ * The formatting is done later by trace_drain(), called from the main loop
+ * or from an idle core, or off-line by scripts/trace_decode.py from a dump
+ * of the rings and the firmware ELF.
+ *
+ * Arguments are copied as 32-bit integers, so %s, %p and floating point
+ * are not supported. A full ring drops the new entry and counts it.
+ *
+ * TRACE compiles to nothing unless ENABLE_TRACE is defined.
+ */
+
+#include <stdint.h>
+
+#define TRACE_ARGS_MAX	5
+#define TRACE_ENTRIES	256		///< Per core, must be a power of 2
+#define TRACE_MAGIC		0x43525454	///< "TTRC"
+
+#if defined (BARE_METAL) && defined (__ARM_ARCH_7A__)
+# define TRACE_CORES	4
+#else
+# define TRACE_CORES	1
+#endif
+
+struct trace_entry {
+	uint32_t nSequence;	///< Index of the entry + 1, written last
+	uint32_t nFormat;	///< Bits 0-23 offset in trace_fmt, bits 24-31 number of arguments
+	uint32_t nMicros;
+	uint32_t nArgs[TRACE_ARGS_MAX];
+};
+
+struct trace_ring {
+	uint32_t nMagic;
+	uint32_t nCore;
+	uint32_t nEntries;
+	uint32_t nEntrySize;
+	volatile uint32_t nHead;
+	volatile uint32_t nTail;
+	volatile uint32_t nDropped;
+	uint32_t nReserved;
+	struct trace_entry entry[TRACE_ENTRIES];
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern void trace_init(void);
+extern void trace_write(const char *pFormat, uint32_t nArgs, ...);
+/**
+ * Format and output at most nMax entries. Must be called from one core only.
+ * @return the number of entries written
+ */
+extern uint32_t trace_drain(uint32_t nMax);
+extern uint32_t trace_get_dropped(void);
+/**
+ * For a binary dump: TRACE_CORES consecutive struct trace_ring
+ */
+extern const struct trace_ring *trace_get_rings(uint32_t *pSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#if defined (ENABLE_TRACE)
+# define TRACE_NARGS_(f, a1, a2, a3, a4, a5, n, ...)	n
+# define TRACE_NARGS(...)	TRACE_NARGS_(__VA_ARGS__, 5, 4, 3, 2, 1, 0, 0)
+# define TRACE_FORMAT_(f, ...)	f
+# define TRACE_ARGS_(f, ...)	__VA_ARGS__
+# define TRACE(...) \
+	do { \
+		static const char s_trace_format[] __attribute__((section("trace_fmt"), used)) = TRACE_FORMAT_(__VA_ARGS__, 0); \
+		trace_write(s_trace_format, TRACE_NARGS(__VA_ARGS__), TRACE_ARGS_(__VA_ARGS__, 0)); \
+	} while (0)
+#else
+# define TRACE(...)	((void)0)
+#endif
+
+#endif /* TRACE_H_ */
@@ -0,0 +1,166 @@
+/**
+ * @file trace.c
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "trace.h"
+
+#if defined (H3)
+# include "h3.h"
+extern int uart0_printf(const char* fmt, ...);
+# define printf uart0_printf
+#elif defined (BARE_METAL)
+# include "bcm2835.h"
+#else
+# include <time.h>
+#endif
+
+extern const char __start_trace_fmt[] __attribute__((weak));
+
+static struct trace_ring s_trace_rings[TRACE_CORES];
+
+static inline uint32_t trace_get_core(void) {
+#if TRACE_CORES > 1
+	uint32_t mpidr;
+	asm volatile ("mrc p15, 0, %0, c0, c0, 5" : "=r" (mpidr));
+	return mpidr & (TRACE_CORES - 1);
+#else
+	return 0;
+#endif
+}
+
+static inline uint32_t trace_get_micros(void) {
+#if defined (H3)
+	return H3_TIMER->AVS_CNT1;
+#elif defined (BARE_METAL)
+	return BCM2835_ST->CLO;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t) ((uint64_t) ts.tv_sec * 1000000U + (uint64_t) ts.tv_nsec / 1000U);
+#endif
+}
+
+void trace_init(void) {
+	uint32_t i;
+
+	memset(s_trace_rings, 0, sizeof(s_trace_rings));
+
+	for (i = 0; i < TRACE_CORES; i++) {
+		s_trace_rings[i].nMagic = TRACE_MAGIC;
+		s_trace_rings[i].nCore = i;
+		s_trace_rings[i].nEntries = TRACE_ENTRIES;
+		s_trace_rings[i].nEntrySize = sizeof(struct trace_entry);
+	}
+}
+
+/*
+ * Lock free: the slot is claimed with a compare and swap on nHead, so an
+ * interrupt handler can trace on the same core. The drain only consumes
+ * an entry after its nSequence is published.
+ */
+void trace_write(const char *pFormat, uint32_t nArgs, ...) {
+	struct trace_ring *pRing = &s_trace_rings[trace_get_core()];
+	uint32_t nHead = __atomic_load_n(&pRing->nHead, __ATOMIC_RELAXED);
+
+	do {
+		if ((nHead - __atomic_load_n(&pRing->nTail, __ATOMIC_ACQUIRE)) >= TRACE_ENTRIES) {
+			__atomic_fetch_add(&pRing->nDropped, 1, __ATOMIC_RELAXED);
+			return;
+		}
+	} while (!__atomic_compare_exchange_n(&pRing->nHead, &nHead, nHead + 1, 1, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+	struct trace_entry *pEntry = &pRing->entry[nHead & (TRACE_ENTRIES - 1)];
+	va_list ap;
+	uint32_t i;
+
+	pEntry->nMicros = trace_get_micros();
+	pEntry->nFormat = ((uint32_t) (pFormat - __start_trace_fmt) & 0xFFFFFF) | (nArgs << 24);
+
+	va_start(ap, nArgs);
+
+	for (i = 0; i < nArgs; i++) {
+		pEntry->nArgs[i] = va_arg(ap, uint32_t);
+	}
+
+	va_end(ap);
+
+	__atomic_store_n(&pEntry->nSequence, nHead + 1, __ATOMIC_RELEASE);
+}
+
+uint32_t trace_drain(uint32_t nMax) {
+	uint32_t nCount = 0;
+	uint32_t nCore;
+
+	for (nCore = 0; nCore < TRACE_CORES; nCore++) {
+		struct trace_ring *pRing = &s_trace_rings[nCore];
+
+		while (nCount < nMax) {
+			const uint32_t nTail = pRing->nTail;
+			const struct trace_entry *pEntry = &pRing->entry[nTail & (TRACE_ENTRIES - 1)];
+
+			if (__atomic_load_n(&pEntry->nSequence, __ATOMIC_ACQUIRE) != (nTail + 1)) {
+				break;
+			}
+
+			const struct trace_entry entry = *pEntry;
+			__atomic_store_n(&pRing->nTail, nTail + 1, __ATOMIC_RELEASE);
+
+			const char *pFormat = &__start_trace_fmt[entry.nFormat & 0xFFFFFF];
+
+#if defined (__linux__) || defined (__CYGWIN__)
+			fprintf(stderr, "%u.%06u %u ", entry.nMicros / 1000000U, entry.nMicros % 1000000U, nCore);
+			fprintf(stderr, pFormat, entry.nArgs[0], entry.nArgs[1], entry.nArgs[2], entry.nArgs[3], entry.nArgs[4]);
+			fputc('\n', stderr);
+#else
+			printf("%u.%06u %u ", entry.nMicros / 1000000U, entry.nMicros % 1000000U, nCore);
+			printf(pFormat, entry.nArgs[0], entry.nArgs[1], entry.nArgs[2], entry.nArgs[3], entry.nArgs[4]);
+			printf("\n");
+#endif
+			nCount++;
+		}
+	}
+
+	return nCount;
+}
+
+uint32_t trace_get_dropped(void) {
+	uint32_t nDropped = 0;
+	uint32_t i;
+
+	for (i = 0; i < TRACE_CORES; i++) {
+		nDropped += s_trace_rings[i].nDropped;
+	}
+
+	return nDropped;
+}
+
+const struct trace_ring *trace_get_rings(uint32_t *pSize) {
+	*pSize = sizeof(s_trace_rings);
+	return s_trace_rings;
+}
@@ -0,0 +1,148 @@
+/**
+ * @file e131gateway.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * E1.31 gateway with multi-threaded receive.
+ *
+ * Usage: e131gateway <interface | ip address> [workers] [universes] [first universe]
+ *
+ * The universes are received by E131BridgeWorkers. The output counts the
+ * DMX frames per port and prints the frame rates once per second.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <atomic>
+
+#include "hardware.h"
+#include "networklinux.h"
+#include "ledblink.h"
+
+#include "e131bridgeworkers.h"
+
+#include "lightset.h"
+
+namespace gateway {
+static constexpr auto MAX_PORTS = e131bridgeworkers::MAX_WORKERS * E131_MAX_PORTS;
+}  // namespace gateway
+
+class FrameCounter: public LightSet {
+public:
+	void Start(__attribute__((unused)) uint8_t nPort) override {
+	}
+
+	void Stop(__attribute__((unused)) uint8_t nPort) override {
+	}
+
+	void SetData(uint8_t nPort, __attribute__((unused)) const uint8_t *pData, __attribute__((unused)) uint16_t nLength) override {
+		m_nFrames[nPort]++;
+	}
+
+	uint32_t GetFrames(uint32_t nPort) {
+		return m_nFrames[nPort].exchange(0);
+	}
+
+private:
+	std::atomic<uint32_t> m_nFrames[gateway::MAX_PORTS] {};
+};
+
+static volatile sig_atomic_t s_bKeepRunning = 1;
+
+static void sig_handler(__attribute__((unused)) int nSignal) {
+	s_bKeepRunning = 0;
+}
+
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s <interface | ip address> [workers] [universes] [first universe]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	const auto nWorkers = argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : 2;
+	auto nUniverses = argc > 3 ? static_cast<uint32_t>(atoi(argv[3])) : 4;
+	const auto nFirstUniverse = argc > 4 ? static_cast<uint16_t>(atoi(argv[4])) : 1;
+
+	if ((nWorkers == 0) || (nWorkers > e131bridgeworkers::MAX_WORKERS)) {
+		fprintf(stderr, "Workers must be 1 .. %d\n", e131bridgeworkers::MAX_WORKERS);
+		return EXIT_FAILURE;
+	}
+
+	signal(SIGINT, sig_handler);
+	signal(SIGTERM, sig_handler);
+
+	Hardware hw;
+	NetworkLinux nw;
+	LedBlink lb;
+
+	if (nw.Init(argv[1]) < 0) {
+		return EXIT_FAILURE;
+	}
+
+	// The workers receive E1.31; the superloop only serves the other services
+	nw.SetIdleTimeout(100);
+
+	FrameCounter counter;
+
+	E131BridgeWorkers workers(nWorkers);
+
+	if (nUniverses > workers.GetMaxPorts()) {
+		nUniverses = workers.GetMaxPorts();
+	}
+
+	workers.SetOutput(&counter);
+
+	for (uint32_t nPortIndex = 0; nPortIndex < nUniverses; nPortIndex++) {
+		workers.SetUniverse(static_cast<uint8_t>(nPortIndex), E131_OUTPUT_PORT, static_cast<uint16_t>(nFirstUniverse + nPortIndex));
+	}
+
+	nw.Print();
+	workers.Print();
+
+	workers.Start();
+
+	auto nPrintMillis = hw.Millis() + 1000;
+
+	while (s_bKeepRunning) {
+		nw.Poll();
+		workers.Run();
+		lb.Run();
+
+		if (hw.Millis() >= nPrintMillis) {
+			nPrintMillis += 1000;
+
+			for (uint32_t nPortIndex = 0; nPortIndex < nUniverses; nPortIndex++) {
+				printf("%u:%u ", nFirstUniverse + nPortIndex, counter.GetFrames(nPortIndex));
+			}
+
+			puts("");
+		}
+	}
+
+	workers.Stop();
+
+	return EXIT_SUCCESS;
+}
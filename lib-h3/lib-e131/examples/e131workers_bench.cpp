@@ -0,0 +1,220 @@
+/**
+ * @file e131workers_bench.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Scaling of E131BridgeWorkers with unicast sACN over the loopback interface.
+ *
+ * Each universe is sent from its own socket, so every universe is a separate
+ * flow for the SO_REUSEPORT hash. For 1, 2, 4 and 8 workers:
+ *
+ *  paced : 200 packets/s per universe, reports the share of packets that did
+ *          not reach the output (must be 0, the socket buffers do not overflow)
+ *  flood : as fast as possible, reports the output frame rate
+ *
+ * Usage: e131workers_bench [universes] [seconds]
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <atomic>
+#include <thread>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "hardware.h"
+#include "networklinux.h"
+#include "ledblink.h"
+
+#include "e131bridgeworkers.h"
+#include "e131packets.h"
+#include "e117const.h"
+
+#include "lightset.h"
+
+namespace bench {
+static constexpr auto MAX_UNIVERSES = 64;
+static constexpr auto PACED_RATE = 200;
+}  // namespace bench
+
+class FrameCounter: public LightSet {
+public:
+	void Start(__attribute__((unused)) uint8_t nPort) override {
+	}
+
+	void Stop(__attribute__((unused)) uint8_t nPort) override {
+	}
+
+	void SetData(__attribute__((unused)) uint8_t nPort, __attribute__((unused)) const uint8_t *pData, __attribute__((unused)) uint16_t nLength) override {
+		m_nFrames++;
+	}
+
+	uint64_t GetFrames() {
+		return m_nFrames.exchange(0);
+	}
+
+private:
+	std::atomic<uint64_t> m_nFrames { 0 };
+};
+
+static uint64_t now_ns() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static void build_packet(struct TE131DataPacket *pPacket, uint16_t nUniverse) {
+	memset(pPacket, 0, sizeof(struct TE131DataPacket));
+
+	pPacket->RootLayer.PreAmbleSize = __builtin_bswap16(0x0010);
+	memcpy(pPacket->RootLayer.ACNPacketIdentifier, E117Const::ACN_PACKET_IDENTIFIER, E117_PACKET_IDENTIFIER_LENGTH);
+	pPacket->RootLayer.FlagsLength = __builtin_bswap16(static_cast<uint16_t>((0x7 << 12) | (sizeof(struct TE131DataPacket) - 16)));
+	pPacket->RootLayer.Vector = __builtin_bswap32(E131_VECTOR_ROOT_DATA);
+	pPacket->RootLayer.Cid[0] = static_cast<uint8_t>(nUniverse);
+
+	pPacket->FrameLayer.FLagsLength = __builtin_bswap16(static_cast<uint16_t>((0x7 << 12) | (sizeof(struct TE131DataPacket) - 38)));
+	pPacket->FrameLayer.Vector = __builtin_bswap32(E131_VECTOR_DATA_PACKET);
+	strcpy(reinterpret_cast<char *>(pPacket->FrameLayer.SourceName), "e131workers_bench");
+	pPacket->FrameLayer.Priority = 100;
+	pPacket->FrameLayer.Universe = __builtin_bswap16(nUniverse);
+
+	pPacket->DMPLayer.FlagsLength = __builtin_bswap16(static_cast<uint16_t>((0x7 << 12) | (sizeof(struct TE131DataPacket) - 115)));
+	pPacket->DMPLayer.Vector = E131_VECTOR_DMP_SET_PROPERTY;
+	pPacket->DMPLayer.Type = 0xa1;
+	pPacket->DMPLayer.AddressIncrement = __builtin_bswap16(0x0001);
+	pPacket->DMPLayer.PropertyValueCount = __builtin_bswap16(E131_DMX_LENGTH + 1);
+}
+
+static uint64_t send_universes(uint32_t nUniverses, uint32_t nSeconds, uint32_t nRate) {
+	static struct TE131DataPacket packets[bench::MAX_UNIVERSES];
+	int nSockets[bench::MAX_UNIVERSES];
+
+	struct sockaddr_in si_to;
+	memset(&si_to, 0, sizeof(si_to));
+	si_to.sin_family = AF_INET;
+	si_to.sin_port = htons(E131_DEFAULT_PORT);
+	si_to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	for (uint32_t i = 0; i < nUniverses; i++) {
+		nSockets[i] = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		build_packet(&packets[i], static_cast<uint16_t>(1 + i));
+	}
+
+	const auto nEnd = now_ns() + nSeconds * 1000000000ULL;
+	const uint64_t nInterval = nRate == 0 ? 0 : 1000000000ULL / nRate;
+	auto nNext = now_ns();
+	uint64_t nSent = 0;
+	uint8_t nSequence = 0;
+
+	while (now_ns() < nEnd) {
+		if (nInterval != 0) {
+			nNext += nInterval;
+			struct timespec ts;
+			ts.tv_sec = static_cast<time_t>(nNext / 1000000000ULL);
+			ts.tv_nsec = static_cast<long>(nNext % 1000000000ULL);
+			clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+		}
+
+		nSequence++;
+
+		for (uint32_t i = 0; i < nUniverses; i++) {
+			packets[i].FrameLayer.SequenceNumber = nSequence;
+			// The output is only updated when the data changes
+			packets[i].DMPLayer.PropertyValues[1] = nSequence;
+
+			if (sendto(nSockets[i], &packets[i], sizeof(struct TE131DataPacket), 0, reinterpret_cast<struct sockaddr*>(&si_to), sizeof(si_to)) > 0) {
+				nSent++;
+			}
+		}
+	}
+
+	for (uint32_t i = 0; i < nUniverses; i++) {
+		close(nSockets[i]);
+	}
+
+	return nSent;
+}
+
+static void run(FrameCounter& counter, uint32_t nWorkers, uint32_t nUniverses, uint32_t nSeconds) {
+	E131BridgeWorkers workers(nWorkers);
+
+	workers.SetOutput(&counter);
+
+	for (uint32_t nPortIndex = 0; nPortIndex < nUniverses; nPortIndex++) {
+		workers.SetUniverse(static_cast<uint8_t>(nPortIndex), E131_OUTPUT_PORT, static_cast<uint16_t>(1 + nPortIndex));
+	}
+
+	workers.Start();
+
+	counter.GetFrames();
+	const auto nSentPaced = send_universes(nUniverses, nSeconds, bench::PACED_RATE);
+	usleep(100000);
+	const auto nFramesPaced = counter.GetFrames();
+
+	const auto nStart = now_ns();
+	send_universes(nUniverses, nSeconds, 0);
+	const auto nFramesFlood = counter.GetFrames();
+	const auto nElapsed = now_ns() - nStart;
+
+	workers.Stop();
+
+	printf("workers %u  paced: sent %7llu output %7llu lost %5.1f%%  flood: %9.0f frames/s\n",
+			nWorkers,
+			static_cast<unsigned long long>(nSentPaced),
+			static_cast<unsigned long long>(nFramesPaced),
+			nSentPaced == 0 ? 0.0 : 100.0 * static_cast<double>(nSentPaced - std::min(nSentPaced, nFramesPaced)) / static_cast<double>(nSentPaced),
+			static_cast<double>(nFramesFlood) * 1e9 / static_cast<double>(nElapsed));
+}
+
+int main(int argc, char **argv) {
+	auto nUniverses = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 16;
+	const auto nSeconds = argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : 2;
+
+	if (nUniverses > bench::MAX_UNIVERSES) {
+		nUniverses = bench::MAX_UNIVERSES;
+	}
+
+	Hardware hw;
+	NetworkLinux nw;
+	LedBlink lb;
+
+	if (nw.Init("lo") < 0) {
+		return EXIT_FAILURE;
+	}
+
+	FrameCounter counter;
+
+	printf("%u unicast universes, %u s per run, %u CPUs\n", nUniverses, nSeconds, std::thread::hardware_concurrency());
+
+	for (uint32_t nWorkers = 1; nWorkers <= e131bridgeworkers::MAX_WORKERS; nWorkers *= 2) {
+		run(counter, nWorkers, nUniverses, nSeconds);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,225 @@
+/**
+ * @file e131workers_sync_test.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * E131BridgeWorkers with universe synchronization over unicast.
+ *
+ * The ports are spread over 2 workers. Data packets with a synchronization
+ * address are held until the synchronization packet, which is sent once, to
+ * one socket of the SO_REUSEPORT group. All ports, of both workers, must be
+ * output after it. The shared LED must follow the data from the superloop.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "hardware.h"
+#include "networklinux.h"
+#include "ledblink.h"
+
+#include "e131bridgeworkers.h"
+#include "e131packets.h"
+#include "e117const.h"
+
+#include "lightset.h"
+
+namespace test {
+static constexpr auto WORKERS = 2;
+static constexpr auto PORTS = 4;
+static constexpr uint16_t UNIVERSE_FIRST = 1;
+static constexpr uint16_t SYNCHRONIZATION_ADDRESS = 100;
+static constexpr useconds_t SETTLE_MICROS = 50000;
+}  // namespace test
+
+class FrameCounter: public LightSet {
+public:
+	void Start(__attribute__((unused)) uint8_t nPort) override {
+	}
+
+	void Stop(__attribute__((unused)) uint8_t nPort) override {
+	}
+
+	void SetData(uint8_t nPort, __attribute__((unused)) const uint8_t *pData, __attribute__((unused)) uint16_t nLength) override {
+		if (nPort < test::PORTS) {
+			m_nFrames[nPort]++;
+		}
+	}
+
+	uint32_t GetFrames(uint32_t nPort) {
+		return m_nFrames[nPort];
+	}
+
+private:
+	std::atomic<uint32_t> m_nFrames[test::PORTS] {};
+};
+
+static void build_root(struct TRootLayer *pRootLayer, uint32_t nVector, uint32_t nSize) {
+	pRootLayer->PreAmbleSize = __builtin_bswap16(0x0010);
+	memcpy(pRootLayer->ACNPacketIdentifier, E117Const::ACN_PACKET_IDENTIFIER, E117_PACKET_IDENTIFIER_LENGTH);
+	pRootLayer->FlagsLength = __builtin_bswap16(static_cast<uint16_t>((0x7 << 12) | (nSize - 16)));
+	pRootLayer->Vector = __builtin_bswap32(nVector);
+	pRootLayer->Cid[0] = 0x5a;
+}
+
+static void build_data(struct TE131DataPacket *pPacket, uint16_t nUniverse, uint8_t nSequence) {
+	memset(pPacket, 0, sizeof(struct TE131DataPacket));
+
+	build_root(&pPacket->RootLayer, E131_VECTOR_ROOT_DATA, sizeof(struct TE131DataPacket));
+
+	pPacket->FrameLayer.FLagsLength = __builtin_bswap16(static_cast<uint16_t>((0x7 << 12) | (sizeof(struct TE131DataPacket) - 38)));
+	pPacket->FrameLayer.Vector = __builtin_bswap32(E131_VECTOR_DATA_PACKET);
+	strcpy(reinterpret_cast<char *>(pPacket->FrameLayer.SourceName), "e131workers_sync_test");
+	pPacket->FrameLayer.Priority = 100;
+	pPacket->FrameLayer.SynchronizationAddress = __builtin_bswap16(test::SYNCHRONIZATION_ADDRESS);
+	pPacket->FrameLayer.SequenceNumber = nSequence;
+	pPacket->FrameLayer.Universe = __builtin_bswap16(nUniverse);
+
+	pPacket->DMPLayer.FlagsLength = __builtin_bswap16(static_cast<uint16_t>((0x7 << 12) | (sizeof(struct TE131DataPacket) - 115)));
+	pPacket->DMPLayer.Vector = E131_VECTOR_DMP_SET_PROPERTY;
+	pPacket->DMPLayer.Type = 0xa1;
+	pPacket->DMPLayer.AddressIncrement = __builtin_bswap16(0x0001);
+	pPacket->DMPLayer.PropertyValueCount = __builtin_bswap16(E131_DMX_LENGTH + 1);
+	pPacket->DMPLayer.PropertyValues[1] = nSequence;
+}
+
+static void build_sync(struct TE131SynchronizationPacket *pPacket, uint8_t nSequence) {
+	memset(pPacket, 0, sizeof(struct TE131SynchronizationPacket));
+
+	build_root(&pPacket->RootLayer, E131_VECTOR_ROOT_EXTENDED, sizeof(struct TE131SynchronizationPacket));
+
+	pPacket->FrameLayer.FLagsLength = __builtin_bswap16(static_cast<uint16_t>((0x7 << 12) | (sizeof(struct TE131SynchronizationPacket) - 38)));
+	pPacket->FrameLayer.Vector = __builtin_bswap32(E131_VECTOR_EXTENDED_SYNCHRONIZATION);
+	pPacket->FrameLayer.SequenceNumber = nSequence;
+	pPacket->FrameLayer.UniverseNumber = __builtin_bswap16(test::SYNCHRONIZATION_ADDRESS);
+}
+
+static uint32_t count_output(FrameCounter& counter, const uint32_t *pBefore) {
+	uint32_t nPorts = 0;
+
+	for (uint32_t nPort = 0; nPort < test::PORTS; nPort++) {
+		if (counter.GetFrames(nPort) != pBefore[nPort]) {
+			nPorts++;
+		}
+	}
+
+	return nPorts;
+}
+
+int main() {
+	Hardware hw;
+	NetworkLinux nw;
+	LedBlink lb;
+
+	if (nw.Init("lo") < 0) {
+		return EXIT_FAILURE;
+	}
+
+	FrameCounter counter;
+	E131BridgeWorkers workers(test::WORKERS);
+
+	workers.SetOutput(&counter);
+
+	for (uint32_t nPort = 0; nPort < test::PORTS; nPort++) {
+		workers.SetUniverse(static_cast<uint8_t>(nPort), E131_OUTPUT_PORT, static_cast<uint16_t>(test::UNIVERSE_FIRST + nPort));
+	}
+
+	workers.Start();
+
+	const auto nSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+	struct sockaddr_in si_to;
+	memset(&si_to, 0, sizeof(si_to));
+	si_to.sin_family = AF_INET;
+	si_to.sin_port = htons(E131_DEFAULT_PORT);
+	si_to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	uint32_t nErrors = 0;
+
+	for (uint8_t nSequence = 1; nSequence <= 3; nSequence++) {
+		uint32_t before[test::PORTS];
+
+		for (uint32_t nPort = 0; nPort < test::PORTS; nPort++) {
+			before[nPort] = counter.GetFrames(nPort);
+
+			struct TE131DataPacket packet;
+			build_data(&packet, static_cast<uint16_t>(test::UNIVERSE_FIRST + nPort), nSequence);
+			sendto(nSocket, &packet, sizeof(packet), 0, reinterpret_cast<struct sockaddr*>(&si_to), sizeof(si_to));
+		}
+
+		usleep(test::SETTLE_MICROS);
+
+		auto nPorts = count_output(counter, before);
+
+		if (nPorts != 0) {
+			printf("sequence %u: %u ports output before the synchronization packet\n", nSequence, nPorts);
+			nErrors++;
+		}
+
+		struct TE131SynchronizationPacket sync;
+		build_sync(&sync, nSequence);
+		sendto(nSocket, &sync, sizeof(sync), 0, reinterpret_cast<struct sockaddr*>(&si_to), sizeof(si_to));
+
+		usleep(test::SETTLE_MICROS);
+
+		nPorts = count_output(counter, before);
+
+		if (nPorts != test::PORTS) {
+			printf("sequence %u: %u of %u ports output after the synchronization packet\n", nSequence, nPorts, test::PORTS);
+			nErrors++;
+		}
+
+		workers.Run();
+
+		if (lb.GetMode() != ledblink::Mode::DATA) {
+			printf("sequence %u: LED mode %d, receiving data\n", nSequence, static_cast<int>(lb.GetMode()));
+			nErrors++;
+		}
+	}
+
+	close(nSocket);
+
+	workers.Stop();
+
+	if (lb.GetMode() != ledblink::Mode::OFF_OFF) {
+		printf("LED mode %d, stopped\n", static_cast<int>(lb.GetMode()));
+		nErrors++;
+	}
+
+	if (nErrors != 0) {
+		printf("FAILED: %u errors\n", nErrors);
+		return EXIT_FAILURE;
+	}
+
+	puts("workers sync: PASSED");
+
+	return EXIT_SUCCESS;
+}
@@ -27,12 +27,15 @@
 #define E131BRIDGE_H_
 
 #include <stdint.h>
+#include <stddef.h>
 #include <assert.h>
 
 #include "e131.h"
 #include "e131packets.h"
 
 #include "lightset.h"
+#include "cachelinealigned.h"
+#include "network.h"
 
 // Handlers
 #include "e131dmx.h"
@@ -67,20 +70,30 @@ struct TE131BridgeState {
 struct TSource {
 	uint32_t time;
 	uint32_t ip;
-	uint8_t data[E131_DMX_LENGTH];
 	uint8_t cid[E131_CID_LENGTH];
 	uint8_t sequenceNumberData;
 };
 
-struct TE131OutputPort {
+/**
+ * Slot buffers, cache line aligned and only allocated for enabled output ports
+ */
+struct TE131OutputPortBuffer: public CacheLineAligned {
 	uint8_t data[E131_DMX_LENGTH];
-	uint16_t length;
+	uint8_t dataA[E131_DMX_LENGTH];		///< Source A
+	uint8_t dataB[E131_DMX_LENGTH];		///< Source B
+};
+
+struct TE131OutputPort {
 	uint16_t nUniverse;
+	uint16_t length;
+	uint16_t nDirtyFirst;
+	uint16_t nDirtyEnd;
 	E131Merge mergeMode;
 	bool IsDataPending;
 	bool bIsEnabled;
 	bool IsTransmitting;
 	bool IsMerging;
+	struct TE131OutputPortBuffer *pBuffer;	///< nullptr until the port is enabled
 	struct TSource sourceA;
 	struct TSource sourceB;
 };
@@ -94,10 +107,13 @@ struct TE131InputPort {
 	uint32_t nMulticastIp;
 };
 
-class E131Bridge {
+class E131Bridge: public NetworkIpObserver {
 public:
-	E131Bridge();
-	~E131Bridge();
+	/**
+	 * @param nHandle A network handle already bound to the E1.31 port, -1 is Network::Begin
+	 */
+	explicit E131Bridge(int32_t nHandle = -1);
+	~E131Bridge() override;
 
 	void SetOutput(LightSet *pLightSet) {
 		m_pLightSet = pLightSet;
@@ -142,6 +158,9 @@ public:
 		return m_State.bDisableMergeTimeout;
 	}
 
+	/**
+	 * When disabled the bridge does not touch the LED, IsReceivingDmx() tells the state
+	 */
 	void SetEnableDataIndicator(bool bEnable = true) {
 		m_bEnableDataIndicator = bEnable;
 	}
@@ -149,6 +168,10 @@ public:
 		return m_bEnableDataIndicator;
 	}
 
+	bool IsReceivingDmx() const {
+		return m_State.bIsReceivingDmx;
+	}
+
 	void SetDisableSynchronize(bool bDisableSynchronize = false) {
 		m_State.bDisableSynchronize = bDisableSynchronize;
 	}
@@ -191,6 +214,8 @@ public:
 
 	void Run();
 
+	void IpChanged() override;
+
 	void Print();
 
 	static E131Bridge* Get() {
@@ -210,6 +235,8 @@ private:
 	bool isIpCidMatch(const struct TSource *);
 	bool IsDmxDataChanged(uint8_t nPortIndex, const uint8_t *pData, uint16_t nLength);
 	bool IsMergedDmxDataChanged(uint8_t nPortIndex, const uint8_t *pData, uint16_t nLength);
+	void SetDirty(uint8_t nPortIndex, uint32_t nFirst, uint32_t nEnd);
+	void SendData(uint8_t nPortIndex);
 
 	void HandleDmx();
 	void HandleSynchronization();
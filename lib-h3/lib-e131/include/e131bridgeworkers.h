@@ -0,0 +1,137 @@
+/**
+ * @file e131bridgeworkers.h
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef E131BRIDGEWORKERS_H_
+#define E131BRIDGEWORKERS_H_
+
+#if !defined (__linux__)
+# error This is Linux only
+#endif
+
+#include <stdint.h>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+#include "e131.h"
+#include "e131bridge.h"
+
+#include "lightset.h"
+
+namespace e131bridgeworkers {
+static constexpr auto MAX_WORKERS = 8;
+static constexpr auto RECV_TIMEOUT_MILLIS = 10;
+}  // namespace e131bridgeworkers
+
+/**
+ * Multi-threaded E1.31 receive.
+ *
+ * The output ports are sharded over N workers, port n is handled by worker (n % N).
+ * Each worker has its own E131Bridge (with its own merge and synchronization state)
+ * and its own SO_REUSEPORT socket, which only joins the multicast groups of its universes.
+ * Unicast data packets are steered by universe to the socket of the owning worker.
+ * Unicast synchronization packets are steered to a forwarder socket, which copies
+ * them to each worker that owns a port (multicast ones reach those workers directly).
+ * All workers feed the same LightSet, calls into it are serialized. A frame
+ * (BeginFrame() .. CommitFrame()) holds the output for its whole duration.
+ * The LED is shared, it is set by Run() from the superloop.
+ */
+class E131BridgeWorkers {
+public:
+	explicit E131BridgeWorkers(uint32_t nWorkers);
+	~E131BridgeWorkers();
+
+	void SetOutput(LightSet *pLightSet);
+
+	void SetUniverse(uint8_t nPortIndex, TE131PortDir dir, uint16_t nUniverse);
+	bool GetUniverse(uint8_t nPortIndex, uint16_t &nUniverse) const;
+
+	void SetMergeMode(uint8_t nPortIndex, E131Merge tE131Merge);
+	void SetDirectUpdate(bool bDirectUpdate);
+	void SetDisableSynchronize(bool bDisableSynchronize);
+
+	uint32_t GetWorkers() const {
+		return m_nWorkers;
+	}
+
+	uint32_t GetMaxPorts() const {
+		return m_nWorkers * E131_MAX_PORTS;
+	}
+
+	void Start();
+	void Stop();
+
+	/**
+	 * Called from the superloop
+	 */
+	void Run();
+
+	void Print();
+
+private:
+	class Output: public LightSet {
+	public:
+		Output(E131BridgeWorkers *pWorkers, uint32_t nWorker) : LightSet(Forward()), m_pWorkers(pWorkers), m_nWorker(nWorker) {
+		}
+
+		void Start(uint8_t nPort) override;
+		void Stop(uint8_t nPort) override;
+		void SetData(uint8_t nPort, const uint8_t *pData, uint16_t nLength) override;
+		void SetDataRange(uint8_t nPort, const uint8_t *pData, uint16_t nLength, uint16_t nFirst, uint16_t nEnd) override;
+		void BeginFrame() override;
+		void CommitFrame() override;
+
+	private:
+		uint8_t ToPortIndex(uint8_t nPort) const {
+			return static_cast<uint8_t>(nPort * m_pWorkers->m_nWorkers + m_nWorker);
+		}
+
+		E131BridgeWorkers *m_pWorkers;
+		uint32_t m_nWorker;
+	};
+
+	struct Worker {
+		int32_t nHandle;
+		E131Bridge *pE131Bridge;
+		Output *pOutput;
+		std::thread thread;
+		std::atomic<bool> bIsReceivingDmx { false };
+	};
+
+	void RunWorker(uint32_t nWorker);
+	void RunSyncForwarder();
+	void SetUnicastSteering();
+
+	uint32_t m_nWorkers;
+	Worker m_Workers[e131bridgeworkers::MAX_WORKERS];
+	int32_t m_nSyncHandle { -1 };
+	uint32_t m_nSyncWorkers { 0 };	///< Bit mask of the workers owning a port
+	std::thread m_SyncThread;
+	LightSet *m_pLightSet { nullptr };
+	std::recursive_mutex m_LightSetMutex;
+	std::atomic<bool> m_bRunning { false };
+};
+
+#endif /* E131BRIDGEWORKERS_H_ */
@@ -43,16 +43,21 @@
 #include "ledblink.h"
 
 #include "debug.h"
+#include "trace.h"
 
 E131Bridge *E131Bridge::s_pThis = nullptr;
 
-E131Bridge::E131Bridge() {
+E131Bridge::E131Bridge(int32_t nHandle) {
 	assert(Hardware::Get() != nullptr);
 	assert(Network::Get() != nullptr);
 	assert(LedBlink::Get() != nullptr);
 
-	assert(s_pThis == nullptr);
-	s_pThis = this;
+	// Only the receive workers (with their own handle) can have more instances
+	assert((s_pThis == nullptr) || (nHandle != -1));
+
+	if (s_pThis == nullptr) {
+		s_pThis = this;
+	}
 
 	for (uint32_t i = 0; i < E131_MAX_PORTS; i++) {
 		memset(&m_OutputPort[i], 0, sizeof(struct TE131OutputPort));
@@ -73,7 +78,12 @@ E131Bridge::E131Bridge() {
 	snprintf(aSourceName, E131_SOURCE_NAME_LENGTH, "%.48s %s", Network::Get()->GetHostName(), Hardware::Get()->GetBoardName(nLength));
 	SetSourceName(aSourceName);
 
-	m_nHandle = Network::Get()->Begin(E131_DEFAULT_PORT); 	// This must be here (and not in Start) for Mac OS and Linux
+	if (nHandle == -1) {
+		m_nHandle = Network::Get()->Begin(E131_DEFAULT_PORT); 	// This must be here (and not in Start) for Mac OS and Linux
+		Network::Get()->AddIpObserver(this);
+	} else {
+		m_nHandle = nHandle;
+	}
 	assert(m_nHandle != -1);								// ToDO Rewrite SetUniverse
 
 	E131Uuid e131UUID;
@@ -82,6 +92,14 @@ E131Bridge::E131Bridge() {
 
 E131Bridge::~E131Bridge() {
 	Stop();
+
+	Network::Get()->RemoveIpObserver(this);
+
+	for (uint32_t i = 0; i < E131_MAX_PORTS; i++) {
+		if (m_OutputPort[i].pBuffer != nullptr) {
+			delete m_OutputPort[i].pBuffer;
+		}
+	}
 }
 
 void E131Bridge::Start() {
@@ -106,7 +124,9 @@ void E131Bridge::Start() {
 		}
 	}
 
-	LedBlink::Get()->SetMode(ledblink::Mode::NORMAL);
+	if (m_bEnableDataIndicator) {
+		LedBlink::Get()->SetMode(ledblink::Mode::NORMAL);
+	}
 }
 
 void E131Bridge::Stop() {
@@ -128,7 +148,9 @@ void E131Bridge::Stop() {
 		}
 	}
 
-	LedBlink::Get()->SetMode(ledblink::Mode::OFF_OFF);
+	if (m_bEnableDataIndicator) {
+		LedBlink::Get()->SetMode(ledblink::Mode::OFF_OFF);
+	}
 }
 
 void E131Bridge::SetSourceName(const char *pSourceName) {
@@ -266,6 +288,12 @@ void E131Bridge::SetUniverse(uint8_t nPortIndex, TE131PortDir dir, uint16_t nUni
 		m_State.nActiveOutputPorts = m_State.nActiveOutputPorts + 1;
 		assert(m_State.nActiveOutputPorts <= E131_MAX_PORTS);
 		m_OutputPort[nPortIndex].bIsEnabled = true;
+
+		if (m_OutputPort[nPortIndex].pBuffer == nullptr) {
+			m_OutputPort[nPortIndex].pBuffer = new TE131OutputPortBuffer;
+			assert(m_OutputPort[nPortIndex].pBuffer != nullptr);
+			memset(m_OutputPort[nPortIndex].pBuffer, 0, sizeof(struct TE131OutputPortBuffer));
+		}
 	}
 
 	Network::Get()->JoinGroup(m_nHandle, UniverseToMulticastIp(nUniverse));
@@ -303,6 +331,28 @@ E131Merge E131Bridge::GetMergeMode(uint8_t nPortIndex) const {
 	return m_OutputPort[nPortIndex].mergeMode;
 }
 
+void E131Bridge::SetDirty(uint8_t nPortIndex, uint32_t nFirst, uint32_t nEnd) {
+	auto &port = m_OutputPort[nPortIndex];
+
+	if (port.nDirtyFirst >= port.nDirtyEnd) {
+		port.nDirtyFirst = static_cast<uint16_t>(nFirst);
+		port.nDirtyEnd = static_cast<uint16_t>(nEnd);
+		return;
+	}
+
+	port.nDirtyFirst = static_cast<uint16_t>(std::min(nFirst, static_cast<uint32_t>(port.nDirtyFirst)));
+	port.nDirtyEnd = static_cast<uint16_t>(std::max(nEnd, static_cast<uint32_t>(port.nDirtyEnd)));
+}
+
+void E131Bridge::SendData(uint8_t nPortIndex) {
+	auto &port = m_OutputPort[nPortIndex];
+
+	m_pLightSet->SetDataRange(nPortIndex, port.pBuffer->data, port.length, port.nDirtyFirst, port.nDirtyEnd);
+
+	port.nDirtyFirst = 0;
+	port.nDirtyEnd = 0;
+}
+
 bool E131Bridge::IsDmxDataChanged(uint8_t nPortIndex, const uint8_t *pData, uint16_t nLength) {
 	assert(nPortIndex < E131_MAX_PORTS);
 	assert(pData != nullptr);
@@ -310,25 +360,37 @@ bool E131Bridge::IsDmxDataChanged(uint8_t nPortIndex, const uint8_t *pData, uint
 	bool isChanged = false;
 
 	const uint8_t *pSrc = pData;
-	uint8_t *pDst = m_OutputPort[nPortIndex].data;
+	uint8_t *pDst = m_OutputPort[nPortIndex].pBuffer->data;
 
 	if (nLength != m_OutputPort[nPortIndex].length) {
 		m_OutputPort[nPortIndex].length = nLength;
 		for (unsigned i = 0 ; i < E131_DMX_LENGTH; i++) {
 			*pDst++ = *pSrc++;
 		}
+		SetDirty(nPortIndex, 0, nLength);
 		return true;
 	}
 
+	uint32_t nFirst = 0;
+	uint32_t nLast = 0;
+
 	for (unsigned i = 0; i < E131_DMX_LENGTH; i++) {
 		if (*pDst != *pSrc) {
 			*pDst = *pSrc;
-			isChanged = true;
+			if (!isChanged) {
+				nFirst = i;
+				isChanged = true;
+			}
+			nLast = i;
 		}
 		pDst++;
 		pSrc++;
 	}
 
+	if (isChanged) {
+		SetDirty(nPortIndex, nFirst, nLast + 1);
+	}
+
 	return isChanged;
 }
 
@@ -346,24 +408,37 @@ bool E131Bridge::IsMergedDmxDataChanged(uint8_t nPortIndex, const uint8_t *pData
 	m_OutputPort[nPortIndex].IsMerging = true;
 
 	if (m_OutputPort[nPortIndex].mergeMode == E131Merge::HTP) {
+		auto *pBuffer = m_OutputPort[nPortIndex].pBuffer;
 
 		if (nLength != m_OutputPort[nPortIndex].length) {
 			m_OutputPort[nPortIndex].length = nLength;
 			for (unsigned i = 0; i < nLength; i++) {
-				uint8_t data = std::max(m_OutputPort[nPortIndex].sourceA.data[i], m_OutputPort[nPortIndex].sourceB.data[i]);
-				m_OutputPort[nPortIndex].data[i] = data;
+				uint8_t data = std::max(pBuffer->dataA[i], pBuffer->dataB[i]);
+				pBuffer->data[i] = data;
 			}
+			SetDirty(nPortIndex, 0, nLength);
 			return true;
 		}
 
+		uint32_t nFirst = 0;
+		uint32_t nLast = 0;
+
 		for (unsigned i = 0; i < nLength; i++) {
-			uint8_t data = std::max(m_OutputPort[nPortIndex].sourceA.data[i], m_OutputPort[nPortIndex].sourceB.data[i]);
-			if (data != m_OutputPort[nPortIndex].data[i]) {
-				m_OutputPort[nPortIndex].data[i] = data;
-				isChanged = true;
+			uint8_t data = std::max(pBuffer->dataA[i], pBuffer->dataB[i]);
+			if (data != pBuffer->data[i]) {
+				pBuffer->data[i] = data;
+				if (!isChanged) {
+					nFirst = i;
+					isChanged = true;
+				}
+				nLast = i;
 			}
 		}
 
+		if (isChanged) {
+			SetDirty(nPortIndex, nFirst, nLast + 1);
+		}
+
 		return isChanged;
 	} else {
 		return IsDmxDataChanged(nPortIndex, pData, nLength);
@@ -458,6 +533,7 @@ void E131Bridge::HandleDmx() {
 
 		struct TSource *pSourceA = &m_OutputPort[i].sourceA;
 		struct TSource *pSourceB = &m_OutputPort[i].sourceB;
+		auto *pBuffer = m_OutputPort[i].pBuffer;
 
 		const uint32_t ipA = pSourceA->ip;
 		const uint32_t ipB = pSourceB->ip;
@@ -519,59 +595,59 @@ void E131Bridge::HandleDmx() {
 		}
 
 		if ((ipA == 0) && (ipB == 0)) {
-			//printf("1. First package from Source\n");
+			TRACE("e131: port %u 1. First package from Source", i);
 			pSourceA->ip = m_E131.IPAddressFrom;
 			pSourceA->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
 			memcpy(pSourceA->cid, m_E131.E131Packet.Data.RootLayer.Cid, 16);
 			pSourceA->time = m_nCurrentPacketMillis;
-			memcpy(pSourceA->data, p, slots);
+			memcpy(pBuffer->dataA, p, slots);
 			sendNewData = IsDmxDataChanged(i, p, slots);
 
 		} else if (isSourceA && (ipB == 0)) {
-			//printf("2. Continue package from SourceA\n");
+			TRACE("e131: port %u 2. Continue package from SourceA", i);
 			pSourceA->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
 			pSourceA->time = m_nCurrentPacketMillis;
-			memcpy(pSourceA->data, p, slots);
+			memcpy(pBuffer->dataA, p, slots);
 			sendNewData = IsDmxDataChanged(i, p, slots);
 
 		} else if ((ipA == 0) && isSourceB) {
-			//printf("3. Continue package from SourceB\n");
+			TRACE("e131: port %u 3. Continue package from SourceB", i);
 			pSourceB->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
 			pSourceB->time = m_nCurrentPacketMillis;
-			memcpy(pSourceB->data, p, slots);
+			memcpy(pBuffer->dataB, p, slots);
 			sendNewData = IsDmxDataChanged(i, p, slots);
 
 		} else if (!isSourceA && (ipB == 0)) {
-			//printf("4. New ip, start merging\n");
+			TRACE("e131: port %u 4. New ip, start merging", i);
 			pSourceB->ip = m_E131.IPAddressFrom;
 			pSourceB->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
 			memcpy(pSourceB->cid, m_E131.E131Packet.Data.RootLayer.Cid, 16);
 			pSourceB->time = m_nCurrentPacketMillis;
-			memcpy(pSourceB->data, p, slots);
-			sendNewData = IsMergedDmxDataChanged(i, pSourceB->data, slots);
+			memcpy(pBuffer->dataB, p, slots);
+			sendNewData = IsMergedDmxDataChanged(i, pBuffer->dataB, slots);
 
 		} else if ((ipA == 0) && !isSourceB) {
-			//printf("5. New ip, start merging\n");
+			TRACE("e131: port %u 5. New ip, start merging", i);
 			pSourceA->ip = m_E131.IPAddressFrom;
 			pSourceA->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
 			memcpy(pSourceA->cid, m_E131.E131Packet.Data.RootLayer.Cid, 16);
 			pSourceA->time = m_nCurrentPacketMillis;
-			memcpy(pSourceA->data, p, slots);
-			sendNewData = IsMergedDmxDataChanged(i, pSourceA->data, slots);
+			memcpy(pBuffer->dataA, p, slots);
+			sendNewData = IsMergedDmxDataChanged(i, pBuffer->dataA, slots);
 
 		} else if (isSourceA && !isSourceB) {
-			//printf("6. Continue merging\n");
+			TRACE("e131: port %u 6. Continue merging", i);
 			pSourceA->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
 			pSourceA->time = m_nCurrentPacketMillis;
-			memcpy(pSourceA->data, p, slots);
-			sendNewData = IsMergedDmxDataChanged(i, pSourceA->data, slots);
+			memcpy(pBuffer->dataA, p, slots);
+			sendNewData = IsMergedDmxDataChanged(i, pBuffer->dataA, slots);
 
 		} else if (!isSourceA && isSourceB) {
-			//printf("7. Continue merging\n");
+			TRACE("e131: port %u 7. Continue merging", i);
 			pSourceB->sequenceNumberData = m_E131.E131Packet.Data.FrameLayer.SequenceNumber;
 			pSourceB->time = m_nCurrentPacketMillis;
-			memcpy(pSourceB->data, p, slots);
-			sendNewData = IsMergedDmxDataChanged(i, pSourceB->data, slots);
+			memcpy(pBuffer->dataB, p, slots);
+			sendNewData = IsMergedDmxDataChanged(i, pBuffer->dataB, slots);
 
 		} else if (isSourceA && isSourceB) {
 			printf("8. Source matches both buffers, this shouldn't be happening!\n");
@@ -618,7 +694,7 @@ void E131Bridge::HandleDmx() {
 		if (sendNewData || m_bDirectUpdate) {
 			if ((!m_State.IsSynchronized) || (m_State.bDisableSynchronize)) {
 
-				m_pLightSet->SetData(i, m_OutputPort[i].data, m_OutputPort[i].length);
+				SendData(i);
 
 				if (!m_OutputPort[i].IsTransmitting) {
 					m_pLightSet->Start(i);
@@ -646,17 +722,21 @@ void E131Bridge::HandleSynchronization() {
 	const uint16_t nSynchronizationAddress = __builtin_bswap16(m_E131.E131Packet.Synchronization.FrameLayer.UniverseNumber);
 
 	if ((nSynchronizationAddress != m_State.nSynchronizationAddressSourceA) && (nSynchronizationAddress != m_State.nSynchronizationAddressSourceB)) {
-		LedBlink::Get()->SetMode(ledblink::Mode::NORMAL);
+		if (m_bEnableDataIndicator) {
+			LedBlink::Get()->SetMode(ledblink::Mode::NORMAL);
+		}
 		DEBUG_PUTS("");
 		return;
 	}
 
 	m_State.SynchronizationTime = m_nCurrentPacketMillis;
 
+	m_pLightSet->BeginFrame();
+
 	for (uint32_t i = 0; i < E131_MAX_PORTS; i++) {
 		if ((m_OutputPort[i].IsDataPending) || (m_OutputPort[i].bIsEnabled && m_bDirectUpdate)){
 
-			m_pLightSet->SetData(i, m_OutputPort[i].data, m_OutputPort[i].length);
+			SendData(i);
 
 			if (!m_OutputPort[i].IsTransmitting) {
 				m_pLightSet->Start(i);
@@ -667,6 +747,8 @@ void E131Bridge::HandleSynchronization() {
 		}
 	}
 
+	m_pLightSet->CommitFrame();
+
 	if (m_pE131Sync != nullptr) {
 		m_pE131Sync->Handler();
 	}
@@ -725,7 +807,10 @@ void E131Bridge::SetNetworkDataLossCondition(bool bSourceA, bool bSourceB) {
 		}
 	}
 
-	LedBlink::Get()->SetMode(ledblink::Mode::NORMAL);
+	if (m_bEnableDataIndicator) {
+		LedBlink::Get()->SetMode(ledblink::Mode::NORMAL);
+	}
+
 	m_State.bIsReceivingDmx = false;
 
 	DEBUG_EXIT
@@ -753,7 +838,11 @@ bool E131Bridge::IsStatusChanged() {
 void E131Bridge::Clear(uint8_t nPortIndex) {
 	assert(nPortIndex < E131_MAX_PORTS);
 
-	uint8_t *pDst = m_OutputPort[nPortIndex].data;
+	if (m_OutputPort[nPortIndex].pBuffer == nullptr) {
+		return;
+	}
+
+	uint8_t *pDst = m_OutputPort[nPortIndex].pBuffer->data;
 
 	for (uint32_t i = 0; i < E131_DMX_LENGTH; i++) {
 		*pDst++ = 0;
@@ -761,7 +850,7 @@ void E131Bridge::Clear(uint8_t nPortIndex) {
 
 	m_OutputPort[nPortIndex].length = E131_DMX_LENGTH;
 
-	m_pLightSet->SetData(nPortIndex, m_OutputPort[nPortIndex].data, m_OutputPort[nPortIndex].length);
+	m_pLightSet->SetData(nPortIndex, m_OutputPort[nPortIndex].pBuffer->data, m_OutputPort[nPortIndex].length);
 
 	if (m_OutputPort[nPortIndex].bIsEnabled && !m_OutputPort[nPortIndex].IsTransmitting) {
 		m_pLightSet->Start(nPortIndex);
@@ -832,11 +921,12 @@ void E131Bridge::Run() {
 				}
 			}
 
-			// The ledblink::Mode::FAST is for RDM Identify (Art-Net 4)
-			if (m_bEnableDataIndicator && (LedBlink::Get()->GetMode() != ledblink::Mode::FAST)) {
-				if ((m_nCurrentPacketMillis - m_nPreviousPacketMillis) >= 1000) {
+			if ((m_nCurrentPacketMillis - m_nPreviousPacketMillis) >= 1000) {
+				m_State.bIsReceivingDmx = false;
+
+				// The ledblink::Mode::FAST is for RDM Identify (Art-Net 4)
+				if (m_bEnableDataIndicator && (LedBlink::Get()->GetMode() != ledblink::Mode::FAST)) {
 					LedBlink::Get()->SetMode(ledblink::Mode::NORMAL);
-					m_State.bIsReceivingDmx = false;
 				}
 			}
 		}
@@ -876,7 +966,9 @@ void E131Bridge::Run() {
 
 		if (nRootVector == E131_VECTOR_ROOT_DATA) {
 			if (IsValidDataPacket()) {
+				m_pLightSet->BeginFrame();
 				HandleDmx();
+				m_pLightSet->CommitFrame();
 			}
 		} else if (nRootVector == E131_VECTOR_ROOT_EXTENDED) {
 			const uint32_t nFramingVector = __builtin_bswap32(m_E131.E131Packet.Raw.FrameLayer.Vector);
@@ -76,3 +76,13 @@ void E131Bridge::SendDiscoveryPacket() {
 		Network::Get()->SendTo(m_nHandle, m_pE131DiscoveryPacket, m_State.DiscoveryPacketLength, m_DiscoveryIpAddress, E131_DEFAULT_PORT);
 	}
 }
+
+/**
+ * Receivers list the sources by the address of the universe discovery packet,
+ * a new address is announced at once instead of after the interval.
+ */
+void E131Bridge::IpChanged() {
+	if ((m_pE131DiscoveryPacket != nullptr) && (Network::Get()->GetIp() != 0)) {
+		m_State.DiscoveryTime = m_nCurrentPacketMillis - (E131_UNIVERSE_DISCOVERY_INTERVAL_SECONDS * 1000);
+	}
+}
@@ -0,0 +1,340 @@
+/**
+ * @file e131bridgeworkers.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include <linux/filter.h>
+#include <mutex>
+#include <thread>
+#include <cassert>
+
+#include "e131bridgeworkers.h"
+#include "e131bridge.h"
+#include "e131.h"
+#include "e131packets.h"
+
+#include "lightset.h"
+#include "ledblink.h"
+
+#include "networklinux.h"
+
+#include "debug.h"
+
+E131BridgeWorkers::E131BridgeWorkers(uint32_t nWorkers) : m_nWorkers(nWorkers) {
+	DEBUG_ENTRY
+
+	assert(nWorkers != 0);
+	assert(nWorkers <= e131bridgeworkers::MAX_WORKERS);
+
+	if (m_nWorkers > e131bridgeworkers::MAX_WORKERS) {
+		m_nWorkers = e131bridgeworkers::MAX_WORKERS;
+	}
+
+	auto *pNetwork = static_cast<NetworkLinux *>(Network::Get());
+	assert(pNetwork != nullptr);
+
+	for (uint32_t i = 0; i < m_nWorkers; i++) {
+		m_Workers[i].nHandle = pNetwork->BeginReusePort(E131_DEFAULT_PORT, e131bridgeworkers::RECV_TIMEOUT_MILLIS);
+		m_Workers[i].pE131Bridge = new E131Bridge(m_Workers[i].nHandle);
+		assert(m_Workers[i].pE131Bridge != nullptr);
+		m_Workers[i].pOutput = new Output(this, i);
+		assert(m_Workers[i].pOutput != nullptr);
+
+		m_Workers[i].pE131Bridge->SetOutput(m_Workers[i].pOutput);
+		// The LED is shared, it is set from Run()
+		m_Workers[i].pE131Bridge->SetEnableDataIndicator(false);
+	}
+
+	// Bound after the workers, it is socket m_nWorkers in the group
+	m_nSyncHandle = pNetwork->BeginReusePort(E131_DEFAULT_PORT, e131bridgeworkers::RECV_TIMEOUT_MILLIS);
+
+	DEBUG_EXIT
+}
+
+E131BridgeWorkers::~E131BridgeWorkers() {
+	DEBUG_ENTRY
+
+	Stop();
+
+	auto *pNetwork = static_cast<NetworkLinux *>(Network::Get());
+
+	for (uint32_t i = 0; i < m_nWorkers; i++) {
+		delete m_Workers[i].pE131Bridge;
+		delete m_Workers[i].pOutput;
+		pNetwork->EndReusePort(m_Workers[i].nHandle);
+	}
+
+	pNetwork->EndReusePort(m_nSyncHandle);
+
+	DEBUG_EXIT
+}
+
+void E131BridgeWorkers::SetOutput(LightSet *pLightSet) {
+	assert(!m_bRunning);
+
+	m_pLightSet = pLightSet;
+}
+
+void E131BridgeWorkers::SetUniverse(uint8_t nPortIndex, TE131PortDir dir, uint16_t nUniverse) {
+	assert(nPortIndex < GetMaxPorts());
+	assert(dir != E131_INPUT_PORT);
+
+	const auto nWorker = nPortIndex % m_nWorkers;
+	const auto nPortIndexWorker = static_cast<uint8_t>(nPortIndex / m_nWorkers);
+
+	m_Workers[nWorker].pE131Bridge->SetUniverse(nPortIndexWorker, dir, nUniverse);
+
+	SetUnicastSteering();
+}
+
+bool E131BridgeWorkers::GetUniverse(uint8_t nPortIndex, uint16_t &nUniverse) const {
+	assert(nPortIndex < GetMaxPorts());
+
+	const auto nWorker = nPortIndex % m_nWorkers;
+	const auto nPortIndexWorker = static_cast<uint8_t>(nPortIndex / m_nWorkers);
+
+	return m_Workers[nWorker].pE131Bridge->GetUniverse(nPortIndexWorker, nUniverse);
+}
+
+void E131BridgeWorkers::SetMergeMode(uint8_t nPortIndex, E131Merge tE131Merge) {
+	assert(nPortIndex < GetMaxPorts());
+
+	const auto nWorker = nPortIndex % m_nWorkers;
+	const auto nPortIndexWorker = static_cast<uint8_t>(nPortIndex / m_nWorkers);
+
+	m_Workers[nWorker].pE131Bridge->SetMergeMode(nPortIndexWorker, tE131Merge);
+}
+
+void E131BridgeWorkers::SetDirectUpdate(bool bDirectUpdate) {
+	for (uint32_t i = 0; i < m_nWorkers; i++) {
+		m_Workers[i].pE131Bridge->SetDirectUpdate(bDirectUpdate);
+	}
+}
+
+void E131BridgeWorkers::SetDisableSynchronize(bool bDisableSynchronize) {
+	for (uint32_t i = 0; i < m_nWorkers; i++) {
+		m_Workers[i].pE131Bridge->SetDisableSynchronize(bDisableSynchronize);
+	}
+}
+
+void E131BridgeWorkers::Start() {
+	DEBUG_ENTRY
+	assert(m_pLightSet != nullptr);
+
+	if (m_bRunning) {
+		DEBUG_EXIT
+		return;
+	}
+
+	m_bRunning = true;
+
+	for (uint32_t i = 0; i < m_nWorkers; i++) {
+		m_Workers[i].pE131Bridge->Start();
+		m_Workers[i].thread = std::thread(&E131BridgeWorkers::RunWorker, this, i);
+	}
+
+	m_SyncThread = std::thread(&E131BridgeWorkers::RunSyncForwarder, this);
+
+	LedBlink::Get()->SetMode(ledblink::Mode::NORMAL);
+
+	DEBUG_EXIT
+}
+
+void E131BridgeWorkers::Stop() {
+	DEBUG_ENTRY
+
+	if (!m_bRunning) {
+		DEBUG_EXIT
+		return;
+	}
+
+	m_bRunning = false;
+
+	m_SyncThread.join();
+
+	for (uint32_t i = 0; i < m_nWorkers; i++) {
+		m_Workers[i].thread.join();
+		m_Workers[i].pE131Bridge->Stop();
+		m_Workers[i].bIsReceivingDmx = false;
+	}
+
+	LedBlink::Get()->SetMode(ledblink::Mode::OFF_OFF);
+
+	DEBUG_EXIT
+}
+
+void E131BridgeWorkers::Run() {
+	// The ledblink::Mode::FAST is for RDM Identify (Art-Net 4)
+	if (!m_bRunning || (LedBlink::Get()->GetMode() == ledblink::Mode::FAST)) {
+		return;
+	}
+
+	bool bIsReceivingDmx = false;
+
+	for (uint32_t i = 0; i < m_nWorkers; i++) {
+		bIsReceivingDmx |= m_Workers[i].bIsReceivingDmx.load(std::memory_order_relaxed);
+	}
+
+	LedBlink::Get()->SetMode(bIsReceivingDmx ? ledblink::Mode::DATA : ledblink::Mode::NORMAL);
+}
+
+void E131BridgeWorkers::RunWorker(uint32_t nWorker) {
+	auto& worker = m_Workers[nWorker];
+
+	// Run blocks in RecvFrom for at most RECV_TIMEOUT_MILLIS
+	while (m_bRunning) {
+		worker.pE131Bridge->Run();
+		// The LED is set from the superloop
+		worker.bIsReceivingDmx.store(worker.pE131Bridge->IsReceivingDmx(), std::memory_order_relaxed);
+	}
+}
+
+/*
+ * A unicast synchronization packet arrives at one socket only. The forwarder sends a copy
+ * to each worker owning a port, with the worker number + 1 in the reserved field of the
+ * framing layer, which the steering filter uses and the receivers ignore.
+ */
+void E131BridgeWorkers::RunSyncForwarder() {
+	auto *pNetwork = Network::Get();
+	struct TE131SynchronizationPacket packet;
+
+	// RecvFrom blocks for at most RECV_TIMEOUT_MILLIS
+	while (m_bRunning) {
+		uint32_t nFromIp;
+		uint16_t nFromPort;
+
+		const auto nBytesReceived = pNetwork->RecvFrom(m_nSyncHandle, &packet, sizeof(packet), &nFromIp, &nFromPort);
+
+		if (nBytesReceived < sizeof(packet)) {
+			continue;
+		}
+
+		for (uint32_t i = 0; i < m_nWorkers; i++) {
+			if (m_nSyncWorkers & (1U << i)) {
+				packet.FrameLayer.Reserved = __builtin_bswap16(static_cast<uint16_t>(i + 1));
+				pNetwork->SendTo(m_nSyncHandle, &packet, nBytesReceived, pNetwork->GetIp(), E131_DEFAULT_PORT);
+			}
+		}
+	}
+}
+
+/*
+ * Unicast datagrams are spread over the sockets of a SO_REUSEPORT group by flow hash,
+ * so most of them would arrive at a worker which does not own the universe.
+ * This filter runs on the UDP payload and returns the index of the socket in the group,
+ * which is the worker number, as the sockets are bound in worker order.
+ * Multicast is not affected, it is delivered to each socket which joined the group.
+ */
+void E131BridgeWorkers::SetUnicastSteering() {
+	struct sock_filter filter[12 + 2 * e131bridgeworkers::MAX_WORKERS * E131_MAX_PORTS + 1];
+	uint16_t nInstructions = 0;
+
+	filter[nInstructions++] = BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct TE131DataPacket, RootLayer.Vector));
+	filter[nInstructions++] = BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, E131_VECTOR_ROOT_DATA, 9, 0);
+	// Discovery packets go to worker 0
+	filter[nInstructions++] = BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, E131_VECTOR_ROOT_EXTENDED, 0, 7);
+	filter[nInstructions++] = BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct TE131SynchronizationPacket, FrameLayer.Vector));
+	filter[nInstructions++] = BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, E131_VECTOR_EXTENDED_SYNCHRONIZATION, 0, 5);
+	// Synchronization packets go to the forwarder, the forwarded copies to worker (Reserved - 1)
+	filter[nInstructions++] = BPF_STMT(BPF_LD | BPF_H | BPF_ABS, offsetof(struct TE131SynchronizationPacket, FrameLayer.Reserved));
+	filter[nInstructions++] = BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, 0, 0, 1);
+	filter[nInstructions++] = BPF_STMT(BPF_RET | BPF_K, m_nWorkers);
+	filter[nInstructions++] = BPF_STMT(BPF_ALU | BPF_SUB | BPF_K, 1);
+	filter[nInstructions++] = BPF_STMT(BPF_RET | BPF_A, 0);
+	filter[nInstructions++] = BPF_STMT(BPF_RET | BPF_K, 0);
+	// Data packets go to the worker owning the universe
+	filter[nInstructions++] = BPF_STMT(BPF_LD | BPF_H | BPF_ABS, offsetof(struct TE131DataPacket, FrameLayer.Universe));
+
+	m_nSyncWorkers = 0;
+
+	for (uint32_t nPortIndex = 0; nPortIndex < GetMaxPorts(); nPortIndex++) {
+		uint16_t nUniverse;
+
+		if (GetUniverse(static_cast<uint8_t>(nPortIndex), nUniverse)) {
+			filter[nInstructions++] = BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, nUniverse, 0, 1);
+			filter[nInstructions++] = BPF_STMT(BPF_RET | BPF_K, nPortIndex % m_nWorkers);
+			m_nSyncWorkers |= (1U << (nPortIndex % m_nWorkers));
+		}
+	}
+
+	filter[nInstructions++] = BPF_STMT(BPF_RET | BPF_K, 0);
+
+	struct sock_fprog program;
+	program.len = nInstructions;
+	program.filter = filter;
+
+	// The program is shared by all the sockets in the group
+	if (setsockopt(m_Workers[0].nHandle, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program, sizeof(program)) == -1) {
+		perror("setsockopt(SO_ATTACH_REUSEPORT_CBPF)");
+	}
+}
+
+void E131BridgeWorkers::Print() {
+	printf("Workers : %u\n", m_nWorkers);
+
+	for (uint32_t nPortIndex = 0; nPortIndex < GetMaxPorts(); nPortIndex++) {
+		uint16_t nUniverse;
+
+		if (GetUniverse(static_cast<uint8_t>(nPortIndex), nUniverse)) {
+			printf(" Port %2u Universe %-3u [worker %u]\n", nPortIndex, nUniverse, nPortIndex % m_nWorkers);
+		}
+	}
+}
+
+/*
+ * Output
+ */
+
+void E131BridgeWorkers::Output::Start(uint8_t nPort) {
+	std::lock_guard<std::recursive_mutex> lock(m_pWorkers->m_LightSetMutex);
+	m_pWorkers->m_pLightSet->Start(ToPortIndex(nPort));
+}
+
+void E131BridgeWorkers::Output::Stop(uint8_t nPort) {
+	std::lock_guard<std::recursive_mutex> lock(m_pWorkers->m_LightSetMutex);
+	m_pWorkers->m_pLightSet->Stop(ToPortIndex(nPort));
+}
+
+void E131BridgeWorkers::Output::SetData(uint8_t nPort, const uint8_t *pData, uint16_t nLength) {
+	std::lock_guard<std::recursive_mutex> lock(m_pWorkers->m_LightSetMutex);
+	m_pWorkers->m_pLightSet->SetData(ToPortIndex(nPort), pData, nLength);
+}
+
+void E131BridgeWorkers::Output::SetDataRange(uint8_t nPort, const uint8_t *pData, uint16_t nLength, uint16_t nFirst, uint16_t nEnd) {
+	std::lock_guard<std::recursive_mutex> lock(m_pWorkers->m_LightSetMutex);
+	m_pWorkers->m_pLightSet->SetDataRange(ToPortIndex(nPort), pData, nLength, nFirst, nEnd);
+}
+
+void E131BridgeWorkers::Output::BeginFrame() {
+	m_pWorkers->m_LightSetMutex.lock();
+	m_pWorkers->m_pLightSet->BeginFrame();
+}
+
+void E131BridgeWorkers::Output::CommitFrame() {
+	m_pWorkers->m_pLightSet->CommitFrame();
+	m_pWorkers->m_LightSetMutex.unlock();
+}
@@ -39,6 +39,8 @@
 #include "phy.h"
 #include "mii.h"
 
+#include "arm/memfunc.h"
+
 #include "debug.h"
 
 #define BUS_SOFT_RESET2_EPHY_RST 	(1 << 2)
@@ -54,10 +56,18 @@
 #define TX_CTL1_TX_DMA_EN			(1 << 30)
 
 #define RX_CTL0_RX_EN				(1U << 31)
+#define RX_CTL0_CHECK_CRC			(1 << 27)	///< IPv4 header and TCP/UDP/ICMP payload checksum offload
 #define RX_CTL1_RX_DMA_EN			(1 << 30)
+#define RX_CTL1_RX_DMA_START		(1U << 31)
 
 #define RX_FRM_FLT_RX_ALL_MULTICAST	(1 << 16)
 
+#define TX_DESC_CTL_CHKSUM_FULL		(3 << 27)	///< Insert IPv4 header and TCP/UDP/ICMP checksum (including pseudo header)
+
+#define RX_DESC_STATUS_PAYLOAD_CHKSUM_ERR	(1 << 0)	///< Also set for frames without a verified payload, e.g. ARP
+#define RX_DESC_STATUS_HEADER_CHKSUM_ERR	(1 << 7)	///< Also set for non-IPv4 frames
+#define RX_DESC_STATUS_ERR_SUM				(1 << 15)
+
 #define	ARM_DMA_ALIGN	64
 
 #define CONFIG_TX_DESCR_NUM	48
@@ -69,6 +79,7 @@
  * using 2048 cause strange behaviors and even BSP driver use 2047
  */
 #define CONFIG_ETH_RXSIZE	2044 /* Note must fit in ETH_BUFSIZE */
+#define CONFIG_RX_SPARE_NUM	24	/* Buffers swapped into the RX descriptors of held frames */
 
 #define TX_TOTAL_BUFSIZE	(CONFIG_ETH_BUFSIZE * CONFIG_TX_DESCR_NUM)
 #define RX_TOTAL_BUFSIZE	(CONFIG_ETH_BUFSIZE * CONFIG_RX_DESCR_NUM)
@@ -87,8 +98,11 @@ struct coherent_region {
 	struct emac_dma_desc tx_chain[CONFIG_RX_DESCR_NUM];
 	char rxbuffer[RX_TOTAL_BUFSIZE] __aligned(ARM_DMA_ALIGN);
 	char txbuffer[TX_TOTAL_BUFSIZE] __aligned(ARM_DMA_ALIGN);
+	char rxspare[CONFIG_ETH_BUFSIZE * CONFIG_RX_SPARE_NUM] __aligned(ARM_DMA_ALIGN);
 	uint32_t rx_currdescnum;
 	uint32_t tx_currdescnum;
+	uint32_t rx_spare[CONFIG_RX_SPARE_NUM];	///< Free buffers, used as a stack
+	uint32_t rx_spare_count;
 };
 
 static struct coherent_region *p_coherent_region = 0;
@@ -223,6 +237,12 @@ static void _rx_descs_init(void) {
 
 	H3_EMAC->RX_DMA_DESC = (uintptr_t)&desc_table_p[0];
 	p_coherent_region->rx_currdescnum = 0;
+
+	for (idx = 0; idx < CONFIG_RX_SPARE_NUM; idx++) {
+		p_coherent_region->rx_spare[idx] = (uintptr_t) &p_coherent_region->rxspare[idx * CONFIG_ETH_BUFSIZE];
+	}
+
+	p_coherent_region->rx_spare_count = CONFIG_RX_SPARE_NUM;
 }
 
 static void _tx_descs_init(void) {
@@ -246,6 +266,32 @@ static void _tx_descs_init(void) {
 	p_coherent_region->tx_currdescnum = 0;
 }
 
+void emac_free_pkt(void);
+
+/*
+ * The checksum status bits are only meaningful for IPv4. The payload
+ * checksum is verified for unfragmented TCP, UDP and ICMP only.
+ */
+static int rx_chksum_failed(const uint8_t *frame, uint32_t status) {
+	if ((frame[12] != 0x08) || (frame[13] != 0x00)) {
+		return 0;
+	}
+
+	if (status & RX_DESC_STATUS_HEADER_CHKSUM_ERR) {
+		return 1;
+	}
+
+	const uint8_t *ip = &frame[14];
+	const uint32_t fragment = ((uint32_t)(ip[6] & 0x3F) << 8) | ip[7];	// MF flag and fragment offset
+	const uint8_t protocol = ip[9];
+
+	if ((fragment != 0) || ((protocol != 1) && (protocol != 6) && (protocol != 17))) {
+		return 0;
+	}
+
+	return 1;
+}
+
 int emac_eth_recv(uint8_t **packetp) {
 	uint32_t status, desc_num = p_coherent_region->rx_currdescnum;
 	struct emac_dma_desc *desc_p = &p_coherent_region->rx_chain[desc_num];
@@ -259,14 +305,30 @@ int emac_eth_recv(uint8_t **packetp) {
 
 		if (length < 0x40) {
 			DEBUG_PUTS("Bad Packet (length < 0x40)");
+			emac_free_pkt();
 			return -1;
 		} else {
 			if (length > CONFIG_ETH_RXSIZE) {
 				DEBUG_PRINTF("Received packet is too big (length=%d)\n", length);
+				emac_free_pkt();
+				return -1;
+			}
+
+			if (__builtin_expect((status & RX_DESC_STATUS_ERR_SUM) != 0, 0)) {
+				DEBUG_PRINTF("Receive error (status=%08x)", status);
+				emac_free_pkt();
 				return -1;
 			}
 
 			*packetp = (uint8_t*) (uint32_t) desc_p->buf_addr;
+
+			if (__builtin_expect((status & (RX_DESC_STATUS_HEADER_CHKSUM_ERR | RX_DESC_STATUS_PAYLOAD_CHKSUM_ERR)) != 0, 0)) {
+				if (rx_chksum_failed(*packetp, status)) {
+					DEBUG_PRINTF("Checksum error (status=%08x)", status);
+					emac_free_pkt();
+					return -1;
+				}
+			}
 #ifdef DEBUG_DUMP
 			debug_dump((void*) *packetp, (uint16_t) length);
 #endif
@@ -277,19 +339,27 @@ int emac_eth_recv(uint8_t **packetp) {
 	return -1;
 }
 
-void emac_eth_send(void *packet, int len) {
+uint8_t *emac_eth_send_get_dma_buffer(void) {
+	const struct emac_dma_desc *desc_p = &p_coherent_region->tx_chain[p_coherent_region->tx_currdescnum];
+
+	return (uint8_t *) desc_p->buf_addr;
+}
+
+/*
+ * The frame has already been written into the buffer returned by emac_eth_send_get_dma_buffer
+ */
+void emac_eth_send_now(int len) {
 	uint32_t value;
 	uint32_t desc_num = p_coherent_region->tx_currdescnum;
 	struct emac_dma_desc *desc_p = &p_coherent_region->tx_chain[desc_num];
-	uintptr_t data_start = (uintptr_t) desc_p->buf_addr;
 
 	desc_p->st = (uint32_t)len;
 	/* Mandatory undocumented bit */
 	desc_p->st |= (1U << 24);
-
-	h3_memcpy((void *) data_start, packet, (size_t)len);
+	/* The IPv4 header checksum and the UDP/ICMP checksum are calculated by the EMAC */
+	desc_p->st |= TX_DESC_CTL_CHKSUM_FULL;
 #ifdef DEBUG_DUMP
-	debug_dump( data_start, (uint16_t) len);
+	debug_dump((void *) desc_p->buf_addr, (uint16_t) len);
 #endif
 	/* frame end */
 	desc_p->st |= (1 << 30);
@@ -313,6 +383,11 @@ void emac_eth_send(void *packet, int len) {
 	H3_EMAC->TX_CTL1 = value;
 }
 
+void emac_eth_send(void *packet, int len) {
+	arm_memcpy(emac_eth_send_get_dma_buffer(), packet, (size_t)len);
+	emac_eth_send_now(len);
+}
+
 void emac_free_pkt(void) {
 	uint32_t desc_num = p_coherent_region->rx_currdescnum;
 	struct emac_dma_desc *desc_p = &p_coherent_region->rx_chain[desc_num];
@@ -328,6 +403,35 @@ void emac_free_pkt(void) {
 	p_coherent_region->rx_currdescnum = desc_num;
 }
 
+/*
+ * Zero-copy receive: the buffer of the current frame is taken out of its
+ * descriptor and a spare buffer is put in. The descriptor goes back to the
+ * DMA straight away, so the ring never stalls on a held frame.
+ * Returns NULL when there is no spare buffer; the caller then copies the
+ * frame and calls emac_free_pkt.
+ * The caller owns the returned buffer until emac_eth_release_pkt.
+ */
+uint8_t *emac_eth_hold_pkt(void) {
+	if (p_coherent_region->rx_spare_count == 0) {
+		return NULL;
+	}
+
+	struct emac_dma_desc *desc_p = &p_coherent_region->rx_chain[p_coherent_region->rx_currdescnum];
+	uint8_t *buffer = (uint8_t *) (uint32_t) desc_p->buf_addr;
+
+	desc_p->buf_addr = p_coherent_region->rx_spare[--p_coherent_region->rx_spare_count];
+
+	emac_free_pkt();
+
+	return buffer;
+}
+
+void emac_eth_release_pkt(uint8_t *buffer) {
+	assert(p_coherent_region->rx_spare_count < CONFIG_RX_SPARE_NUM);
+
+	p_coherent_region->rx_spare[p_coherent_region->rx_spare_count++] = (uint32_t) buffer;
+}
+
 void _autonegotiation(void) {
 	uint32_t value;
 
@@ -411,7 +515,7 @@ void __attribute__((cold)) emac_start(__attribute__((unused)) bool reset_emac) {
 	H3_EMAC->TX_CTL1 = value;
 
 	value = H3_EMAC->RX_CTL0;
-	value |= RX_CTL0_RX_EN;
+	value |= RX_CTL0_RX_EN | RX_CTL0_CHECK_CRC;
 	H3_EMAC->RX_CTL0 = value;
 
 	value = H3_EMAC->TX_CTL0;
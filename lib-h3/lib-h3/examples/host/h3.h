@@ -0,0 +1,53 @@
+/**
+ * @file h3.h
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Host stand-in for h3.h, for the tests that build the net stack on the
+ * host: the timer counts microseconds since the start of the test.
+ */
+
+#ifndef H3_H_
+#define H3_H_
+
+#include <stdint.h>
+
+struct host_timer {
+	volatile uint32_t AVS_CNT0;
+	volatile uint32_t AVS_CNT1;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern struct host_timer *host_timer(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define H3_TIMER	(host_timer())
+
+#endif /* H3_H_ */
@@ -0,0 +1,250 @@
+/**
+ * @file net_chksum_test.c
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Host conformance test and benchmark for net/net_chksum.c
+ *
+ * - RFC 1071 numerical example
+ * - every start offset 0..7 and length 0..1999 against a byte-wise reference
+ * - chaining of partial sums at every even split point
+ * - RFC 1624 incremental update, including the example of section 4
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+extern uint32_t net_chksum_partial(uint32_t, const void *, uint32_t);
+extern uint16_t net_chksum_fold(uint32_t);
+extern uint16_t net_chksum(void *, uint32_t);
+extern uint16_t net_chksum_adjust(uint16_t, uint16_t, uint16_t);
+
+#define BUFFER_SIZE		2048
+#define MAX_LENGTH		2000
+
+static uint8_t s_buffer[BUFFER_SIZE + 8] __attribute__((aligned(16)));
+static unsigned s_errors;
+
+#define CHECK(cond, ...)	do { if (!(cond)) { if (s_errors++ < 10) { printf(__VA_ARGS__); } } } while (0)
+
+/*
+ * RFC 1071, byte by byte in network byte order. The result is returned in
+ * memory order, as it is stored in the packet.
+ */
+static uint16_t ref_chksum(const uint8_t *p, uint32_t len) {
+	uint32_t sum = 0;
+	uint32_t i;
+
+	for (i = 0; i + 1 < len; i += 2) {
+		sum += (uint32_t) (p[i] << 8) | p[i + 1];
+	}
+
+	if (len & 1) {
+		sum += (uint32_t) p[len - 1] << 8;
+	}
+
+	while (sum >> 16) {
+		sum = (sum & 0xFFFF) + (sum >> 16);
+	}
+
+	const uint16_t chksum = (uint16_t) ~sum;
+	uint16_t in_memory;
+	const uint8_t be[2] = { (uint8_t) (chksum >> 8), (uint8_t) chksum };
+	memcpy(&in_memory, be, 2);
+
+	return in_memory;
+}
+
+/* The original 16-bit loop, for the benchmark */
+static uint16_t old_chksum(void *data, uint32_t len) {
+	uint32_t sum = 0;
+	uint16_t *ptr = (uint16_t *) data;
+
+	while (len > 1) {
+		sum += *ptr++;
+		len -= 2;
+	}
+
+	if (len > 0) {
+		sum += *(uint8_t *) ptr;
+	}
+
+	while (sum >> 16) {
+		sum = (sum >> 16) + (sum & 0xFFFF);
+	}
+
+	return (uint16_t) ~sum;
+}
+
+static void fill(unsigned pattern) {
+	unsigned i;
+
+	for (i = 0; i < sizeof(s_buffer); i++) {
+		s_buffer[i] = pattern == 0 ? (uint8_t) rand() : pattern == 1 ? 0xFF : 0x00;
+	}
+}
+
+static void test_rfc1071_example(void) {
+	/* RFC 1071 section 3: the sum of these bytes is ddf2, the checksum 220d */
+	uint8_t data[8] = { 0x00, 0x01, 0xf2, 0x03, 0xf4, 0xf5, 0xf6, 0xf7 };
+
+	const uint16_t chksum = net_chksum(data, sizeof(data));
+	CHECK(chksum == ref_chksum(data, sizeof(data)), "example: %04x\n", chksum);
+	CHECK(((const uint8_t *) &chksum)[0] == 0x22 && ((const uint8_t *) &chksum)[1] == 0x0d, "example: %04x != 220d\n", chksum);
+}
+
+static void test_offsets_lengths(void) {
+	unsigned pattern, offset, length;
+
+	for (pattern = 0; pattern < 3; pattern++) {
+		fill(pattern);
+		for (offset = 0; offset < 8; offset++) {
+			for (length = 0; length < MAX_LENGTH; length++) {
+				const uint16_t got = net_chksum(&s_buffer[offset], length);
+				const uint16_t expected = ref_chksum(&s_buffer[offset], length);
+				CHECK(got == expected, "offset %u length %u: %04x != %04x\n", offset, length, got, expected);
+			}
+		}
+	}
+}
+
+static void test_chaining(void) {
+	unsigned offset, length, split;
+
+	fill(0);
+
+	for (offset = 0; offset < 4; offset++) {
+		for (length = 0; length < 300; length++) {
+			const uint16_t expected = ref_chksum(&s_buffer[offset], length);
+			for (split = 0; split <= length; split += 2) {
+				uint32_t sum = net_chksum_partial(0, &s_buffer[offset], split);
+				sum = net_chksum_partial(sum, &s_buffer[offset + split], length - split);
+				CHECK(net_chksum_fold(sum) == expected, "chain offset %u length %u split %u\n", offset, length, split);
+			}
+			/* Three blocks, with a pseudo header like sum in front */
+			if (length >= 8) {
+				uint32_t sum = 0x1234;
+				sum = net_chksum_partial(sum, &s_buffer[offset], 4);
+				sum = net_chksum_partial(sum, &s_buffer[offset + 4], 4);
+				sum = net_chksum_partial(sum, &s_buffer[offset + 8], length - 8);
+				const uint32_t whole = net_chksum_partial(0x1234, &s_buffer[offset], length);
+				CHECK(net_chksum_fold(sum) == net_chksum_fold(whole), "chain3 offset %u length %u\n", offset, length);
+			}
+		}
+	}
+}
+
+static void test_adjust(void) {
+	unsigned i;
+
+	/* RFC 1624 section 4: HC = 0xDD2F, m = 0x5555, m' = 0x3285 gives HC' = 0x0000 */
+	const uint16_t hc = net_chksum_adjust(0xDD2F, 0x5555, 0x3285);
+	CHECK(hc == 0x0000, "rfc1624 example: %04x\n", hc);
+
+	for (i = 0; i < 200000; i++) {
+		uint8_t packet[64];
+		unsigned j;
+
+		for (j = 0; j < sizeof(packet); j++) {
+			packet[j] = (uint8_t) rand();
+		}
+
+		const unsigned field = 2 * (unsigned) (rand() % 16);
+		const unsigned chksum_field = field == 62 ? 0 : 62;
+
+		packet[chksum_field] = packet[chksum_field + 1] = 0;
+		const uint16_t chksum = net_chksum(packet, sizeof(packet));
+
+		uint16_t old_value, new_value = (uint16_t) rand();
+		memcpy(&old_value, &packet[field], 2);
+		memcpy(&packet[field], &new_value, 2);
+
+		const uint16_t expected = net_chksum(packet, sizeof(packet));
+		const uint16_t got = net_chksum_adjust(chksum, old_value, new_value);
+
+		/* 0x0000 and 0xFFFF are both zero in one's complement */
+		CHECK((got == expected) || ((uint16_t) (got + 1) <= 1 && (uint16_t) (expected + 1) <= 1), "adjust %04x != %04x\n", got, expected);
+
+		/* Verifying the adjusted packet must give zero */
+		memcpy(&packet[chksum_field], &got, 2);
+		CHECK(net_chksum(packet, sizeof(packet)) == 0 || net_chksum(packet, sizeof(packet)) == 0xFFFF, "adjust verify\n");
+	}
+}
+
+static uint64_t now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+static void benchmark(void) {
+	static const uint32_t lengths[] = { 20, 64, 512, 1472 };
+	volatile uint16_t sink = 0;
+	unsigned i, n;
+
+	fill(0);
+
+	printf("length   old ns   new ns   new MB/s\n");
+
+	for (i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+		const unsigned runs = 2000000 / lengths[i] * 20;
+
+		uint64_t t0 = now_ns();
+		for (n = 0; n < runs; n++) {
+			sink = (uint16_t) (sink + old_chksum(&s_buffer[n & 2], lengths[i]));
+			__asm__ volatile("" ::: "memory");
+		}
+		uint64_t t1 = now_ns();
+		for (n = 0; n < runs; n++) {
+			sink = (uint16_t) (sink + net_chksum(&s_buffer[n & 2], lengths[i]));
+			__asm__ volatile("" ::: "memory");
+		}
+		uint64_t t2 = now_ns();
+
+		const double old_ns = (double) (t1 - t0) / runs;
+		const double new_ns = (double) (t2 - t1) / runs;
+
+		printf("%6u %8.1f %8.1f %10.0f\n", lengths[i], old_ns, new_ns, lengths[i] * 1e3 / new_ns);
+	}
+}
+
+int main(int argc, char **argv) {
+	srand(1);
+
+	test_rfc1071_example();
+	test_offsets_lengths();
+	test_chaining();
+	test_adjust();
+
+	printf("net_chksum: %u errors\n", s_errors);
+
+	if ((argc > 1) && (strcmp(argv[1], "-b") == 0)) {
+		benchmark();
+	}
+
+	return s_errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,470 @@
+/**
+ * @file net_dhcp_test.c
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Host test of the DHCP client in net/dhcp.c: the net stack runs on a
+ * stubbed EMAC, against an in-process DHCP server with a configurable one-way
+ * delay. An ARP stand-in answers probes for an address owned by another host.
+ *
+ * - cold boot, full DORA
+ * - warm boot, cached lease ACKed: ARP probes, INIT-REBOOT request, no DORA
+ * - cached lease NAKed: the address drops to 0.0.0.0, the background client
+ *   falls back to DORA
+ * - cached address in use: the probe fails, blocking DORA
+ * - server silent for 1.5 s: the cached address is used, bound later
+ *
+ * Prints the time to a usable IP and the time until the lease is bound.
+ *
+ * Usage: net_dhcp_test [one-way delay us]
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "h3.h"
+
+#include "net/net.h"
+
+#include "../net/net_packets.h"
+#include "../net/dhcp_internal.h"
+
+#define QUEUE_SIZE		64
+#define BOUND_TIMEOUT_US	(15 * 1000 * 1000)
+#define LEASE_TIME		3600
+
+struct frame {
+	uint64_t due;
+	int length;
+	uint8_t data[FRAME_BUFFER_SIZE];
+};
+
+struct dhcp_message {
+	uint8_t op;
+	uint8_t htype;
+	uint8_t hlen;
+	uint8_t hops;
+	uint32_t xid;
+	uint16_t secs;
+	uint16_t flags;
+	uint8_t ciaddr[4];
+	uint8_t yiaddr[4];
+	uint8_t siaddr[4];
+	uint8_t giaddr[4];
+	uint8_t chaddr[16];
+	uint8_t sname[64];
+	uint8_t file[128];
+	uint8_t options[DHCP_OPT_SIZE];
+} __attribute__((packed));
+
+static const uint8_t s_mac[6] = { 0x02, 0x11, 0x22, 0x33, 0x44, 0x55 };
+static const uint8_t s_server_mac[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+static const uint8_t s_other_mac[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x02 };
+
+static uint64_t s_start_us;
+static struct host_timer s_timer;
+
+static struct frame s_queue[QUEUE_SIZE];
+static int s_queue_head;
+static int s_queue_tail;
+static uint8_t s_rx[FRAME_BUFFER_SIZE];
+
+/* DHCP server stand-in */
+static uint32_t s_delay_us = 2000;
+static uint32_t s_server_ip;
+static uint32_t s_pool_ip;
+static uint32_t s_netmask;
+static uint32_t s_gw;
+static uint32_t s_bound_ip;
+static uint8_t s_bound_mac[6];
+static uint64_t s_server_mute_until;
+
+/* Another host owns this address */
+static uint32_t s_conflict_ip;
+
+static int s_discovers;
+static int s_reboot_requests;
+static int s_select_requests;
+static int s_probes;
+static uint32_t s_discover_src;
+
+static int s_bound_callbacks;
+static int s_unbound_callbacks;
+static struct dhcp_lease s_cached;
+static bool s_have_cached;
+
+static unsigned s_errors;
+
+#define CHECK(cond)	do { if (!(cond)) { s_errors++; printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); } } while (0)
+
+static uint64_t now_us(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000 + (uint64_t) ts.tv_nsec / 1000;
+}
+
+struct host_timer *host_timer(void) {
+	const uint32_t micros = (uint32_t) (now_us() - s_start_us);
+
+	s_timer.AVS_CNT0 = micros;
+	s_timer.AVS_CNT1 = micros;
+
+	return &s_timer;
+}
+
+void console_error(const char *s) {
+	fprintf(stderr, "console_error: %s\n", s);
+}
+
+static void deliver(const void *p, int length, uint32_t delay_us) {
+	struct frame *f = &s_queue[s_queue_tail];
+
+	s_queue_tail = (s_queue_tail + 1) % QUEUE_SIZE;
+
+	f->due = now_us() + delay_us;
+	f->length = length;
+	memcpy(f->data, p, (size_t) length);
+}
+
+int emac_eth_recv(uint8_t **p) {
+	if ((s_queue_head == s_queue_tail) || (s_queue[s_queue_head].due > now_us())) {
+		return 0;
+	}
+
+	const int length = s_queue[s_queue_head].length;
+
+	memcpy(s_rx, s_queue[s_queue_head].data, (size_t) length);
+	s_queue_head = (s_queue_head + 1) % QUEUE_SIZE;
+
+	*p = s_rx;
+	return length;
+}
+
+void emac_free_pkt(void) {
+}
+
+static int option_find(const struct dhcp_message *m, int length, uint8_t code, uint8_t *value) {
+	const uint8_t *p = m->options + 4;
+	const uint8_t *end = (const uint8_t *) m + length;
+
+	while ((p < end) && (*p != 255)) {
+		if (*p == 0) {
+			p++;
+			continue;
+		}
+
+		if (*p == code) {
+			memcpy(value, p + 2, p[1]);
+			return p[1];
+		}
+
+		p += 2 + p[1];
+	}
+
+	return -1;
+}
+
+static uint8_t *option_put(uint8_t *p, uint8_t code, const void *value, uint8_t length) {
+	*p++ = code;
+	*p++ = length;
+	memcpy(p, value, length);
+
+	return p + length;
+}
+
+static void server_reply(const struct dhcp_message *request, uint8_t type, uint32_t yiaddr) {
+	struct t_udp udp;
+
+	memset(&udp, 0, sizeof(struct t_udp));
+	memset(udp.ether.dst, 0xFF, 6);
+	memcpy(udp.ether.src, s_server_mac, 6);
+	udp.ether.type = __builtin_bswap16(ETHER_TYPE_IPv4);
+	udp.ip4.ver_ihl = 0x45;
+	udp.ip4.proto = IPv4_PROTO_UDP;
+	memcpy(udp.ip4.src, &s_server_ip, 4);
+	memset(udp.ip4.dst, 0xFF, 4);
+	udp.udp.source_port = __builtin_bswap16(DHCP_PORT_SERVER);
+	udp.udp.destination_port = __builtin_bswap16(DHCP_PORT_CLIENT);
+
+	struct dhcp_message *m = (struct dhcp_message *) udp.udp.data;
+
+	m->op = DHCP_OP_BOOTREPLY;
+	m->htype = DHCP_HTYPE_10MB;
+	m->hlen = 6;
+	m->xid = request->xid;
+	memcpy(m->chaddr, request->chaddr, 16);
+	memcpy(m->yiaddr, &yiaddr, 4);
+
+	const uint32_t cookie = __builtin_bswap32(MAGIC_COOKIE);
+	memcpy(m->options, &cookie, 4);
+
+	uint8_t *p = option_put(m->options + 4, 53, &type, 1);
+	p = option_put(p, 54, &s_server_ip, 4);
+
+	if (type != DCHP_TYPE_NAK) {
+		const uint32_t lease_time = __builtin_bswap32(LEASE_TIME);
+
+		p = option_put(p, 1, &s_netmask, 4);
+		p = option_put(p, 3, &s_gw, 4);
+		p = option_put(p, 51, &lease_time, 4);
+	}
+
+	*p++ = 255;
+
+	const int length = (int) (p - (uint8_t *) m);
+
+	udp.udp.len = __builtin_bswap16((uint16_t) (length + 8));
+	deliver(&udp, (int) (sizeof(struct ether_packet) + sizeof(struct t_ip4_packet) + 8) + length, s_delay_us);
+}
+
+static void server_handle(const struct t_udp *udp) {
+	if ((now_us() < s_server_mute_until) || (udp->ip4.proto != IPv4_PROTO_UDP) || (__builtin_bswap16(udp->udp.destination_port) != DHCP_PORT_SERVER)) {
+		return;
+	}
+
+	const struct dhcp_message *m = (const struct dhcp_message *) udp->udp.data;
+	const int length = __builtin_bswap16(udp->udp.len) - 8;
+	uint8_t type = 0;
+	uint8_t value[64];
+	uint32_t requested_ip = 0;
+
+	option_find(m, length, 53, &type);
+	const bool has_server_id = (option_find(m, length, 54, value) == 4);
+
+	if (option_find(m, length, 50, value) == 4) {
+		memcpy(&requested_ip, value, 4);
+	}
+
+	switch (type) {
+	case DCHP_TYPE_DISCOVER:
+		s_discovers++;
+		memcpy(&s_discover_src, udp->ip4.src, 4);
+		server_reply(m, DCHP_TYPE_OFFER, s_pool_ip);
+		break;
+	case DCHP_TYPE_REQUEST:
+		if (has_server_id) {
+			/* SELECTING */
+			s_select_requests++;
+			if (requested_ip == s_pool_ip) {
+				s_bound_ip = s_pool_ip;
+				memcpy(s_bound_mac, m->chaddr, 6);
+				server_reply(m, DCHP_TYPE_ACK, s_pool_ip);
+			} else {
+				server_reply(m, DCHP_TYPE_NAK, 0);
+			}
+		} else {
+			/* INIT-REBOOT */
+			s_reboot_requests++;
+			if ((requested_ip == s_bound_ip) && (memcmp(s_bound_mac, m->chaddr, 6) == 0)) {
+				server_reply(m, DCHP_TYPE_ACK, requested_ip);
+			} else {
+				server_reply(m, DCHP_TYPE_NAK, 0);
+			}
+		}
+		break;
+	case DCHP_TYPE_RELEASE:
+		s_bound_ip = 0;
+		break;
+	default:
+		break;
+	}
+}
+
+static void arp_handle(const struct t_arp *arp) {
+	if (arp->arp.opcode != __builtin_bswap16(ARP_OPCODE_RQST)) {
+		return;
+	}
+
+	if (arp->arp.sender_ip == 0) {
+		s_probes++;
+	}
+
+	if ((s_conflict_ip == 0) || (arp->arp.target_ip != s_conflict_ip)) {
+		return;
+	}
+
+	struct t_arp reply;
+
+	memset(&reply, 0, sizeof(struct t_arp));
+	memcpy(reply.ether.dst, arp->ether.src, 6);
+	memcpy(reply.ether.src, s_other_mac, 6);
+	reply.ether.type = __builtin_bswap16(ETHER_TYPE_ARP);
+	reply.arp.hardware_type = __builtin_bswap16(1);
+	reply.arp.protocol_type = __builtin_bswap16(ETHER_TYPE_IPv4);
+	reply.arp.hardware_size = 6;
+	reply.arp.protocol_size = 4;
+	reply.arp.opcode = __builtin_bswap16(ARP_OPCODE_REPLY);
+	memcpy(reply.arp.sender_mac, s_other_mac, 6);
+	reply.arp.sender_ip = s_conflict_ip;
+	memcpy(reply.arp.target_mac, arp->arp.sender_mac, 6);
+
+	deliver(&reply, sizeof(struct t_arp), 300);
+}
+
+void emac_eth_send(void *p, __attribute__((unused)) int length) {
+	const struct ether_packet *ether = (const struct ether_packet *) p;
+
+	if (ether->type == __builtin_bswap16(ETHER_TYPE_IPv4)) {
+		server_handle((const struct t_udp *) p);
+	} else if (ether->type == __builtin_bswap16(ETHER_TYPE_ARP)) {
+		arp_handle((const struct t_arp *) p);
+	}
+}
+
+static void bound_callback(void) {
+	struct dhcp_lease lease;
+
+	if (net_get_dhcp_lease(&lease)) {
+		s_bound_callbacks++;
+	} else {
+		s_unbound_callbacks++;
+	}
+}
+
+static uint32_t ip4(uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+	return a | b << 8 | c << 16 | d << 24;
+}
+
+static double ms(uint64_t us) {
+	return (double) us / 1000.0;
+}
+
+/*
+ * Boots the client with the cached lease of the previous boot, if any. When
+ * net_init() returns with the cached address, runs the main loop until the
+ * background client has bound the lease.
+ */
+static void boot(const char *name, uint32_t expected_ip) {
+	struct ip_info info;
+	struct dhcp_lease lease;
+	const struct dhcp_lease none = { 0, 0, 0, 0, 0 };
+	bool use_dhcp = true;
+	bool zeroconf = false;
+
+	memset(&info, 0, sizeof(struct ip_info));
+
+	s_queue_head = s_queue_tail = 0;
+	s_bound_callbacks = 0;
+	s_unbound_callbacks = 0;
+	s_discover_src = 0;
+	s_discovers = s_reboot_requests = s_select_requests = s_probes = 0;
+
+	net_set_dhcp_lease(s_have_cached ? &s_cached : &none);
+	net_set_dhcp_callback(bound_callback);
+
+	const uint64_t start = now_us();
+	net_init(s_mac, &info, (const uint8_t *) "host", &use_dhcp, &zeroconf);
+	const uint64_t ip_us = now_us() - start;
+
+	/* A full DORA in net_init() binds the lease before it returns */
+	uint64_t bound_us = (s_discovers != 0) ? ip_us : 0;
+
+	if (bound_us == 0) {
+		while ((s_bound_callbacks == 0) && (now_us() - start < BOUND_TIMEOUT_US)) {
+			net_handle();
+		}
+
+		if (s_bound_callbacks != 0) {
+			bound_us = now_us() - start;
+		}
+	}
+
+	const bool is_leased = net_get_dhcp_lease(&lease);
+
+	printf("%-34s IP %8.2f ms  bound %8.2f ms  %u.%u.%u.%u  discover %d init-reboot %d select %d probes %d\n",
+			name, ms(ip_us), ms(bound_us),
+			lease.ip & 0xFF, (lease.ip >> 8) & 0xFF, (lease.ip >> 16) & 0xFF, lease.ip >> 24,
+			s_discovers, s_reboot_requests, s_select_requests, s_probes);
+
+	CHECK(use_dhcp);
+	CHECK(is_leased);
+	CHECK(bound_us != 0);
+	CHECK(lease.ip == expected_ip);
+	CHECK(lease.lease_time == LEASE_TIME);
+	CHECK(lease.server_ip == s_server_ip);
+	CHECK(lease.netmask == s_netmask);
+	CHECK(lease.gw == s_gw);
+
+	/* What NetworkH3emac stores through StoreNetwork */
+	s_cached = lease;
+	s_have_cached = true;
+}
+
+int main(int argc, char **argv) {
+	s_start_us = now_us();
+
+	if (argc > 1) {
+		s_delay_us = (uint32_t) atoi(argv[1]);
+	}
+
+	printf("DHCP server one-way delay %u us\n", s_delay_us);
+
+	s_server_ip = ip4(192, 168, 2, 1);
+	s_gw = s_server_ip;
+	s_netmask = ip4(255, 255, 255, 0);
+	s_pool_ip = ip4(192, 168, 2, 100);
+
+	boot("cold boot, full DORA", s_pool_ip);
+	CHECK((s_discovers >= 1) && (s_reboot_requests == 0));
+
+	boot("cached lease ACKed", s_pool_ip);
+	CHECK((s_discovers == 0) && (s_reboot_requests == 1) && (s_probes == 2));
+	CHECK(s_unbound_callbacks == 0);
+
+	/* The server lost the binding and hands out another address */
+	s_pool_ip = ip4(192, 168, 2, 101);
+	s_bound_ip = 0;
+	boot("cached lease NAKed", s_pool_ip);
+	CHECK((s_reboot_requests == 1) && (s_discovers == 1));
+	/* RFC 2131 3.2: the NAKed address is not used for the DISCOVER */
+	CHECK((s_unbound_callbacks == 1) && (s_discover_src == 0));
+
+	/* Another host took the address */
+	s_conflict_ip = s_pool_ip;
+	s_bound_ip = 0;
+	s_pool_ip = ip4(192, 168, 2, 102);
+	boot("cached address in use", s_pool_ip);
+	CHECK((s_reboot_requests == 0) && (s_discovers >= 1));
+	s_conflict_ip = 0;
+
+	boot("cached lease ACKed again", s_pool_ip);
+	CHECK((s_reboot_requests == 1) && (s_discovers == 0));
+
+	/* Requests to a muted server are not counted */
+	s_server_mute_until = now_us() + 1500 * 1000;
+	boot("server silent for 1.5 s", s_pool_ip);
+	CHECK((s_reboot_requests == 1) && (s_discovers == 0));
+
+	if (s_errors != 0) {
+		printf("FAILED: %u errors\n", s_errors);
+		return EXIT_FAILURE;
+	}
+
+	puts("PASSED");
+	return EXIT_SUCCESS;
+}
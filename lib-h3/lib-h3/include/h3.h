@@ -785,7 +785,6 @@ extern "C" {
 #endif
 
 extern void udelay(uint32_t);
-extern void *h3_memcpy(void *__restrict__ dest, void const *__restrict__ src, size_t n);
 
 typedef enum H3_BOOT_DEVICE {
 	H3_BOOT_DEVICE_UNK,
@@ -41,6 +41,14 @@ struct ip_info {
     struct ip_addr gw;
 };
 
+struct dhcp_lease {
+    uint32_t ip;
+    uint32_t netmask;
+    uint32_t gw;
+    uint32_t server_ip;
+    uint32_t lease_time;	/* seconds */
+};
+
 #define IP_BROADCAST	((uint32_t) 0xFFFFFFFF)
 #define HOST_NAME_MAX 	64	/* including a terminating null byte. */
 
@@ -58,6 +66,16 @@ extern bool net_set_dhcp(struct ip_info *, bool *);
 extern bool net_set_zeroconf(struct ip_info *);
 //
 extern void net_dhcp_release(void);
+/*
+ * With a cached lease, net_init() probes the address, starts in INIT-REBOOT
+ * and returns with the cached address. The DHCPACK, or a full DISCOVER after
+ * a DHCPNAK, is handled in the background by net_handle(); the callback runs
+ * whenever a lease is bound there. A DHCPNAK also drops the address to 0.0.0.0
+ * until the next lease is bound; the callback then runs with no lease.
+ */
+extern void net_set_dhcp_lease(const struct dhcp_lease *);
+extern bool net_get_dhcp_lease(struct dhcp_lease *);
+extern void net_set_dhcp_callback(void (*)(void));
 //
 extern int udp_bind(uint16_t);
 extern int udp_unbind(uint16_t);
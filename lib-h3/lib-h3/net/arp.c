@@ -32,6 +32,8 @@
 #include "net_packets.h"
 #include "net_debug.h"
 
+#include "h3.h"
+
 #ifndef ALIGNED
 # define ALIGNED __attribute__ ((aligned (4)))
 #endif
@@ -45,6 +47,16 @@ static struct t_arp s_arp_announce ALIGNED;
 static struct t_arp s_arp_request ALIGNED ;
 static struct t_arp s_arp_reply ALIGNED;
 
+static uint32_t s_probe_ip;
+static volatile bool s_probe_conflict;
+
+/*
+ * RFC 5227 allows 3 probes spread over 1-2 seconds. This one is only used to
+ * re-use a cached DHCP lease, which the server confirms afterwards anyway.
+ */
+#define PROBE_NUM		2
+#define PROBE_WAIT_US	(25 * 1000)
+
 typedef union pcast32 {
 	uint32_t u32;
 	uint8_t u8[4];
@@ -76,6 +88,13 @@ void arp_handle_request(struct t_arp *p_arp) {
 
 	DEBUG_PRINTF("Sender "IPSTR" Target "IPSTR, IP2STR(p_arp->arp.sender_ip), IP2STR(target.u32));
 
+	if (__builtin_expect((s_probe_ip != 0), 0)) {
+		// Someone is using the address, or is probing for it as well
+		if ((p_arp->arp.sender_ip == s_probe_ip) || ((p_arp->arp.sender_ip == 0) && (target.u32 == s_probe_ip) && (memcmp(p_arp->arp.sender_mac, s_arp_request.arp.sender_mac, ETH_ADDR_LEN) != 0))) {
+			s_probe_conflict = true;
+		}
+	}
+
 	if (target.u32 != s_arp_announce.arp.sender_ip) {
 		DEBUG2_EXIT
 		return;
@@ -98,6 +117,10 @@ void arp_handle_request(struct t_arp *p_arp) {
 void arp_handle_reply(struct t_arp *p_arp) {
 	DEBUG2_ENTRY
 
+	if (__builtin_expect((s_probe_ip != 0), 0) && (p_arp->arp.sender_ip == s_probe_ip)) {
+		s_probe_conflict = true;
+	}
+
 	arp_cache_update(p_arp->arp.sender_mac, p_arp->arp.sender_ip);
 
 	DEBUG2_EXIT
@@ -174,6 +197,40 @@ void arp_send_request(uint32_t ip) {
 	DEBUG2_EXIT
 }
 
+/*
+ * ARP Probe: a request with sender IP 0.0.0.0, so that no ARP cache is updated.
+ * arp_init() must have been called. Returns true when the address is in use.
+ */
+bool arp_probe(uint32_t ip) {
+	DEBUG_ENTRY
+
+	const uint32_t sender_ip = s_arp_request.arp.sender_ip;
+	uint32_t i;
+
+	s_probe_ip = ip;
+	s_probe_conflict = false;
+
+	s_arp_request.arp.sender_ip = 0;
+	s_arp_request.arp.target_ip = ip;
+
+	for (i = 0; (i < PROBE_NUM) && !s_probe_conflict; i++) {
+		emac_eth_send((void *)&s_arp_request, sizeof(struct t_arp));
+
+		const uint32_t micros_stamp = H3_TIMER->AVS_CNT1;
+
+		while (!s_probe_conflict && ((H3_TIMER->AVS_CNT1 - micros_stamp) < PROBE_WAIT_US)) {
+			net_handle();
+		}
+	}
+
+	s_arp_request.arp.sender_ip = sender_ip;
+	s_probe_ip = 0;
+
+	DEBUG_PRINTF(IPSTR " %s", IP2STR(ip), s_probe_conflict ? "in use" : "free");
+	DEBUG_EXIT
+	return s_probe_conflict;
+}
+
 void arp_handle(struct t_arp *p_arp) {
 	DEBUG1_ENTRY
 
@@ -41,6 +41,9 @@
  #define ALIGNED __attribute__ ((aligned (4)))
 #endif
 
+extern void net_dhcp_bound(const struct dhcp_lease *);
+extern void net_dhcp_unbound(void);
+
 typedef union pcast32 {
 	uint32_t u32;
 	uint8_t u8[4];
@@ -74,6 +77,7 @@ enum OPTIONS {
 	OPTIONS_HOSTNAME = 12,
 	OPTIONS_DOMAIN_NAME = 15,
 	OPTIONS_REQUESTED_IP = 50,
+	OPTIONS_LEASE_TIME = 51,
 	OPTIONS_MESSAGE_TYPE = 53,
 	OPTIONS_SERVER_IDENTIFIER = 54,
 	OPTIONS_PARAM_REQUEST = 55,
@@ -83,12 +87,28 @@ enum OPTIONS {
 	OPTIONS_END_OPTION = 255
 };
 
+/*
+ * Retransmission intervals of the background client, see dhcp_client_timer()
+ */
+#define REBOOT_RETRIES			3
+#define REBOOT_TIMEOUT_US		(1000 * 1000)
+#define REQUEST_RETRIES			4
+#define DISCOVER_TIMEOUT_US		(2000 * 1000)
+
 static struct t_dhcp_message s_dhcp_message ALIGNED;
 
 static uint8_t s_dhcp_server_ip[IPv4_ADDR_LEN] ALIGNED = { 0, };
 static uint8_t s_dhcp_allocated_ip[IPv4_ADDR_LEN] ALIGNED = { 0, };
 static uint8_t s_dhcp_allocated_gw[IPv4_ADDR_LEN] ALIGNED = { 0, };
 static uint8_t s_dhcp_allocated_netmask[IPv4_ADDR_LEN] ALIGNED = { 0, };
+static uint32_t s_dhcp_lease_time;
+
+static uint8_t s_mac_address[ETH_ADDR_LEN] ALIGNED;
+static const uint8_t *s_hostname;
+static enum DHCP_STATE s_state = DHCP_STATE_DHCP_STOP;
+static int s_idx;
+static uint32_t s_retries;
+static uint32_t s_micros_timeout;
 
 static void _message_init(const uint8_t *mac_address) {
 	uint32_t i;
@@ -145,7 +165,11 @@ static void _send_discover(int idx, const uint8_t *mac_address) {
 	DEBUG_EXIT
 }
 
-static void _send_request(int idx, const uint8_t *mac_address, const uint8_t *hostname) {
+/*
+ * In the INIT-REBOOT state the Server Identifier option must not be sent,
+ * the Requested IP Address option is the cached address (RFC 2131, 4.3.2).
+ */
+static void _send_request(int idx, const uint8_t *mac_address, const uint8_t *hostname, bool init_reboot) {
 	DEBUG_ENTRY
 
 	uint32_t i;
@@ -170,12 +194,14 @@ static void _send_request(int idx, const uint8_t *mac_address, const uint8_t *ho
 	s_dhcp_message.options[k++] = s_dhcp_allocated_ip[2];
 	s_dhcp_message.options[k++] = s_dhcp_allocated_ip[3];
 
-	s_dhcp_message.options[k++] = OPTIONS_SERVER_IDENTIFIER;
-	s_dhcp_message.options[k++] = 0x04;
-	s_dhcp_message.options[k++] = s_dhcp_server_ip[0];
-	s_dhcp_message.options[k++] = s_dhcp_server_ip[1];
-	s_dhcp_message.options[k++] = s_dhcp_server_ip[2];
-	s_dhcp_message.options[k++] = s_dhcp_server_ip[3];
+	if (!init_reboot) {
+		s_dhcp_message.options[k++] = OPTIONS_SERVER_IDENTIFIER;
+		s_dhcp_message.options[k++] = 0x04;
+		s_dhcp_message.options[k++] = s_dhcp_server_ip[0];
+		s_dhcp_message.options[k++] = s_dhcp_server_ip[1];
+		s_dhcp_message.options[k++] = s_dhcp_server_ip[2];
+		s_dhcp_message.options[k++] = s_dhcp_server_ip[3];
+	}
 
 	s_dhcp_message.options[k++] = OPTIONS_HOSTNAME;
 	s_dhcp_message.options[k++] = 0; // length of hostname
@@ -199,94 +225,110 @@ static void _send_request(int idx, const uint8_t *mac_address, const uint8_t *ho
 	DEBUG_EXIT
 }
 
-static int _parse_response(int idx, const uint8_t *mac_address) {
-	struct t_dhcp_message response;
-	uint16_t size = 0;
+static int _parse_message(const struct t_dhcp_message *response, uint16_t size) {
+	uint8_t type = 0;
+	uint8_t opt_len = 0;
 
-	const uint32_t micros_stamp = H3_TIMER->AVS_CNT1;
+	const uint8_t *p = (const uint8_t *) response;
+	p = p + sizeof(struct t_dhcp_message) - DHCP_OPT_SIZE + 4;
+	const uint8_t *e = (const uint8_t *) response + size;
 
-	do {
-		net_handle();
+	while (p < e) {
+		switch (*p) {
+		case OPTIONS_END_OPTION:
+			p = e;
+			break;
+		case OPTIONS_PAD_OPTION:
+			p++;
+			break;
+		case OPTIONS_MESSAGE_TYPE:
+			p++;
+			p++;
+			type = *p++;
+			break;
+		case OPTIONS_SUBNET_MASK:
+			p++;
+			p++;
+			s_dhcp_allocated_netmask[0] = *p++;
+			s_dhcp_allocated_netmask[1] = *p++;
+			s_dhcp_allocated_netmask[2] = *p++;
+			s_dhcp_allocated_netmask[3] = *p++;
+			break;
+		case OPTIONS_ROUTERS_ON_SUBNET:
+			p++;
+			opt_len = *p++;
+			s_dhcp_allocated_gw[0] = *p++;
+			s_dhcp_allocated_gw[1] = *p++;
+			s_dhcp_allocated_gw[2] = *p++;
+			s_dhcp_allocated_gw[3] = *p++;
+			p = p + (opt_len - 4);
+			break;
+		case OPTIONS_LEASE_TIME:
+			p++;
+			p++;
+			s_dhcp_lease_time = ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | (uint32_t) p[3];
+			p += 4;
+			break;
+		case OPTIONS_SERVER_IDENTIFIER :
+			p++;
+			opt_len = *p++;
+			s_dhcp_server_ip[0] = *p++;
+			s_dhcp_server_ip[1] = *p++;
+			s_dhcp_server_ip[2] = *p++;
+			s_dhcp_server_ip[3] = *p++;
+			break;
+		default:
+			p++;
+			opt_len = *p++;
+			p += opt_len;
+			break;
+		}
+	}
 
-		uint32_t from_ip;
-		uint16_t from_port;
+	if ((type == DCHP_TYPE_OFFER) || (type == DCHP_TYPE_ACK)) {
+		s_dhcp_allocated_ip[0] = response->yiaddr[0];
+		s_dhcp_allocated_ip[1] = response->yiaddr[1];
+		s_dhcp_allocated_ip[2] = response->yiaddr[2];
+		s_dhcp_allocated_ip[3] = response->yiaddr[3];
+	}
 
-		size = udp_recv(idx, (uint8_t *)&response, sizeof(struct t_dhcp_message), &from_ip, &from_port);
+	return type;
+}
 
-		if ((size > 0) && (from_port == DHCP_PORT_SERVER)) {
-			if (memcmp(response.chaddr, mac_address, ETH_ADDR_LEN) == 0) {
-				break;
-			}
+/*
+ * Non-blocking, returns the type of the first queued message for this client, or -1
+ */
+static int _poll_response(int idx, const uint8_t *mac_address) {
+	struct t_dhcp_message response;
+	uint16_t size;
+	uint32_t from_ip;
+	uint16_t from_port;
+
+	while ((size = udp_recv(idx, (uint8_t *)&response, sizeof(struct t_dhcp_message), &from_ip, &from_port)) > 0) {
+		if ((from_port == DHCP_PORT_SERVER) && (memcmp(response.chaddr, mac_address, ETH_ADDR_LEN) == 0)) {
+			return _parse_message(&response, size);
 		}
-	} while ((H3_TIMER->AVS_CNT1 - micros_stamp) < (500 * 1000));
+	}
 
-	DEBUG_PRINTF("timeout %u", H3_TIMER->AVS_CNT1 - micros_stamp);
+	return -1;
+}
 
-	uint8_t type = 0;
-	uint8_t opt_len = 0;
+static int _parse_response(int idx, const uint8_t *mac_address) {
+	int type;
 
-	if (size > 0) {
-		uint8_t *p = (uint8_t *) &response;
-		p = p + sizeof(struct t_dhcp_message) - DHCP_OPT_SIZE + 4;
-		uint8_t *e = (uint8_t *) &response + size;
-
-		while (p < e) {
-			switch (*p) {
-			case OPTIONS_END_OPTION:
-				p = e;
-				break;
-			case OPTIONS_PAD_OPTION:
-				p++;
-				break;
-			case OPTIONS_MESSAGE_TYPE:
-				p++;
-				p++;
-				type = *p++;
-				break;
-   			case OPTIONS_SUBNET_MASK:
-   				p++;
-   				p++;
-   				s_dhcp_allocated_netmask[0] = *p++;
-   				s_dhcp_allocated_netmask[1] = *p++;
-   				s_dhcp_allocated_netmask[2] = *p++;
-   				s_dhcp_allocated_netmask[3] = *p++;
-   				break;
-   			case OPTIONS_ROUTERS_ON_SUBNET:
-   				p++;
-   				opt_len = *p++;
-   				s_dhcp_allocated_gw[0] = *p++;
-   				s_dhcp_allocated_gw[1] = *p++;
-   				s_dhcp_allocated_gw[2] = *p++;
-   				s_dhcp_allocated_gw[3] = *p++;
-   				p = p + (opt_len - 4);
-   				break;
-   			case OPTIONS_SERVER_IDENTIFIER :
-   				p++;
-   				opt_len = *p++;
-   				s_dhcp_server_ip[0] = *p++;
-   				s_dhcp_server_ip[1] = *p++;
-   				s_dhcp_server_ip[2] = *p++;
-   				s_dhcp_server_ip[3] = *p++;
-   				break;
-			default:
-				p++;
-				opt_len = *p++;
-				p += opt_len;
-				break;
-			}
-		}
+	const uint32_t micros_stamp = H3_TIMER->AVS_CNT1;
 
-		if (type == DCHP_TYPE_OFFER) {
-            s_dhcp_allocated_ip[0] = response.yiaddr[0];
-            s_dhcp_allocated_ip[1] = response.yiaddr[1];
-            s_dhcp_allocated_ip[2] = response.yiaddr[2];
-            s_dhcp_allocated_ip[3] = response.yiaddr[3];
+	do {
+		net_handle();
+
+		if ((type = _poll_response(idx, mac_address)) >= 0) {
+			break;
 		}
+	} while ((H3_TIMER->AVS_CNT1 - micros_stamp) < (500 * 1000));
 
-		return type;
-	}
+	DEBUG_PRINTF("timeout %u", H3_TIMER->AVS_CNT1 - micros_stamp);
 
-	return -1;
+	return type;
 }
 
 int dhcp_client(const uint8_t *mac_address, struct ip_info  *p_ip_info, const uint8_t *hostname) {
@@ -295,6 +337,8 @@ int dhcp_client(const uint8_t *mac_address, struct ip_info  *p_ip_info, const ui
 	bool have_ip = false;
 	int32_t retries = 20;
 
+	s_state = DHCP_STATE_DHCP_STOP;	// This blocking client is in charge now
+
 	_message_init(mac_address);
 
 	int idx = udp_bind(DHCP_PORT_CLIENT);
@@ -322,7 +366,7 @@ int dhcp_client(const uint8_t *mac_address, struct ip_info  *p_ip_info, const ui
 
 		DEBUG_PRINTF(IPSTR, s_dhcp_server_ip[0],s_dhcp_server_ip[1],s_dhcp_server_ip[2],s_dhcp_server_ip[3]);
 
-		_send_request(idx, mac_address, hostname);
+		_send_request(idx, mac_address, hostname, false);
 
 		if ((type =_parse_response(idx, mac_address)) < 0) {
 			continue;
@@ -349,15 +393,163 @@ int dhcp_client(const uint8_t *mac_address, struct ip_info  *p_ip_info, const ui
 
 		memcpy(ip.u8, s_dhcp_allocated_netmask, IPv4_ADDR_LEN);
 		p_ip_info->netmask.addr = ip.u32;
+	} else {
+		memset(s_dhcp_allocated_ip, 0, IPv4_ADDR_LEN);
 	}
 
 	DEBUG_EXIT
 	return have_ip ? 0 : -2;
 }
 
+/*
+ * Starts from the INIT-REBOOT state with a cached lease and returns at once.
+ * The caller keeps using the cached address; dhcp_client_timer() waits for
+ * the DHCPACK and falls back to a full DISCOVER on DHCPNAK or timeout.
+ */
+void dhcp_client_reboot(const uint8_t *mac_address, const struct dhcp_lease *p_lease, const uint8_t *hostname) {
+	DEBUG_ENTRY
+
+	_pcast32 ip;
+
+	ip.u32 = p_lease->ip;
+	memcpy(s_dhcp_allocated_ip, ip.u8, IPv4_ADDR_LEN);
+	ip.u32 = p_lease->netmask;
+	memcpy(s_dhcp_allocated_netmask, ip.u8, IPv4_ADDR_LEN);
+	ip.u32 = p_lease->gw;
+	memcpy(s_dhcp_allocated_gw, ip.u8, IPv4_ADDR_LEN);
+	ip.u32 = p_lease->server_ip;
+	memcpy(s_dhcp_server_ip, ip.u8, IPv4_ADDR_LEN);
+	s_dhcp_lease_time = p_lease->lease_time;
+
+	memcpy(s_mac_address, mac_address, ETH_ADDR_LEN);
+	s_hostname = hostname;
+
+	_message_init(mac_address);
+
+	s_idx = udp_bind(DHCP_PORT_CLIENT);
+
+	if (s_idx < 0) {
+		s_state = DHCP_STATE_DHCP_STOP;
+		DEBUG_EXIT
+		return;
+	}
+
+	_send_request(s_idx, s_mac_address, s_hostname, true);
+
+	s_state = DHCP_STATE_DHCP_REREQUEST;
+	s_retries = REBOOT_RETRIES;
+	s_micros_timeout = H3_TIMER->AVS_CNT1 + REBOOT_TIMEOUT_US;
+
+	DEBUG_EXIT
+}
+
+bool dhcp_client_get_lease(struct dhcp_lease *p_lease) {
+	_pcast32 ip;
+
+	memcpy(ip.u8, s_dhcp_allocated_ip, IPv4_ADDR_LEN);
+	p_lease->ip = ip.u32;
+	memcpy(ip.u8, s_dhcp_allocated_netmask, IPv4_ADDR_LEN);
+	p_lease->netmask = ip.u32;
+	memcpy(ip.u8, s_dhcp_allocated_gw, IPv4_ADDR_LEN);
+	p_lease->gw = ip.u32;
+	memcpy(ip.u8, s_dhcp_server_ip, IPv4_ADDR_LEN);
+	p_lease->server_ip = ip.u32;
+	p_lease->lease_time = s_dhcp_lease_time;
+
+	return p_lease->ip != 0;
+}
+
+static void _start_discover(void) {
+	DEBUG_PUTS("");
+
+	s_state = DHCP_STATE_DHCP_DISCOVER;
+	s_retries = 0;
+	s_micros_timeout = H3_TIMER->AVS_CNT1 + DISCOVER_TIMEOUT_US;
+
+	_send_discover(s_idx, s_mac_address);
+}
+
+static void _bound(void) {
+	struct dhcp_lease lease;
+
+	udp_unbind(DHCP_PORT_CLIENT);
+	s_state = DHCP_STATE_DHCP_LEASED;
+
+	dhcp_client_get_lease(&lease);
+	net_dhcp_bound(&lease);
+}
+
+/*
+ * RFC 2131 3.2: after a DHCPNAK the address may no longer be used
+ */
+static void _nak(void) {
+	memset(s_dhcp_allocated_ip, 0, IPv4_ADDR_LEN);
+	net_dhcp_unbound();
+	_start_discover();
+}
+
+/*
+ * Called from net_timers_run(), every 100 msec
+ */
+void dhcp_client_timer(void) {
+	if (__builtin_expect((s_state == DHCP_STATE_DHCP_STOP) || (s_state == DHCP_STATE_DHCP_LEASED), 1)) {
+		return;
+	}
+
+	const int type = _poll_response(s_idx, s_mac_address);
+	const bool is_timeout = ((int32_t) (H3_TIMER->AVS_CNT1 - s_micros_timeout) >= 0);
+
+	switch (s_state) {
+	case DHCP_STATE_DHCP_REREQUEST:
+		if (type == DCHP_TYPE_ACK) {
+			_bound();
+		} else if (type == DCHP_TYPE_NAK) {
+			DEBUG_PUTS("DHCPNAK for the cached lease");
+			_nak();
+		} else if (is_timeout) {
+			if (s_retries-- == 0) {
+				_start_discover();
+			} else {
+				_send_request(s_idx, s_mac_address, s_hostname, true);
+				s_micros_timeout = H3_TIMER->AVS_CNT1 + REBOOT_TIMEOUT_US;
+			}
+		}
+		break;
+	case DHCP_STATE_DHCP_DISCOVER:
+		if (type == DCHP_TYPE_OFFER) {
+			_send_request(s_idx, s_mac_address, s_hostname, false);
+			s_state = DHCP_STATE_DHCP_REQUEST;
+			s_retries = REQUEST_RETRIES;
+			s_micros_timeout = H3_TIMER->AVS_CNT1 + DISCOVER_TIMEOUT_US;
+		} else if (is_timeout) {
+			_send_discover(s_idx, s_mac_address);
+			s_micros_timeout = H3_TIMER->AVS_CNT1 + DISCOVER_TIMEOUT_US;
+		}
+		break;
+	case DHCP_STATE_DHCP_REQUEST:
+		if (type == DCHP_TYPE_ACK) {
+			_bound();
+		} else if (type == DCHP_TYPE_NAK) {
+			_nak();
+		} else if (is_timeout) {
+			if (s_retries-- == 0) {
+				_start_discover();
+			} else {
+				_send_request(s_idx, s_mac_address, s_hostname, false);
+				s_micros_timeout = H3_TIMER->AVS_CNT1 + DISCOVER_TIMEOUT_US;
+			}
+		}
+		break;
+	default:
+		break;
+	}
+}
+
 void dhcp_client_release(void) {
 	DEBUG_ENTRY
 
+	s_state = DHCP_STATE_DHCP_STOP;
+
 	int idx = udp_bind(DHCP_PORT_CLIENT);
 
 	uint32_t k = 6;
@@ -377,5 +569,7 @@ void dhcp_client_release(void) {
 
 	udp_unbind(DHCP_PORT_CLIENT);
 
+	memset(s_dhcp_allocated_ip, 0, IPv4_ADDR_LEN);
+
 	DEBUG_EXIT
 }
@@ -38,6 +38,7 @@
 static struct t_icmp s_reply ALIGNED;
 
 extern uint16_t net_chksum(void*, uint32_t);
+extern uint16_t net_chksum_adjust(uint16_t, uint16_t, uint16_t);
 extern void emac_eth_send(void*, int);
 
 typedef union pcast32 {
@@ -94,8 +95,11 @@ void icmp_handle(struct t_icmp *p_icmp) {
 
 			memcpy(s_reply.icmp.payload, p_icmp->icmp.payload, payload_size);
 
-			s_reply.icmp.checksum = 0;
-			s_reply.icmp.checksum = net_chksum((void *)&s_reply.ip4, (uint32_t)__builtin_bswap16(p_icmp->ip4.len));
+			// Only the type has changed, so adjust the checksum of the request (RFC 1624)
+			const uint16_t echo = (uint16_t) (ICMP_TYPE_ECHO | (ICMP_CODE_ECHO << 8));
+			const uint16_t echo_reply = (uint16_t) (ICMP_TYPE_ECHO_REPLY | (ICMP_CODE_ECHO << 8));
+
+			s_reply.icmp.checksum = net_chksum_adjust(p_icmp->icmp.checksum, echo, echo_reply);
 
 			debug_dump(&s_reply, sizeof(struct ether_packet) + __builtin_bswap16(p_icmp->ip4.len));
 
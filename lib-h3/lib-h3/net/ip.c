@@ -31,6 +31,9 @@
 #include "net_debug.h"
 
 #if defined(DO_NET_CHKSUM)
+# include <stdio.h>
+# include <assert.h>
+
  extern uint16_t net_chksum(void *, uint32_t);
 #endif
 
@@ -79,7 +82,7 @@ void ip_handle(struct t_ip4 *p_ip4) {
 
 #if defined(DO_NET_CHKSUM)
 	uint16_t chksum;
-	// Really needed, doesn't do EMAC this job?
+	// The EMAC is already dropping frames with a wrong IPv4 header checksum
 	if ((chksum = net_chksum((void *) &p_ip4->ip4, sizeof(p_ip4->ip4))) != 0) {
 		printf("chksum=%d\n", chksum);
 		assert(0);
@@ -39,6 +39,7 @@ extern void net_timers_init(void);
 extern void net_timers_run(void);
 
 extern void arp_init(const uint8_t *, const struct ip_info  *);
+extern bool arp_probe(uint32_t);
 extern void arp_handle(struct t_arp *);
 
 extern void ip_init(const uint8_t *, const struct ip_info  *);
@@ -48,6 +49,8 @@ extern void ip_shutdown(void);
 
 extern int dhcp_client(const uint8_t *, struct ip_info *, const uint8_t *);
 extern void dhcp_client_release(void);
+extern void dhcp_client_reboot(const uint8_t *, const struct dhcp_lease *, const uint8_t *);
+extern bool dhcp_client_get_lease(struct dhcp_lease *);
 
 extern void rfc3927_init(const uint8_t *mac_address);
 extern bool rfc3927(struct ip_info *p_ip_info);
@@ -57,6 +60,36 @@ static uint8_t s_mac_address[ETH_ADDR_LEN] __attribute__ ((aligned (4)));
 static char s_hostname[HOST_NAME_MAX] __attribute__ ((aligned (4))); /* including a terminating null byte. */
 static uint8_t *s_p __attribute__ ((aligned (4)));
 static bool s_is_dhcp = false;
+static struct dhcp_lease s_dhcp_lease __attribute__ ((aligned (4)));
+static void (*s_dhcp_callback)(void);
+
+/*
+ * Fast boot: RFC 5227 probe for the cached address, then INIT-REBOOT
+ * without waiting for the server.
+ */
+static bool _dhcp_init_reboot(const uint8_t *mac_address, struct ip_info *p_ip_info) {
+	if (s_dhcp_lease.ip == 0) {
+		return false;
+	}
+
+	const struct ip_info probe_info = { .ip.addr = 0, .netmask.addr = 0, .gw.addr = 0 };
+
+	arp_init(mac_address, &probe_info);	// ARP requests have sender IP 0.0.0.0 now
+
+	if (arp_probe(s_dhcp_lease.ip)) {
+		DEBUG_PUTS("Cached DHCP address is in use");
+		s_dhcp_lease.ip = 0;
+		return false;
+	}
+
+	dhcp_client_reboot(mac_address, &s_dhcp_lease, (const uint8_t *)s_hostname);
+
+	p_ip_info->ip.addr = s_dhcp_lease.ip;
+	p_ip_info->netmask.addr = s_dhcp_lease.netmask;
+	p_ip_info->gw.addr = s_dhcp_lease.gw;
+
+	return true;
+}
 
 void __attribute__((cold)) net_init(const uint8_t *mac_address, struct ip_info *p_ip_info, const uint8_t *hostname, bool *use_dhcp, bool *is_zeroconf_used) {
 	uint32_t i;
@@ -68,7 +101,7 @@ void __attribute__((cold)) net_init(const uint8_t *mac_address, struct ip_info *
 
 	*is_zeroconf_used = false;
 
-	if (*use_dhcp) {
+	if (*use_dhcp && !_dhcp_init_reboot(mac_address, p_ip_info)) {
 		if (dhcp_client(mac_address, p_ip_info, (const uint8_t *)s_hostname) < 0) {
 			*use_dhcp = false;
 			DEBUG_PUTS("DHCP Client failed");
@@ -144,6 +177,65 @@ void net_dhcp_release(void) {
 	s_is_dhcp = false;
 }
 
+void net_set_dhcp_lease(const struct dhcp_lease *p_lease) {
+	s_dhcp_lease = *p_lease;
+}
+
+bool net_get_dhcp_lease(struct dhcp_lease *p_lease) {
+	if (!s_is_dhcp) {
+		return false;
+	}
+
+	return dhcp_client_get_lease(p_lease);
+}
+
+void net_set_dhcp_callback(void (*callback)(void)) {
+	s_dhcp_callback = callback;
+}
+
+/*
+ * Called by the background DHCP client
+ */
+void net_dhcp_bound(const struct dhcp_lease *p_lease) {
+	const bool is_changed = (p_lease->ip != s_ip_info.ip.addr) || (p_lease->netmask != s_ip_info.netmask.addr);
+
+	s_ip_info.ip.addr = p_lease->ip;
+	s_ip_info.netmask.addr = p_lease->netmask;
+	s_ip_info.gw.addr = p_lease->gw;
+
+	if (is_changed) {
+		arp_init(s_mac_address, &s_ip_info);
+		ip_set_ip(&s_ip_info);
+	}
+
+	s_is_dhcp = true;
+
+	if (s_dhcp_callback != 0) {
+		s_dhcp_callback();
+	}
+}
+
+/*
+ * Called by the background DHCP client after a DHCPNAK. The stack runs
+ * on 0.0.0.0 until the next lease is bound.
+ */
+void net_dhcp_unbound(void) {
+	if (s_ip_info.ip.addr == 0) {
+		return;
+	}
+
+	s_ip_info.ip.addr = 0;
+	s_ip_info.netmask.addr = 0;
+	s_ip_info.gw.addr = 0;
+
+	arp_init(s_mac_address, &s_ip_info);
+	ip_set_ip(&s_ip_info);
+
+	if (s_dhcp_callback != 0) {
+		s_dhcp_callback();
+	}
+}
+
 bool net_set_zeroconf(struct ip_info *p_ip_info) {
 	const bool b = rfc3927(&s_ip_info);
 
@@ -25,28 +25,112 @@
 
 #include <stdint.h>
 
-uint16_t net_chksum(void *data, uint32_t len) {
-	uint32_t sum;
-	uint16_t *ptr;
+/*
+ * RFC 1071 Internet checksum.
+ *
+ * The data is summed as 32-bit words into a 64-bit accumulator, 32 bytes per
+ * iteration. The carries are collected in the upper half and folded back at
+ * the end, so there is no per-word carry handling in the inner loop.
+ * The sum is computed in host byte order, which is fine as the one's complement
+ * sum is byte order independent (RFC 1071, 2.(B)).
+ */
+
+static inline uint32_t _fold64(uint64_t sum) {
+	sum = (sum >> 32) + (sum & 0xFFFFFFFF);
+	sum = (sum >> 32) + (sum & 0xFFFFFFFF);
+	return (uint32_t) sum;
+}
 
-	ptr = (uint16_t *) data;
-	sum = 0;
+static inline uint16_t _fold32(uint32_t sum) {
+	sum = (sum >> 16) + (sum & 0xFFFF);
+	sum = (sum >> 16) + (sum & 0xFFFF);
+	return (uint16_t) sum;
+}
+
+/**
+ * Partial (not complemented) checksum, which can be chained.
+ * All chained blocks, except the last one, must have an even length.
+ */
+uint32_t net_chksum_partial(uint32_t sum, const void *data, uint32_t len) {
+	const uint8_t *p = (const uint8_t *) data;
+	uint64_t acc = 0;
+	uint32_t t = 0;
+	const uint32_t odd = (uint32_t) ((uintptr_t) p & 1);
 
-	while (len > 1) {
-		sum += *ptr;
-		ptr++;
+	if (len == 0) {
+		return sum;
+	}
+
+	/* Align to 16-bit, the first byte is the high byte of a swapped word */
+	if (odd) {
+		t = (uint32_t) *p++ << 8;
+		len--;
+	}
+
+	/* Align to 32-bit */
+	if (((uintptr_t) p & 2) && (len >= 2)) {
+		acc += *(const uint16_t *) p;
+		p += 2;
+		len -= 2;
+	}
+
+	const uint32_t *p32 = (const uint32_t *) p;
+
+	while (len >= 32) {
+		acc += p32[0];
+		acc += p32[1];
+		acc += p32[2];
+		acc += p32[3];
+		acc += p32[4];
+		acc += p32[5];
+		acc += p32[6];
+		acc += p32[7];
+		p32 += 8;
+		len -= 32;
+	}
+
+	while (len >= 4) {
+		acc += *p32++;
+		len -= 4;
+	}
+
+	p = (const uint8_t *) p32;
+
+	if (len >= 2) {
+		acc += *(const uint16_t *) p;
+		p += 2;
 		len -= 2;
 	}
 
 	/* Add left-over byte, if any */
 	if (len > 0) {
-		sum += __builtin_bswap16((*((uint8_t *) ptr) << 8));
+		t |= *p;
 	}
 
-	/* Fold 32-bit sum into 16 bits */
-	while (sum >> 16) {
-		sum = (sum >> 16) + (sum & 0xFFFF);
+	acc += t;
+
+	uint32_t s = _fold32(_fold64(acc));
+
+	if (odd) {
+		s = __builtin_bswap16((uint16_t) s);
 	}
 
-	return (~sum);
+	return _fold32(_fold64((uint64_t) s + sum));
+}
+
+uint16_t net_chksum_fold(uint32_t sum) {
+	return (uint16_t) ~_fold32(sum);
+}
+
+uint16_t net_chksum(void *data, uint32_t len) {
+	return net_chksum_fold(net_chksum_partial(0, data, len));
+}
+
+/**
+ * Incremental update, RFC 1624 eqn. 3: HC' = ~(~HC + ~m + m')
+ * All values as they are in the packet (network byte order).
+ */
+uint16_t net_chksum_adjust(uint16_t chksum, uint16_t old_value, uint16_t new_value) {
+	const uint32_t sum = (uint32_t) (uint16_t) ~chksum + (uint32_t) (uint16_t) ~old_value + new_value;
+	return net_chksum_fold(sum);
 }
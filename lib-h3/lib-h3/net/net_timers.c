@@ -28,6 +28,7 @@
 #include "h3.h"
 
 extern void igmp_timer(void);
+extern void dhcp_client_timer(void);
 #ifndef NDEBUG
  extern void arp_cache_timer(void);
 #endif
@@ -46,6 +47,7 @@ void net_timers_run(void) {
 	if (__builtin_expect((micros_now >= s_ticker), 0)) {
 		s_ticker = micros_now + INTERVAL_US;
 		igmp_timer();
+		dhcp_client_timer();
 #ifndef NDEBUG
 		arp_cache_timer();
 #endif
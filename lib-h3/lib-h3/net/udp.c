@@ -39,6 +39,8 @@
 
 #include "h3.h"
 
+#include "arm/memfunc.h"
+
 extern int console_error(const char *);
 
 #ifndef ALIGNED
@@ -51,7 +53,10 @@ extern int console_error(const char *);
 
 extern void emac_eth_send(void *, int);
 extern uint32_t arp_cache_lookup(uint32_t, uint8_t *);
-extern uint16_t net_chksum(void *, uint32_t);
+#if defined(DO_NET_CHKSUM)
+ extern uint32_t net_chksum_partial(uint32_t, const void *, uint32_t);
+ extern uint16_t net_chksum_fold(uint32_t);
+#endif
 
 #define MAX_PORTS_ALLOWED	16
 #define MAX_ENTRIES			(1 << 2) // Must always be a power of 2
@@ -120,6 +125,33 @@ void __attribute__((cold)) udp_shutdown(void) {
 	DEBUG1_EXIT
 }
 
+#if defined(DO_NET_CHKSUM)
+/*
+ * The EMAC is already dropping frames with a wrong UDP checksum.
+ * This is for verifying the checksum offload only.
+ */
+static bool _udp_chksum_valid(const struct t_udp *p_udp) {
+	if (p_udp->udp.checksum == 0) { // No checksum has been generated by the transmitter
+		return true;
+	}
+
+	const uint32_t udp_length = __builtin_bswap16(p_udp->udp.len);
+
+	if (udp_length > sizeof(struct t_udp_packet)) { // Not all of the datagram is in the receive buffer
+		return true;
+	}
+
+	// Pseudo header
+	uint32_t sum = net_chksum_partial(0, p_udp->ip4.src, 2 * IPv4_ADDR_LEN);
+	sum += __builtin_bswap16(IPv4_PROTO_UDP);
+	sum += p_udp->udp.len;
+
+	sum = net_chksum_partial(sum, &p_udp->udp, udp_length);
+
+	return net_chksum_fold(sum) == 0;
+}
+#endif
+
 void udp_handle(struct t_udp *p_udp) {
 	uint32_t port_index;
 	_pcast32 src;
@@ -146,7 +178,21 @@ void udp_handle(struct t_udp *p_udp) {
 		return;
 	}
 
-	const uint32_t entry = s_recv_queue[port_index].queue_tail;
+#if defined(DO_NET_CHKSUM)
+	if (__builtin_expect((!_udp_chksum_valid(p_udp)), 0)) {
+		DEBUG_PRINTF(IPSTR ":%d checksum error", p_udp->ip4.src[0],p_udp->ip4.src[1],p_udp->ip4.src[2],p_udp->ip4.src[3], dest_port);
+		return;
+	}
+#endif
+
+	const uint32_t entry = s_recv_queue[port_index].queue_head;
+	const uint32_t next = (entry + 1) & MAX_ENTRIES_MASK;
+
+	if (__builtin_expect((next == s_recv_queue[port_index].queue_tail), 0)) {
+		DEBUG_PRINTF(IPSTR ":%d queue full", p_udp->ip4.src[0],p_udp->ip4.src[1],p_udp->ip4.src[2],p_udp->ip4.src[3], dest_port);
+		return;
+	}
+
 	struct queue_entry *p_queue_entry = &s_recv_queue[port_index].entries[entry];
 
 	const uint32_t data_length = __builtin_bswap16(p_udp->udp.len) - UDP_HEADER_SIZE;
@@ -155,14 +201,14 @@ void udp_handle(struct t_udp *p_udp) {
 
 	i = MIN(FRAME_BUFFER_SIZE, data_length);
 
-	h3_memcpy(p_queue_entry->data, p_udp->udp.data, i);
+	arm_memcpy(p_queue_entry->data, p_udp->udp.data, i);
 
 	memcpy(src.u8, p_udp->ip4.src, IPv4_ADDR_LEN);
 	p_queue_entry->from_ip = src.u32;
 	p_queue_entry->from_port = __builtin_bswap16(p_udp->udp.source_port);
 	p_queue_entry->size = i;
 
-	s_recv_queue[port_index].queue_head = (s_recv_queue[port_index].queue_head + 1) & MAX_ENTRIES_MASK;
+	s_recv_queue[port_index].queue_head = next;
 }
 
 // -->
@@ -222,7 +268,7 @@ uint16_t udp_recv(uint8_t idx, uint8_t *packet, uint16_t size, uint32_t *from_ip
 
 	const uint16_t i = MIN(size, p_queue_entry->size);
 
-	h3_memcpy(packet, p_queue_entry->data, i);
+	arm_memcpy(packet, p_queue_entry->data, i);
 
 	*from_ip = p_queue_entry->from_ip;
 	*from_port = p_queue_entry->from_port;
@@ -266,15 +312,16 @@ int udp_send(uint8_t idx, const uint8_t *packet, uint16_t size, uint32_t to_ip,
 	//IPv4
 	s_send_packet.ip4.id = s_id;
 	s_send_packet.ip4.len = __builtin_bswap16(size + IPv4_UDP_HEADERS_SIZE);
+	// The IPv4 header checksum and the UDP checksum are inserted by the EMAC
 	s_send_packet.ip4.chksum = 0;
-	s_send_packet.ip4.chksum = net_chksum((void *) &s_send_packet.ip4, (uint32_t) sizeof(s_send_packet.ip4));
 
 	//UDP
 	s_send_packet.udp.source_port = __builtin_bswap16(s_ports_allowed[idx]);
 	s_send_packet.udp.destination_port = __builtin_bswap16(remote_port);
 	s_send_packet.udp.len = __builtin_bswap16(size + UDP_HEADER_SIZE);
+	s_send_packet.udp.checksum = 0;
 
-	h3_memcpy(s_send_packet.udp.data, packet, MIN(FRAME_BUFFER_SIZE, size));
+	arm_memcpy(s_send_packet.udp.data, packet, MIN(FRAME_BUFFER_SIZE, size));
 
 	// debug_dump( &s_send_packet, size + UDP_PACKET_HEADERS_SIZE);
 
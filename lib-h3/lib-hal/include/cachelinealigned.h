@@ -1,8 +1,8 @@
 /**
- * @file h3_memcpy.h
+ * @file cachelinealigned.h
  *
  */
-/* Copyright (C) 2019 by Arjan van Vught mailto:info@orangepi-dmx.nl
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -23,40 +23,30 @@
  * THE SOFTWARE.
  */
 
+#ifndef CACHELINEALIGNED_H_
+#define CACHELINEALIGNED_H_
+
 #include <stdint.h>
 #include <stddef.h>
-#include <assert.h>
-
-//#include <stdio.h>
-
-void* h3_memcpy(void *__restrict__ dest, void const *__restrict__ src, size_t n) {
-//	assert(((uint32_t )((uint32_t* ) src) & 0x3) == 0);
-//	assert(((uint32_t )((uint32_t* ) dest) & 0x3) == 0);
-
-//	if (((uint32_t )((uint32_t* ) src) & 0x3) != 0) {
-//		printf("src=%p\n", (void *)src);
-//	}
-//
-//	if (((uint32_t )((uint32_t* ) dest) & 0x3) != 0) {
-//		printf("dest=%p\n", (void *)dest);
-//	}
-
-	uint32_t *plDst = (uint32_t*) dest;
-	uint32_t const *plSrc = (uint32_t const*) src;
-
-	if ((((uint32_t) src & 0x3) == 0) && (((uint32_t) dest & 0x3) == 0)) {
-		while (n >= 4) {
-			*plDst++ = *plSrc++;
-			n -= 4;
-		}
-	}
 
-	uint8_t *pcDst = (uint8_t*) plDst;
-	uint8_t const *pcSrc = (uint8_t const*) plSrc;
+/**
+ * Base for classes and structs of which the heap instances must start on a
+ * cache line. Single objects only, the allocation is padded by one cache line.
+ */
+class CacheLineAligned {
+public:
+	static constexpr uintptr_t CACHE_LINE_SIZE = 64;
+
+	static void *operator new(size_t nSize) {
+		auto *pAllocated = new uint8_t[nSize + CACHE_LINE_SIZE];
+		const auto nAligned = (reinterpret_cast<uintptr_t>(pAllocated) + sizeof(uint8_t *) + CACHE_LINE_SIZE - 1) & ~(CACHE_LINE_SIZE - 1);
+		reinterpret_cast<uint8_t **>(nAligned)[-1] = pAllocated;
+		return reinterpret_cast<void *>(nAligned);
+	}
 
-	while (n--) {
-		*pcDst++ = *pcSrc++;
+	static void operator delete(void *p) {
+		delete[] reinterpret_cast<uint8_t **>(p)[-1];
 	}
+};
 
-	return dest;
-}
+#endif /* CACHELINEALIGNED_H_ */
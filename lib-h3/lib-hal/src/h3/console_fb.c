@@ -32,6 +32,7 @@
 #include "device/fb.h"
 
 #include "arm/arm.h"
+#include "arm/memfunc.h"
 
 extern unsigned char FONT[] __attribute__((aligned(4)));
 
@@ -47,6 +47,7 @@ static uint32_t cached_blocks[CACHE_ENTRIES] __attribute__((aligned(4)));
 static uint8_t cache_buffer[SECTOR_SIZE * CACHE_ENTRIES] __attribute__((aligned(SECTOR_SIZE)));
 
 #include "arm/arm.h"
+#include "arm/memfunc.h"
 #endif
 
 static volatile BYTE diskio_status = (BYTE) STA_NOINIT;
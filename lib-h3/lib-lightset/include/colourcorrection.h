@@ -0,0 +1,103 @@
+/**
+ * @file colourcorrection.h
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef COLOURCORRECTION_H_
+#define COLOURCORRECTION_H_
+
+#include <stdint.h>
+
+class PropertiesBuilder;
+
+namespace colourcorrection {
+enum class Channel {
+	RED, GREEN, BLUE, WHITE, LAST
+};
+namespace defaults {
+static constexpr uint8_t GAMMA = 10;				///< 1.0, linear
+static constexpr uint8_t WHITE_BALANCE = 0xFF;
+static constexpr uint8_t MAX_BRIGHTNESS = 0xFF;
+}  // namespace defaults
+namespace gamma {
+static constexpr uint8_t MIN = 1;					///< 0.1
+static constexpr uint8_t MAX = 40;					///< 4.0
+}  // namespace gamma
+}  // namespace colourcorrection
+
+struct TColourCorrectionParams {
+	uint8_t nGamma;				///< Gamma * 10
+	uint8_t nWhiteBalance[4];	///< Red, Green, Blue, White scale 0-255
+	uint8_t nMaxBrightness;		///< Current limit, scale 0-255
+} __attribute__((packed));
+
+/**
+ * Gamma, white balance and current limit compiled into one 256 entry
+ * table per colour channel. The table holds 16-bit values, so outputs
+ * with more than 8 bits resolution (TLC59711, PCA9685) keep the
+ * precision; 8-bit outputs use the high byte.
+ * The outputs apply the table in their encoder, there is no extra pass.
+ */
+class ColourCorrection {
+public:
+	ColourCorrection();
+
+	void Set(const struct TColourCorrectionParams *pParams);
+	void Get(struct TColourCorrectionParams *pParams) const;
+
+	bool IsIdentity() const {
+		return m_bIsIdentity;
+	}
+
+	uint8_t Get8(colourcorrection::Channel tChannel, uint8_t nValue) const {
+		return static_cast<uint8_t>(m_Table[static_cast<uint32_t>(tChannel)][nValue] >> 8);
+	}
+
+	uint16_t Get16(colourcorrection::Channel tChannel, uint8_t nValue) const {
+		return m_Table[static_cast<uint32_t>(tChannel)][nValue];
+	}
+
+	const uint16_t *GetTable(colourcorrection::Channel tChannel) const {
+		return m_Table[static_cast<uint32_t>(tChannel)];
+	}
+
+	void Print() const;
+
+	/*
+	 * Params helpers, shared by the txt files of the outputs
+	 */
+	static void SetDefaults(struct TColourCorrectionParams *pParams);
+	static bool Scan(const char *pLine, struct TColourCorrectionParams *pParams);
+	static void Builder(PropertiesBuilder& builder, const struct TColourCorrectionParams *pParams, bool bIsSet);
+	static void Dump(const struct TColourCorrectionParams *pParams);
+
+private:
+	void Compile();
+
+private:
+	struct TColourCorrectionParams m_tParams;
+	bool m_bIsIdentity { true };
+	uint16_t m_Table[static_cast<uint32_t>(colourcorrection::Channel::LAST)][256];
+};
+
+#endif /* COLOURCORRECTION_H_ */
@@ -40,7 +40,7 @@ enum TLightSetDmx {
 	DMX_MAX_VALUE = 255
 };
 
-enum TLightSetOutputType {
+enum TLightSetOutputType : uint8_t {	// Stored in the params structs, one byte on every target
 	LIGHTSET_OUTPUT_TYPE_DMX,
 	LIGHTSET_OUTPUT_TYPE_SPI,
 	LIGHTSET_OUTPUT_TYPE_MONITOR,
@@ -75,6 +75,28 @@ public:
 
 	virtual void SetData(uint8_t nPort, const uint8_t *pData, uint16_t nLength)= 0;
 
+	/*
+	 * Optional dirty range. Only slots [nFirst, nEnd) have changed since the
+	 * previous SetData for this port, nFirst >= nEnd when nothing changed.
+	 * The default ignores the range and does a full SetData.
+	 */
+	virtual void SetDataRange(uint8_t nPort, const uint8_t *pData, uint16_t nLength, __attribute__((unused)) uint16_t nFirst, __attribute__((unused)) uint16_t nEnd) {
+		SetData(nPort, pData, nLength);
+	}
+
+	/*
+	 * Optional frame batching. The nodes bracket the SetData calls for each
+	 * received packet, and for each synchronization, with BeginFrame() /
+	 * CommitFrame(), so that an output spanning several ports is transmitted
+	 * at most once per commit instead of per port.
+	 * SetData outside a frame keeps the per-port behaviour.
+	 */
+	virtual void BeginFrame() {
+	}
+
+	virtual void CommitFrame() {
+	}
+
 	virtual void Print() {
 	}
 
@@ -101,6 +123,16 @@ public:
 	}
 
 protected:
+	/*
+	 * For adapters which forward to another LightSet.
+	 * They do not become LightSet::Get().
+	 */
+	struct Forward {
+	};
+
+	explicit LightSet(__attribute__((unused)) Forward forward) {
+	}
+
 	LightSetDisplay *m_pLightSetDisplay{nullptr};
 	LightSetHandler *m_pLightSetHandler{nullptr};
 
@@ -46,6 +46,10 @@ public:
 	void Stop(uint8_t nPort) override;
 
 	void SetData(uint8_t nPort, const uint8_t *, uint16_t) override;
+	void SetDataRange(uint8_t nPort, const uint8_t *, uint16_t, uint16_t, uint16_t) override;
+
+	void BeginFrame() override;
+	void CommitFrame() override;
 
 	void Print() override;
 
@@ -43,6 +43,10 @@ struct LightSetConst {
 	static const char PARAMS_DMX_SLOT_INFO[];
 
 	static const char PARAMS_TEST_PATTERN[];
+
+	static const char PARAMS_GAMMA[];
+	static const char PARAMS_WHITE_BALANCE[4][20];
+	static const char PARAMS_MAX_BRIGHTNESS[];
 };
 
 #endif /* LIGHTSETCONST_H_ */
@@ -0,0 +1,125 @@
+/**
+ * @file colourcorrection.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+#include <cassert>
+
+#include "colourcorrection.h"
+
+#include "debug.h"
+
+using namespace colourcorrection;
+
+/**
+ * 2^y for y <= 0, only used when compiling the tables.
+ * Round to the nearest integer n, so the fraction f is within [-0.5, 0.5]
+ * where a 6th order Taylor expansion is accurate to better than 16 bits.
+ */
+static float exp2_negative(float y) {
+	if (y < -24.0f) {
+		return 0.0f;
+	}
+
+	const auto n = static_cast<int32_t>(y - 0.5f);
+	const auto f = y - static_cast<float>(n);
+
+	auto fValue = 1.0f + f * (0.693147181f + f * (0.240226507f + f * (0.0555041087f + f * (0.00961812911f + f * (0.00133335581f + f * 0.000154035304f)))));
+
+	for (auto i = n; i < 0; i++) {
+		fValue *= 0.5f;
+	}
+
+	return fValue;
+}
+
+ColourCorrection::ColourCorrection() {
+	SetDefaults(&m_tParams);
+	Compile();
+}
+
+void ColourCorrection::Set(const struct TColourCorrectionParams *pParams) {
+	assert(pParams != nullptr);
+
+	m_tParams = *pParams;
+
+	if (m_tParams.nGamma < gamma::MIN) {
+		m_tParams.nGamma = gamma::MIN;
+	} else if (m_tParams.nGamma > gamma::MAX) {
+		m_tParams.nGamma = gamma::MAX;
+	}
+
+	Compile();
+}
+
+void ColourCorrection::Get(struct TColourCorrectionParams *pParams) const {
+	assert(pParams != nullptr);
+
+	*pParams = m_tParams;
+}
+
+void ColourCorrection::Compile() {
+	DEBUG_ENTRY
+
+	m_bIsIdentity = (m_tParams.nGamma == defaults::GAMMA) && (m_tParams.nMaxBrightness == defaults::MAX_BRIGHTNESS);
+
+	const auto fGamma = static_cast<float>(m_tParams.nGamma) / 10.0f;
+
+	for (uint32_t nChannel = 0; nChannel < static_cast<uint32_t>(Channel::LAST); nChannel++) {
+		if (m_tParams.nWhiteBalance[nChannel] != defaults::WHITE_BALANCE) {
+			m_bIsIdentity = false;
+		}
+
+		// Full scale 65535 * (white balance / 255) * (max brightness / 255)
+		const auto fScale = (65535.0f * static_cast<float>(m_tParams.nWhiteBalance[nChannel] * m_tParams.nMaxBrightness)) / (255.0f * 255.0f);
+
+		m_Table[nChannel][0] = 0;
+
+		for (uint32_t i = 1; i < 256; i++) {
+			auto fValue = static_cast<float>(i) / 255.0f;
+
+			if (m_tParams.nGamma != defaults::GAMMA) {
+				fValue = exp2_negative(fGamma * log2f(fValue));
+			}
+
+			m_Table[nChannel][i] = static_cast<uint16_t>((fValue * fScale) + 0.5f);
+		}
+	}
+
+	DEBUG_PRINTF("m_bIsIdentity=%d", m_bIsIdentity);
+	DEBUG_EXIT
+}
+
+void ColourCorrection::Print() const {
+	if (m_bIsIdentity) {
+		return;
+	}
+
+	printf(" Colour correction\n");
+	printf("  Gamma          : %d.%d\n", m_tParams.nGamma / 10, m_tParams.nGamma % 10);
+	printf("  White balance  : %d:%d:%d:%d\n", m_tParams.nWhiteBalance[0], m_tParams.nWhiteBalance[1], m_tParams.nWhiteBalance[2], m_tParams.nWhiteBalance[3]);
+	printf("  Max brightness : %d\n", m_tParams.nMaxBrightness);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file colourcorrectionparams.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#if !defined(__clang__)	// Needed for compiling on MacOS
+# pragma GCC push_options
+# pragma GCC optimize ("Os")
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <cassert>
+
+#include "colourcorrection.h"
+
+#include "lightsetconst.h"
+
+#include "sscan.h"
+#include "propertiesbuilder.h"
+
+using namespace colourcorrection;
+
+void ColourCorrection::SetDefaults(struct TColourCorrectionParams *pParams) {
+	assert(pParams != nullptr);
+
+	pParams->nGamma = defaults::GAMMA;
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(Channel::LAST); i++) {
+		pParams->nWhiteBalance[i] = defaults::WHITE_BALANCE;
+	}
+
+	pParams->nMaxBrightness = defaults::MAX_BRIGHTNESS;
+}
+
+bool ColourCorrection::Scan(const char *pLine, struct TColourCorrectionParams *pParams) {
+	assert(pLine != nullptr);
+	assert(pParams != nullptr);
+
+	float fValue;
+
+	if (Sscan::Float(pLine, LightSetConst::PARAMS_GAMMA, fValue) == Sscan::OK) {
+		const auto nGamma = static_cast<uint32_t>((fValue * 10.0f) + 0.5f);
+
+		if ((nGamma >= gamma::MIN) && (nGamma <= gamma::MAX)) {
+			pParams->nGamma = static_cast<uint8_t>(nGamma);
+		} else {
+			pParams->nGamma = defaults::GAMMA;
+		}
+		return true;
+	}
+
+	uint8_t nValue8;
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(Channel::LAST); i++) {
+		if (Sscan::Uint8(pLine, LightSetConst::PARAMS_WHITE_BALANCE[i], nValue8) == Sscan::OK) {
+			pParams->nWhiteBalance[i] = nValue8;
+			return true;
+		}
+	}
+
+	if (Sscan::Uint8(pLine, LightSetConst::PARAMS_MAX_BRIGHTNESS, nValue8) == Sscan::OK) {
+		pParams->nMaxBrightness = nValue8;
+		return true;
+	}
+
+	return false;
+}
+
+void ColourCorrection::Builder(PropertiesBuilder& builder, const struct TColourCorrectionParams *pParams, bool bIsSet) {
+	assert(pParams != nullptr);
+
+	builder.Add(LightSetConst::PARAMS_GAMMA, static_cast<float>(pParams->nGamma) / 10.0f, bIsSet);
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(Channel::LAST); i++) {
+		builder.Add(LightSetConst::PARAMS_WHITE_BALANCE[i], pParams->nWhiteBalance[i], bIsSet);
+	}
+
+	builder.Add(LightSetConst::PARAMS_MAX_BRIGHTNESS, pParams->nMaxBrightness, bIsSet);
+}
+
+void ColourCorrection::Dump(__attribute__((unused)) const struct TColourCorrectionParams *pParams) {
+#ifndef NDEBUG
+	assert(pParams != nullptr);
+
+	printf(" %s=%d.%d\n", LightSetConst::PARAMS_GAMMA, pParams->nGamma / 10, pParams->nGamma % 10);
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(Channel::LAST); i++) {
+		printf(" %s=%d\n", LightSetConst::PARAMS_WHITE_BALANCE[i], pParams->nWhiteBalance[i]);
+	}
+
+	printf(" %s=%d\n", LightSetConst::PARAMS_MAX_BRIGHTNESS, pParams->nMaxBrightness);
+#endif
+}
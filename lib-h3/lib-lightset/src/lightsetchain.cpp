@@ -70,6 +70,26 @@ void LightSetChain::SetData(uint8_t nPort, const uint8_t *pData, uint16_t nSize)
 	}
 }
 
+void LightSetChain::SetDataRange(uint8_t nPort, const uint8_t *pData, uint16_t nSize, uint16_t nFirst, uint16_t nEnd) {
+	assert(pData != nullptr);
+
+	for (unsigned i = 0; i < m_nSize; i++) {
+		m_pTable[i].pLightSet->SetDataRange(nPort, pData, nSize, nFirst, nEnd);
+	}
+}
+
+void LightSetChain::BeginFrame() {
+	for (unsigned i = 0; i < m_nSize; i++) {
+		m_pTable[i].pLightSet->BeginFrame();
+	}
+}
+
+void LightSetChain::CommitFrame() {
+	for (unsigned i = 0; i < m_nSize; i++) {
+		m_pTable[i].pLightSet->CommitFrame();
+	}
+}
+
 void LightSetChain::Print() {
 	for (unsigned i = 0; i < m_nSize; i++) {
 		m_pTable[i].pLightSet->Print();
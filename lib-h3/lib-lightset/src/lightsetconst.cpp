@@ -46,3 +46,8 @@ const char LightSetConst::PARAMS_DMX_START_ADDRESS[] = "dmx_start_address";
 const char LightSetConst::PARAMS_DMX_SLOT_INFO[] = "dmx_slot_info";
 
 const char LightSetConst::PARAMS_TEST_PATTERN[] = "test_pattern";
+
+const char LightSetConst::PARAMS_GAMMA[] = "gamma";
+const char LightSetConst::PARAMS_WHITE_BALANCE[4][20] = { "white_balance_red",
+		"white_balance_green", "white_balance_blue", "white_balance_white" };
+const char LightSetConst::PARAMS_MAX_BRIGHTNESS[] = "max_brightness";
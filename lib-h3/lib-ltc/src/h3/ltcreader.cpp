@@ -44,6 +44,7 @@
 
 #include "arm/arm.h"
 #include "arm/synchronize.h"
+#include "arm/ringbuffer.h"
 #include "arm/gic.h"
 
 #ifndef NDEBUG
@@ -87,10 +88,20 @@ static volatile bool bTimeCodeSync = false;
 static volatile bool bTimeCodeValid = false;
 
 static volatile uint8_t aTimeCodeBits[8] ALIGNED;
-static volatile bool bIsDropFrameFlagSet = false;
 
-static volatile bool bTimeCodeAvailable = false;
-static volatile struct midi::Timecode s_tMidiTimeCode = { 0, 0, 0, 0, static_cast<uint8_t>(midi::TimecodeType::EBU) };
+/**
+ * Decoded frames, handed off from the FIQ to Run()
+ */
+struct FiqTimeCode {
+	uint8_t nFrames;
+	uint8_t nSeconds;
+	uint8_t nMinutes;
+	uint8_t nHours;
+	bool bIsDropFrameFlagSet;
+};
+
+static ring::Spsc<struct FiqTimeCode, 4> s_TimeCodes;
+static struct midi::Timecode s_tMidiTimeCode = { 0, 0, 0, 0, static_cast<uint8_t>(midi::TimecodeType::EBU) };
 
 // ARM Generic Timer
 static volatile uint32_t nUpdatesPerSecond = 0;
@@ -159,10 +170,12 @@ static void __attribute__((interrupt("FIQ"))) fiq_handler() {
 
 			bTimeCodeValid = false;
 
-			s_tMidiTimeCode.nFrames  = (10 * (aTimeCodeBits[1] & 0x03)) + (aTimeCodeBits[0] & 0x0F);
-			s_tMidiTimeCode.nSeconds = (10 * (aTimeCodeBits[3] & 0x07)) + (aTimeCodeBits[2] & 0x0F);
-			s_tMidiTimeCode.nMinutes = (10 * (aTimeCodeBits[5] & 0x07)) + (aTimeCodeBits[4] & 0x0F);
-			s_tMidiTimeCode.nHours   = (10 * (aTimeCodeBits[7] & 0x03)) + (aTimeCodeBits[6] & 0x0F);
+			struct FiqTimeCode tTimeCode;
+
+			tTimeCode.nFrames  = (10 * (aTimeCodeBits[1] & 0x03)) + (aTimeCodeBits[0] & 0x0F);
+			tTimeCode.nSeconds = (10 * (aTimeCodeBits[3] & 0x07)) + (aTimeCodeBits[2] & 0x0F);
+			tTimeCode.nMinutes = (10 * (aTimeCodeBits[5] & 0x07)) + (aTimeCodeBits[4] & 0x0F);
+			tTimeCode.nHours   = (10 * (aTimeCodeBits[7] & 0x03)) + (aTimeCodeBits[6] & 0x0F);
 
 			aTimeCode[10] = (aTimeCodeBits[0] & 0x0F) + '0';	// frames
 			aTimeCode[9]  = (aTimeCodeBits[1] & 0x03) + '0';	// 10's of frames
@@ -173,9 +186,10 @@ static void __attribute__((interrupt("FIQ"))) fiq_handler() {
 			aTimeCode[1]  = (aTimeCodeBits[6] & 0x0F) + '0';	// hours
 			aTimeCode[0]  = (aTimeCodeBits[7] & 0x03) + '0';	// 10's of hours
 
-			bIsDropFrameFlagSet = (aTimeCodeBits[1] & (1 << 2));
+			tTimeCode.bIsDropFrameFlagSet = (aTimeCodeBits[1] & (1 << 2));
 
-			bTimeCodeAvailable = true;
+			// When Run() falls behind, the newest frames are dropped; Run() catches up with the next one
+			s_TimeCodes.Push(tTimeCode);
 		}
 	}
 
@@ -235,18 +249,21 @@ void LtcReader::Run() {
 	uint32_t nNowUs =  0;
 #endif
 
-	dmb();
+	struct FiqTimeCode tTimeCode;
+	bool bTimeCodeAvailable = false;
+
+	while (s_TimeCodes.Pop(tTimeCode)) {
+		bTimeCodeAvailable = true;
+	}
+
 	if (bTimeCodeAvailable) {
-		dmb();
-		bTimeCodeAvailable = false;
 
 #ifndef NDEBUG
 		nNowUs =  h3_hs_timer_lo_us();
 #endif
 		TimeCodeType = ltc::type::UNKNOWN;
 
-		dmb();
-		if (bIsDropFrameFlagSet) {
+		if (tTimeCode.bIsDropFrameFlagSet) {
 			TimeCodeType = ltc::type::DF;
 #ifndef NDEBUG
 			nLimitUs = (1000000.0 / 30);
@@ -270,6 +287,10 @@ void LtcReader::Run() {
 			}
 		}
 
+		s_tMidiTimeCode.nFrames = tTimeCode.nFrames;
+		s_tMidiTimeCode.nSeconds = tTimeCode.nSeconds;
+		s_tMidiTimeCode.nMinutes = tTimeCode.nMinutes;
+		s_tMidiTimeCode.nHours = tTimeCode.nHours;
 		s_tMidiTimeCode.nType = TimeCodeType;
 
 		struct TLtcTimeCode tLtcTimeCode;
@@ -285,13 +306,13 @@ void LtcReader::Run() {
 		}
 
 		if (!m_ptLtcDisabledOutputs->bRtpMidi) {
-			RtpMidi::Get()->SendTimeCode(reinterpret_cast<const struct midi::Timecode *>(const_cast<struct midi::Timecode *>(&s_tMidiTimeCode)));
+			RtpMidi::Get()->SendTimeCode(&s_tMidiTimeCode);
 		}
 
 		if (m_tTimeCodeTypePrevious != TimeCodeType) {
 			m_tTimeCodeTypePrevious = TimeCodeType;
 
-			Midi::Get()->SendTimeCode(reinterpret_cast<const struct midi::Timecode *>(const_cast<struct midi::Timecode *>(&s_tMidiTimeCode)));
+			Midi::Get()->SendTimeCode(&s_tMidiTimeCode);
 
 			H3_TIMER->TMR1_INTV = TimeCodeConst::TMR_INTV[TimeCodeType] / 4;
 			H3_TIMER->TMR1_CTRL |= (TIMER_CTRL_EN_START | TIMER_CTRL_RELOAD);
@@ -325,7 +346,7 @@ void LtcReader::Run() {
 		if (__builtin_expect((IsMidiQuarterFrameMessage), 0)) {
 			dmb();
 			IsMidiQuarterFrameMessage = false;
-			Midi::Get()->SendQf(reinterpret_cast<const struct midi::Timecode *>(const_cast<struct midi::Timecode *>(&s_tMidiTimeCode)), nMidiQuarterFramePiece);
+			Midi::Get()->SendQf(&s_tMidiTimeCode, nMidiQuarterFramePiece);
 		}
 		LedBlink::Get()->SetFrequency(ltc::led_frequency::DATA);
 	} else {
@@ -33,6 +33,7 @@
 #include "ltc.h"
 
 #include "rgbpanel.h"
+#include "rgbpanelparams.h"
 
 #include "debug.h"
 
@@ -72,6 +73,12 @@ void LtcDisplayRgbPanel::Init() {
 		m_LineColours[i].nBlue = 0x00;
 	}
 
+	RgbPanelParams rgbPanelParams;
+
+	if (rgbPanelParams.Load()) {
+		rgbPanelParams.Set(m_pRgbPanel);
+	}
+
 	m_pRgbPanel->Start();
 
 	DEBUG_EXIT
@@ -0,0 +1,186 @@
+/**
+ * @file recvfrom_bench.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * CPU load and receive latency of the NetworkLinux superloop.
+ *
+ * A superloop with 8 bound ports (the services of a typical node) reads all
+ * of them on every iteration, while a sender thread sends timestamped
+ * datagrams to one port at a fixed rate over the loopback interface.
+ *
+ *  recvfrom  : no Poll; every RecvFrom is a recvfrom system call
+ *  poll      : Poll once per iteration, idle timeout 0
+ *  poll-idle : Poll once per iteration, idle timeout 1 ms
+ *
+ * Usage: recvfrom_bench [packets per second] [seconds]
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "networklinux.h"
+
+namespace bench {
+static constexpr auto PORTS = 8;
+static constexpr uint16_t PORT_FIRST = 40000;
+}  // namespace bench
+
+static uint64_t now_ns() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static uint64_t cpu_ns() {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return (static_cast<uint64_t>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000ULL
+			+ static_cast<uint64_t>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec)) * 1000ULL;
+}
+
+static void sender(std::atomic<bool> *pRunning, uint32_t nRate) {
+	const auto nSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+	struct sockaddr_in si_to;
+	memset(&si_to, 0, sizeof(si_to));
+	si_to.sin_family = AF_INET;
+	si_to.sin_port = htons(bench::PORT_FIRST);
+	si_to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	const uint64_t nInterval = 1000000000ULL / nRate;
+	auto nNext = now_ns();
+
+	while (*pRunning) {
+		nNext += nInterval;
+
+		struct timespec ts;
+		ts.tv_sec = static_cast<time_t>(nNext / 1000000000ULL);
+		ts.tv_nsec = static_cast<long>(nNext % 1000000000ULL);
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+
+		uint8_t buffer[530];	// Art-Net ArtDmx size
+		const auto nSent = now_ns();
+		memcpy(buffer, &nSent, sizeof(nSent));
+		sendto(nSocket, buffer, sizeof(buffer), 0, reinterpret_cast<struct sockaddr*>(&si_to), sizeof(si_to));
+	}
+
+	close(nSocket);
+}
+
+static void run(const char *pMode, bool bPoll, int nIdleTimeoutMillis, uint32_t nRate, uint32_t nSeconds) {
+	NetworkLinux nw;
+	nw.Init("lo");
+	nw.SetIdleTimeout(nIdleTimeoutMillis);
+
+	int32_t nHandles[bench::PORTS];
+
+	for (auto i = 0; i < bench::PORTS; i++) {
+		nHandles[i] = nw.Begin(static_cast<uint16_t>(bench::PORT_FIRST + i));
+	}
+
+	std::vector<uint64_t> latencies;
+	latencies.reserve(nRate * nSeconds + 1024);
+
+	std::atomic<bool> bRunning(true);
+	std::thread thread(sender, &bRunning, nRate);
+
+	const auto nCpuStart = cpu_ns();
+	const auto nStart = now_ns();
+	const auto nEnd = nStart + nSeconds * 1000000000ULL;
+	uint64_t nIterations = 0;
+
+	while (now_ns() < nEnd) {
+		if (bPoll) {
+			nw.Poll();
+		}
+
+		for (auto i = 0; i < bench::PORTS; i++) {
+			uint8_t buffer[1500];
+			uint32_t nFromIp;
+			uint16_t nFromPort;
+
+			if (nw.RecvFrom(nHandles[i], buffer, sizeof(buffer), &nFromIp, &nFromPort) != 0) {
+				uint64_t nSent;
+				memcpy(&nSent, buffer, sizeof(nSent));
+				latencies.push_back(now_ns() - nSent);
+			}
+		}
+
+		nIterations++;
+	}
+
+	const auto nWall = now_ns() - nStart;
+	const auto nCpu = cpu_ns() - nCpuStart;
+
+	bRunning = false;
+	thread.join();
+
+	for (auto i = 0; i < bench::PORTS; i++) {
+		nw.End(static_cast<uint16_t>(bench::PORT_FIRST + i));
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+
+	uint64_t nSum = 0;
+	for (const auto nLatency : latencies) {
+		nSum += nLatency;
+	}
+
+	const auto nCount = latencies.size();
+
+	printf("\n%-10s cpu %5.1f%%  loops/s %9.0f  received %6zu  latency us avg %6.1f p99 %7.1f max %7.1f\n",
+			pMode,
+			100.0 * static_cast<double>(nCpu) / static_cast<double>(nWall),
+			static_cast<double>(nIterations) * 1e9 / static_cast<double>(nWall),
+			nCount,
+			nCount == 0 ? 0.0 : static_cast<double>(nSum) / static_cast<double>(nCount) / 1000.0,
+			nCount == 0 ? 0.0 : static_cast<double>(latencies[nCount * 99 / 100]) / 1000.0,
+			nCount == 0 ? 0.0 : static_cast<double>(latencies[nCount - 1]) / 1000.0);
+}
+
+int main(int argc, char **argv) {
+	const uint32_t nRate = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 1000;
+	const uint32_t nSeconds = argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : 3;
+
+	printf("%u ports, %u packets/s on port %u, %u s per mode\n", bench::PORTS, nRate, bench::PORT_FIRST, nSeconds);
+
+	run("recvfrom", false, 0, nRate, nSeconds);
+	run("poll", true, 0, nRate, nSeconds);
+	run("poll-idle", true, 1, nRate, nSeconds);
+
+	return 0;
+}
@@ -0,0 +1,634 @@
+/**
+ * @file tftpdaemon_test.cpp
+ *
+ */
+/* Copyright (C) 2020 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * TFTPDaemon against a small RFC 2347/2348/7440 client, over an in-memory
+ * network with a simulated one-way delay. Time is simulated as well, so the
+ * transfer times are those of the protocol, not of the host.
+ *
+ *  put / get, 512 byte blocks in lock-step
+ *  put, blksize 1468
+ *  put / get, blksize 1468 with windowsize 4 and 16
+ *  put / get, blksize 1468 with windowsize 16 and 1% loss towards the daemon
+ *
+ * Every transfer must be byte-identical. Without loss, a windowed put must
+ * take one FileWrite per window.
+ *
+ * Usage: tftpdaemon_test [one-way delay us]
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "network.h"
+#include "tftpdaemon.h"
+
+namespace test {
+static constexpr uint32_t DAEMON_IP = 0x0100000A;	// 10.0.0.1
+static constexpr uint32_t CLIENT_IP = 0x0200000A;	// 10.0.0.2
+static constexpr uint16_t TFTP_PORT = 69;
+static constexpr uint16_t CLIENT_PORT = 50000;
+static constexpr uint32_t FILE_SIZE = 3000000;
+static constexpr uint64_t CLIENT_TIMEOUT_US = 100000;
+}  // namespace test
+
+namespace opcode {
+static constexpr uint16_t RRQ = 1;
+static constexpr uint16_t WRQ = 2;
+static constexpr uint16_t DATA = 3;
+static constexpr uint16_t ACK = 4;
+static constexpr uint16_t ERROR = 5;
+static constexpr uint16_t OACK = 6;
+}  // namespace opcode
+
+static uint64_t s_nNowUs;
+
+struct Packet {
+	uint64_t nDueUs;
+	uint16_t nFromPort;
+	uint16_t nToPort;
+	std::vector<uint8_t> Data;
+};
+
+/**
+ * The daemon side is the Network interface. The client side sends with
+ * ClientSend and receives with ClientRecv. Every packet arrives after the
+ * one-way delay; every m_nDropEvery'th packet towards the daemon is lost.
+ */
+class NetworkLoopback final: public Network {
+public:
+	NetworkLoopback() {
+		const uint8_t aMacAddress[NETWORK_MAC_SIZE] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+		memcpy(m_aNetMacaddr, aMacAddress, NETWORK_MAC_SIZE);
+		m_nLocalIp = test::DAEMON_IP;
+		m_nNetmask = 0x000000FF;	// 255.0.0.0
+		m_IsDhcpCapable = false;
+		strcpy(m_aHostName, "loopback");
+		strcpy(m_aIfName, "loopback");
+	}
+
+	int32_t Begin(uint16_t nPort) override {
+		m_Ports[m_nNextHandle] = nPort;
+		return m_nNextHandle++;
+	}
+
+	int32_t End(uint16_t nPort) override {
+		for (auto it = m_Ports.begin(); it != m_Ports.end(); ++it) {
+			if (it->second == nPort) {
+				m_Ports.erase(it);
+				// A closed socket drops what is queued for it
+				m_ToDaemon.erase(std::remove_if(m_ToDaemon.begin(), m_ToDaemon.end(), [nPort](const Packet& packet) {
+					return packet.nToPort == nPort;
+				}), m_ToDaemon.end());
+				return 0;
+			}
+		}
+
+		return -1;
+	}
+
+	void MacAddressCopyTo(uint8_t *pMacAddress) override {
+		memcpy(pMacAddress, m_aNetMacaddr, NETWORK_MAC_SIZE);
+	}
+
+	void JoinGroup(__attribute__((unused)) int32_t nHandle, __attribute__((unused)) uint32_t nIp) override {
+	}
+
+	void LeaveGroup(__attribute__((unused)) int32_t nHandle, __attribute__((unused)) uint32_t nIp) override {
+	}
+
+	uint16_t RecvFrom(int32_t nHandle, void *pBuffer, uint16_t nLength, uint32_t *pFromIp, uint16_t *pFromPort) override {
+		const auto it = m_Ports.find(nHandle);
+
+		if (it == m_Ports.end()) {
+			return 0;
+		}
+
+		for (auto packet = m_ToDaemon.begin(); packet != m_ToDaemon.end() && packet->nDueUs <= s_nNowUs; ++packet) {
+			if (packet->nToPort == it->second) {
+				const auto nBytes = static_cast<uint16_t>(std::min(packet->Data.size(), static_cast<size_t>(nLength)));
+				memcpy(pBuffer, packet->Data.data(), nBytes);
+				*pFromIp = test::CLIENT_IP;
+				*pFromPort = packet->nFromPort;
+				m_ToDaemon.erase(packet);
+				return nBytes;
+			}
+		}
+
+		return 0;
+	}
+
+	void SendTo(int32_t nHandle, const void *pBuffer, uint16_t nLength, __attribute__((unused)) uint32_t nToIp, uint16_t nRemotePort) override {
+		const auto *p = reinterpret_cast<const uint8_t *>(pBuffer);
+		m_ToClient.push_back(Packet { s_nNowUs + m_nDelayUs, m_Ports[nHandle], nRemotePort, std::vector<uint8_t>(p, p + nLength) });
+	}
+
+	void SetIp(__attribute__((unused)) uint32_t nIp) override {
+	}
+
+	void SetNetmask(__attribute__((unused)) uint32_t nNetmask) override {
+	}
+
+	bool SetZeroconf() override {
+		return false;
+	}
+
+	bool EnableDhcp() override {
+		return false;
+	}
+
+	void ClientSend(const std::vector<uint8_t>& Data, uint16_t nToPort) {
+		if ((m_nDropEvery != 0) && ((++m_nSent % m_nDropEvery) == 0)) {
+			return;
+		}
+
+		m_ToDaemon.push_back(Packet { s_nNowUs + m_nDelayUs, test::CLIENT_PORT, nToPort, Data });
+	}
+
+	bool ClientRecv(Packet& packet) {
+		if (m_ToClient.empty() || (m_ToClient.front().nDueUs > s_nNowUs)) {
+			return false;
+		}
+
+		packet = m_ToClient.front();
+		m_ToClient.pop_front();
+		return true;
+	}
+
+	uint64_t GetNextDueUs() {
+		// Nobody listens on the port: dropped, as on a real network
+		m_ToDaemon.erase(std::remove_if(m_ToDaemon.begin(), m_ToDaemon.end(), [this](const Packet& packet) {
+			return (packet.nDueUs <= s_nNowUs) && !IsOpen(packet.nToPort);
+		}), m_ToDaemon.end());
+
+		auto nDueUs = UINT64_MAX;
+
+		if (!m_ToDaemon.empty()) {
+			nDueUs = m_ToDaemon.front().nDueUs;
+		}
+
+		if (!m_ToClient.empty()) {
+			nDueUs = std::min(nDueUs, m_ToClient.front().nDueUs);
+		}
+
+		return nDueUs;
+	}
+
+	void Reset(uint64_t nDelayUs, uint32_t nDropEvery) {
+		m_Ports.clear();
+		m_ToDaemon.clear();
+		m_ToClient.clear();
+		m_nDelayUs = nDelayUs;
+		m_nDropEvery = nDropEvery;
+		m_nSent = 0;
+	}
+
+private:
+	bool IsOpen(uint16_t nPort) const {
+		for (const auto& it : m_Ports) {
+			if (it.second == nPort) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	std::map<int32_t, uint16_t> m_Ports;
+	int32_t m_nNextHandle { 0 };
+	std::deque<Packet> m_ToDaemon;
+	std::deque<Packet> m_ToClient;
+	uint64_t m_nDelayUs { 0 };
+	uint32_t m_nDropEvery { 0 };
+	uint32_t m_nSent { 0 };
+};
+
+class TFTPFileServerMemory final: public TFTPDaemon {
+public:
+	bool FileOpen(__attribute__((unused)) const char *pFileName, __attribute__((unused)) TFTPMode tMode) override {
+		return true;
+	}
+
+	bool FileCreate(__attribute__((unused)) const char *pFileName, __attribute__((unused)) TFTPMode tMode) override {
+		m_Data.clear();
+		return true;
+	}
+
+	bool FileClose() override {
+		m_bIsClosed = true;
+		return true;
+	}
+
+	size_t FileRead(void *pBuffer, size_t nCount, uint32_t nOffset) override {
+		if (nOffset >= m_Data.size()) {
+			return 0;
+		}
+
+		const auto nBytes = std::min(nCount, m_Data.size() - nOffset);
+		memcpy(pBuffer, &m_Data[nOffset], nBytes);
+		return nBytes;
+	}
+
+	size_t FileWrite(const void *pBuffer, size_t nCount, uint32_t nOffset) override {
+		if (m_Data.size() < nOffset + nCount) {
+			m_Data.resize(nOffset + nCount);
+		}
+
+		memcpy(&m_Data[nOffset], pBuffer, nCount);
+
+		m_nWrites++;
+		m_nMaxWrite = std::max(m_nMaxWrite, static_cast<uint32_t>(nCount));
+		return nCount;
+	}
+
+	void Exit() override {
+	}
+
+	std::vector<uint8_t> m_Data;
+	uint32_t m_nWrites { 0 };
+	uint32_t m_nMaxWrite { 0 };
+	bool m_bIsClosed { false };
+};
+
+/**
+ * RFC 7440 client. A put sends a window of DATA packets and waits for the
+ * ACK; a get acknowledges every window and the last block. On a timeout the
+ * request, the window or the last ACK is sent again.
+ */
+class TFTPClient {
+public:
+	TFTPClient(NetworkLoopback& Network, bool bIsPut, uint32_t nBlockSize, uint32_t nWindowSize, std::vector<uint8_t>& Data):
+		m_Network(Network), m_bIsPut(bIsPut), m_nBlockSize(nBlockSize), m_nWindowSize(nWindowSize), m_Data(Data)
+	{
+		m_nBlocks = static_cast<uint32_t>(m_Data.size() / m_nBlockSize + 1);
+		SendRequest();
+	}
+
+	/**
+	 * Returns true when it did something, false when it waits for the
+	 * network or for its timeout.
+	 */
+	bool Run() {
+		Packet packet;
+
+		if (m_Network.ClientRecv(packet)) {
+			m_nPeerPort = packet.nFromPort;
+			m_nDeadlineUs = s_nNowUs + test::CLIENT_TIMEOUT_US;
+			Handle(packet.Data);
+			return true;
+		}
+
+		if (s_nNowUs >= m_nDeadlineUs) {
+			m_nDeadlineUs = s_nNowUs + test::CLIENT_TIMEOUT_US;
+			m_nTimeouts++;
+
+			if (m_nPeerPort == 0) {
+				SendRequest();
+			} else if (m_bIsPut) {
+				SendWindow();
+			} else {
+				SendAck(static_cast<uint16_t>(m_nExpected - 1));
+			}
+			return true;
+		}
+
+		return false;
+	}
+
+	bool IsDone() const {
+		return m_bIsDone;
+	}
+
+	bool IsError() const {
+		return m_bIsError;
+	}
+
+	uint64_t GetDeadlineUs() const {
+		return m_nDeadlineUs;
+	}
+
+	uint32_t GetTimeouts() const {
+		return m_nTimeouts;
+	}
+
+	uint32_t GetBlockSize() const {
+		return m_nBlockSize;
+	}
+
+	uint32_t GetWindowSize() const {
+		return m_nWindowSize;
+	}
+
+private:
+	static void Put16(std::vector<uint8_t>& Packet, uint16_t nValue) {
+		Packet.push_back(static_cast<uint8_t>(nValue >> 8));
+		Packet.push_back(static_cast<uint8_t>(nValue));
+	}
+
+	static void PutString(std::vector<uint8_t>& Packet, const char *pString) {
+		Packet.insert(Packet.end(), pString, pString + strlen(pString) + 1);
+	}
+
+	static uint16_t Get16(const std::vector<uint8_t>& Packet, size_t nOffset) {
+		return static_cast<uint16_t>((Packet[nOffset] << 8) | Packet[nOffset + 1]);
+	}
+
+	void SendRequest() {
+		std::vector<uint8_t> Request;
+		char aValue[16];
+
+		Put16(Request, m_bIsPut ? opcode::WRQ : opcode::RRQ);
+		PutString(Request, "fw.bin");
+		PutString(Request, "octet");
+
+		if (m_nBlockSize != TFTPDaemon::BLKSIZE_DEFAULT) {
+			PutString(Request, "blksize");
+			snprintf(aValue, sizeof(aValue), "%u", m_nBlockSize);
+			PutString(Request, aValue);
+		}
+
+		if (m_nWindowSize != 1) {
+			PutString(Request, "windowsize");
+			snprintf(aValue, sizeof(aValue), "%u", m_nWindowSize);
+			PutString(Request, aValue);
+		}
+
+		if (m_bIsPut && (Request.size() > 15)) {
+			PutString(Request, "tsize");
+			snprintf(aValue, sizeof(aValue), "%u", static_cast<uint32_t>(m_Data.size()));
+			PutString(Request, aValue);
+		}
+
+		m_Network.ClientSend(Request, test::TFTP_PORT);
+	}
+
+	void SendAck(uint16_t nBlock) {
+		std::vector<uint8_t> Ack;
+
+		Put16(Ack, opcode::ACK);
+		Put16(Ack, nBlock);
+
+		m_Network.ClientSend(Ack, m_nPeerPort);
+	}
+
+	void SendWindow() {
+		const auto nLast = std::min(m_nAcked + m_nWindowSize, m_nBlocks);
+
+		for (auto nBlock = m_nAcked + 1; nBlock <= nLast; nBlock++) {
+			const auto nOffset = static_cast<size_t>(nBlock - 1) * m_nBlockSize;
+			const auto nLength = std::min(static_cast<size_t>(m_nBlockSize), m_Data.size() - nOffset);
+			std::vector<uint8_t> Data;
+
+			Put16(Data, opcode::DATA);
+			Put16(Data, static_cast<uint16_t>(nBlock));
+			Data.insert(Data.end(), m_Data.begin() + static_cast<long>(nOffset), m_Data.begin() + static_cast<long>(nOffset + nLength));
+
+			m_Network.ClientSend(Data, m_nPeerPort);
+		}
+	}
+
+	void HandleOptionAck(const std::vector<uint8_t>& Packet) {
+		size_t nOffset = 2;
+
+		while (nOffset < Packet.size()) {
+			const auto *pName = reinterpret_cast<const char *>(&Packet[nOffset]);
+			const auto *pValue = pName + strlen(pName) + 1;
+
+			if (strcmp(pName, "blksize") == 0) {
+				m_nBlockSize = static_cast<uint32_t>(atoi(pValue));
+			} else if (strcmp(pName, "windowsize") == 0) {
+				m_nWindowSize = static_cast<uint32_t>(atoi(pValue));
+			}
+
+			nOffset = static_cast<size_t>(pValue + strlen(pValue) + 1 - reinterpret_cast<const char *>(Packet.data()));
+		}
+
+		m_nBlocks = static_cast<uint32_t>(m_Data.size() / m_nBlockSize + 1);
+	}
+
+	void Handle(const std::vector<uint8_t>& Packet) {
+		if (Packet.size() < 4) {
+			return;
+		}
+
+		const auto nOpCode = Get16(Packet, 0);
+
+		if (nOpCode == opcode::ERROR) {
+			m_bIsError = true;
+			m_bIsDone = true;
+			return;
+		}
+
+		if (m_bIsPut) {
+			HandlePut(nOpCode, Packet);
+		} else {
+			HandleGet(nOpCode, Packet);
+		}
+	}
+
+	void HandlePut(uint16_t nOpCode, const std::vector<uint8_t>& Packet) {
+		if (nOpCode == opcode::OACK) {
+			HandleOptionAck(Packet);
+			m_bIsStarted = true;
+			SendWindow();
+			return;
+		}
+
+		if (nOpCode != opcode::ACK) {
+			return;
+		}
+
+		if (!m_bIsStarted) {
+			// Plain ACK of block 0: the daemon did not take the options
+			m_nBlockSize = TFTPDaemon::BLKSIZE_DEFAULT;
+			m_nWindowSize = 1;
+			m_nBlocks = static_cast<uint32_t>(m_Data.size() / m_nBlockSize + 1);
+		}
+
+		m_bIsStarted = true;
+
+		const auto nDelta = static_cast<uint16_t>(Get16(Packet, 2) - m_nAcked);
+
+		if (nDelta > m_nWindowSize) {
+			return;
+		}
+
+		m_nAcked += nDelta;
+
+		if (m_nAcked == m_nBlocks) {
+			m_bIsDone = true;
+		} else {
+			SendWindow();
+		}
+	}
+
+	void HandleGet(uint16_t nOpCode, const std::vector<uint8_t>& Packet) {
+		if (nOpCode == opcode::OACK) {
+			HandleOptionAck(Packet);
+			SendAck(0);
+			return;
+		}
+
+		if (nOpCode != opcode::DATA) {
+			return;
+		}
+
+		const auto nBlock = Get16(Packet, 2);
+
+		if (nBlock != static_cast<uint16_t>(m_nExpected)) {
+			SendAck(static_cast<uint16_t>(m_nExpected - 1));
+			m_nSinceAck = 0;
+			return;
+		}
+
+		m_Data.insert(m_Data.end(), Packet.begin() + 4, Packet.end());
+		m_nExpected++;
+		m_nSinceAck++;
+
+		const auto bIsLast = (Packet.size() - 4 < m_nBlockSize);
+
+		if (bIsLast || (m_nSinceAck == m_nWindowSize)) {
+			SendAck(nBlock);
+			m_nSinceAck = 0;
+		}
+
+		m_bIsDone = bIsLast;
+	}
+
+	NetworkLoopback& m_Network;
+	bool m_bIsPut;
+	uint32_t m_nBlockSize;
+	uint32_t m_nWindowSize;
+	std::vector<uint8_t>& m_Data;
+	uint32_t m_nBlocks;
+	uint16_t m_nPeerPort { 0 };
+	uint64_t m_nDeadlineUs { s_nNowUs + test::CLIENT_TIMEOUT_US };
+	uint32_t m_nTimeouts { 0 };
+	bool m_bIsDone { false };
+	bool m_bIsError { false };
+	// put
+	bool m_bIsStarted { false };
+	uint32_t m_nAcked { 0 };
+	// get
+	uint32_t m_nExpected { 1 };
+	uint32_t m_nSinceAck { 0 };
+};
+
+static NetworkLoopback s_Network;
+static std::vector<uint8_t> s_File;
+static uint64_t s_nDelayUs = 1000;
+static uint32_t s_nErrors;
+
+static void transfer(const char *pName, bool bIsPut, uint32_t nBlockSize, uint32_t nWindowSize, uint32_t nDropEvery) {
+	s_Network.Reset(s_nDelayUs, nDropEvery);
+
+	TFTPFileServerMemory Daemon;
+	std::vector<uint8_t> Data;
+
+	if (bIsPut) {
+		Data = s_File;
+	} else {
+		Daemon.m_Data = s_File;
+	}
+
+	const auto nStartUs = s_nNowUs;
+	TFTPClient Client(s_Network, bIsPut, nBlockSize, nWindowSize, Data);
+
+	while (!Client.IsDone()) {
+		// A few runs, so that the daemon also gets through its send states
+		for (uint32_t i = 0; i < 4; i++) {
+			Daemon.Run();
+		}
+
+		if (!Client.Run()) {
+			s_nNowUs = std::max(s_nNowUs, std::min(s_Network.GetNextDueUs(), Client.GetDeadlineUs()));
+		}
+	}
+
+	// The last ACK of a put is sent after FileClose
+	for (uint32_t i = 0; i < 4; i++) {
+		Daemon.Run();
+	}
+
+	const auto& Received = bIsPut ? Daemon.m_Data : Data;
+	const auto bIsIdentical = (Received == s_File);
+	const auto nWindows = (s_File.size() / Client.GetBlockSize() + Client.GetWindowSize()) / Client.GetWindowSize();
+
+	printf("%-42s %7.3f s  %4u timeouts", pName, static_cast<double>(s_nNowUs - nStartUs) / 1e6, Client.GetTimeouts());
+
+	if (bIsPut) {
+		printf("  %5u FileWrite calls, max %u bytes", Daemon.m_nWrites, Daemon.m_nMaxWrite);
+	}
+
+	puts(bIsIdentical ? "" : "  DIFFERS");
+
+	if (Client.IsError() || !bIsIdentical || (bIsPut && !Daemon.m_bIsClosed)) {
+		s_nErrors++;
+	}
+
+	if (bIsPut && (nDropEvery == 0) && (Daemon.m_nWrites != nWindows)) {
+		printf("FileWrite calls %u, expected one per window (%u)\n", Daemon.m_nWrites, static_cast<uint32_t>(nWindows));
+		s_nErrors++;
+	}
+}
+
+int main(int argc, char **argv) {
+	if (argc > 1) {
+		s_nDelayUs = static_cast<uint64_t>(atoi(argv[1]));
+	}
+
+	auto nSeed = 0x12345678U;
+
+	for (uint32_t i = 0; i < test::FILE_SIZE; i++) {
+		nSeed = nSeed * 1103515245U + 12345U;
+		s_File.push_back(static_cast<uint8_t>(nSeed >> 16));
+	}
+
+	printf("%u bytes, one-way delay %u us\n", test::FILE_SIZE, static_cast<uint32_t>(s_nDelayUs));
+
+	transfer("put, 512", true, 512, 1, 0);
+	transfer("put, blksize 1468", true, 1468, 1, 0);
+	transfer("put, blksize 1468, windowsize 4", true, 1468, 4, 0);
+	transfer("put, blksize 1468, windowsize 16", true, 1468, 16, 0);
+	transfer("get, 512", false, 512, 1, 0);
+	transfer("get, blksize 1468, windowsize 4", false, 1468, 4, 0);
+	transfer("get, blksize 1468, windowsize 16", false, 1468, 16, 0);
+	transfer("put, blksize 1468, windowsize 16, 1% loss", true, 1468, 16, 100);
+	transfer("get, blksize 1468, windowsize 16, 1% loss", false, 1468, 16, 100);
+
+	if (s_nErrors != 0) {
+		printf("FAILED: %u errors\n", s_nErrors);
+		return EXIT_FAILURE;
+	}
+
+	puts("PASSED");
+	return EXIT_SUCCESS;
+}
@@ -48,6 +48,14 @@ enum TNetwork {
 	NETWORK_DOMAINNAME_SIZE = 64	/* including a terminating null byte. */
 };
 
+struct TDhcpLease {
+	uint32_t nIp;
+	uint32_t nNetmask;
+	uint32_t nGatewayIp;
+	uint32_t nServerIp;
+	uint32_t nLeaseTime;	///< Seconds
+};
+
 enum class DhcpClientStatus {
 	IDLE,
 	RENEW,
@@ -69,6 +77,18 @@ struct NetworkDisplay {
 	virtual void ShowShutdown()=0;
 };
 
+/**
+ * Services that keep a copy of the local address, for example in a prebuilt
+ * reply packet. Called when the address or netmask changes at run time,
+ * also when a DHCPNAK drops the address to 0.0.0.0.
+ */
+class NetworkIpObserver {
+public:
+	virtual ~NetworkIpObserver() {}
+
+	virtual void IpChanged()=0;
+};
+
 class NetworkStore {
 public:
 	virtual ~NetworkStore() {}
@@ -77,6 +97,11 @@ public:
 	virtual void SaveNetMask(uint32_t nNetMask)=0;
 	virtual void SaveHostName(const char *pHostName, uint32_t nLength)=0;
 	virtual void SaveDhcp(bool bIsDhcpUsed)=0;
+	/**
+	 * The last DHCP lease, for the INIT-REBOOT fast path at the next boot
+	 */
+	virtual void SaveDhcpLease(const struct TDhcpLease *pDhcpLease)=0;
+	virtual bool CopyDhcpLease(struct TDhcpLease *pDhcpLease)=0;
 };
 
 class Network {
@@ -97,6 +122,13 @@ public:
 	virtual void JoinGroup(int32_t nHandle, uint32_t nIp)=0;
 	virtual void LeaveGroup(int32_t nHandle, uint32_t nIp)=0;
 
+	/**
+	 * Called once per superloop iteration, before the services read their sockets.
+	 * Receives the pending frames on bare metal. RecvFrom never blocks.
+	 */
+	virtual void Poll() {
+	}
+
 	virtual uint16_t RecvFrom(int32_t nHandle, void *pBuffer, uint16_t nLength, uint32_t *pFromIp, uint16_t *pFromPort)=0;
 	virtual void SendTo(int32_t nHandle, const void *pBuffer, uint16_t nLength, uint32_t nToIp, uint16_t nRemotePort)=0;
 
@@ -215,6 +247,9 @@ public:
 		m_pNetworkStore = pNetworkStore;
 	}
 
+	void AddIpObserver(NetworkIpObserver *pNetworkIpObserver);
+	void RemoveIpObserver(NetworkIpObserver *pNetworkIpObserver);
+
 	bool IsValidIp(uint32_t nIp) {
 		return (m_nLocalIp & m_nNetmask) == (nIp & m_nNetmask);
 	}
@@ -244,7 +279,12 @@ protected:
 	NetworkDisplay *m_pNetworkDisplay { nullptr };
 	NetworkStore *m_pNetworkStore { nullptr };
 
+	void NotifyIpChanged();
+
 private:
+	static constexpr uint32_t IP_OBSERVERS_MAX = 4;
+	NetworkIpObserver *m_pNetworkIpObservers[IP_OBSERVERS_MAX] {};
+
 	struct QueuedConfig {
 		static constexpr uint32_t NONE = 0;
 		static constexpr uint32_t STATIC_IP = (1U << 0);
@@ -63,12 +63,16 @@ public:
 
 	bool EnableDhcp() override; 
 
-	void Run() {
+	void Poll() override {
 		net_handle();
 	}
 
+	static void staticCallbackFunction();
+
 private:
 	void SetDefaultIp();
+	void SaveDhcpLease();
+	void callbackFunction();
 };
 
 #endif /* NETWORKH3EMAC_H_ */
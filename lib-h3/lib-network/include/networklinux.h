@@ -59,6 +59,28 @@ public:
 	uint16_t RecvFrom(int32_t nHandle, void *pBuffer, uint16_t nLength, uint32_t *pFromIp, uint16_t *pFromPort);
 	void SendTo(int32_t nHandle, const void *pBuffer, uint16_t nLength, uint32_t nToIp, uint16_t nRemotePort);
 
+#if defined (__linux__)
+	/**
+	 * Reads the receive readiness of all bound sockets with a single epoll_wait.
+	 * RecvFrom only calls recvfrom for the sockets reported readable.
+	 * When no socket is readable, it sleeps for at most the idle timeout (default 0).
+	 */
+	void Poll() override;
+
+	void SetIdleTimeout(int nTimeoutMillis) {
+		m_nIdleTimeoutMillis = nTimeoutMillis;
+	}
+
+	/**
+	 * An additional socket bound with SO_REUSEPORT, which only receives the multicast
+	 * groups joined on it. It is not part of the superloop polling;
+	 * RecvFrom blocks on it for at most nTimeoutMillis.
+	 * Intended for receive worker threads.
+	 */
+	int32_t BeginReusePort(uint16_t nPort, uint32_t nTimeoutMillis);
+	void EndReusePort(int32_t nHandle);
+#endif
+
 private:
 	uint32_t GetDefaultGateway();
 	bool IsDhclient(const char *pIfName);
@@ -67,6 +89,13 @@ private:
 #if defined(__APPLE__)
 	bool OSxGetMacaddress(const char *pIfName, uint8_t *pMacAddress);
 #endif
+
+#if defined (__linux__)
+	int m_nEpollFd { -1 };
+	int m_nIdleTimeoutMillis { 0 };
+	uint32_t m_nReadyMask { 0 };	///< Sockets with pending data, per port index
+	bool m_bPolled { false };	///< Without Poll, RecvFrom reads every socket
+#endif
 };
 
 #endif /* NETWORKLINUX_H_ */
@@ -43,18 +43,30 @@ public:
 	virtual bool FileOpen(const char *pFileName, TFTPMode tMode)=0;
 	virtual bool FileCreate(const char *pFileName, TFTPMode tMode)=0;
 	virtual bool FileClose()=0;
-	virtual size_t FileRead(void *pBuffer, size_t nCount, unsigned nBlockNumber)=0;
-	virtual size_t FileWrite(const void *pBuffer, size_t nCount, unsigned nBlockNumber)=0;
+	/**
+	 * nOffset is the position in the file. FileRead is called once per block,
+	 * FileWrite once per received window, so with a negotiated blksize and
+	 * windowsize it gets up to BLKSIZE_MAX * WINDOWSIZE_MAX contiguous bytes.
+	 */
+	virtual size_t FileRead(void *pBuffer, size_t nCount, uint32_t nOffset)=0;
+	virtual size_t FileWrite(const void *pBuffer, size_t nCount, uint32_t nOffset)=0;
 
 	virtual void Exit()=0;
 
+	static constexpr uint32_t BLKSIZE_DEFAULT = 512;
+	static constexpr uint32_t BLKSIZE_MAX = 1468;	///< 1500 MTU - IPv4 (20) - UDP (8) - TFTP (4)
+	static constexpr uint32_t WINDOWSIZE_MAX = 16;
+
 private:
 	void HandleRequest();
+	bool HandleOptions(const char *pOptions, const char *pEnd);
 	void HandleRecvAck();
 	void HandleRecvData();
 	void SendError (uint16_t usErrorCode, const char *pErrorMessage);
+	void SendOptionAck();
 	void DoRead();
 	void DoWriteAck();
+	bool WindowFlush();
 
 private:
 	enum class TFTPState {
@@ -67,14 +79,26 @@ private:
 	};
 	TFTPState m_nState{TFTPState::INIT};
 	int m_nIdx{-1};
-	uint8_t m_Buffer[528];
+	uint8_t m_Buffer[4 + BLKSIZE_MAX + 1];	///< +1 to terminate the request strings
 	uint32_t m_nFromIp{0};
 	uint16_t m_nFromPort{0};
 	size_t m_nLength{0};
 	uint16_t m_nBlockNumber{0};
 	size_t m_nDataLength{0};
-	uint16_t m_nPacketLength{0};
 	bool m_bIsLastBlock{false};
+	// RFC 2347 options
+	uint32_t m_nBlockSize{BLKSIZE_DEFAULT};
+	uint32_t m_nWindowSize{1};
+	uint32_t m_nTransferSize{0};
+	uint32_t m_nOptionMask{0};
+	// RFC 7440 window. RRQ: DATA packets sent but not yet acknowledged, one slot each.
+	// WRQ: contiguous data of the blocks received since the last FileWrite.
+	uint8_t m_Window[WINDOWSIZE_MAX * (4 + BLKSIZE_MAX)];
+	uint32_t m_nWindowFirst{0};
+	uint32_t m_nWindowBlocks{0};
+	uint32_t m_nWindowLength{0};
+	uint32_t m_nFileOffset{0};
+	bool m_bIsGapAcked{false};
 
 	static TFTPDaemon* Get() {
 		return s_pThis;
@@ -119,6 +119,24 @@ void NetworkH3emac::Init(NetworkParamsStore *pNetworkParamsStore) {
 		m_pNetworkDisplay->ShowDhcpStatus(DhcpClientStatus::RENEW);
 	}
 
+	if (m_IsDhcpUsed && (m_pNetworkStore != nullptr)) {
+		struct TDhcpLease tDhcpLease;
+
+		if (m_pNetworkStore->CopyDhcpLease(&tDhcpLease)) {
+			struct dhcp_lease lease;
+
+			lease.ip = tDhcpLease.nIp;
+			lease.netmask = tDhcpLease.nNetmask;
+			lease.gw = tDhcpLease.nGatewayIp;
+			lease.server_ip = tDhcpLease.nServerIp;
+			lease.lease_time = tDhcpLease.nLeaseTime;
+
+			net_set_dhcp_lease(&lease);
+		}
+	}
+
+	net_set_dhcp_callback(NetworkH3emac::staticCallbackFunction);
+
 	net_init(m_aNetMacaddr, &tIpInfo, reinterpret_cast<const uint8_t*>(m_aHostName), &m_IsDhcpUsed, &m_IsZeroconfUsed);
 
 	if ((m_pNetworkDisplay != nullptr) && m_IsZeroconfUsed) {
@@ -164,6 +182,10 @@ void NetworkH3emac::Init(NetworkParamsStore *pNetworkParamsStore) {
 		m_nGatewayIp = m_nLocalIp;
 	}
 
+	if (m_IsDhcpUsed) {
+		SaveDhcpLease();
+	}
+
 	DEBUG_EXIT
 }
 
@@ -289,6 +311,8 @@ void NetworkH3emac::SetIp(uint32_t nIp) {
 		m_pNetworkDisplay->ShowNetMask();
 	}
 
+	NotifyIpChanged();
+
 	DEBUG_EXIT
 }
 
@@ -314,6 +338,8 @@ void NetworkH3emac::SetNetmask(uint32_t nNetmask) {
 		m_pNetworkDisplay->ShowNetMask();
 	}
 
+	NotifyIpChanged();
+
 	DEBUG_EXIT
 }
 
@@ -352,6 +378,10 @@ bool NetworkH3emac::SetZeroconf() {
 		m_pNetworkDisplay->ShowNetMask();
 	}
 
+	if (m_IsZeroconfUsed) {
+		NotifyIpChanged();
+	}
+
 	return m_IsZeroconfUsed;
 }
 
@@ -386,6 +416,8 @@ bool NetworkH3emac::EnableDhcp() {
 		Hardware::Get()->WatchdogInit();
 	}
 
+	const auto bIsChanged = (tIpInfo.ip.addr != m_nLocalIp) || (tIpInfo.netmask.addr != m_nNetmask);
+
 	m_nLocalIp = tIpInfo.ip.addr;
 	m_nNetmask = tIpInfo.netmask.addr;
 	m_nGatewayIp = tIpInfo.gw.addr;
@@ -394,6 +426,10 @@ bool NetworkH3emac::EnableDhcp() {
 		m_pNetworkStore->SaveDhcp(m_IsDhcpUsed);
 	}
 
+	if (m_IsDhcpUsed) {
+		SaveDhcpLease();
+	}
+
 	if (m_pNetworkDisplay != nullptr) {
 		m_pNetworkDisplay->ShowIp();
 	}
@@ -402,6 +438,79 @@ bool NetworkH3emac::EnableDhcp() {
 		m_pNetworkDisplay->ShowNetMask();
 	}
 
+	if (bIsChanged) {
+		NotifyIpChanged();
+	}
+
 	DEBUG_EXIT
 	return m_IsDhcpUsed;
 }
+
+void NetworkH3emac::SaveDhcpLease() {
+	struct dhcp_lease lease;
+
+	if ((m_pNetworkStore == nullptr) || !net_get_dhcp_lease(&lease)) {
+		return;
+	}
+
+	struct TDhcpLease tDhcpLease;
+
+	tDhcpLease.nIp = lease.ip;
+	tDhcpLease.nNetmask = lease.netmask;
+	tDhcpLease.nGatewayIp = lease.gw;
+	tDhcpLease.nServerIp = lease.server_ip;
+	tDhcpLease.nLeaseTime = lease.lease_time;
+
+	m_pNetworkStore->SaveDhcpLease(&tDhcpLease);
+}
+
+/**
+ * A lease has been bound by the background DHCP client, either the cached one
+ * confirmed by the server or a new one after a DHCPNAK. After the DHCPNAK
+ * itself there is no lease and the address is 0.0.0.0 until the next one.
+ */
+void NetworkH3emac::callbackFunction() {
+	DEBUG_ENTRY
+
+	struct dhcp_lease lease;
+	const auto bIsBound = net_get_dhcp_lease(&lease);
+
+	if (!bIsBound) {
+		lease.ip = 0;
+		lease.netmask = 0;
+		lease.gw = 0;
+		lease.lease_time = 0;
+	}
+
+	const auto bIsChanged = (lease.ip != m_nLocalIp) || (lease.netmask != m_nNetmask);
+
+	m_IsDhcpUsed = true;
+	m_IsZeroconfUsed = false;
+	m_nLocalIp = lease.ip;
+	m_nNetmask = lease.netmask;
+	m_nGatewayIp = (lease.gw == 0) ? m_nLocalIp : lease.gw;
+
+	if (bIsBound) {
+		SaveDhcpLease();
+	}
+
+	if (m_pNetworkDisplay != nullptr) {
+		m_pNetworkDisplay->ShowDhcpStatus(bIsBound ? DhcpClientStatus::GOT_IP : DhcpClientStatus::RENEW);
+
+		if (bIsChanged) {
+			m_pNetworkDisplay->ShowIp();
+			m_pNetworkDisplay->ShowNetMask();
+		}
+	}
+
+	if (bIsChanged) {
+		NotifyIpChanged();
+	}
+
+	DEBUG_PRINTF(IPSTR " %u seconds", IP2STR(lease.ip), lease.lease_time);
+	DEBUG_EXIT
+}
+
+void NetworkH3emac::staticCallbackFunction() {
+	static_cast<NetworkH3emac*>(Network::Get())->callbackFunction();
+}
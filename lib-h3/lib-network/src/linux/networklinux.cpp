@@ -34,6 +34,9 @@
 #include <ifaddrs.h>
 #include <errno.h>
 #include <cassert>
+#if defined (__linux__)
+# include <sys/epoll.h>
+#endif
 
 #include "networklinux.h"
 
@@ -61,6 +64,24 @@ NetworkLinux::NetworkLinux() {
 }
 
 NetworkLinux::~NetworkLinux() {
+#if defined (__linux__)
+	if (m_nEpollFd >= 0) {
+		close(m_nEpollFd);
+	}
+#endif
+}
+
+/**
+ * Returns the port index for a socket handle, or -1
+ */
+static int32_t get_port_index(int32_t nHandle) {
+	for (int32_t i = 0; i < max::PORTS_ALLOWED; i++) {
+		if (snHandles[i] == nHandle) {
+			return i;
+		}
+	}
+
+	return -1;
 }
 
 int NetworkLinux::Init(const char *s) {
@@ -84,6 +105,13 @@ int NetworkLinux::Init(const char *s) {
  * END
  */
 
+#if defined (__linux__)
+	if ((m_nEpollFd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+		perror("epoll_create1");
+		exit(EXIT_FAILURE);
+	}
+#endif
+
 	assert(s != nullptr);
 
 	if (IfGetByAddress(s, m_aIfName, sizeof(m_aIfName)) == 0) {
@@ -189,6 +217,16 @@ int32_t NetworkLinux::Begin(uint16_t nPort) {
 		exit(EXIT_FAILURE);
 	}
 
+#if defined (__linux__)
+	struct epoll_event event;
+	event.events = EPOLLIN;
+	event.data.u32 = static_cast<uint32_t>(i);
+
+	if (epoll_ctl(m_nEpollFd, EPOLL_CTL_ADD, nSocket, &event) == -1) {
+		perror("epoll_ctl(EPOLL_CTL_ADD)");
+		exit(EXIT_FAILURE);
+	}
+#else
 	struct timeval recv_timeout;
 	recv_timeout.tv_sec = 0;
 	recv_timeout.tv_usec = 10;
@@ -197,6 +235,7 @@ int32_t NetworkLinux::Begin(uint16_t nPort) {
 		perror("setsockopt(SO_RCVTIMEO)");
 		exit(EXIT_FAILURE);
 	}
+#endif
 
     memset(&si_me, 0, sizeof(si_me));
 
@@ -250,6 +289,9 @@ int32_t NetworkLinux::End(uint16_t nPort) {
 		if (s_ports_allowed[i] == nPort) {
 			s_ports_allowed[i] = 0;
 			printf("close");
+#if defined (__linux__)
+			m_nReadyMask &= ~(1U << i);
+#endif
 			if (close(snHandles[i]) == -1) {
 				perror("unbind");
 				exit(EXIT_FAILURE);
@@ -310,12 +352,20 @@ void NetworkLinux::SetIp(__attribute__((unused)) uint32_t nIp) {
 
     m_IsDhcpUsed = false;
     m_nLocalIp = nIp;
+
+    NotifyIpChanged();
 #endif
 }
 
 void NetworkLinux::SetNetmask(__attribute__((unused)) uint32_t nNetmask) {
 #if defined(__linux__)
+	if (nNetmask == m_nNetmask) {
+		return;
+	}
+
 	m_nNetmask = nNetmask;
+
+	NotifyIpChanged();
 #endif
 }
 
@@ -350,13 +400,45 @@ uint16_t NetworkLinux::RecvFrom(int32_t nHandle, void *pPacket, uint16_t nSize,
 	struct sockaddr_in si_other;
 	socklen_t slen = sizeof(si_other);
 
+#if defined (__linux__)
+	const auto nIndex = get_port_index(nHandle);
+
+	if (nIndex < 0) {
+		// Handle from BeginReusePort
+		if ((recv_len = recvfrom(nHandle, pPacket, nSize, 0, reinterpret_cast<struct sockaddr*>(&si_other), &slen)) == -1) {
+			if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+				perror("recvfrom");
+			}
+			return 0;
+		}
+
+		*pFromIp = si_other.sin_addr.s_addr;
+		*pFromPort = ntohs(si_other.sin_port);
+
+		return recv_len;
+	}
+
+	const auto nMask = 1U << nIndex;
+
+	if (m_bPolled && ((m_nReadyMask & nMask) == 0)) {
+		return 0;
+	}
 
+	if ((recv_len = recvfrom(nHandle, pPacket, nSize, MSG_DONTWAIT, reinterpret_cast<struct sockaddr*>(&si_other), &slen)) == -1) {
+		if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+			perror("recvfrom");
+		}
+		m_nReadyMask &= ~nMask;
+		return 0;
+	}
+#else
 	if ((recv_len = recvfrom(nHandle, pPacket, nSize, 0, reinterpret_cast<struct sockaddr*>(&si_other), &slen)) == -1) {
 		if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
 			perror("recvfrom");
 		}
 		return 0;
 	}
+#endif
 
 	*pFromIp = si_other.sin_addr.s_addr;
 	*pFromPort = ntohs(si_other.sin_port);
@@ -364,6 +446,99 @@ uint16_t NetworkLinux::RecvFrom(int32_t nHandle, void *pPacket, uint16_t nSize,
 	return recv_len;
 }
 
+#if defined (__linux__)
+void NetworkLinux::Poll() {
+	struct epoll_event events[max::PORTS_ALLOWED];
+
+	const auto nEvents = epoll_wait(m_nEpollFd, events, max::PORTS_ALLOWED, m_nIdleTimeoutMillis);
+
+	m_bPolled = true;
+
+	if (nEvents == -1) {
+		if (errno != EINTR) {
+			perror("epoll_wait");
+		}
+		m_nReadyMask = ~0U;
+		return;
+	}
+
+	m_nReadyMask = 0;
+
+	for (auto i = 0; i < nEvents; i++) {
+		m_nReadyMask |= (1U << events[i].data.u32);
+	}
+}
+#endif
+
+#if defined (__linux__)
+int32_t NetworkLinux::BeginReusePort(uint16_t nPort, uint32_t nTimeoutMillis) {
+	DEBUG_ENTRY
+	DEBUG_PRINTF("port = %d", nPort);
+
+	int nSocket;
+	struct sockaddr_in si_me;
+	int true_flag = true;
+	int false_flag = false;
+
+	if ((nSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)) == -1) {
+		perror("socket");
+		exit(EXIT_FAILURE);
+	}
+
+	if (setsockopt(nSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char*>(&true_flag), sizeof(int)) == -1) {
+		perror("setsockopt(SO_REUSEADDR)");
+		exit(EXIT_FAILURE);
+	}
+
+	if (setsockopt(nSocket, SOL_SOCKET, SO_REUSEPORT, reinterpret_cast<char*>(&true_flag), sizeof(int)) == -1) {
+		perror("setsockopt(SO_REUSEPORT)");
+		exit(EXIT_FAILURE);
+	}
+
+	// Only deliver the multicast groups joined on this socket
+	if (setsockopt(nSocket, IPPROTO_IP, IP_MULTICAST_ALL, reinterpret_cast<char*>(&false_flag), sizeof(int)) == -1) {
+		perror("setsockopt(IP_MULTICAST_ALL)");
+		exit(EXIT_FAILURE);
+	}
+
+	if (setsockopt(nSocket, SOL_SOCKET, SO_BROADCAST, reinterpret_cast<char*>(&true_flag), sizeof(int)) == -1) {
+		perror("setsockopt(SO_BROADCAST)");
+		exit(EXIT_FAILURE);
+	}
+
+	struct timeval recv_timeout;
+	recv_timeout.tv_sec = nTimeoutMillis / 1000;
+	recv_timeout.tv_usec = (nTimeoutMillis % 1000) * 1000;
+
+	if (setsockopt(nSocket, SOL_SOCKET, SO_RCVTIMEO, static_cast<void*>(&recv_timeout), sizeof(recv_timeout)) == -1) {
+		perror("setsockopt(SO_RCVTIMEO)");
+		exit(EXIT_FAILURE);
+	}
+
+	memset(&si_me, 0, sizeof(si_me));
+
+	si_me.sin_family = AF_INET;
+	si_me.sin_port = htons(nPort);
+	si_me.sin_addr.s_addr = htonl(INADDR_ANY);
+
+	if (bind(nSocket, reinterpret_cast<struct sockaddr*>(&si_me), sizeof(si_me)) == -1) {
+		perror("bind");
+		exit(EXIT_FAILURE);
+	}
+
+	DEBUG_EXIT
+	return nSocket;
+}
+
+void NetworkLinux::EndReusePort(int32_t nHandle) {
+	assert(get_port_index(nHandle) < 0);
+
+	if (close(nHandle) == -1) {
+		perror("close");
+	}
+}
+#endif
+
 void NetworkLinux::SendTo(int32_t nHandle, const void *pPacket, uint16_t nSize, uint32_t nToIp, uint16_t nRemotePort) {
 	struct sockaddr_in si_other;
 	socklen_t slen = sizeof(si_other);
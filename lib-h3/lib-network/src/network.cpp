@@ -128,6 +128,35 @@ uint32_t Network::CIDRToNetmask(uint8_t nCDIR) {
 	return 0;
 }
 
+void Network::AddIpObserver(NetworkIpObserver *pNetworkIpObserver) {
+	for (uint32_t i = 0; i < IP_OBSERVERS_MAX; i++) {
+		if (m_pNetworkIpObservers[i] == nullptr) {
+			m_pNetworkIpObservers[i] = pNetworkIpObserver;
+			return;
+		}
+	}
+
+	assert(0);
+}
+
+void Network::RemoveIpObserver(NetworkIpObserver *pNetworkIpObserver) {
+	for (uint32_t i = 0; i < IP_OBSERVERS_MAX; i++) {
+		if (m_pNetworkIpObservers[i] == pNetworkIpObserver) {
+			m_pNetworkIpObservers[i] = nullptr;
+		}
+	}
+}
+
+void Network::NotifyIpChanged() {
+	DEBUG_PRINTF(IPSTR "/%d", IP2STR(m_nLocalIp), GetNetmaskCIDR());
+
+	for (uint32_t i = 0; i < IP_OBSERVERS_MAX; i++) {
+		if (m_pNetworkIpObservers[i] != nullptr) {
+			m_pNetworkIpObservers[i]->IpChanged();
+		}
+	}
+}
+
 void Network::SetHostName(const char *pHostName) {
 	DEBUG_ENTRY
 
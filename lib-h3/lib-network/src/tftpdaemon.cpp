@@ -25,9 +25,14 @@
 
 /*
  * https://tools.ietf.org/html/rfc1350
+ * https://tools.ietf.org/html/rfc2347 Option Extension
+ * https://tools.ietf.org/html/rfc2348 Blocksize Option
+ * https://tools.ietf.org/html/rfc2349 Transfer Size Option
+ * https://tools.ietf.org/html/rfc7440 Windowsize Option
  */
 
 #include <stdint.h>
+#include <stdio.h>
 #include <string.h>
 #include <cassert>
 
@@ -42,7 +47,8 @@ enum TOpCode {
 	OP_CODE_WRQ = 2,			///< Write request (WRQ)
 	OP_CODE_DATA = 3,			///< Data (DATA)
 	OP_CODE_ACK = 4,			///< Acknowledgment (ACK)
-	OP_CODE_ERROR = 5			///< Error (ERROR)
+	OP_CODE_ERROR = 5,			///< Error (ERROR)
+	OP_CODE_OACK = 6			///< Option Acknowledgment (OACK)
 };
 
 enum TErrorCode {
@@ -56,18 +62,28 @@ enum TErrorCode {
 	ERROR_CODE_INV_USER = 7		///< No such user.
 };
 
+enum TOption {
+	OPTION_BLKSIZE = (1U << 0),
+	OPTION_WINDOWSIZE = (1U << 1),
+	OPTION_TSIZE = (1U << 2)
+};
+
 #define TFTP_UDP_PORT			69
 
 namespace min {
 	static constexpr auto FILENAME_MODE_LEN = (1 + 1 + 1 + 1);
+	static constexpr auto BLKSIZE = 8;
+	static constexpr auto WINDOWSIZE = 1;
 }
 
 namespace max {
 	static constexpr auto FILENAME_LEN = 128;
 	static constexpr auto MODE_LEN = 16;
 	static constexpr auto FILENAME_MODE_LEN = (FILENAME_LEN + 1 + MODE_LEN + 1);
-	static constexpr auto DATA_LEN = 512;
+	static constexpr auto DATA_LEN = TFTPDaemon::BLKSIZE_MAX;
 	static constexpr auto ERRMSG_LEN = 128;
+	static constexpr auto BLKSIZE = 65464;
+	static constexpr auto WINDOWSIZE = 65535;
 }
 
 #if  !defined (PACKED)
@@ -96,6 +112,30 @@ struct TTFTPDataPacket {
 	uint8_t Data[max::DATA_LEN];
 } PACKED;
 
+struct TTFTPOackPacket {
+	uint16_t OpCode;
+	char Options[max::DATA_LEN];
+} PACKED;
+
+static constexpr auto DATA_HEADER_LEN = sizeof(struct TTFTPDataPacket) - max::DATA_LEN;
+
+static bool parse_uint32(const char *pValue, uint32_t& nValue) {
+	if (*pValue == '\0') {
+		return false;
+	}
+
+	nValue = 0;
+
+	while (*pValue != '\0') {
+		if ((*pValue < '0') || (*pValue > '9') || (nValue > 0x0FFFFFFF)) {
+			return false;
+		}
+		nValue = nValue * 10 + static_cast<uint32_t>(*pValue++ - '0');
+	}
+
+	return true;
+}
+
 TFTPDaemon *TFTPDaemon::s_pThis = nullptr;
 
 TFTPDaemon::TFTPDaemon()
@@ -144,13 +184,38 @@ bool TFTPDaemon::Run() {
 		m_nBlockNumber = 0;
 		m_nState = TFTPState::WAITING_RQ;
 		m_bIsLastBlock = false;
+		m_nBlockSize = BLKSIZE_DEFAULT;
+		m_nWindowSize = 1;
+		m_nTransferSize = 0;
+		m_nOptionMask = 0;
+		m_nWindowFirst = 0;
+		m_nWindowBlocks = 0;
+		m_nWindowLength = 0;
+		m_nFileOffset = 0;
+		m_bIsGapAcked = false;
 		memset(&m_Buffer, 0, sizeof(struct TTFTPReqPacket));
 	} else {
 		m_nLength = Network::Get()->RecvFrom(m_nIdx, &m_Buffer, sizeof(m_Buffer), &m_nFromIp, &m_nFromPort);
 
+		if ((m_nState != TFTPState::WAITING_RQ) && (m_nLength >= DATA_HEADER_LEN)) {
+			auto *pAckPacket = reinterpret_cast<struct TTFTPAckPacket*>(&m_Buffer);
+
+			if (pAckPacket->OpCode == __builtin_bswap16(OP_CODE_ERROR)) {
+				DEBUG_PRINTF("Error %d from " IPSTR, __builtin_bswap16(pAckPacket->BlockNumber), IP2STR(m_nFromIp));
+				// Transfer aborted by the client. FileClose() is not called for a write,
+				// as it marks the file as complete.
+				if (m_nState == TFTPState::RRQ_RECV_ACK) {
+					FileClose();
+				}
+				m_nState = TFTPState::INIT;
+				return true;
+			}
+		}
+
 		switch (m_nState) {
 		case TFTPState::WAITING_RQ:
-			if (m_nLength > min::FILENAME_MODE_LEN) {
+			if ((m_nLength > min::FILENAME_MODE_LEN) && (m_nLength < sizeof(m_Buffer))) {
+				m_Buffer[m_nLength] = '\0';
 				HandleRequest();
 			}
 			break;
@@ -163,7 +228,7 @@ bool TFTPDaemon::Run() {
 			}
 			break;
 		case TFTPState::WRQ_RECV_PACKET:
-			if (m_nLength <= sizeof(struct TTFTPDataPacket)) {
+			if ((m_nLength >= DATA_HEADER_LEN) && (m_nLength <= (DATA_HEADER_LEN + m_nBlockSize))) {
 				HandleRecvData();
 			}
 			break;
@@ -209,6 +274,14 @@ void TFTPDaemon::HandleRequest() {
 
 	DEBUG_PRINTF("Incoming %s request from " IPSTR " %s %s", nOpCode == OP_CODE_RRQ ? "read" : "write", IP2STR(m_nFromIp), pFileName, pMode);
 
+	const auto *pEnd = reinterpret_cast<const char *>(&m_Buffer[m_nLength]);
+	const auto *pOptions = pMode + strlen(pMode) + 1;
+
+	if ((pOptions < pEnd) && HandleOptions(pOptions, pEnd) && (nOpCode == OP_CODE_RRQ)) {
+		// The size of the file to be read is not known
+		m_nOptionMask &= ~static_cast<uint32_t>(OPTION_TSIZE);
+	}
+
 	switch (nOpCode) {
 		case OP_CODE_RRQ:
 			if(!FileOpen(pFileName, tMode)) {
@@ -217,8 +290,14 @@ void TFTPDaemon::HandleRequest() {
 			} else {
 				Network::Get()->End(TFTP_UDP_PORT);
 				m_nIdx = Network::Get()->Begin(m_nFromPort);
-				m_nState = TFTPState::RRQ_SEND_PACKET;
-				DoRead();
+				if (m_nOptionMask != 0) {
+					// The client acknowledges the OACK with block number 0
+					SendOptionAck();
+					m_nState = TFTPState::RRQ_RECV_ACK;
+				} else {
+					m_nState = TFTPState::RRQ_SEND_PACKET;
+					DoRead();
+				}
 			}
 			break;
 		case OP_CODE_WRQ:
@@ -228,8 +307,14 @@ void TFTPDaemon::HandleRequest() {
 			} else {
 				Network::Get()->End(TFTP_UDP_PORT);
 				m_nIdx = Network::Get()->Begin(m_nFromPort);
-				m_nState = TFTPState::WRQ_SEND_ACK;
-				DoWriteAck();
+				if (m_nOptionMask != 0) {
+					// The OACK replaces the ACK of block number 0
+					SendOptionAck();
+					m_nState = TFTPState::WRQ_RECV_PACKET;
+				} else {
+					m_nState = TFTPState::WRQ_SEND_ACK;
+					DoWriteAck();
+				}
 			}
 			break;
 		default:
@@ -238,6 +323,81 @@ void TFTPDaemon::HandleRequest() {
 	}
 }
 
+/**
+ * Options the server does not know, or with an invalid value, are ignored.
+ * Requested values larger than the maximum are lowered, the OACK tells the client.
+ */
+bool TFTPDaemon::HandleOptions(const char *pOptions, const char *pEnd) {
+	while (pOptions < pEnd) {
+		const char *pOption = pOptions;
+		const char *pValue = pOption + strlen(pOption) + 1;
+
+		if (pValue >= pEnd) {
+			break;
+		}
+
+		pOptions = pValue + strlen(pValue) + 1;
+
+		uint32_t nValue;
+
+		if (!parse_uint32(pValue, nValue)) {
+			continue;
+		}
+
+		DEBUG_PRINTF("%s=%u", pOption, nValue);
+
+		if (strcasecmp(pOption, "blksize") == 0) {
+			if ((nValue >= min::BLKSIZE) && (nValue <= max::BLKSIZE)) {
+				m_nBlockSize = nValue < BLKSIZE_MAX ? nValue : BLKSIZE_MAX;
+				m_nOptionMask |= OPTION_BLKSIZE;
+			}
+		} else if (strcasecmp(pOption, "windowsize") == 0) {
+			if ((nValue >= min::WINDOWSIZE) && (nValue <= max::WINDOWSIZE)) {
+				m_nWindowSize = nValue < WINDOWSIZE_MAX ? nValue : WINDOWSIZE_MAX;
+				m_nOptionMask |= OPTION_WINDOWSIZE;
+			}
+		} else if (strcasecmp(pOption, "tsize") == 0) {
+			m_nTransferSize = nValue;
+			m_nOptionMask |= OPTION_TSIZE;
+		}
+	}
+
+	DEBUG_PRINTF("m_nBlockSize=%u, m_nWindowSize=%u, m_nTransferSize=%u", m_nBlockSize, m_nWindowSize, m_nTransferSize);
+
+	return m_nOptionMask != 0;
+}
+
+void TFTPDaemon::SendOptionAck() {
+	auto *pOackPacket = reinterpret_cast<struct TTFTPOackPacket*>(&m_Buffer);
+
+	pOackPacket->OpCode = __builtin_bswap16(OP_CODE_OACK);
+
+	auto *pOption = pOackPacket->Options;
+	const auto *pEnd = &pOackPacket->Options[sizeof(pOackPacket->Options)];
+
+	// snprintf writes the '\0' that separates the option strings
+	if (m_nOptionMask & OPTION_BLKSIZE) {
+		pOption += snprintf(pOption, static_cast<size_t>(pEnd - pOption), "blksize") + 1;
+		pOption += snprintf(pOption, static_cast<size_t>(pEnd - pOption), "%u", m_nBlockSize) + 1;
+	}
+
+	if (m_nOptionMask & OPTION_WINDOWSIZE) {
+		pOption += snprintf(pOption, static_cast<size_t>(pEnd - pOption), "windowsize") + 1;
+		pOption += snprintf(pOption, static_cast<size_t>(pEnd - pOption), "%u", m_nWindowSize) + 1;
+	}
+
+	if (m_nOptionMask & OPTION_TSIZE) {
+		pOption += snprintf(pOption, static_cast<size_t>(pEnd - pOption), "tsize") + 1;
+		pOption += snprintf(pOption, static_cast<size_t>(pEnd - pOption), "%u", m_nTransferSize) + 1;
+	}
+
+	const auto nLength = static_cast<uint16_t>(pOption - reinterpret_cast<char *>(&m_Buffer));
+
+	DEBUG_PRINTF("Sending OACK to " IPSTR ":%d, nLength=%d", IP2STR(m_nFromIp), m_nFromPort, nLength);
+
+	Network::Get()->SendTo(m_nIdx, &m_Buffer, nLength, m_nFromIp, m_nFromPort);
+}
+
 void TFTPDaemon::SendError (uint16_t nErrorCode, const char *pErrorMessage) {
 	TTFTPErrorPacket ErrorPacket;
 
@@ -248,28 +408,41 @@ void TFTPDaemon::SendError (uint16_t nErrorCode, const char *pErrorMessage) {
 	Network::Get()->SendTo(m_nIdx, &ErrorPacket, sizeof ErrorPacket, m_nFromIp, m_nFromPort);
 }
 
+/**
+ * Reads blocks until the window is full, then (re)sends all the blocks
+ * in the window that are not yet acknowledged.
+ * m_nBlockNumber is the last acknowledged block.
+ */
 void TFTPDaemon::DoRead() {
-	auto *pDataPacket = reinterpret_cast<struct TTFTPDataPacket*>(&m_Buffer);
+	while ((m_nWindowBlocks < m_nWindowSize) && !m_bIsLastBlock) {
+		const auto nSlot = (m_nWindowFirst + m_nWindowBlocks) % m_nWindowSize;
+		auto *pDataPacket = reinterpret_cast<struct TTFTPDataPacket*>(&m_Window[nSlot * sizeof(struct TTFTPDataPacket)]);
 
-	if (m_nState == TFTPState::RRQ_SEND_PACKET) {
-		m_nDataLength = FileRead(pDataPacket->Data, max::DATA_LEN, ++m_nBlockNumber);
+		m_nDataLength = FileRead(pDataPacket->Data, m_nBlockSize, m_nFileOffset);
+		m_nFileOffset += m_nDataLength;
+		m_nWindowBlocks++;
 
 		pDataPacket->OpCode = __builtin_bswap16(OP_CODE_DATA);
-		pDataPacket->BlockNumber = __builtin_bswap16(m_nBlockNumber);
+		pDataPacket->BlockNumber = __builtin_bswap16(static_cast<uint16_t>(m_nBlockNumber + m_nWindowBlocks));
 
-		m_nPacketLength = sizeof pDataPacket->OpCode + sizeof pDataPacket->BlockNumber + m_nDataLength;
-		m_bIsLastBlock = m_nDataLength < max::DATA_LEN;
+		m_bIsLastBlock = m_nDataLength < m_nBlockSize;
 
 		if (m_bIsLastBlock) {
 			FileClose();
 		}
 
-		DEBUG_PRINTF("m_nDataLength=%d, m_nPacketLength=%d, m_bIsLastBlock=%d", m_nDataLength, m_nPacketLength, m_bIsLastBlock);
+		DEBUG_PRINTF("m_nDataLength=%d, m_nWindowBlocks=%d, m_bIsLastBlock=%d", m_nDataLength, m_nWindowBlocks, m_bIsLastBlock);
 	}
 
 	DEBUG_PRINTF("Sending to " IPSTR ":%d", IP2STR(m_nFromIp), m_nFromPort);
 
-	Network::Get()->SendTo(m_nIdx, &m_Buffer, m_nPacketLength, m_nFromIp, m_nFromPort);
+	for (uint32_t i = 0; i < m_nWindowBlocks; i++) {
+		const auto nSlot = (m_nWindowFirst + i) % m_nWindowSize;
+		const auto bIsLastBlock = m_bIsLastBlock && ((i + 1) == m_nWindowBlocks);
+		const auto nLength = static_cast<uint16_t>(DATA_HEADER_LEN + (bIsLastBlock ? m_nDataLength : m_nBlockSize));
+
+		Network::Get()->SendTo(m_nIdx, &m_Window[nSlot * sizeof(struct TTFTPDataPacket)], nLength, m_nFromIp, m_nFromPort);
+	}
 
 	m_nState = TFTPState::RRQ_RECV_ACK;
 }
@@ -278,12 +451,32 @@ void TFTPDaemon::HandleRecvAck() {
 	auto *pAckPacket = reinterpret_cast<struct TTFTPAckPacket*>(&m_Buffer);
 
 	if (pAckPacket->OpCode == __builtin_bswap16(OP_CODE_ACK)) {
+		const auto nAcked = static_cast<uint16_t>(__builtin_bswap16(pAckPacket->BlockNumber) - m_nBlockNumber);
 
-		DEBUG_PRINTF("Incoming from " IPSTR ", BlockNumber=%d, m_nBlockNumber=%d", IP2STR(m_nFromIp), __builtin_bswap16(pAckPacket->BlockNumber), m_nBlockNumber	);
+		DEBUG_PRINTF("Incoming from " IPSTR ", BlockNumber=%d, m_nBlockNumber=%d, nAcked=%d", IP2STR(m_nFromIp), __builtin_bswap16(pAckPacket->BlockNumber), m_nBlockNumber, nAcked);
 
-		if (pAckPacket->BlockNumber == __builtin_bswap16(m_nBlockNumber)) {
-			m_nState = m_bIsLastBlock ? TFTPState::INIT : TFTPState::RRQ_SEND_PACKET;
+		if (nAcked > m_nWindowBlocks) {
+			return;
 		}
+
+		// Without a window a duplicate ACK is not answered (Sorcerer's Apprentice Syndrome).
+		// With a window it is the ACK of the last block received in sequence.
+		if ((nAcked == 0) && (m_nWindowBlocks != 0) && (m_nWindowSize == 1)) {
+			return;
+		}
+
+		if (m_bIsLastBlock && (nAcked == m_nWindowBlocks)) {
+			m_nState = TFTPState::INIT;
+			return;
+		}
+
+		m_nBlockNumber = static_cast<uint16_t>(m_nBlockNumber + nAcked);
+		m_nWindowFirst = (m_nWindowFirst + nAcked) % m_nWindowSize;
+		m_nWindowBlocks -= nAcked;
+
+		// Read and send right away, a next ACK must not be consumed by RRQ_SEND_PACKET
+		m_nState = TFTPState::RRQ_SEND_PACKET;
+		DoRead();
 	}
 }
 
@@ -299,26 +492,70 @@ void TFTPDaemon::DoWriteAck() {
 	Network::Get()->SendTo(m_nIdx, &m_Buffer, sizeof(struct TTFTPAckPacket), m_nFromIp, m_nFromPort);
 }
 
-void TFTPDaemon::HandleRecvData() {
-	auto *pDataPacket = reinterpret_cast<struct TTFTPDataPacket*>(&m_Buffer);
+/**
+ * One FileWrite for all the blocks received since the previous ACK
+ */
+bool TFTPDaemon::WindowFlush() {
+	if (m_nWindowLength != 0) {
+		if (FileWrite(m_Window, m_nWindowLength, m_nFileOffset) != m_nWindowLength) {
+			SendError(ERROR_CODE_DISK_FULL, "Write failed");
+			m_nState = TFTPState::INIT;
+			return false;
+		}
 
-	if (pDataPacket->OpCode == __builtin_bswap16(OP_CODE_DATA)) {
-		m_nDataLength = m_nLength - 4;
-		m_nBlockNumber = __builtin_bswap16(pDataPacket->BlockNumber);
+		m_nFileOffset += m_nWindowLength;
+		m_nWindowLength = 0;
+	}
 
-		DEBUG_PRINTF("Incoming from " IPSTR ", m_nLength=%d, m_nBlockNumber=%d, m_nDataLength=%d", IP2STR(m_nFromIp), m_nLength, m_nBlockNumber,m_nDataLength);
+	m_nWindowBlocks = 0;
+	return true;
+}
 
-		if (m_nDataLength == FileWrite(pDataPacket->Data, m_nDataLength, m_nBlockNumber)) {
+void TFTPDaemon::HandleRecvData() {
+	auto *pDataPacket = reinterpret_cast<struct TTFTPDataPacket*>(&m_Buffer);
 
-			if (m_nDataLength < max::DATA_LEN) {
+	if (pDataPacket->OpCode == __builtin_bswap16(OP_CODE_DATA)) {
+		m_nDataLength = m_nLength - DATA_HEADER_LEN;
+		const auto nBlockNumber = __builtin_bswap16(pDataPacket->BlockNumber);
+		const auto nExpected = static_cast<uint16_t>(m_nBlockNumber + 1);
+
+		DEBUG_PRINTF("Incoming from " IPSTR ", m_nLength=%d, nBlockNumber=%d, m_nDataLength=%d", IP2STR(m_nFromIp), m_nLength, nBlockNumber, m_nDataLength);
+
+		if (nBlockNumber == nExpected) {
+			memcpy(&m_Window[m_nWindowLength], pDataPacket->Data, m_nDataLength);
+			m_nWindowLength += m_nDataLength;
+			m_nWindowBlocks++;
+			m_nBlockNumber = nBlockNumber;
+			m_bIsGapAcked = false;
+
+			if (m_nDataLength < m_nBlockSize) {
+				if (!WindowFlush()) {
+					return;
+				}
 				m_bIsLastBlock = true;
 				FileClose();
+				DoWriteAck();
+			} else if (m_nWindowBlocks == m_nWindowSize) {
+				if (WindowFlush()) {
+					DoWriteAck();
+				}
 			}
 
+			return;
+		}
+
+		if ((nBlockNumber == m_nBlockNumber) && (m_nWindowBlocks == 0)) {
+			// Our ACK got lost, the client sends the window again
 			DoWriteAck();
-		} else {
-			SendError(ERROR_CODE_DISK_FULL, "Write failed");
-			m_nState = TFTPState::INIT;
+			return;
+		}
+
+		if ((static_cast<uint16_t>(nBlockNumber - nExpected) < 0x8000) && !m_bIsGapAcked) {
+			// A block is missing, the client resends the window from the block after this ACK
+			m_bIsGapAcked = true;
+			if (WindowFlush()) {
+				DoWriteAck();
+			}
 		}
 	}
 }
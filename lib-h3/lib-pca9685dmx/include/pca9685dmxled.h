@@ -32,6 +32,8 @@
 
 #include "pca9685pwmled.h"
 
+#include "colourcorrection.h"
+
 class PCA9685DmxLed final: public LightSet {
 public:
 	PCA9685DmxLed();
@@ -41,6 +43,7 @@ public:
 	void Stop(uint8_t nPort = 0) override;
 
 	void SetData(uint8_t nPort, const uint8_t *pDmxData, uint16_t nLength) override;
+	void SetDataRange(uint8_t nPort, const uint8_t *pDmxData, uint16_t nLength, uint16_t nFirst, uint16_t nEnd) override;
 
 public: // RDM
 	bool SetDmxStartAddress(uint16_t nDmxStartAddress) override;
@@ -79,6 +82,15 @@ public:
 
 	void SetDmxFootprint(uint16_t nDmxFootprint);
 
+	/**
+	 * The channels are taken as Red, Green, Blue triplets
+	 */
+	void SetColourCorrection(const struct TColourCorrectionParams *pParams) {
+		m_ColourCorrection.Set(pParams);
+		m_bFullRefresh = true;
+		m_bForceWrite = true;
+	}
+
 private:
 	void Initialize();
 
@@ -91,10 +103,13 @@ private:
 	bool m_bOutputInvert{false};
 	bool m_bOutputDriver{true};
 	bool m_bIsStarted{false};
+	bool m_bFullRefresh{true};
+	bool m_bForceWrite{false};
 	PCA9685PWMLed **m_pPWMLed{nullptr};
 	uint8_t *m_pDmxData{nullptr};
 	char *m_pSlotInfoRaw{nullptr};
 	struct TLightSetSlotInfo *m_pSlotInfo{nullptr};
+	ColourCorrection m_ColourCorrection;
 };
 
 #endif /* PCA9685DMXLED_H_ */
@@ -55,6 +55,7 @@ private:
     uint16_t m_nPwmFrequency{PWMLED_DEFAULT_FREQUENCY};
 	bool m_bOutputInvert{false};
 	bool m_bOutputDriver{true};
+	struct TColourCorrectionParams m_tColourCorrection;
 };
 
 #endif /* PCA9685DMXLEDPARAMS_H_ */
@@ -24,6 +24,7 @@
  */
 
 #include <stdint.h>
+#include <algorithm>
 #ifndef NDEBUG
  #include <stdio.h>
 #endif
@@ -85,32 +86,61 @@ void PCA9685DmxLed::Stop(__attribute__((unused)) uint8_t nPort) {
 	m_bIsStarted = false;
 }
 
-void PCA9685DmxLed::SetData(__attribute__((unused)) uint8_t nPort, const uint8_t *pDmxData, uint16_t nLength) {
+void PCA9685DmxLed::SetData(uint8_t nPort, const uint8_t *pDmxData, uint16_t nLength) {
+	m_bFullRefresh = true;
+	SetDataRange(nPort, pDmxData, nLength, 0, nLength);
+}
+
+void PCA9685DmxLed::SetDataRange(__attribute__((unused)) uint8_t nPort, const uint8_t *pDmxData, uint16_t nLength, uint16_t nFirst, uint16_t nEnd) {
 	assert(pDmxData != nullptr);
 	assert(nLength <= DMX_MAX_CHANNELS);
 
 	if (__builtin_expect((m_pPWMLed == nullptr), 0)) {
+		m_bFullRefresh = true;
 		Start();
 	}
 
-	uint8_t *p = const_cast<uint8_t*>(pDmxData) + m_nDmxStartAddress - 1;
-	uint8_t *q = m_pDmxData;
+	unsigned nFirstChannel = 0;
+
+	if (!m_bFullRefresh) {
+		const unsigned nOffset = m_nDmxStartAddress - 1U;
 
-	uint16_t nChannel = m_nDmxStartAddress;
+		if ((nFirst >= nEnd) || (nEnd <= nOffset)) {
+			return;
+		}
+
+		nFirstChannel = (nFirst > nOffset) ? (nFirst - nOffset) : 0;
+		nLength = std::min(nLength, nEnd);
+	}
 
-	for (unsigned j = 0; j < m_nBoardInstances; j++) {
-		for (unsigned i = 0; i < PCA9685_PWM_CHANNELS; i++) {
+	m_bFullRefresh = false;
+
+	const auto bForceWrite = m_bForceWrite;
+	m_bForceWrite = false;
+
+	uint8_t *p = const_cast<uint8_t*>(pDmxData) + m_nDmxStartAddress - 1 + nFirstChannel;
+	uint8_t *q = m_pDmxData + nFirstChannel;
+
+	uint16_t nChannel = static_cast<uint16_t>(m_nDmxStartAddress + nFirstChannel);
+	unsigned nColour = nFirstChannel % 3;
+
+	for (unsigned j = nFirstChannel / PCA9685_PWM_CHANNELS; j < m_nBoardInstances; j++) {
+		for (unsigned i = (j == nFirstChannel / PCA9685_PWM_CHANNELS) ? (nFirstChannel % PCA9685_PWM_CHANNELS) : 0; i < PCA9685_PWM_CHANNELS; i++) {
 			if ((nChannel >= (m_nDmxFootprint + m_nDmxStartAddress)) || (nChannel > nLength)) {
 				j = m_nBoardInstances;
 				break;
 			}
-			if (*p != *q) {
-				uint8_t value = *p;
+			if (bForceWrite || (*p != *q)) {
+				// 12-bit, the identity table gives (value << 4) | (value >> 4)
+				const uint16_t value = m_ColourCorrection.Get16(static_cast<colourcorrection::Channel>(nColour), *p) >> 4;
 #ifndef NDEBUG
 				printf("m_pPWMLed[%d]->SetDmx(CHANNEL(%d), %d)\n", static_cast<int>(j), static_cast<int>(i), static_cast<int>(value));
 #endif
 				m_pPWMLed[j]->Set(CHANNEL(i), value);
 			}
+			if (++nColour == 3) {
+				nColour = 0;
+			}
 			*q = *p;
 			p++;
 			q++;
@@ -124,6 +154,7 @@ bool PCA9685DmxLed::SetDmxStartAddress(uint16_t nDmxStartAddress) {
 
 	if ((nDmxStartAddress != 0) && (nDmxStartAddress <= DMX_MAX_CHANNELS)) {
 		m_nDmxStartAddress = nDmxStartAddress;
+		m_bFullRefresh = true;
 		return true;
 	}
 
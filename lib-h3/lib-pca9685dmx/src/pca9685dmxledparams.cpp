@@ -43,6 +43,7 @@
 #define SET_OUTPUT_INVERT_MASK	(1 << 1)
 #define SET_OUTPUT_DRIVER_MASK	(1 << 2)
 #define I2C_SLAVE_ADDRESS_MASK	(1 << 3)
+#define COLOUR_CORRECTION_MASK	(1 << 4)
 
 constexpr char PARAMS_FILE_NAME[] = "pwmled.txt";
 constexpr char PARAMS_I2C_SLAVE_ADDRESS[] = "i2c_slave_address";
@@ -53,6 +54,7 @@ constexpr char PARAMS_OUTPUT_DRIVER[] = "output_driver";
 PCA9685DmxLedParams::PCA9685DmxLedParams() :
 	PCA9685DmxParams(PARAMS_FILE_NAME)
 {
+	ColourCorrection::SetDefaults(&m_tColourCorrection);
 }
 
 PCA9685DmxLedParams::~PCA9685DmxLedParams() {
@@ -88,6 +90,10 @@ void PCA9685DmxLedParams::Set(PCA9685DmxLed* pDmxLed) {
 		pDmxLed->SetOutDriver(m_bOutputDriver);
 	}
 
+	if(isMaskSet(COLOUR_CORRECTION_MASK)) {
+		pDmxLed->SetColourCorrection(&m_tColourCorrection);
+	}
+
 	const uint16_t DmxStartAddress = GetDmxStartAddress(isSet);
 	if (isSet) {
 		pDmxLed->SetDmxStartAddress(DmxStartAddress);
@@ -134,6 +140,10 @@ void PCA9685DmxLedParams::Dump() {
 		printf(" %s=%d [The 16 LEDn outputs are configured with %s structure]\n", PARAMS_OUTPUT_DRIVER, (int) m_bOutputDriver, m_bOutputDriver ? "a totem pole" : "an open-drain");
 	}
 
+	if(isMaskSet(COLOUR_CORRECTION_MASK)) {
+		ColourCorrection::Dump(&m_tColourCorrection);
+	}
+
 	PCA9685DmxParams::Dump();
 #endif
 }
@@ -175,6 +185,10 @@ void PCA9685DmxLedParams::callbackFunction(const char* pLine) {
 		}
 		return;
 	}
+
+	if (ColourCorrection::Scan(pLine, &m_tColourCorrection)) {
+		m_bSetList |= COLOUR_CORRECTION_MASK;
+	}
 }
 
 void PCA9685DmxLedParams::staticCallbackFunction(void* p, const char* s) {
@@ -47,6 +47,17 @@ struct DevicesParamsConst {
 
 	static const char ACTIVE_OUT[];
 	static const char USE_SI5351A[];
+
+	static const char LED_INTERPOLATION[];
+	static const char LED_DITHER[];
+
+	static const char MAP_PANEL_WIDTH[];
+	static const char MAP_PANEL_HEIGHT[];
+	static const char MAP_PANEL_COLUMNS[];
+	static const char MAP_PANEL_ROWS[];
+	static const char MAP_SERPENTINE[];
+	static const char MAP_ROTATION[];
+	static const char MAP_CSV[];
 };
 
 #endif /* DEVICESPARAMSCONST_H_ */
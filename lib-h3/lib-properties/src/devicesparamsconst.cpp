@@ -45,3 +45,14 @@ const char DevicesParamsConst::GLOBAL_BRIGHTNESS[] = "global_brightness";
 
 const char DevicesParamsConst::ACTIVE_OUT[] = "active_out";
 const char DevicesParamsConst::USE_SI5351A[] = "use_si5351A";
+
+const char DevicesParamsConst::LED_INTERPOLATION[] = "led_interpolation";
+const char DevicesParamsConst::LED_DITHER[] = "led_dither";
+
+const char DevicesParamsConst::MAP_PANEL_WIDTH[] = "map_panel_width";
+const char DevicesParamsConst::MAP_PANEL_HEIGHT[] = "map_panel_height";
+const char DevicesParamsConst::MAP_PANEL_COLUMNS[] = "map_panel_columns";
+const char DevicesParamsConst::MAP_PANEL_ROWS[] = "map_panel_rows";
+const char DevicesParamsConst::MAP_SERPENTINE[] = "map_serpentine";
+const char DevicesParamsConst::MAP_ROTATION[] = "map_rotation";
+const char DevicesParamsConst::MAP_CSV[] = "map_csv";
@@ -121,24 +121,22 @@ bool TFTPFileServer::FileClose() {
 	return true;
 }
 
-size_t TFTPFileServer::FileRead(__attribute__((unused)) void* pBuffer, __attribute__((unused)) size_t nCount, __attribute__((unused)) unsigned nBlockNumber) {
+size_t TFTPFileServer::FileRead(__attribute__((unused)) void* pBuffer, __attribute__((unused)) size_t nCount, __attribute__((unused)) uint32_t nOffset) {
 	DEBUG_ENTRY
 
 	DEBUG_EXIT
 	return 0;
 }
 
-size_t TFTPFileServer::FileWrite(const void *pBuffer, size_t nCount, unsigned nBlockNumber) {
-	DEBUG_PRINTF("pBuffer=%p, nCount=%d, nBlockNumber=%d (%d)", pBuffer, nCount, nBlockNumber, m_nSize / 512);
+size_t TFTPFileServer::FileWrite(const void *pBuffer, size_t nCount, uint32_t nOffset) {
+	DEBUG_PRINTF("pBuffer=%p, nCount=%d, nOffset=%u (%u)", pBuffer, nCount, nOffset, m_nSize);
 
-	if (nBlockNumber > (m_nSize / 512)) {
+	if ((nOffset + nCount) > m_nSize) {
 		m_nFileSize = 0;
 		return 0;
 	}
 
-	assert(nBlockNumber != 0);
-
-	if (nBlockNumber == 1) {
+	if (nOffset == 0) {
 		UBootHeader uImage(reinterpret_cast<uint8_t *>(const_cast<void*>(pBuffer)));
 		if (!uImage.IsValid()) {
 			DEBUG_PUTS("uImage is not valid");
@@ -152,13 +150,11 @@ size_t TFTPFileServer::FileWrite(const void *pBuffer, size_t nCount, unsigned nB
 		// Temporarily code END
 	}
 
-	uint32_t nOffset = (nBlockNumber - 1) * 512;
-
-	assert((nOffset + nCount) <= m_nSize);
-
 	memcpy(&m_pBuffer[nOffset], pBuffer, nCount);
 
-	m_nFileSize += nCount; //FIXME BUG When in retry ?
+	if ((nOffset + nCount) > m_nFileSize) {
+		m_nFileSize = nOffset + nCount;
+	}
 
 	return nCount;
 }
@@ -70,13 +70,13 @@ bool TFTPFileServer::FileClose(void) {
 	return false;
 }
 
-size_t TFTPFileServer::FileRead(__attribute__((unused)) void* pBuffer, __attribute__((unused)) size_t nCount, __attribute__((unused)) unsigned nBlockNumber) {
+size_t TFTPFileServer::FileRead(__attribute__((unused)) void* pBuffer, __attribute__((unused)) size_t nCount, __attribute__((unused)) uint32_t nOffset) {
 	DEBUG_ENTRY
 	DEBUG_EXIT
 	return 0;
 }
 
-size_t TFTPFileServer::FileWrite(__attribute__((unused)) const void *pBuffer, __attribute__((unused)) size_t nCount, __attribute__((unused)) unsigned nBlockNumber) {
+size_t TFTPFileServer::FileWrite(__attribute__((unused)) const void *pBuffer, __attribute__((unused)) size_t nCount, __attribute__((unused)) uint32_t nOffset) {
 	DEBUG_ENTRY
 	DEBUG_EXIT
 	return 0;
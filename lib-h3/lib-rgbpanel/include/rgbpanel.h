@@ -28,6 +28,8 @@
 
 #include "rgbpanelconst.h"
 
+class ColourCorrection;
+
 namespace rgbpanel {
 static constexpr auto PWM_WIDTH = 94;
 }  // namespace rgbpanel
@@ -43,6 +45,7 @@ public:
 	void Stop();
 
 	void SetPixel(uint32_t nColumn, uint32_t nRow, uint8_t nRed, uint8_t nGreen, uint8_t nBlue);
+	void SetColourCorrection(const ColourCorrection *pColourCorrection);
 	void Cls();
 	void Show();
 
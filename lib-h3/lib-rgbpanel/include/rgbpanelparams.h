@@ -29,6 +29,9 @@
 #include <stdint.h>
 
 #include "rgbpanelconst.h"
+#include "rgbpanel.h"
+
+#include "colourcorrection.h"
 
 struct TRgbPanelParams {
 	uint32_t nSetList;
@@ -36,6 +39,7 @@ struct TRgbPanelParams {
 	uint8_t nRows;
 	uint8_t nChain;
 	uint8_t nType;
+	struct TColourCorrectionParams tColourCorrection;
 } __attribute__((packed));
 
 static_assert(sizeof(struct TRgbPanelParams) <= 32, "struct TRgbPanelParams is too large");
@@ -45,6 +49,7 @@ struct RgbPanelParamsMask {
 	static constexpr auto ROWS = (1U << 1);
 	static constexpr auto CHAIN = (1U << 2);
 	static constexpr auto TYPE = (1U << 3);
+	static constexpr auto COLOUR_CORRECTION = (1U << 4);
 };
 
 class RgbPanelParamsStore {
@@ -66,6 +71,8 @@ public:
 	void Builder(const struct TRgbPanelParams *pRgbPanelParams, char *pBuffer, uint32_t nLength, uint32_t &nSize);
 	void Save(char *pBuffer, uint32_t nLength, uint32_t &nSize);
 
+	void Set(RgbPanel *pRgbPanel);
+
 	void Dump();
 
 	uint32_t GetCols() const {
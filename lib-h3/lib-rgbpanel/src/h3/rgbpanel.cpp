@@ -32,6 +32,8 @@
 
 #include "rgbpanel.h"
 
+#include "colourcorrection.h"
+
 #include "h3_spi.h"
 #include "h3_i2c.h"
 #include "h3_gpio.h"
@@ -40,6 +42,8 @@
 #include "h3_smp.h"
 
 #include "arm/synchronize.h"
+#include "arm/ringbuffer.h"
+#include "arm/memfunc.h"
 
 #include "debug.h"
 
@@ -67,14 +71,18 @@ void core1_task();
 static uint32_t s_nColumns __attribute__ ((aligned (64)));
 static uint32_t s_nRows ;
 static uint32_t s_nBufferSize ;
+static uint32_t s_nFrameSize ;
 static uint32_t s_nShowCounter ;
 //
-static volatile bool s_bDoSwap;
 static volatile uint32_t s_nUpdatesCounter;
 //
-static uint32_t *s_pFramebuffer1 ;
-static uint32_t *s_pFramebuffer2 ;
-static uint8_t *s_pTablePWM ;
+/**
+ * Core 0 draws into the back buffer, core 1 scans out the front buffer.
+ * Show() never waits for the scan out to finish.
+ */
+static ring::TripleBuffer<uint32_t *> s_Framebuffers;
+static uint32_t *s_pFramebuffer ;	///< Back buffer, owned by core 0
+static uint8_t *s_pTablePWM ;	///< Red, Green, Blue
 //
 static bool s_bIsCoreRunning;
 
@@ -87,7 +95,6 @@ void RgbPanel::PlatformInit() {
 	s_nColumns = m_nColumns;
 	s_nRows = m_nRows;
 	s_nShowCounter = 0;
-	s_bDoSwap = false;
 	s_nUpdatesCounter = 0;
 	s_bIsCoreRunning = false;
 
@@ -130,30 +137,52 @@ void RgbPanel::PlatformInit() {
 	s_nBufferSize = m_nColumns * m_nRows * PWM_WIDTH;
 	DEBUG_PRINTF("nBufferSize=%u", s_nBufferSize);
 
-	s_pFramebuffer1 = new uint32_t[s_nBufferSize];
-	assert(s_pFramebuffer1 != nullptr);
+	// Not from the static arena, LtcDisplayRgbPanel re-creates the RgbPanel
+	for (uint32_t nIndex = 0; nIndex < 3; nIndex++) {
+		auto *pFramebuffer = new uint32_t[s_nBufferSize];
+		assert(pFramebuffer != nullptr);
 
-	s_pFramebuffer2 = new uint32_t[s_nBufferSize];
-	assert(s_pFramebuffer2 != nullptr);
+		DEBUG_PRINTF("%u %p", nIndex, pFramebuffer);
 
-	DEBUG_PRINTF("%p %p", s_pFramebuffer1, s_pFramebuffer2);
+		arm_memset(pFramebuffer, 0, s_nBufferSize * sizeof(uint32_t));
 
-	for (uint32_t i = 0; i < s_nBufferSize; i++) {
-		s_pFramebuffer1[i] = 0;
-		s_pFramebuffer2[i] = 0;
+		s_Framebuffers.Get(nIndex) = pFramebuffer;
 	}
 
-	s_pTablePWM = new uint8_t[256];
+	s_pFramebuffer = s_Framebuffers.GetBack();
+	s_nFrameSize = m_nColumns * (m_nRows / 2) * PWM_WIDTH;
+
+	s_pTablePWM = new uint8_t[3 * 256];
+	assert(s_pTablePWM != nullptr);
+
+	SetColourCorrection(nullptr);
+}
+
+/**
+ * The colour correction is compiled into the PWM tables,
+ * so SetPixel has no extra cost.
+ */
+void RgbPanel::SetColourCorrection(const ColourCorrection *pColourCorrection) {
 	assert(s_pTablePWM != nullptr);
 
-	for (uint32_t i = 0; i < 256; i++) {
-		s_pTablePWM[i] = (i * PWM_WIDTH) / 255;
+	for (uint32_t nChannel = 0; nChannel < 3; nChannel++) {
+		auto *pTable = &s_pTablePWM[nChannel * 256];
+
+		for (uint32_t i = 0; i < 256; i++) {
+			if (pColourCorrection == nullptr) {
+				pTable[i] = static_cast<uint8_t>((i * PWM_WIDTH) / 255);
+			} else {
+				const auto nValue = pColourCorrection->Get16(static_cast<colourcorrection::Channel>(nChannel), static_cast<uint8_t>(i));
+				pTable[i] = static_cast<uint8_t>((nValue * PWM_WIDTH) / 0xFFFF);
+			}
+		}
 	}
 }
 
 void RgbPanel::PlatformCleanUp() {
-	delete[] s_pFramebuffer1;
-	delete[] s_pFramebuffer2;
+	for (uint32_t nIndex = 0; nIndex < 3; nIndex++) {
+		delete[] s_Framebuffers.Get(nIndex);
+	}
 	delete[] s_pTablePWM;
 }
 
@@ -198,14 +227,14 @@ void RgbPanel::Dump() {
 		printf("[");
 		for (uint32_t i = 0; i < m_nColumns; i++) {
 			const uint32_t nIndex = (nRow * m_nColumns) + i;
-			printf("%x ", s_pFramebuffer1[nIndex]);
+			printf("%x ", s_pFramebuffer[nIndex]);
 		}
 		puts("]");
 	}
 }
 
 void RgbPanel::Cls() {
-	auto lp = reinterpret_cast<uint64_t*>(s_pFramebuffer1);
+	auto lp = reinterpret_cast<uint64_t*>(s_pFramebuffer);
 	uint32_t n = s_nBufferSize * 4;
 
 	while ((n / 8) > 0) {
@@ -242,7 +271,7 @@ void RgbPanel::SetPixel(uint32_t nColumn, uint32_t nRow, uint8_t nRed, uint8_t n
 
 			const uint32_t nIndex = nBaseIndex + (nPWM * m_nColumns);
 
-			uint32_t nValue = s_pFramebuffer1[nIndex];
+			uint32_t nValue = s_pFramebuffer[nIndex];
 
 			nValue &= ~((1U << HUB75B_R1) | (1U << HUB75B_G1) | (1U << HUB75B_B1));
 
@@ -250,15 +279,15 @@ void RgbPanel::SetPixel(uint32_t nColumn, uint32_t nRow, uint8_t nRed, uint8_t n
 				nValue |= (1U << HUB75B_R1);
 			}
 
-			if (s_pTablePWM[nGreen] > nPWM) {
+			if (s_pTablePWM[256 + nGreen] > nPWM) {
 				nValue |= (1U << HUB75B_G1);
 			}
 
-			if (s_pTablePWM[nBlue] > nPWM) {
+			if (s_pTablePWM[512 + nBlue] > nPWM) {
 				nValue |= (1U << HUB75B_B1);
 			}
 
-			s_pFramebuffer1[nIndex] = nValue;
+			s_pFramebuffer[nIndex] = nValue;
 		}
 	} else {
 		const uint32_t nBaseIndex = ((nRow - (m_nRows / 2)) * m_nColumns * PWM_WIDTH) + nColumn;
@@ -267,32 +296,38 @@ void RgbPanel::SetPixel(uint32_t nColumn, uint32_t nRow, uint8_t nRed, uint8_t n
 
 			const uint32_t nIndex = nBaseIndex + (nPWM * m_nColumns);
 
-			uint32_t nValue = s_pFramebuffer1[nIndex];
+			uint32_t nValue = s_pFramebuffer[nIndex];
 			nValue &= ~((1U << HUB75B_R2) | (1U << HUB75B_G2) | (1U << HUB75B_B2));
 
 			if (s_pTablePWM[nRed] > nPWM) {
 				nValue |= (1U << HUB75B_R2);
 			}
 
-			if (s_pTablePWM[nGreen] > nPWM) {
+			if (s_pTablePWM[256 + nGreen] > nPWM) {
 				nValue |= (1U << HUB75B_G2);
 			}
 
-			if (s_pTablePWM[nBlue] > nPWM) {
+			if (s_pTablePWM[512 + nBlue] > nPWM) {
 				nValue |= (1U << HUB75B_B2);
 			}
 
-			s_pFramebuffer1[nIndex] = nValue;
+			s_pFramebuffer[nIndex] = nValue;
 		}
 	}
 }
 
+/**
+ * The published frame is copied into the new back buffer,
+ * as SetPixel and the text functions only update part of the frame.
+ */
 void RgbPanel::Show() {
-	do {
-		dmb();
-	} while (s_bDoSwap);
+	const auto *pPublished = s_pFramebuffer;
+
+	s_Framebuffers.Publish();
+	s_pFramebuffer = s_Framebuffers.GetBack();
+
+	arm_memcpy(s_pFramebuffer, pPublished, s_nFrameSize * sizeof(uint32_t));
 
-	s_bDoSwap = true;
 	s_nShowCounter++;
 }
 
@@ -302,6 +337,8 @@ void core1_task() {
 	uint32_t nGPIO = H3_PIO_PORTA->DAT & ~((1U << HUB75B_R1) | (1U << HUB75B_G1) | (1U << HUB75B_B1) | (1U << HUB75B_R2) | (1U << HUB75B_G2) | (1U << HUB75B_B2));
 
 	for (;;) {
+		const auto *pFramebuffer = s_Framebuffers.GetFront();
+
 		for (uint32_t nRow = 0; nRow < (s_nRows / 2); nRow++) {
 
 			const uint32_t nBaseIndex = nRow * nMultiplier;
@@ -312,7 +349,7 @@ void core1_task() {
 
 				/* Shift in next data */
 				for (uint32_t i = 0; i < s_nColumns; i++) {
-					const uint32_t nValue = s_pFramebuffer2[nIndex++];
+					const uint32_t nValue = pFramebuffer[nIndex++];
 					// Clock high with data
 					H3_PIO_PORTA->DAT = nGPIO | (1U << HUB75B_CK) | nValue;
 					// Clock low
@@ -340,12 +377,6 @@ void core1_task() {
 
 		s_nUpdatesCounter++;
 
-		if (s_bDoSwap) {
-			auto pTmp = s_pFramebuffer1;
-			s_pFramebuffer1 = s_pFramebuffer2;
-			s_pFramebuffer2 = pTmp;
-			dmb();
-			s_bDoSwap = false;
-		}
+		s_Framebuffers.Update();
 	}
 }
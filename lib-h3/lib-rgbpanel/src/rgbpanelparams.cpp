@@ -51,6 +51,7 @@ RgbPanelParams::RgbPanelParams(RgbPanelParamsStore *pRgbPanelParamsStore): m_pRg
 	m_tRgbPanelParams.nRows = defaults::ROWS;
 	m_tRgbPanelParams.nChain = defaults::CHAIN;
 	m_tRgbPanelParams.nType = static_cast<uint8_t>(defaults::TYPE);
+	ColourCorrection::SetDefaults(&m_tRgbPanelParams.tColourCorrection);
 }
 
 bool RgbPanelParams::Load() {
@@ -126,6 +127,11 @@ void RgbPanelParams::callbackFunction(const char *pLine) {
 		return;
 	}
 
+	if (ColourCorrection::Scan(pLine, &m_tRgbPanelParams.tColourCorrection)) {
+		m_tRgbPanelParams.nSetList |= RgbPanelParamsMask::COLOUR_CORRECTION;
+		return;
+	}
+
 	char cBuffer[type::MAX_NAME_LENGTH];
 	uint32_t nLength = sizeof(cBuffer) - 1;
 
@@ -156,6 +162,9 @@ void RgbPanelParams::Builder(const struct TRgbPanelParams *pRgbPanelParams, char
 	builder.Add(RgbPanelParamsConst::CHAIN, m_tRgbPanelParams.nChain, isMaskSet(RgbPanelParamsMask::CHAIN));
 	builder.Add(RgbPanelParamsConst::TYPE, RgbPanel::GetType(static_cast<Types>(m_tRgbPanelParams.nType)), isMaskSet(RgbPanelParamsMask::TYPE));
 
+	builder.AddComment("Colour correction");
+	ColourCorrection::Builder(builder, &m_tRgbPanelParams.tColourCorrection, isMaskSet(RgbPanelParamsMask::COLOUR_CORRECTION));
+
 	nSize = builder.GetSize();
 }
 
@@ -56,5 +56,9 @@ void RgbPanelParams::Dump() {
 	if (isMaskSet(RgbPanelParamsMask::TYPE)) {
 		printf(" %s=%d [%s]\n", RgbPanelParamsConst::TYPE, m_tRgbPanelParams.nType, RgbPanel::GetType(static_cast<Types>(m_tRgbPanelParams.nType)));
 	}
+
+	if (isMaskSet(RgbPanelParamsMask::COLOUR_CORRECTION)) {
+		ColourCorrection::Dump(&m_tRgbPanelParams.tColourCorrection);
+	}
 #endif
 }
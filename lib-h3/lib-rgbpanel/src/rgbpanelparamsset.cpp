@@ -0,0 +1,43 @@
+/**
+ * @file rgbpanelparamsset.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <cassert>
+
+#include "rgbpanelparams.h"
+#include "rgbpanel.h"
+
+#include "colourcorrection.h"
+
+void RgbPanelParams::Set(RgbPanel *pRgbPanel) {
+	assert(pRgbPanel != nullptr);
+
+	if (isMaskSet(RgbPanelParamsMask::COLOUR_CORRECTION)) {
+		// The tables are compiled into the PWM tables of the panel
+		ColourCorrection colourCorrection;
+		colourCorrection.Set(&m_tRgbPanelParams.tColourCorrection);
+
+		pRgbPanel->SetColourCorrection(colourCorrection.IsIdentity() ? nullptr : &colourCorrection);
+	}
+}
@@ -37,8 +37,8 @@ public:
 	bool FileOpen(const char *pFileName, TFTPMode tMode) override;
 	bool FileCreate(const char *pFileName, TFTPMode tMode) override;
 	bool FileClose() override;
-	size_t FileRead(void *pBuffer, size_t nCount, unsigned nBlockNumber) override;
-	size_t FileWrite(const void *pBuffer, size_t nCount, unsigned nBlockNumber) override;
+	size_t FileRead(void *pBuffer, size_t nCount, uint32_t nOffset) override;
+	size_t FileWrite(const void *pBuffer, size_t nCount, uint32_t nOffset) override;
 
 	void Exit() override;
 
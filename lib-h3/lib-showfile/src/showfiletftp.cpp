@@ -83,10 +83,10 @@ bool ShowFileTFTP::FileClose() {
 	return true;
 }
 
-size_t ShowFileTFTP::FileRead(void *pBuffer, size_t nCount, __attribute__((unused)) unsigned nBlockNumber) {
+size_t ShowFileTFTP::FileRead(void *pBuffer, size_t nCount, __attribute__((unused)) uint32_t nOffset) {
 	return fread(pBuffer, 1, nCount, m_pFile);
 }
 
-size_t ShowFileTFTP::FileWrite(const void *pBuffer, size_t nCount, __attribute__((unused)) unsigned nBlockNumber) {
+size_t ShowFileTFTP::FileWrite(const void *pBuffer, size_t nCount, __attribute__((unused)) uint32_t nOffset) {
 	return fwrite(pBuffer, 1, nCount, m_pFile);
 }
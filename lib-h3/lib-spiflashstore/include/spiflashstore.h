@@ -61,6 +61,7 @@ enum class Store {
 	RDMSUBDEVICES,
 	GPS,
 	RGBPANEL,
+	DHCP_LEASE,
 	LAST
 };
 }  // namespace spiflashstore
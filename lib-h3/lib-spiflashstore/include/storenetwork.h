@@ -40,6 +40,8 @@ public:
 	void SaveNetMask(uint32_t nNetMask) override;
 	void SaveHostName(const char *pHostName, uint32_t nLength) override;
 	void SaveDhcp(bool bIsDhcpUsed) override;
+	void SaveDhcpLease(const struct TDhcpLease *pDhcpLease) override;
+	bool CopyDhcpLease(struct TDhcpLease *pDhcpLease) override;
 
 	static StoreNetwork *Get() {
 		return s_pThis;
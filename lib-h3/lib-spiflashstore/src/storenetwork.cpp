@@ -25,6 +25,7 @@
 
 #include <algorithm>
 #include <stdint.h>
+#include <string.h>
 #include <cassert>
 
 #include "storenetwork.h"
@@ -37,6 +38,18 @@
 
 using namespace spiflashstore;
 
+namespace storenetwork {
+/**
+ * Store::DHCP_LEASE, appended so that the layout of the other stores is unchanged
+ */
+struct TDhcpLease {
+	uint32_t nSetList;
+	struct ::TDhcpLease Lease;
+}__attribute__((packed));
+
+static constexpr auto DHCP_LEASE_VALID = (1U << 0);
+}  // namespace storenetwork
+
 StoreNetwork *StoreNetwork::s_pThis = nullptr;
 
 StoreNetwork::StoreNetwork() {
@@ -98,3 +111,31 @@ void StoreNetwork::SaveDhcp(bool bIsDhcpUsed) {
 
 	DEBUG_EXIT
 }
+
+void StoreNetwork::SaveDhcpLease(const struct TDhcpLease *pDhcpLease) {
+	DEBUG_ENTRY
+
+	SpiFlashStore::Get()->Update(Store::DHCP_LEASE, __builtin_offsetof(struct storenetwork::TDhcpLease, Lease), pDhcpLease, sizeof(struct TDhcpLease), storenetwork::DHCP_LEASE_VALID);
+
+	DEBUG_EXIT
+}
+
+bool StoreNetwork::CopyDhcpLease(struct TDhcpLease *pDhcpLease) {
+	DEBUG_ENTRY
+
+	struct storenetwork::TDhcpLease tDhcpLease;
+
+	memset(&tDhcpLease, 0, sizeof(struct storenetwork::TDhcpLease));
+
+	SpiFlashStore::Get()->Copy(Store::DHCP_LEASE, &tDhcpLease, sizeof(struct storenetwork::TDhcpLease));
+
+	if (((tDhcpLease.nSetList & storenetwork::DHCP_LEASE_VALID) == 0) || (tDhcpLease.Lease.nIp == 0)) {
+		DEBUG_EXIT
+		return false;
+	}
+
+	memcpy(pDhcpLease, &tDhcpLease.Lease, sizeof(struct TDhcpLease));
+
+	DEBUG_EXIT
+	return true;
+}
@@ -33,6 +33,8 @@
 #include "tlc59711.h"
 #include "tlc59711dmxstore.h"
 
+#include "colourcorrection.h"
+
 enum TTLC59711Type {
 	TTLC59711_TYPE_RGB,
 	TTLC59711_TYPE_RGBW,
@@ -48,6 +50,7 @@ public:
 	void Stop(uint8_t nPort = 0) override;
 
 	void SetData(uint8_t nPort, const uint8_t *pDmxData, uint16_t nLength) override;
+	void SetDataRange(uint8_t nPort, const uint8_t *pDmxData, uint16_t nLength, uint16_t nFirst, uint16_t nEnd) override;
 
 	void Blackout(bool bBlackout);
 
@@ -66,6 +69,11 @@ public:
 		return m_nSpiSpeedHz;
 	}
 
+	void SetColourCorrection(const struct TColourCorrectionParams *pParams) {
+		m_ColourCorrection.Set(pParams);
+		m_bFullRefresh = true;
+	}
+
 	void SetTLC59711DmxStore(TLC59711DmxStore *pTLC59711Store) {
 		m_pTLC59711DmxStore = pTLC59711Store;
 	}
@@ -100,10 +108,12 @@ private:
 	uint8_t m_nBoardInstances{1};
 	bool m_bIsStarted{false};
 	bool m_bBlackout{false};
+	bool m_bFullRefresh{true};
 	TLC59711 *m_pTLC59711{nullptr};
 	uint32_t m_nSpiSpeedHz{0};
 	TTLC59711Type m_LEDType{TTLC59711_TYPE_RGB};
 	uint8_t m_nLEDCount;
+	ColourCorrection m_ColourCorrection;
 
 	TLC59711DmxStore *m_pTLC59711DmxStore{nullptr};
 };
@@ -30,12 +30,15 @@
 
 #include "tlc59711dmx.h"
 
+#include "colourcorrection.h"
+
 struct TTLC59711DmxParams {
     uint32_t nSetList;
 	TTLC59711Type LedType;
 	uint8_t nLedCount;
 	uint16_t nDmxStartAddress;
     uint32_t nSpiSpeedHz;
+    struct TColourCorrectionParams tColourCorrection;
 };
 //} __attribute__((packed));
 
@@ -44,6 +47,7 @@ struct TLC59711DmxParamsMask {
 	static constexpr auto LED_COUNT = (1U << 1);
 	static constexpr auto START_ADDRESS = (1U << 2);
 	static constexpr auto SPI_SPEED = (1U << 3);
+	static constexpr auto COLOUR_CORRECTION = (1U << 4);
 };
 
 class TLC59711DmxParamsStore {
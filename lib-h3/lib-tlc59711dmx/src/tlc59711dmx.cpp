@@ -24,6 +24,7 @@
  */
 
 #include <stdint.h>
+#include <algorithm>
 #include <cassert>
 
 #include "tlc59711dmx.h"
@@ -70,32 +71,67 @@ void TLC59711Dmx::Stop(__attribute__((unused)) uint8_t nPort) {
 	m_bIsStarted = false;
 }
 
-void TLC59711Dmx::SetData(__attribute__((unused)) uint8_t nPort, const uint8_t* pDmxData, uint16_t nLength) {
+void TLC59711Dmx::SetData(uint8_t nPort, const uint8_t* pDmxData, uint16_t nLength) {
+	m_bFullRefresh = true;
+	SetDataRange(nPort, pDmxData, nLength, 0, nLength);
+}
+
+void TLC59711Dmx::SetDataRange(__attribute__((unused)) uint8_t nPort, const uint8_t* pDmxData, uint16_t nLength, uint16_t nFirst, uint16_t nEnd) {
 	assert(pDmxData != nullptr);
 	assert(nLength <= DMX_UNIVERSE_SIZE);
 
 	if (__builtin_expect((m_pTLC59711 == nullptr), 0)) {
+		m_bFullRefresh = true;
 		Start();
 	}
 
-	uint8_t *p = const_cast<uint8_t*>(pDmxData) + m_nDmxStartAddress - 1;
+	unsigned nFirstChannel = 0;
+	unsigned nEndChannel = m_nDmxFootprint;
+
+	if (!m_bFullRefresh) {
+		const unsigned nOffset = m_nDmxStartAddress - 1U;
+
+		if ((nFirst >= nEnd) || (nEnd <= nOffset)) {
+			return;
+		}
+
+		nFirstChannel = (nFirst > nOffset) ? (nFirst - nOffset) : 0;
+		nEndChannel = std::min(nEndChannel, nEnd - nOffset);
+
+		if (nFirstChannel >= nEndChannel) {
+			return;
+		}
+	}
+
+	m_bFullRefresh = false;
+
+	uint8_t *p = const_cast<uint8_t*>(pDmxData) + m_nDmxStartAddress - 1 + nFirstChannel;
 
-	unsigned nDmxAddress = m_nDmxStartAddress;
+	unsigned nDmxAddress = m_nDmxStartAddress + nFirstChannel;
+	const unsigned nDmxAddressFirst = nDmxAddress;
 
-	for (unsigned i = 0; i < m_nDmxFootprint; i++) {
+	// The identity table holds (value << 8) | value, so there is no need to test for it
+	const unsigned nColours = (m_LEDType == TTLC59711_TYPE_RGBW) ? 4 : 3;
+	unsigned nColour = nFirstChannel % nColours;
+
+	for (unsigned i = nFirstChannel; i < nEndChannel; i++) {
 		if (nDmxAddress > nLength) {
 			break;
 		}
 
-		const uint16_t nValue = (static_cast<uint16_t>(*p) << 8) | static_cast<uint16_t>(*p);
+		const uint16_t nValue = m_ColourCorrection.Get16(static_cast<colourcorrection::Channel>(nColour), *p);
 
 		m_pTLC59711->Set(i, nValue);
 
+		if (++nColour == nColours) {
+			nColour = 0;
+		}
+
 		p++;
 		nDmxAddress++;
 	}
 
-	if (__builtin_expect((nDmxAddress == m_nDmxStartAddress), 0)) {
+	if (__builtin_expect((nDmxAddress == nDmxAddressFirst), 0)) {
 		return;
 	}
 
@@ -154,6 +190,7 @@ bool TLC59711Dmx::SetDmxStartAddress(uint16_t nDmxStartAddress) {
 
 	if ((nDmxStartAddress != 0) && (nDmxStartAddress <= DMX_UNIVERSE_SIZE)) {
 		m_nDmxStartAddress = nDmxStartAddress;
+		m_bFullRefresh = true;
 
 		if (m_pTLC59711DmxStore != nullptr) {
 			m_pTLC59711DmxStore->SaveDmxStartAddress(m_nDmxStartAddress);
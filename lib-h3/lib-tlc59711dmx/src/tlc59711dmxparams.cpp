@@ -53,6 +53,7 @@ TLC59711DmxParams::TLC59711DmxParams(TLC59711DmxParamsStore *pTLC59711ParamsStor
 	m_tTLC59711Params.nLedCount = 4;
 	m_tTLC59711Params.nDmxStartAddress = 1;
 	m_tTLC59711Params.nSpiSpeedHz = 0;
+	ColourCorrection::SetDefaults(&m_tTLC59711Params.tColourCorrection);
 }
 
 bool TLC59711DmxParams::Load() {
@@ -132,6 +133,11 @@ void TLC59711DmxParams::callbackFunction(const char* pLine) {
 	if (Sscan::Uint32(pLine, DevicesParamsConst::SPI_SPEED_HZ, value32) == Sscan::OK) {
 		m_tTLC59711Params.nSpiSpeedHz = value32;
 		m_tTLC59711Params.nSetList |= TLC59711DmxParamsMask::SPI_SPEED;
+		return;
+	}
+
+	if (ColourCorrection::Scan(pLine, &m_tTLC59711Params.tColourCorrection)) {
+		m_tTLC59711Params.nSetList |= TLC59711DmxParamsMask::COLOUR_CORRECTION;
 	}
 }
 
@@ -160,6 +166,10 @@ void TLC59711DmxParams::Dump() {
 	if(isMaskSet(TLC59711DmxParamsMask::SPI_SPEED)) {
 		printf(" %s=%d Hz\n", DevicesParamsConst::SPI_SPEED_HZ, m_tTLC59711Params.nSpiSpeedHz);
 	}
+
+	if(isMaskSet(TLC59711DmxParamsMask::COLOUR_CORRECTION)) {
+		ColourCorrection::Dump(&m_tTLC59711Params.tColourCorrection);
+	}
 #endif
 }
 
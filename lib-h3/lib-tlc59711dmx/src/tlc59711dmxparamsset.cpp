@@ -46,4 +46,8 @@ void TLC59711DmxParams::Set(TLC59711Dmx* pTLC59711Dmx) {
 	if(isMaskSet(TLC59711DmxParamsMask::SPI_SPEED)) {
 		pTLC59711Dmx->SetSpiSpeedHz(m_tTLC59711Params.nSpiSpeedHz);
 	}
+
+	if(isMaskSet(TLC59711DmxParamsMask::COLOUR_CORRECTION)) {
+		pTLC59711Dmx->SetColourCorrection(&m_tTLC59711Params.tColourCorrection);
+	}
 }
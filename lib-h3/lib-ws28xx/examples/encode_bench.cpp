@@ -0,0 +1,120 @@
+/**
+ * @file encode_bench.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Encode time of one frame of 680 LEDs for each LED type: SetLED per LED
+ * against the bulk SetLEDs, and SetLEDs with colour correction (gamma 2.2).
+ *
+ * Usage: encode_bench [frames]
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "ws28xx.h"
+#include "colourcorrection.h"
+
+using namespace ws28xx;
+
+namespace bench {
+static constexpr auto LED_COUNT = 680;
+}  // namespace bench
+
+static uint64_t now_ns() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static double bulk(WS28xx& ws28xx, uint8_t *pFrame, uint32_t nFrames) {
+	const auto nStart = now_ns();
+
+	for (uint32_t nFrame = 0; nFrame < nFrames; nFrame++) {
+		pFrame[nFrame % 100]++;
+		ws28xx.SetLEDs(0, pFrame, bench::LED_COUNT);
+	}
+
+	return static_cast<double>(now_ns() - nStart) / 1000.0 / nFrames;
+}
+
+static double perled(WS28xx& ws28xx, uint8_t *pFrame, uint32_t nFrames) {
+	const auto isRGBW = (ws28xx.GetLEDType() == Type::SK6812W);
+	const auto nChannels = isRGBW ? 4U : 3U;
+	const auto nStart = now_ns();
+
+	for (uint32_t nFrame = 0; nFrame < nFrames; nFrame++) {
+		pFrame[nFrame % 100]++;
+
+		for (uint32_t nLed = 0; nLed < bench::LED_COUNT; nLed++) {
+			const auto *p = &pFrame[nLed * nChannels];
+
+			if (isRGBW) {
+				ws28xx.SetLED(nLed, p[0], p[1], p[2], p[3]);
+			} else {
+				ws28xx.SetLED(nLed, p[0], p[1], p[2]);
+			}
+		}
+	}
+
+	return static_cast<double>(now_ns() - nStart) / 1000.0 / nFrames;
+}
+
+int main(int argc, char **argv) {
+	const auto nFrames = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 2000;
+
+	static uint8_t frame[bench::LED_COUNT * 4];
+
+	for (uint32_t i = 0; i < sizeof(frame); i++) {
+		frame[i] = static_cast<uint8_t>(i * 7);
+	}
+
+	ColourCorrection colourCorrection;
+	struct TColourCorrectionParams params;
+	ColourCorrection::SetDefaults(&params);
+	params.nGamma = 22;
+	colourCorrection.Set(&params);
+
+	printf("%d LEDs, us per frame\n", bench::LED_COUNT);
+
+	for (uint32_t nType = 0; nType < static_cast<uint32_t>(Type::UNDEFINED); nType++) {
+		const auto type = static_cast<Type>(nType);
+
+		WS28xx ws28xx(type, bench::LED_COUNT);
+		ws28xx.Initialize();
+
+		ws28xx.SetColourCorrection(nullptr);
+		const auto fPerLed = perled(ws28xx, frame, nFrames);
+		const auto fPlain = bulk(ws28xx, frame, nFrames);
+
+		ws28xx.SetColourCorrection(&colourCorrection);
+		const auto fCorrected = bulk(ws28xx, frame, nFrames);
+
+		printf("%-8s  SetLED %6.2f  SetLEDs %6.2f  with correction %6.2f\n", WS28xx::GetLedTypeString(type), fPerLed, fPlain, fCorrected);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,237 @@
+/**
+ * @file encode_test.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * The selected encoders against a reference per LED encoder (the
+ * bit loop and the colour order switch the encoders replaced), for every
+ * LED type and colour order, with and without colour correction.
+ * The pixel buffers must be byte-identical.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ws28xx.h"
+#include "rgbmapping.h"
+#include "colourcorrection.h"
+
+using namespace ws28xx;
+
+namespace test {
+static constexpr auto LED_COUNT = 100;
+}  // namespace test
+
+class WS28xxTest: public WS28xx {
+public:
+	using WS28xx::WS28xx;
+
+	const uint8_t *GetBuffer() const {
+		return m_pBuffer;
+	}
+
+	uint32_t GetBufSize() const {
+		return m_nBufSize;
+	}
+};
+
+class Reference {
+public:
+	Reference(const WS28xxTest& ws28xx): m_ws28xx(ws28xx) {
+		m_nBufSize = ws28xx.GetBufSize();
+		m_pBuffer = new uint8_t[m_nBufSize];
+		memcpy(m_pBuffer, ws28xx.GetBuffer(), m_nBufSize);
+	}
+
+	~Reference() {
+		delete[] m_pBuffer;
+	}
+
+	const uint8_t *GetBuffer() const {
+		return m_pBuffer;
+	}
+
+	void SetColour(uint32_t nOffset, uint8_t nValue) {
+		for (uint8_t mask = 0x80; mask != 0; mask >>= 1) {
+			m_pBuffer[nOffset++] = (nValue & mask) ? m_ws28xx.GetHighCode() : m_ws28xx.GetLowCode();
+		}
+	}
+
+	void SetLED(uint32_t nLEDIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue, uint8_t nWhite) {
+		const auto tType = m_ws28xx.GetLEDType();
+
+		if (tType == Type::SK6812W) {
+			const auto nOffset = nLEDIndex * 32;
+			SetColour(nOffset, nGreen);
+			SetColour(nOffset + 8, nRed);
+			SetColour(nOffset + 16, nBlue);
+			SetColour(nOffset + 24, nWhite);
+			return;
+		}
+
+		if (tType == Type::WS2801) {
+			const auto nOffset = nLEDIndex * 3;
+			m_pBuffer[nOffset] = nRed;
+			m_pBuffer[nOffset + 1] = nGreen;
+			m_pBuffer[nOffset + 2] = nBlue;
+			return;
+		}
+
+		if (tType == Type::APA102) {
+			const auto nOffset = 4 + (nLEDIndex * 4);
+			m_pBuffer[nOffset] = m_ws28xx.GetGlobalBrightness();
+			m_pBuffer[nOffset + 1] = nRed;
+			m_pBuffer[nOffset + 2] = nGreen;
+			m_pBuffer[nOffset + 3] = nBlue;
+			return;
+		}
+
+		if (tType == Type::P9813) {
+			const auto nOffset = 4 + (nLEDIndex * 4);
+			m_pBuffer[nOffset] = static_cast<uint8_t>(0xC0 | ((~nBlue & 0xC0) >> 2) | ((~nGreen & 0xC0) >> 4) | ((~nRed & 0xC0) >> 6));
+			m_pBuffer[nOffset + 1] = nBlue;
+			m_pBuffer[nOffset + 2] = nGreen;
+			m_pBuffer[nOffset + 3] = nRed;
+			return;
+		}
+
+		const auto nOffset = nLEDIndex * 24;
+
+		switch (m_ws28xx.GetRgbMapping()) {
+		case rgbmapping::Map::RBG:
+			SetColour(nOffset, nRed);
+			SetColour(nOffset + 8, nBlue);
+			SetColour(nOffset + 16, nGreen);
+			break;
+		case rgbmapping::Map::GRB:
+			SetColour(nOffset, nGreen);
+			SetColour(nOffset + 8, nRed);
+			SetColour(nOffset + 16, nBlue);
+			break;
+		case rgbmapping::Map::GBR:
+			SetColour(nOffset, nGreen);
+			SetColour(nOffset + 8, nBlue);
+			SetColour(nOffset + 16, nRed);
+			break;
+		case rgbmapping::Map::BRG:
+			SetColour(nOffset, nBlue);
+			SetColour(nOffset + 8, nRed);
+			SetColour(nOffset + 16, nGreen);
+			break;
+		case rgbmapping::Map::BGR:
+			SetColour(nOffset, nBlue);
+			SetColour(nOffset + 8, nGreen);
+			SetColour(nOffset + 16, nRed);
+			break;
+		default:  // RGB
+			SetColour(nOffset, nRed);
+			SetColour(nOffset + 8, nGreen);
+			SetColour(nOffset + 16, nBlue);
+			break;
+		}
+	}
+
+private:
+	const WS28xxTest& m_ws28xx;
+	uint8_t *m_pBuffer;
+	uint32_t m_nBufSize;
+};
+
+static uint32_t check(Type tType, rgbmapping::Map tMap, const ColourCorrection *pColourCorrection) {
+	WS28xxTest ws28xx(tType, test::LED_COUNT, tMap);
+	ws28xx.Initialize();
+	ws28xx.SetGlobalBrightness(0x11);
+	ws28xx.SetColourCorrection(pColourCorrection);
+
+	Reference reference(ws28xx);
+
+	const uint32_t nChannels = (tType == Type::SK6812W) ? 4 : 3;
+	uint8_t frame[test::LED_COUNT * 4];
+
+	for (uint32_t i = 0; i < sizeof(frame); i++) {
+		frame[i] = static_cast<uint8_t>(rand());
+	}
+
+	// The first half in one call, the second half per LED
+	ws28xx.SetLEDs(0, frame, test::LED_COUNT / 2);
+
+	for (uint32_t nLed = 0; nLed < test::LED_COUNT; nLed++) {
+		uint8_t colours[4];
+
+		for (uint32_t nChannel = 0; nChannel < nChannels; nChannel++) {
+			const auto nValue = frame[nLed * nChannels + nChannel];
+			colours[nChannel] = pColourCorrection == nullptr ? nValue : pColourCorrection->Get8(static_cast<colourcorrection::Channel>(nChannel), nValue);
+		}
+
+		reference.SetLED(nLed, colours[0], colours[1], colours[2], nChannels == 4 ? colours[3] : 0);
+
+		if (nLed >= test::LED_COUNT / 2) {
+			const auto *p = &frame[nLed * nChannels];
+			if (nChannels == 4) {
+				ws28xx.SetLED(nLed, p[0], p[1], p[2], p[3]);
+			} else {
+				ws28xx.SetLED(nLed, p[0], p[1], p[2]);
+			}
+		}
+	}
+
+	if (memcmp(ws28xx.GetBuffer(), reference.GetBuffer(), ws28xx.GetBufSize()) != 0) {
+		printf("%s %s correction %d: buffers differ\n", WS28xx::GetLedTypeString(tType), RGBMapping::ToString(ws28xx.GetRgbMapping()), pColourCorrection != nullptr);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main() {
+	ColourCorrection colourCorrection;
+	struct TColourCorrectionParams params;
+	ColourCorrection::SetDefaults(&params);
+	params.nGamma = 22;
+	params.nWhiteBalance[0] = 200;
+	params.nMaxBrightness = 180;
+	colourCorrection.Set(&params);
+
+	uint32_t nErrors = 0;
+	uint32_t nChecks = 0;
+
+	for (uint32_t nType = 0; nType < static_cast<uint32_t>(Type::UNDEFINED); nType++) {
+		for (uint32_t nMap = 0; nMap <= static_cast<uint32_t>(rgbmapping::Map::UNDEFINED); nMap++) {
+			nErrors += check(static_cast<Type>(nType), static_cast<rgbmapping::Map>(nMap), nullptr);
+			nErrors += check(static_cast<Type>(nType), static_cast<rgbmapping::Map>(nMap), &colourCorrection);
+			nChecks += 2;
+		}
+	}
+
+	if (nErrors != 0) {
+		printf("FAILED: %u of %u\n", nErrors, nChecks);
+		return EXIT_FAILURE;
+	}
+
+	printf("encoders: %u PASSED\n", nChecks);
+
+	return EXIT_SUCCESS;
+}
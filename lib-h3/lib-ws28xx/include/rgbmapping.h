@@ -24,10 +24,23 @@
 #ifndef RGBMAPPING_H_
 #define RGBMAPPING_H_
 
+#include <stdint.h>
+
 namespace rgbmapping {
 enum class Map {
 	RGB, RBG, GRB, GBR, BRG, BGR, UNDEFINED
 };
+
+/**
+ * Wire order as compile-time indexes into a R,G,B triplet
+ */
+template<Map tMap> struct Order;
+template<> struct Order<Map::RGB> { static constexpr uint32_t FIRST = 0, SECOND = 1, THIRD = 2; };
+template<> struct Order<Map::RBG> { static constexpr uint32_t FIRST = 0, SECOND = 2, THIRD = 1; };
+template<> struct Order<Map::GRB> { static constexpr uint32_t FIRST = 1, SECOND = 0, THIRD = 2; };
+template<> struct Order<Map::GBR> { static constexpr uint32_t FIRST = 1, SECOND = 2, THIRD = 0; };
+template<> struct Order<Map::BRG> { static constexpr uint32_t FIRST = 2, SECOND = 0, THIRD = 1; };
+template<> struct Order<Map::BGR> { static constexpr uint32_t FIRST = 2, SECOND = 1, THIRD = 0; };
 }  // namespace rgbmapping
 
 struct RGBMapping {
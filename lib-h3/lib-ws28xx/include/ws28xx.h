@@ -27,9 +27,12 @@
 #define WS28XX_H_
 
 #include <stdint.h>
+#include <cassert>
 
 #include "rgbmapping.h"
 
+class ColourCorrection;
+
 namespace ws28xx {
 enum class Type {
 	WS2801 = 0,
@@ -107,14 +110,47 @@ public:
 		return m_nClockSpeedHz;
 	}
 
+	/**
+	 * Bytes clocked out per Update(), one byte per bit for the RTZ types
+	 */
+	uint32_t GetBufSize() const {
+		return m_nBufSize;
+	}
+
 	void SetGlobalBrightness(uint8_t nGlobalBrightness);
 
 	uint8_t GetGlobalBrightness() const {
 		return m_nGlobalBrightness;
 	}
 
-	void SetLED(uint32_t nLEDIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue);
-	void SetLED(uint32_t nLEDIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue, uint8_t nWhite);
+	/**
+	 * The tables are applied in SetLED, nullptr disables.
+	 */
+	void SetColourCorrection(const ColourCorrection *pColourCorrection) {
+		m_pColourCorrection = pColourCorrection;
+		SelectEncoder();
+	}
+
+	void SetLED(uint32_t nLEDIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue) {
+		const uint8_t colours[4] = { nRed, nGreen, nBlue, 0 };
+		SetLEDs(nLEDIndex, colours, 1);
+	}
+
+	void SetLED(uint32_t nLEDIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue, uint8_t nWhite) {
+		assert(m_tLEDType == ws28xx::Type::SK6812W);
+		const uint8_t colours[4] = { nRed, nGreen, nBlue, nWhite };
+		SetLEDs(nLEDIndex, colours, 1);
+	}
+
+	/**
+	 * pData holds nCount packed R,G,B (R,G,B,W for SK6812W) values
+	 */
+	void SetLEDs(uint32_t nLEDIndex, const uint8_t *pData, uint32_t nCount) {
+		assert(m_pBuffer != nullptr);
+		assert(m_pSetLEDs != nullptr);
+		assert(nLEDIndex + nCount <= m_nLedCount);
+		(this->*m_pSetLEDs)(nLEDIndex, pData, nCount);
+	}
 
 	void Update();
 	void Blackout();
@@ -135,7 +171,12 @@ public:
 	}
 
 private:
-	void SetColorWS28xx(uint32_t nOffset, uint8_t nValue);
+	typedef void (WS28xx::*SetLEDsFunction)(uint32_t, const uint8_t *, uint32_t);
+	template<class Encoder, bool bCorrection> void SetLEDsEncoded(uint32_t nLEDIndex, const uint8_t *pData, uint32_t nCount);
+	template<class Encoder> SetLEDsFunction GetEncoder() const;
+
+protected:
+	void SelectEncoder();
 
 protected:
 	ws28xx::Type m_tLEDType { ws28xx::defaults::TYPE };
@@ -147,6 +188,9 @@ protected:
 	uint8_t m_nHighCode;
 	bool m_bIsRTZProtocol { false };
 	uint8_t m_nGlobalBrightness { 0xFF };
+	const ColourCorrection *m_pColourCorrection { nullptr };
+	SetLEDsFunction m_pSetLEDs { nullptr };
+	uint8_t m_CodeTable[256][8];	///< RTZ bit codes per colour value
 	uint8_t *m_pBuffer { nullptr };
 	uint8_t *m_pBlackoutBuffer { nullptr };
 
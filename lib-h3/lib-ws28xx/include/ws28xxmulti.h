@@ -27,6 +27,7 @@
 #define WS28XXMULTI_H_
 
 #include <stdint.h>
+#include <cassert>
 
 #include "ws28xx.h"
 
@@ -36,6 +37,8 @@
 
 #include "rgbmapping.h"
 
+class ColourCorrection;
+
 namespace ws28xxmulti {
 enum class Board {
 	X4, X8, UNKNOWN
@@ -74,23 +77,44 @@ public:
 		return m_nLedCount;
 	}
 
+	/**
+	 * Bits clocked out per port and Update()
+	 */
+	uint32_t GetBufSize() const {
+		return m_nBufSize;
+	}
+
 	ws28xxmulti::Board GetBoard() const {
 		return m_tBoard;
 	}
 
-	void SetLED(uint8_t nPort, uint16_t nLedIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue) {
-		if (m_tBoard == ws28xxmulti::Board::X8) {
-			SetLED8x(nPort, nLedIndex, nRed, nGreen, nBlue);
-		} else {
-			SetLED4x(nPort, nLedIndex, nRed, nGreen, nBlue);
-		}
+	/**
+	 * The tables are applied in SetLED, nullptr disables.
+	 */
+	void SetColourCorrection(const ColourCorrection *pColourCorrection) {
+		m_pColourCorrection = pColourCorrection;
+		SelectEncoder();
 	}
-	void SetLED(uint8_t nPort, uint16_t nLedIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue, uint8_t nWhite) {
-		if (m_tBoard == ws28xxmulti::Board::X8) {
-			SetLED8x(nPort, nLedIndex, nRed, nGreen, nBlue, nWhite);
-		} else {
-			SetLED4x(nPort, nLedIndex, nRed, nGreen, nBlue, nWhite);
-		}
+
+	void SetLED(uint32_t nPort, uint32_t nLedIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue) {
+		const uint8_t colours[4] = { nRed, nGreen, nBlue, 0 };
+		SetLEDs(nPort, nLedIndex, colours, 1);
+	}
+
+	void SetLED(uint32_t nPort, uint32_t nLedIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue, uint8_t nWhite) {
+		assert(m_tWS28xxType == ws28xx::Type::SK6812W);
+		const uint8_t colours[4] = { nRed, nGreen, nBlue, nWhite };
+		SetLEDs(nPort, nLedIndex, colours, 1);
+	}
+
+	/**
+	 * pData holds nCount packed R,G,B (R,G,B,W for SK6812W) values
+	 */
+	void SetLEDs(uint32_t nPort, uint32_t nLedIndex, const uint8_t *pData, uint32_t nCount) {
+		assert(m_pSetLEDs != nullptr);
+		assert(nPort < (m_tBoard == ws28xxmulti::Board::X8 ? 8U : 4U));
+		assert(nLedIndex + nCount <= m_nLedCount);
+		(this->*m_pSetLEDs)(nPort, nLedIndex, pData, nCount);
 	}
 
 #if defined (H3)
@@ -120,6 +144,11 @@ public:
 	}
 
 private:
+	typedef void (WS28xxMulti::*SetLEDsFunction)(uint32_t, uint32_t, const uint8_t *, uint32_t);
+	template<class Order, bool b8x, bool bCorrection> void SetLEDsEncoded(uint32_t nPort, uint32_t nLedIndex, const uint8_t *pData, uint32_t nCount);
+	template<class Order, bool b8x> SetLEDsFunction GetEncoder() const;
+	template<class Order> SetLEDsFunction GetEncoder() const;
+	void SelectEncoder();
 	uint8_t ReverseBits(uint8_t nBits);
 // 4x
 	bool IsMCP23017();
@@ -128,17 +157,11 @@ private:
 	void SetupGPIO();
 	void SetupBuffers4x();
 	void Generate800kHz(const uint32_t *pBuffer);
-	void SetColour4x(uint8_t nPort, uint16_t nLedIndex, uint8_t nColour1, uint8_t nColour2, uint8_t nColour3);
-	void SetLED4x(uint8_t nPort, uint16_t nLedIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue);
-	void SetLED4x(uint8_t nPort, uint16_t nLedIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue, uint8_t nWhite);
 // 8x
 	void SetupHC595(uint8_t nT0H, uint8_t nT1H);
 	void SetupSPI();
 	void SetupCPLD();
 	void SetupBuffers8x();
-	void SetColour8x(uint8_t nPort, uint16_t nLedIndex, uint8_t nColour1, uint8_t nColour2, uint8_t nColour3);
-	void SetLED8x(uint8_t nPort, uint16_t nLedIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue);
-	void SetLED8x(uint8_t nPort, uint16_t nLedIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue, uint8_t nWhite);
 
 private:
 	ws28xxmulti::Board m_tBoard { ws28xxmulti::defaults::BOARD };
@@ -153,6 +176,8 @@ private:
 	uint8_t *m_pBuffer8x { nullptr };
 	uint8_t *m_pBlackoutBuffer8x { nullptr };
 	JamSTAPLDisplay *m_pJamSTAPLDisplay { nullptr };
+	const ColourCorrection *m_pColourCorrection { nullptr };
+	SetLEDsFunction m_pSetLEDs { nullptr };
 
 	static WS28xxMulti *s_pThis;
 };
@@ -50,6 +50,8 @@ WS28xxDMA::~WS28xxDMA() {
 }
 
 bool WS28xxDMA::Initialize() {
+	SelectEncoder();
+
 	uint32_t nSize;
 
 	m_pBuffer = const_cast<uint8_t*>(h3_spi_dma_tx_prepare(&nSize));
@@ -52,7 +52,7 @@ WS28xx::WS28xx(Type Type, uint16_t nLedCount, rgbmapping::Map tRGBMapping, uint8
 
 	assert(m_nLedCount != 0);
 
-	if ((m_tLEDType == Type::SK6812W) || (m_tLEDType == Type::APA102)) {
+	if ((m_tLEDType == Type::SK6812W) || (m_tLEDType == Type::APA102) || (m_tLEDType == Type::P9813)) {
 		m_nBufSize = m_nLedCount * 4U;
 	} else {
 		m_nBufSize = m_nLedCount * 3U;
@@ -141,10 +141,18 @@ WS28xx::~WS28xx() {
 }
 
 bool WS28xx::Initialize() {
+	SelectEncoder();
+
 	assert(m_pBuffer == nullptr);
+	assert(m_pBlackoutBuffer == nullptr);
+
+	// Not from the static arena, WS28xxDmx re-creates the WS28xx when the configuration changes
 	m_pBuffer = new uint8_t[m_nBufSize];
 	assert(m_pBuffer != nullptr);
 
+	m_pBlackoutBuffer = new uint8_t[m_nBufSize];
+	assert(m_pBlackoutBuffer != nullptr);
+
 	if ((m_tLEDType == Type::APA102) || (m_tLEDType == Type::P9813)) {
 		memset(m_pBuffer, 0, 4);
 
@@ -161,10 +169,6 @@ bool WS28xx::Initialize() {
 		memset(m_pBuffer, m_tLEDType == Type::WS2801 ? 0 : m_nLowCode, m_nBufSize);
 	}
 
-	assert(m_pBlackoutBuffer == nullptr);
-	m_pBlackoutBuffer = new uint8_t[m_nBufSize];
-	assert(m_pBlackoutBuffer != nullptr);
-
 	memcpy(m_pBlackoutBuffer, m_pBuffer, m_nBufSize);
 
 	Blackout();
@@ -123,6 +123,8 @@ void WS28xxMulti::Initialize(Type tWS28xxType, uint16_t nLedCount, rgbmapping::M
 		SetupBuffers8x();
 	}
 
+	SelectEncoder();
+
 	DEBUG_PRINTF("m_nLedCount=%d, m_nBufSize=%d", m_nLedCount,m_nBufSize);
 	DEBUG_EXIT
 }
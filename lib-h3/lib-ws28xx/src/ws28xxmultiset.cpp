@@ -0,0 +1,144 @@
+/**
+ * @file ws28xxmultiset.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <cassert>
+
+#include "ws28xxmulti.h"
+#include "rgbmapping.h"
+
+#include "colourcorrection.h"
+
+using namespace ws28xx;
+using namespace ws28xxmulti;
+using colourcorrection::Channel;
+
+/*
+ * The encoders are selected once, the inner loops have no per LED branching.
+ * Each output owns one bit in the 4x (uint32_t) or 8x (uint8_t) bit planes.
+ */
+namespace encoder {
+template<rgbmapping::Map tMap>
+struct RGB : public rgbmapping::Order<tMap> {
+	static constexpr uint32_t CHANNELS = 3;
+	static constexpr uint32_t FOURTH = 3;
+};
+
+struct GRBW {
+	static constexpr uint32_t CHANNELS = 4;
+	static constexpr uint32_t FIRST = 1, SECOND = 0, THIRD = 2, FOURTH = 3;
+};
+
+template<typename T>
+inline void SetBitPlanes(T *pBuffer, uint32_t nPortMask, uint32_t nValue) {
+	for (uint32_t nBit = 0; nBit < 8; nBit++) {
+		const uint32_t nSet = (0U - ((nValue >> (7 - nBit)) & 0x1)) & nPortMask;
+		pBuffer[nBit] = static_cast<T>((pBuffer[nBit] & ~nPortMask) | nSet);
+	}
+}
+
+template<class Order, typename T>
+inline void Encode(T *pBuffer, uint32_t nPortMask, const uint8_t *pColours) {
+	SetBitPlanes(&pBuffer[0], nPortMask, pColours[Order::FIRST]);
+	SetBitPlanes(&pBuffer[8], nPortMask, pColours[Order::SECOND]);
+	SetBitPlanes(&pBuffer[16], nPortMask, pColours[Order::THIRD]);
+	if (Order::CHANNELS == 4) {
+		SetBitPlanes(&pBuffer[24], nPortMask, pColours[Order::FOURTH]);
+	}
+}
+}  // namespace encoder
+
+template<class Order, bool b8x, bool bCorrection>
+void WS28xxMulti::SetLEDsEncoded(uint32_t nPort, uint32_t nLedIndex, const uint8_t *pData, uint32_t nCount) {
+	const auto nPortMask = 1U << nPort;
+	auto nOffset = nLedIndex * Order::CHANNELS * 8;
+
+	for (uint32_t i = 0; i < nCount; i++) {
+		const uint8_t *pColours = pData;
+		uint8_t colours[Order::CHANNELS];
+
+		if (bCorrection) {
+			for (uint32_t nChannel = 0; nChannel < Order::CHANNELS; nChannel++) {
+				colours[nChannel] = m_pColourCorrection->Get8(static_cast<Channel>(nChannel), pData[nChannel]);
+			}
+			pColours = colours;
+		}
+
+		if (b8x) {
+			encoder::Encode<Order>(&m_pBuffer8x[nOffset], nPortMask, pColours);
+		} else {
+			encoder::Encode<Order>(&m_pBuffer4x[nOffset], nPortMask, pColours);
+		}
+
+		pData += Order::CHANNELS;
+		nOffset += Order::CHANNELS * 8;
+	}
+}
+
+template<class Order, bool b8x>
+WS28xxMulti::SetLEDsFunction WS28xxMulti::GetEncoder() const {
+	if (m_pColourCorrection != nullptr) {
+		return &WS28xxMulti::SetLEDsEncoded<Order, b8x, true>;
+	}
+
+	return &WS28xxMulti::SetLEDsEncoded<Order, b8x, false>;
+}
+
+template<class Order>
+WS28xxMulti::SetLEDsFunction WS28xxMulti::GetEncoder() const {
+	if (m_tBoard == Board::X8) {
+		return GetEncoder<Order, true>();
+	}
+
+	return GetEncoder<Order, false>();
+}
+
+void WS28xxMulti::SelectEncoder() {
+	if (m_tWS28xxType == Type::SK6812W) {
+		m_pSetLEDs = GetEncoder<encoder::GRBW>();
+		return;
+	}
+
+	switch (m_tRGBMapping) {
+	case rgbmapping::Map::RGB:
+		m_pSetLEDs = GetEncoder<encoder::RGB<rgbmapping::Map::RGB>>();
+		break;
+	case rgbmapping::Map::RBG:
+		m_pSetLEDs = GetEncoder<encoder::RGB<rgbmapping::Map::RBG>>();
+		break;
+	case rgbmapping::Map::GBR:
+		m_pSetLEDs = GetEncoder<encoder::RGB<rgbmapping::Map::GBR>>();
+		break;
+	case rgbmapping::Map::BRG:
+		m_pSetLEDs = GetEncoder<encoder::RGB<rgbmapping::Map::BRG>>();
+		break;
+	case rgbmapping::Map::BGR:
+		m_pSetLEDs = GetEncoder<encoder::RGB<rgbmapping::Map::BGR>>();
+		break;
+	default:  // GRB
+		m_pSetLEDs = GetEncoder<encoder::RGB<rgbmapping::Map::GRB>>();
+		break;
+	}
+}
@@ -24,56 +24,155 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 #include <cassert>
 
 #include "ws28xx.h"
 #include "rgbmapping.h"
 
+#include "colourcorrection.h"
+
 using namespace ws28xx;
+using colourcorrection::Channel;
+
+/*
+ * The encoders are selected once, the inner loops have no per LED branching.
+ * Each Encode writes one LED at pBuffer, the colours are in R,G,B(,W) order.
+ */
+namespace encoder {
+template<rgbmapping::Map tMap>
+struct RTZ {
+	static constexpr uint32_t CHANNELS = 3;
+	static constexpr uint32_t BYTES = 24;
+	static constexpr uint32_t HEADER = 0;
+
+	static void Encode(uint8_t *pBuffer, const uint8_t *pColours, const uint8_t (*pCodeTable)[8], __attribute__((unused)) uint8_t nGlobalBrightness) {
+		memcpy(&pBuffer[0], pCodeTable[pColours[rgbmapping::Order<tMap>::FIRST]], 8);
+		memcpy(&pBuffer[8], pCodeTable[pColours[rgbmapping::Order<tMap>::SECOND]], 8);
+		memcpy(&pBuffer[16], pCodeTable[pColours[rgbmapping::Order<tMap>::THIRD]], 8);
+	}
+};
+
+struct RTZW {	// GRBW
+	static constexpr uint32_t CHANNELS = 4;
+	static constexpr uint32_t BYTES = 32;
+	static constexpr uint32_t HEADER = 0;
+
+	static void Encode(uint8_t *pBuffer, const uint8_t *pColours, const uint8_t (*pCodeTable)[8], __attribute__((unused)) uint8_t nGlobalBrightness) {
+		memcpy(&pBuffer[0], pCodeTable[pColours[1]], 8);
+		memcpy(&pBuffer[8], pCodeTable[pColours[0]], 8);
+		memcpy(&pBuffer[16], pCodeTable[pColours[2]], 8);
+		memcpy(&pBuffer[24], pCodeTable[pColours[3]], 8);
+	}
+};
+
+struct WS2801 {
+	static constexpr uint32_t CHANNELS = 3;
+	static constexpr uint32_t BYTES = 3;
+	static constexpr uint32_t HEADER = 0;
+
+	static void Encode(uint8_t *pBuffer, const uint8_t *pColours, __attribute__((unused)) const uint8_t (*pCodeTable)[8], __attribute__((unused)) uint8_t nGlobalBrightness) {
+		pBuffer[0] = pColours[0];
+		pBuffer[1] = pColours[1];
+		pBuffer[2] = pColours[2];
+	}
+};
+
+struct APA102 {
+	static constexpr uint32_t CHANNELS = 3;
+	static constexpr uint32_t BYTES = 4;
+	static constexpr uint32_t HEADER = 4;
+
+	static void Encode(uint8_t *pBuffer, const uint8_t *pColours, __attribute__((unused)) const uint8_t (*pCodeTable)[8], uint8_t nGlobalBrightness) {
+		pBuffer[0] = nGlobalBrightness;
+		pBuffer[1] = pColours[0];
+		pBuffer[2] = pColours[1];
+		pBuffer[3] = pColours[2];
+	}
+};
+
+struct P9813 {
+	static constexpr uint32_t CHANNELS = 3;
+	static constexpr uint32_t BYTES = 4;
+	static constexpr uint32_t HEADER = 4;
+
+	static void Encode(uint8_t *pBuffer, const uint8_t *pColours, __attribute__((unused)) const uint8_t (*pCodeTable)[8], __attribute__((unused)) uint8_t nGlobalBrightness) {
+		const auto nRed = pColours[0];
+		const auto nGreen = pColours[1];
+		const auto nBlue = pColours[2];
+
+		pBuffer[0] = static_cast<uint8_t>(0xC0 | ((~nBlue & 0xC0) >> 2) | ((~nGreen & 0xC0) >> 4) | ((~nRed & 0xC0) >> 6));
+		pBuffer[1] = nBlue;
+		pBuffer[2] = nGreen;
+		pBuffer[3] = nRed;
+	}
+};
+}  // namespace encoder
+
+template<class Encoder, bool bCorrection>
+void WS28xx::SetLEDsEncoded(uint32_t nLEDIndex, const uint8_t *pData, uint32_t nCount) {
+	auto *pBuffer = &m_pBuffer[Encoder::HEADER + (nLEDIndex * Encoder::BYTES)];
+
+	assert(Encoder::HEADER + ((nLEDIndex + nCount) * Encoder::BYTES) <= m_nBufSize);
+
+	for (uint32_t i = 0; i < nCount; i++) {
+		if (bCorrection) {
+			uint8_t colours[Encoder::CHANNELS];
 
-void WS28xx::SetLED(uint32_t nLEDIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue) {
-	assert(m_pBuffer != nullptr);
-	assert(nLEDIndex < m_nLedCount);
+			for (uint32_t nChannel = 0; nChannel < Encoder::CHANNELS; nChannel++) {
+				colours[nChannel] = m_pColourCorrection->Get8(static_cast<Channel>(nChannel), pData[nChannel]);
+			}
 
-	if (__builtin_expect((m_bIsRTZProtocol), 1)) {
-		uint32_t nOffset = nLEDIndex * 3;
-		nOffset *= 8;
+			Encoder::Encode(pBuffer, colours, m_CodeTable, m_nGlobalBrightness);
+		} else {
+			Encoder::Encode(pBuffer, pData, m_CodeTable, m_nGlobalBrightness);
+		}
+
+		pData += Encoder::CHANNELS;
+		pBuffer += Encoder::BYTES;
+	}
+}
+
+template<class Encoder>
+WS28xx::SetLEDsFunction WS28xx::GetEncoder() const {
+	if (m_pColourCorrection != nullptr) {
+		return &WS28xx::SetLEDsEncoded<Encoder, true>;
+	}
+
+	return &WS28xx::SetLEDsEncoded<Encoder, false>;
+}
+
+void WS28xx::SelectEncoder() {
+	for (uint32_t nValue = 0; nValue < 256; nValue++) {
+		for (uint32_t nBit = 0; nBit < 8; nBit++) {
+			m_CodeTable[nValue][nBit] = (nValue & (0x80U >> nBit)) ? m_nHighCode : m_nLowCode;
+		}
+	}
+
+	if (m_bIsRTZProtocol) {
+		if (m_tLEDType == Type::SK6812W) {
+			m_pSetLEDs = GetEncoder<encoder::RTZW>();
+			return;
+		}
 
 		switch (m_tRGBMapping) {
-		case rgbmapping::Map::RGB:
-			SetColorWS28xx(nOffset, nRed);
-			SetColorWS28xx(nOffset + 8, nGreen);
-			SetColorWS28xx(nOffset + 16, nBlue);
-			break;
 		case rgbmapping::Map::RBG:
-			SetColorWS28xx(nOffset, nRed);
-			SetColorWS28xx(nOffset + 8, nBlue);
-			SetColorWS28xx(nOffset + 16, nGreen);
+			m_pSetLEDs = GetEncoder<encoder::RTZ<rgbmapping::Map::RBG>>();
 			break;
 		case rgbmapping::Map::GRB:
-			SetColorWS28xx(nOffset, nGreen);
-			SetColorWS28xx(nOffset + 8, nRed);
-			SetColorWS28xx(nOffset + 16, nBlue);
+			m_pSetLEDs = GetEncoder<encoder::RTZ<rgbmapping::Map::GRB>>();
 			break;
 		case rgbmapping::Map::GBR:
-			SetColorWS28xx(nOffset, nGreen);
-			SetColorWS28xx(nOffset + 8, nBlue);
-			SetColorWS28xx(nOffset + 16, nRed);
+			m_pSetLEDs = GetEncoder<encoder::RTZ<rgbmapping::Map::GBR>>();
 			break;
 		case rgbmapping::Map::BRG:
-			SetColorWS28xx(nOffset, nBlue);
-			SetColorWS28xx(nOffset + 8, nRed);
-			SetColorWS28xx(nOffset + 16, nGreen);
+			m_pSetLEDs = GetEncoder<encoder::RTZ<rgbmapping::Map::BRG>>();
 			break;
 		case rgbmapping::Map::BGR:
-			SetColorWS28xx(nOffset, nBlue);
-			SetColorWS28xx(nOffset + 8, nGreen);
-			SetColorWS28xx(nOffset + 16, nRed);
+			m_pSetLEDs = GetEncoder<encoder::RTZ<rgbmapping::Map::BGR>>();
 			break;
 		default:  // RGB
-			SetColorWS28xx(nOffset, nRed);
-			SetColorWS28xx(nOffset + 8, nGreen);
-			SetColorWS28xx(nOffset + 16, nBlue);
+			m_pSetLEDs = GetEncoder<encoder::RTZ<rgbmapping::Map::RGB>>();
 			break;
 		}
 
@@ -81,72 +180,16 @@ void WS28xx::SetLED(uint32_t nLEDIndex, uint8_t nRed, uint8_t nGreen, uint8_t nB
 	}
 
 	if (m_tLEDType == Type::APA102) {
-		uint32_t nOffset = 4 + (nLEDIndex * 4);
-		assert(nOffset + 3 < m_nBufSize);
-
-		m_pBuffer[nOffset] = m_nGlobalBrightness;
-		m_pBuffer[nOffset + 1] = nRed;
-		m_pBuffer[nOffset + 2] = nGreen;
-		m_pBuffer[nOffset + 3] = nBlue;
-
-		return;
-	}
-
-	if (m_tLEDType == Type::WS2801) {
-		uint32_t nOffset = nLEDIndex * 3;
-		assert(nOffset + 2 < m_nBufSize);
-
-		m_pBuffer[nOffset] = nRed;
-		m_pBuffer[nOffset + 1] = nGreen;
-		m_pBuffer[nOffset + 2] = nBlue;
-
+		m_pSetLEDs = GetEncoder<encoder::APA102>();
 		return;
 	}
 
 	if (m_tLEDType == Type::P9813) {
-		uint32_t nOffset = 4 + (nLEDIndex * 4);
-		assert(nOffset + 3 < m_nBufSize);
-
-		const uint8_t nFlag = 0xC0 | ((~nBlue & 0xC0) >> 2) | ((~nGreen & 0xC0) >> 4) | ((~nRed & 0xC0) >> 6);
-
-		m_pBuffer[nOffset] = nFlag;
-		m_pBuffer[nOffset + 1] = nBlue;
-		m_pBuffer[nOffset + 2] = nGreen;
-		m_pBuffer[nOffset + 3] = nRed;
-
+		m_pSetLEDs = GetEncoder<encoder::P9813>();
 		return;
 	}
-}
-
-void WS28xx::SetLED(uint32_t nLEDIndex, uint8_t nRed, uint8_t nGreen, uint8_t nBlue, uint8_t nWhite) {
-	assert(m_pBuffer != nullptr);
-	assert(nLEDIndex < m_nLedCount);
-	assert(m_tLEDType == Type::SK6812W);
-
-	uint32_t nOffset = nLEDIndex * 4;
-
-	if (m_tLEDType == Type::SK6812W) {
-		nOffset *= 8;
-
-		SetColorWS28xx(nOffset, nGreen);
-		SetColorWS28xx(nOffset + 8, nRed);
-		SetColorWS28xx(nOffset + 16, nBlue);
-		SetColorWS28xx(nOffset + 24, nWhite);
-	}
-}
-
-void WS28xx::SetColorWS28xx(uint32_t nOffset, uint8_t nValue) {
-	assert(m_tLEDType != Type::WS2801);
-	assert(nOffset + 7 < m_nBufSize);
 
-	for (uint8_t mask = 0x80; mask != 0; mask >>= 1) {
-		if (nValue & mask) {
-			m_pBuffer[nOffset] = m_nHighCode;
-		} else {
-			m_pBuffer[nOffset] = m_nLowCode;
-		}
-		nOffset++;
-	}
+	m_pSetLEDs = GetEncoder<encoder::WS2801>();
 }
 
 void WS28xx::SetGlobalBrightness(uint8_t nGlobalBrightness) {
@@ -0,0 +1,114 @@
+/**
+ * @file dirtyrange_bench.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Encode cost of WS28xxDmx::SetData (full universe) against
+ * WS28xxDmx::SetDataRange (changed slots only), for a WS2812B string of
+ * 680 LEDs spread over 4 universes. Each frame changes a window of
+ * slots in every universe.
+ *
+ * Usage: dirtyrange_bench [frames]
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hardware.h"
+
+#include "ws28xxdmx.h"
+#include "ws28xx.h"
+
+namespace bench {
+static constexpr auto PORTS = 4;
+static constexpr auto LED_COUNT = 680;
+static constexpr auto UNIVERSE_SLOTS = 510;
+}  // namespace bench
+
+static uint64_t now_ns() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static double run(WS28xxDmx& ws28xxDmx, uint8_t pData[][bench::UNIVERSE_SLOTS], uint32_t nFrames, uint16_t nDirty, bool bRange) {
+	const auto nStart = now_ns();
+
+	for (uint32_t nFrame = 0; nFrame < nFrames; nFrame++) {
+		const auto nFirst = static_cast<uint16_t>((nFrame * 3) % (bench::UNIVERSE_SLOTS - nDirty + 1));
+		const auto nEnd = static_cast<uint16_t>(nFirst + nDirty);
+
+		for (uint8_t nPort = 0; nPort < bench::PORTS; nPort++) {
+			for (uint32_t i = nFirst; i < nEnd; i++) {
+				pData[nPort][i]++;
+			}
+
+			if (bRange) {
+				ws28xxDmx.SetDataRange(nPort, pData[nPort], bench::UNIVERSE_SLOTS, nFirst, nEnd);
+			} else {
+				ws28xxDmx.SetData(nPort, pData[nPort], bench::UNIVERSE_SLOTS);
+			}
+		}
+	}
+
+	return static_cast<double>(now_ns() - nStart) / 1000.0 / nFrames;
+}
+
+int main(int argc, char **argv) {
+	const auto nFrames = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : 20000;
+
+	Hardware hw;
+
+	WS28xxDmx ws28xxDmx;
+	ws28xxDmx.SetLEDType(ws28xx::Type::WS2812B);
+	ws28xxDmx.SetLEDCount(bench::LED_COUNT);
+	ws28xxDmx.Start();
+
+	static uint8_t data[bench::PORTS][bench::UNIVERSE_SLOTS];
+
+	for (uint8_t nPort = 0; nPort < bench::PORTS; nPort++) {
+		for (uint32_t i = 0; i < bench::UNIVERSE_SLOTS; i++) {
+			data[nPort][i] = static_cast<uint8_t>(i * 7 + nPort);
+		}
+		ws28xxDmx.SetData(nPort, data[nPort], bench::UNIVERSE_SLOTS);
+	}
+
+	printf("%d LEDs, %d universes, %u frames, us per frame\n", bench::LED_COUNT, bench::PORTS, nFrames);
+
+	const uint16_t dirty[] = { 3, 30, 150, bench::UNIVERSE_SLOTS };
+
+	for (const auto nDirty : dirty) {
+		const auto fFull = run(ws28xxDmx, data, nFrames, nDirty, false);
+		const auto fRange = run(ws28xxDmx, data, nFrames, nDirty, true);
+
+		printf("dirty %3u slots/universe  SetData %7.2f  SetDataRange %7.2f\n", nDirty, fFull, fRange);
+	}
+
+	ws28xxDmx.Stop();
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file dither_test.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * WS28xxDmxDither: for a constant 8.8 input v (v <= 0xFF00), every output
+ * is (v >> 8) or (v >> 8) + 1, and the sum over 256 refreshes is exactly v.
+ * All values are tested, one per channel.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "ws28xxdmxdither.h"
+
+int main() {
+	static constexpr uint32_t SIZE = 0xFF00 + 1;
+
+	static uint16_t input[SIZE];
+	static uint32_t sum[SIZE];
+
+	for (uint32_t i = 0; i < SIZE; i++) {
+		input[i] = static_cast<uint16_t>(i);
+	}
+
+	WS28xxDmxDither dither(SIZE);
+	uint32_t nErrors = 0;
+
+	for (uint32_t nFrame = 0; nFrame < 256; nFrame++) {
+		const auto *pOutput = dither.Run(input);
+
+		for (uint32_t i = 0; i < SIZE; i++) {
+			if ((pOutput[i] != (i >> 8)) && (pOutput[i] != (i >> 8) + 1)) {
+				if (nErrors++ < 8) {
+					printf("value %04x frame %u: output %u\n", i, nFrame, pOutput[i]);
+				}
+			}
+			sum[i] += pOutput[i];
+		}
+	}
+
+	for (uint32_t i = 0; i < SIZE; i++) {
+		if (sum[i] != i) {
+			if (nErrors++ < 16) {
+				printf("value %04x: sum over 256 frames %u\n", i, sum[i]);
+			}
+		}
+	}
+
+	if (nErrors != 0) {
+		printf("FAILED: %u errors\n", nErrors);
+		return EXIT_FAILURE;
+	}
+
+	puts("dither: PASSED");
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file interpolator_test.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * WS28xxDmxInterpolator: the word-wise (SWAR) blend of Run() and Run16()
+ * must be bit-exact with a scalar per-byte blend, for sizes that are not a
+ * multiple of 4. Then Run() is timed against the scalar blend for a frame
+ * of 680 RGB pixels.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ws28xxdmxinterpolator.h"
+
+static uint64_t now_ns() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static void fill(uint8_t *pData, uint32_t nSize) {
+	for (uint32_t i = 0; i < nSize; i++) {
+		pData[i] = static_cast<uint8_t>(rand());
+	}
+}
+
+static uint32_t check(uint32_t nSize) {
+	WS28xxDmxInterpolator interpolator(nSize);
+	uint8_t *pFrom = new uint8_t[nSize];
+	uint32_t nErrors = 0;
+	uint32_t nMicros = 0;
+
+	for (uint32_t nRound = 0; nRound < 200; nRound++) {
+		nMicros += 20000 + static_cast<uint32_t>(rand() % 10000);
+
+		// The transition starts from what is on the output now
+		memcpy(pFrom, interpolator.Run(nMicros), nSize);
+
+		fill(interpolator.GetInput(), nSize);
+		interpolator.Latch(nMicros);
+
+		const auto *pTo = interpolator.GetInput();
+		const auto nPeriod = interpolator.GetInputPeriodMicros();
+		const auto nElapsed = static_cast<uint32_t>(rand()) % (nPeriod + 1000);
+		const auto bDone = nElapsed >= nPeriod;
+		const auto f = bDone ? 256U : (nElapsed * 256U) / nPeriod;
+
+		const auto *pOut16 = interpolator.Run16(nMicros + nElapsed);
+		const auto *pOut = interpolator.Run(nMicros + nElapsed);
+
+		for (uint32_t i = 0; i < nSize; i++) {
+			const auto n16 = pFrom[i] * (256U - f) + pTo[i] * f;
+
+			if ((pOut[i] != (n16 >> 8)) || (pOut16[i] != n16)) {
+				if (nErrors++ < 8) {
+					printf("size %u byte %u f %u: from %u to %u -> %u/%u, expected %u/%u\n", nSize, i, f, pFrom[i], pTo[i], pOut[i], pOut16[i], n16 >> 8, n16);
+				}
+			}
+		}
+
+		if (interpolator.IsActive() == bDone) {
+			printf("size %u: active %d after %u of %u us\n", nSize, interpolator.IsActive(), nElapsed, nPeriod);
+			nErrors++;
+		}
+	}
+
+	delete[] pFrom;
+
+	return nErrors;
+}
+
+static void bench(uint32_t nPixels) {
+	const auto nSize = nPixels * 3;
+	const auto nRuns = 20000U;
+
+	WS28xxDmxInterpolator interpolator(nSize);
+	fill(interpolator.GetInput(), nSize);
+	interpolator.Latch(0);
+	fill(interpolator.GetInput(), nSize);
+	interpolator.Latch(25000);
+
+	uint32_t nSum = 0;
+	auto nStart = now_ns();
+
+	for (uint32_t nRun = 0; nRun < nRuns; nRun++) {
+		nSum += interpolator.Run(25000 + (nRun % 20000))[nRun % nSize];
+	}
+
+	const auto fSwar = static_cast<double>(now_ns() - nStart) / nRuns;
+
+	uint8_t *pFrom = new uint8_t[nSize];
+	uint8_t *pTo = new uint8_t[nSize];
+	uint8_t *pOut = new uint8_t[nSize];
+	fill(pFrom, nSize);
+	fill(pTo, nSize);
+
+	nStart = now_ns();
+
+	for (uint32_t nRun = 0; nRun < nRuns; nRun++) {
+		const auto f = (nRun % 20000) * 256U / 25000;
+		for (uint32_t i = 0; i < nSize; i++) {
+			pOut[i] = static_cast<uint8_t>((pFrom[i] * (256U - f) + pTo[i] * f) >> 8);
+		}
+		nSum += pOut[nRun % nSize];
+		__asm__ volatile("" ::: "memory");
+	}
+
+	const auto fScalar = static_cast<double>(now_ns() - nStart) / nRuns;
+
+	printf("%u RGB pixels: Run %.2f us (%.0f Mpixels/s), scalar blend %.2f us (%.0f Mpixels/s) [%u]\n",
+			nPixels,
+			fSwar / 1000.0, nPixels / fSwar * 1000.0,
+			fScalar / 1000.0, nPixels / fScalar * 1000.0,
+			nSum & 1);
+
+	delete[] pOut;
+	delete[] pTo;
+	delete[] pFrom;
+}
+
+int main() {
+	uint32_t nErrors = 0;
+
+	const uint32_t sizes[] = { 1, 3, 510, 1021, 2040 };
+
+	for (const auto nSize : sizes) {
+		nErrors += check(nSize);
+	}
+
+	if (nErrors != 0) {
+		printf("FAILED: %u errors\n", nErrors);
+		return EXIT_FAILURE;
+	}
+
+	puts("bit-exact: PASSED");
+
+	bench(680);
+
+	return EXIT_SUCCESS;
+}
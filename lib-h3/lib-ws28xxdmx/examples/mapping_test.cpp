@@ -0,0 +1,144 @@
+/**
+ * @file mapping_test.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * WS28xxDmxMapping: the compiled tables of small layouts are checked
+ * against hand-derived ones, then the per-frame gather through the table
+ * (as in WS28xxDmxMulti::SetLEDsMapped) is timed for 8 outputs of 680
+ * RGB pixels.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ws28xxdmxmapping.h"
+
+using namespace ws28xxdmxmapping;
+
+static uint64_t now_ns() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+static uint32_t check(const char *pName, uint32_t nLedCount, const struct TWS28xxDmxMapping& tMapping, const uint16_t *pExpected) {
+	WS28xxDmxMapping mapping(1, nLedCount, 3);
+	mapping.Compile(&tMapping);
+
+	if (memcmp(mapping.GetTable(), pExpected, nLedCount * sizeof(uint16_t)) == 0) {
+		return 0;
+	}
+
+	printf("%s: got", pName);
+	for (uint32_t i = 0; i < nLedCount; i++) {
+		printf(" %d", mapping.GetTable()[i]);
+	}
+	puts("");
+
+	return 1;
+}
+
+static void bench() {
+	static constexpr uint32_t OUTPUTS = 8;
+	static constexpr uint32_t LED_COUNT = 680;
+	static constexpr uint32_t FRAMES = 2000;
+
+	// 2 x 4 panels of 40 x 17, serpentine: 8 x 680 pixels
+	const struct TWS28xxDmxMapping tMapping = { 40, 17, 2, 4, flags::SERPENTINE };
+
+	WS28xxDmxMapping mapping(OUTPUTS, LED_COUNT, 3);
+	mapping.Compile(&tMapping);
+
+	auto *pInput = mapping.GetInput();
+
+	for (uint32_t i = 0; i < OUTPUTS * LED_COUNT * 3; i++) {
+		pInput[i] = static_cast<uint8_t>(i);
+	}
+
+	static uint8_t output[OUTPUTS * LED_COUNT * 3];
+	uint32_t nSum = 0;
+
+	const auto nStart = now_ns();
+
+	for (uint32_t nFrame = 0; nFrame < FRAMES; nFrame++) {
+		const auto *pTable = mapping.GetTable();
+		auto *pOutput = output;
+
+		for (uint32_t j = 0; j < OUTPUTS * LED_COUNT; j++) {
+			const auto nSource = *pTable++;
+
+			if (__builtin_expect((nSource == UNMAPPED), 0)) {
+				pOutput[0] = pOutput[1] = pOutput[2] = 0;
+			} else {
+				const auto *p = &pInput[nSource * 3];
+				pOutput[0] = p[0];
+				pOutput[1] = p[1];
+				pOutput[2] = p[2];
+			}
+
+			pOutput += 3;
+		}
+
+		nSum += output[nFrame % sizeof(output)];
+		pInput[nFrame % (OUTPUTS * LED_COUNT * 3)]++;
+	}
+
+	printf("gather %ux%u RGB pixels: %.2f us per frame [%u]\n", OUTPUTS, LED_COUNT, static_cast<double>(now_ns() - nStart) / 1000.0 / FRAMES, nSum & 1);
+}
+
+int main() {
+	uint32_t nErrors = 0;
+
+	// 4 x 2 single panel
+	const uint16_t serpentine[] = { 0, 1, 2, 3, 7, 6, 5, 4 };
+	const uint16_t rotation90[] = { 6, 4, 2, 0, 7, 5, 3, 1 };
+	const uint16_t rotation180[] = { 7, 6, 5, 4, 3, 2, 1, 0 };
+	const uint16_t rotation270[] = { 1, 3, 5, 7, 0, 2, 4, 6 };
+	// 2 x 2 panels of 2 x 2, canvas 4 x 4
+	const uint16_t panels[] = { 0, 1, 4, 5, 2, 3, 6, 7, 8, 9, 12, 13, 10, 11, 14, 15 };
+	// 3 x 2 panel on 8 pixels, the last 2 are blanked
+	const uint16_t unmapped[] = { 0, 1, 2, 3, 4, 5, UNMAPPED, UNMAPPED };
+
+	nErrors += check("serpentine", 8, { 4, 2, 1, 1, flags::SERPENTINE }, serpentine);
+	nErrors += check("rotation 90", 8, { 4, 2, 1, 1, 1 << flags::ROTATION_SHIFT }, rotation90);
+	nErrors += check("rotation 180", 8, { 4, 2, 1, 1, 2 << flags::ROTATION_SHIFT }, rotation180);
+	nErrors += check("rotation 270", 8, { 4, 2, 1, 1, 3 << flags::ROTATION_SHIFT }, rotation270);
+	nErrors += check("panels", 16, { 2, 2, 2, 2, 0 }, panels);
+	nErrors += check("unmapped", 8, { 3, 2, 1, 1, 0 }, unmapped);
+
+	if (nErrors != 0) {
+		printf("FAILED: %u errors\n", nErrors);
+		return EXIT_FAILURE;
+	}
+
+	puts("mapping: PASSED");
+
+	bench();
+
+	return EXIT_SUCCESS;
+}
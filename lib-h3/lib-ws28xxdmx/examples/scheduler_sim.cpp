@@ -0,0 +1,156 @@
+/**
+ * @file scheduler_sim.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * WS28xxDmxScheduler against a mock SPI/DMA output, on a simulated clock.
+ *
+ * Frames arrive at a fixed input rate. The mock output is busy for
+ * GetFrameMicros() after each transmission start.
+ *
+ *  direct    : every frame is transmitted, the main loop waits while the
+ *              output is busy (the unscheduled WS28xxDmx behaviour). Frames
+ *              that do not fit in the receive queue meanwhile are dropped.
+ *  scheduled : frames are latched, Run() starts the transmissions
+ *
+ * Reported: output frames/s, coalesced (or dropped) frames, the latency from frame
+ * arrival to transmission start, and the time the main loop was stalled.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "ws28xxdmxscheduler.h"
+#include "ws28xx.h"
+
+namespace sim {
+static constexpr uint32_t SECONDS = 10;
+static constexpr uint32_t STEP_MICROS = 10;	///< Main loop iteration
+static constexpr uint32_t RX_QUEUE = 4;		///< Frames the network buffers hold
+}  // namespace sim
+
+struct Result {
+	uint32_t nTransmitted;
+	uint32_t nCoalesced;
+	uint64_t nLatencySum;
+	uint32_t nLatencyMax;
+	uint64_t nStalled;
+};
+
+static void print(const char *pMode, const Result& result) {
+	printf("  %-9s  out %5.1f fps  coalesced %5u  latency avg %6.0f us max %6u us  stalled %5.1f%%\n",
+			pMode,
+			static_cast<double>(result.nTransmitted) / sim::SECONDS,
+			result.nCoalesced,
+			result.nTransmitted == 0 ? 0.0 : static_cast<double>(result.nLatencySum) / result.nTransmitted,
+			result.nLatencyMax,
+			100.0 * static_cast<double>(result.nStalled) / (sim::SECONDS * 1000000.0));
+}
+
+static void latency(Result& result, uint32_t nMicros, uint32_t nArrivalMicros) {
+	const auto nLatency = nMicros - nArrivalMicros;
+	result.nLatencySum += nLatency;
+	if (nLatency > result.nLatencyMax) {
+		result.nLatencyMax = nLatency;
+	}
+}
+
+static Result direct(uint32_t nFrameMicros, uint32_t nInputMicros) {
+	Result result {};
+	uint32_t nBusyUntil = 0;
+	uint32_t nNextInput = 0;
+
+	for (uint32_t nMicros = 0; nMicros < sim::SECONDS * 1000000U; nMicros += sim::STEP_MICROS) {
+		if (nMicros < nNextInput) {
+			continue;
+		}
+
+		while ((nMicros - nNextInput) >= sim::RX_QUEUE * nInputMicros) {
+			nNextInput += nInputMicros;
+			result.nCoalesced++;
+		}
+
+		const auto nArrival = nNextInput;
+		nNextInput += nInputMicros;
+
+		if (nMicros < nBusyUntil) {
+			// Encoding waits for the active transfer
+			result.nStalled += nBusyUntil - nMicros;
+			nMicros = nBusyUntil;
+		}
+
+		latency(result, nMicros, nArrival);
+		result.nTransmitted++;
+		nBusyUntil = nMicros + nFrameMicros;
+	}
+
+	return result;
+}
+
+static Result scheduled(uint32_t nFrameMicros, uint32_t nInputMicros) {
+	WS28xxDmxScheduler scheduler;
+	scheduler.SetFrameMicros(nFrameMicros);
+
+	Result result {};
+	uint32_t nBusyUntil = 0;
+	uint32_t nNextInput = 0;
+	uint32_t nArrival = 0;
+
+	for (uint32_t nMicros = 0; nMicros < sim::SECONDS * 1000000U; nMicros += sim::STEP_MICROS) {
+		if (nMicros >= nNextInput) {
+			nArrival = nNextInput;
+			nNextInput += nInputMicros;
+			scheduler.Latch();
+		}
+
+		if ((nMicros >= nBusyUntil) && scheduler.Run(nMicros)) {
+			latency(result, nMicros, nArrival);
+			nBusyUntil = nMicros + nFrameMicros;
+		}
+	}
+
+	result.nTransmitted = scheduler.GetTransmitted();
+	result.nCoalesced = scheduler.GetCoalesced();
+
+	return result;
+}
+
+int main() {
+	const uint32_t ledCounts[] = { 170, 680 };
+	const uint32_t inputFps[] = { 30, 44, 100 };
+
+	for (const auto nLedCount : ledCounts) {
+		const auto nFrameMicros = WS28xxDmxScheduler::GetFrameMicros(ws28xx::Type::WS2812B, nLedCount * ws28xx::single::RGB, 0);
+
+		for (const auto nFps : inputFps) {
+			printf("WS2812B %u LEDs, frame %u us (%u fps max), input %u fps\n", nLedCount, nFrameMicros, 1000000U / nFrameMicros, nFps);
+
+			print("direct", direct(nFrameMicros, 1000000U / nFps));
+			print("scheduled", scheduled(nFrameMicros, 1000000U / nFps));
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
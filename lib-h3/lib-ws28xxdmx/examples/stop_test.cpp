@@ -0,0 +1,143 @@
+/**
+ * @file stop_test.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * WS28xxDmx with the scheduler and interpolation: after Stop() or
+ * Blackout(true) the strip must stay dark, whatever frame was latched
+ * or whatever transition was running. Run() must not transmit until the
+ * output is started or the blackout is released.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hardware.h"
+
+#include "ws28xxdmx.h"
+#include "ws28xx.h"
+
+namespace test {
+static constexpr auto LED_COUNT = 170;
+static constexpr auto SLOTS = LED_COUNT * 3;
+static constexpr uint32_t DARK_MILLIS = 100;	///< Longer than a transition
+}  // namespace test
+
+static void run_for(WS28xxDmx& ws28xxDmx, uint32_t nMillis) {
+	const auto nStart = Hardware::Get()->Millis();
+
+	while ((Hardware::Get()->Millis() - nStart) < nMillis) {
+		ws28xxDmx.Run();
+		usleep(100);
+	}
+}
+
+static uint32_t check_dark(const char *pName, WS28xxDmx& ws28xxDmx) {
+	const auto nTransmitted = ws28xxDmx.GetScheduler().GetTransmitted();
+
+	run_for(ws28xxDmx, test::DARK_MILLIS);
+
+	const auto nAfter = ws28xxDmx.GetScheduler().GetTransmitted();
+
+	if (nAfter != nTransmitted) {
+		printf("%s: %u frames transmitted\n", pName, nAfter - nTransmitted);
+		return 1;
+	}
+
+	return 0;
+}
+
+static uint32_t check_lit(const char *pName, WS28xxDmx& ws28xxDmx) {
+	const auto nTransmitted = ws28xxDmx.GetScheduler().GetTransmitted();
+
+	run_for(ws28xxDmx, 10);
+
+	if (ws28xxDmx.GetScheduler().GetTransmitted() == nTransmitted) {
+		printf("%s: nothing transmitted\n", pName);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main() {
+	Hardware hw;
+
+	WS28xxDmx ws28xxDmx;
+	ws28xxDmx.SetLEDType(ws28xx::Type::WS2812B);
+	ws28xxDmx.SetLEDCount(test::LED_COUNT);
+	ws28xxDmx.SetScheduled(true);
+	ws28xxDmx.SetInterpolation(true);
+	ws28xxDmx.Start();
+
+	static uint8_t data[test::SLOTS];
+	uint32_t nErrors = 0;
+
+	memset(data, 0xFF, sizeof(data));
+
+	// Stop with a frame latched and not yet transmitted
+	ws28xxDmx.SetData(0, data, test::SLOTS);
+	ws28xxDmx.Stop();
+	nErrors += check_dark("stop latched", ws28xxDmx);
+
+	// Stop in the middle of a transition
+	ws28xxDmx.Start();
+	ws28xxDmx.SetData(0, data, test::SLOTS);
+	nErrors += check_lit("start", ws28xxDmx);
+	data[0] = 0;
+	ws28xxDmx.SetData(0, data, test::SLOTS);
+	run_for(ws28xxDmx, 2);
+	ws28xxDmx.Stop();
+	nErrors += check_dark("stop transition", ws28xxDmx);
+
+	// Blackout with a frame latched, and frames received during the blackout
+	ws28xxDmx.Start();
+	data[0] = 0xFF;
+	ws28xxDmx.SetData(0, data, test::SLOTS);
+	ws28xxDmx.Blackout(true);
+	nErrors += check_dark("blackout latched", ws28xxDmx);
+	data[1] = 0;
+	ws28xxDmx.SetData(0, data, test::SLOTS);
+	nErrors += check_dark("blackout receiving", ws28xxDmx);
+
+	// Released, the output follows the input again
+	ws28xxDmx.Blackout(false);
+	data[1] = 0xFF;
+	ws28xxDmx.SetData(0, data, test::SLOTS);
+	nErrors += check_lit("released", ws28xxDmx);
+
+	ws28xxDmx.Stop();
+
+	if (nErrors != 0) {
+		printf("FAILED: %u errors\n", nErrors);
+		return EXIT_FAILURE;
+	}
+
+	puts("stop: PASSED");
+
+	return EXIT_SUCCESS;
+}
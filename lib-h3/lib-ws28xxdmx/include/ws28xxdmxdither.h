@@ -0,0 +1,54 @@
+/**
+ * @file ws28xxdmxdither.h
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef WS28XXDMXDITHER_H_
+#define WS28XXDMXDITHER_H_
+
+#include <stdint.h>
+
+/**
+ * Temporal error diffusion from 8.8 fixed point to 8-bit.
+ * The fraction that is lost when a channel is truncated is carried
+ * to the next refresh of the same channel, so the average over
+ * successive frames has the full 16-bit resolution.
+ */
+class WS28xxDmxDither {
+public:
+	WS28xxDmxDither(uint32_t nSize);
+	~WS28xxDmxDither();
+
+	const uint8_t *Run(const uint16_t *pInput);
+
+	uint32_t GetSize() const {
+		return m_nSize;
+	}
+
+private:
+	uint32_t m_nSize;
+	uint8_t *m_pResidual;
+	uint8_t *m_pOutput;
+};
+
+#endif /* WS28XXDMXDITHER_H_ */
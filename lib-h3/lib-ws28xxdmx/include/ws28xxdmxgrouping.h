@@ -38,6 +38,9 @@ public:
 	}
 
 	void SetData(uint8_t nPort, const uint8_t *pData, uint16_t nLenght) override;
+	void SetDataRange(uint8_t nPort, const uint8_t *pData, uint16_t nLength, __attribute__((unused)) uint16_t nFirst, __attribute__((unused)) uint16_t nEnd) override {
+		SetData(nPort, pData, nLength);
+	}
 
 	void SetLEDType(ws28xx::Type tLedType) override;
 	void SetLEDCount(uint16_t nLedCount) override;
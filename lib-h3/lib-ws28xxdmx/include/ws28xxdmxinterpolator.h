@@ -0,0 +1,95 @@
+/**
+ * @file ws28xxdmxinterpolator.h
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef WS28XXDMXINTERPOLATOR_H_
+#define WS28XXDMXINTERPOLATOR_H_
+
+#include <stdint.h>
+
+namespace ws28xxdmxinterpolator {
+static constexpr uint32_t MAX_INPUT_PERIOD_MICROS = 100000;	///< Slower input is not interpolated
+static constexpr uint32_t DEFAULT_INPUT_PERIOD_MICROS = 25000;
+}  // namespace ws28xxdmxinterpolator
+
+/**
+ * Linear interpolation between the last two received frames.
+ * The frame is received in GetInput(), Latch() starts a new
+ * transition from the last output towards it, and Run() returns the
+ * intermediate frame at the given time. The transition takes one
+ * (averaged) input period.
+ */
+class WS28xxDmxInterpolator {
+public:
+	WS28xxDmxInterpolator(uint32_t nSize);
+	~WS28xxDmxInterpolator();
+
+	uint8_t *GetInput() {
+		return reinterpret_cast<uint8_t *>(m_pInput);
+	}
+
+	uint32_t GetSize() const {
+		return m_nSize;
+	}
+
+	void Latch(uint32_t nMicros);
+
+	bool IsActive() const {
+		return m_bActive;
+	}
+
+	/**
+	 * End the transition at the current output, the next Latch()
+	 * starts from there.
+	 */
+	void Stop() {
+		m_bActive = false;
+	}
+
+	const uint8_t *Run(uint32_t nMicros);
+
+	/**
+	 * As Run(), with the full 8.8 fixed point result per channel.
+	 * Allocates the 16-bit buffer on first use.
+	 */
+	const uint16_t *Run16(uint32_t nMicros);
+
+	uint32_t GetInputPeriodMicros() const {
+		return m_nInputPeriodMicros;
+	}
+
+private:
+	uint32_t m_nSize;
+	uint32_t m_nWords;
+	uint32_t *m_pInput;
+	uint32_t *m_pFrom;
+	uint32_t *m_pTo;
+	uint32_t *m_pOutput;
+	uint32_t *m_pOutput16 { nullptr };
+	uint32_t m_nLatchMicros { 0 };
+	uint32_t m_nInputPeriodMicros { ws28xxdmxinterpolator::DEFAULT_INPUT_PERIOD_MICROS };
+	bool m_bActive { false };
+};
+
+#endif /* WS28XXDMXINTERPOLATOR_H_ */
@@ -0,0 +1,89 @@
+/**
+ * @file ws28xxdmxmapping.h
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef WS28XXDMXMAPPING_H_
+#define WS28XXDMXMAPPING_H_
+
+#include <stdint.h>
+
+namespace ws28xxdmxmapping {
+static constexpr uint16_t UNMAPPED = 0xFFFF;
+static constexpr char CSV_FILE_NAME[] = "pixelmap.csv";
+namespace flags {
+static constexpr uint8_t SERPENTINE = (1U << 0);
+static constexpr uint8_t CSV = (1U << 1);
+static constexpr uint8_t ROTATION_SHIFT = 2;		///< 2 bits, 90 degree steps clockwise
+static constexpr uint8_t ROTATION_MASK = (3U << ROTATION_SHIFT);
+}  // namespace flags
+}  // namespace ws28xxdmxmapping
+
+struct TWS28xxDmxMapping {
+	uint8_t nPanelWidth;	///< 0 = no mapping
+	uint8_t nPanelHeight;
+	uint8_t nPanelColumns;
+	uint8_t nPanelRows;
+	uint8_t nFlags;
+} __attribute__((packed));
+
+/**
+ * The layout is compiled once into a table with, for each physical pixel
+ * (output after output), the index of the pixel in the DMX frame.
+ * The DMX frame is the canvas in row order, fed by the universes of all
+ * the ports consecutively, so a row can spill over to the next port.
+ * The panels are chained left to right, top to bottom.
+ */
+class WS28xxDmxMapping {
+public:
+	WS28xxDmxMapping(uint32_t nOutputs, uint32_t nLedCount, uint32_t nChannelsPerLed);
+	~WS28xxDmxMapping();
+
+	void Compile(const struct TWS28xxDmxMapping *ptMapping);
+	bool LoadCsv(const char *pFileName = ws28xxdmxmapping::CSV_FILE_NAME);
+
+	uint8_t *GetInput() {
+		return m_pInput;
+	}
+
+	const uint16_t *GetTable() const {
+		return m_pTable;
+	}
+
+	uint32_t GetPixels() const {
+		return m_nPixels;
+	}
+
+	void Print();
+
+private:
+	uint32_t m_nOutputs;
+	uint32_t m_nLedCount;
+	uint32_t m_nPixels;
+	uint32_t m_nMapped { 0 };
+	uint16_t *m_pTable;
+	uint8_t *m_pInput;
+	struct TWS28xxDmxMapping m_tMapping;
+};
+
+#endif /* WS28XXDMXMAPPING_H_ */
@@ -36,6 +36,13 @@
 
 #include "pixelpatterns.h"
 
+#include "ws28xxdmxscheduler.h"
+#include "ws28xxdmxinterpolator.h"
+#include "ws28xxdmxdither.h"
+#include "ws28xxdmxmapping.h"
+
+#include "colourcorrection.h"
+
 namespace ws28xxdmxmulti {
 
 }  // namespace ws28xxdmxmulti
@@ -51,6 +58,10 @@ public:
 	void Stop(uint8_t nPort) override;
 
 	void SetData(uint8_t nPort, const uint8_t *pData, uint16_t nLength) override;
+	void SetDataRange(uint8_t nPort, const uint8_t *pData, uint16_t nLength, uint16_t nFirst, uint16_t nEnd) override;
+
+	void BeginFrame() override;
+	void CommitFrame() override;
 
 	void Blackout(bool bBlackout);
 
@@ -105,6 +116,59 @@ public:
 	void SetTestPattern(pixelpatterns::Pattern TestPattern);
 	void RunTestPattern();
 
+	/**
+	 * When scheduled, transmissions are started from Run() at the
+	 * output's maximum refresh rate, with only the newest frame sent.
+	 */
+	void SetScheduled(bool bScheduled) {
+		m_bScheduled = bScheduled;
+	}
+
+	bool GetScheduled() const {
+		return m_bScheduled;
+	}
+
+	/**
+	 * Interpolate between received frames at the output refresh rate.
+	 * Requires the scheduler, takes effect at Start.
+	 */
+	void SetInterpolation(bool bInterpolation) {
+		m_bInterpolation = bInterpolation;
+	}
+
+	bool GetInterpolation() const {
+		return m_bInterpolation;
+	}
+
+	/**
+	 * Temporal dithering of the 8.8 interpolated frames.
+	 * Requires interpolation, takes effect at Start.
+	 */
+	void SetDither(bool bDither) {
+		m_bDither = bDither;
+	}
+
+	bool GetDither() const {
+		return m_bDither;
+	}
+
+	void SetColourCorrection(const struct TColourCorrectionParams *pParams);
+
+	/**
+	 * The table is compiled at Start
+	 */
+	void SetMapping(const struct TWS28xxDmxMapping *ptMapping);
+
+	const ColourCorrection& GetColourCorrection() const {
+		return m_ColourCorrection;
+	}
+
+	const WS28xxDmxScheduler& GetScheduler() const {
+		return m_Scheduler;
+	}
+
+	void Run();
+
 	void Print() override;
 
 	// RDMNet LLRP Device Only
@@ -122,6 +186,9 @@ public:
 
 private:
 	void UpdateMembers();
+	void Transmit();
+	void SetLEDs(uint32_t nOutIndex, const uint8_t *pData, uint32_t nLength, uint32_t i, uint32_t beginIndex, uint32_t endIndex);
+	void SetLEDsMapped(const uint8_t *pFrame);
 
 private:
 	ws28xx::Type m_tLedType { ws28xx::defaults::TYPE };
@@ -146,6 +213,19 @@ private:
 	uint32_t m_nChannelsPerLed { 3 };
 
 	uint32_t m_nPortIdLast { 3 };
+	bool m_bInFrame { false };
+	bool m_bFrameLastPort { false };	///< The frame updated the last port, as SetData without a frame, transmit on commit
+	bool m_bScheduled { false };
+	WS28xxDmxScheduler m_Scheduler;
+	bool m_bInterpolation { false };
+	WS28xxDmxInterpolator *m_pInterpolator { nullptr };
+	bool m_bDither { false };
+	WS28xxDmxDither *m_pDither { nullptr };
+	ColourCorrection m_ColourCorrection;
+	bool m_bMapping { false };
+	struct TWS28xxDmxMapping m_tMapping;
+	WS28xxDmxMapping *m_pMapping { nullptr };
+	uint32_t m_nFullRefresh { ~0U };
 	bool m_bUseSI5351A { false };
 
 	PixelPatterns *m_pPixelPatterns { nullptr };
@@ -34,6 +34,10 @@
 
 #include "rgbmapping.h"
 
+#include "ws28xxdmxmapping.h"
+
+#include "colourcorrection.h"
+
 namespace ws28xxdmxparams {
 	static constexpr auto MAX_OUTPUTS = 8;
 }  // ws28xxdmxparams name
@@ -54,6 +58,8 @@ struct TWS28xxDmxParams {
 	uint8_t nHighCode;										///< 1	  22
 	uint16_t nStartUniverse[ws28xxdmxparams::MAX_OUTPUTS];	///< 16   38
 	uint8_t nTestPattern;									///< 1    39
+	struct TColourCorrectionParams tColourCorrection;		///< 6    45
+	struct TWS28xxDmxMapping tMapping;						///< 5    50
 }__attribute__((packed));
 
 static_assert(sizeof(struct TWS28xxDmxParams) <= 64, "struct TWS28xxDmxParams is too large");
@@ -80,6 +86,10 @@ struct WS28xxDmxParamsMask {
 	static constexpr auto START_UNI_PORT_7 = (1U << 18);
 	static constexpr auto START_UNI_PORT_8 = (1U << 19);
 	static constexpr auto TEST_PATTERN = (1U << 20);
+	static constexpr auto INTERPOLATION = (1U << 21);
+	static constexpr auto DITHER = (1U << 22);
+	static constexpr auto COLOUR_CORRECTION = (1U << 23);
+	static constexpr auto MAPPING = (1U << 24);
 };
 
 class WS28xxDmxParamsStore {
@@ -166,6 +176,14 @@ public:
 		return 0;
 	}
 
+	bool IsInterpolation() const {
+		return isMaskSet(WS28xxDmxParamsMask::INTERPOLATION);
+	}
+
+	bool IsDither() const {
+		return isMaskSet(WS28xxDmxParamsMask::DITHER);
+	}
+
 	uint8_t GetTestPattern() const {
 		return m_tWS28xxParams.nTestPattern;
 	}
@@ -0,0 +1,129 @@
+/**
+ * @file ws28xxdmxscheduler.h
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef WS28XXDMXSCHEDULER_H_
+#define WS28XXDMXSCHEDULER_H_
+
+#include <stdint.h>
+
+#include "ws28xx.h"
+
+namespace ws28xxdmxscheduler {
+static constexpr uint32_t RTZ_BIT_NANOS = 1250;		///< 800 kHz
+static constexpr uint32_t RTZ_RESET_MICROS = 300;	///< WS2813/WS2815 need > 280 us
+static constexpr uint32_t SPI_LATCH_MICROS = 500;	///< WS2801 latch
+}  // namespace ws28xxdmxscheduler
+
+/**
+ * Paces the pixel transmissions. The output encodes each received frame
+ * into its pixel buffer and calls Latch(); Run() tells when the next
+ * transmission may start. Frames that arrive faster than the output can
+ * clock them out are coalesced: only the newest is transmitted.
+ */
+class WS28xxDmxScheduler {
+public:
+	void SetFrameMicros(uint32_t nFrameMicros) {
+		m_nPeriodMicros = nFrameMicros == 0 ? 1 : nFrameMicros;
+	}
+
+	uint32_t GetFrameMicros() const {
+		return m_nPeriodMicros;
+	}
+
+	uint32_t GetMaxFps() const {
+		return 1000000U / m_nPeriodMicros;
+	}
+
+	void Latch() {
+		m_nLatched++;
+
+		if (m_bPending) {
+			m_nCoalesced++;
+		}
+
+		m_bPending = true;
+	}
+
+	/**
+	 * Request a transmission without a new frame, e.g. an interpolated one
+	 */
+	void Refresh() {
+		m_bPending = true;
+	}
+
+	/**
+	 * Drop the pending frame after the driver was written directly,
+	 * e.g. a blackout. The next transmission may start a period later.
+	 */
+	void Cancel(uint32_t nMicros) {
+		m_bPending = false;
+		m_nNextMicros = nMicros + m_nPeriodMicros;
+	}
+
+	bool IsPending() const {
+		return m_bPending;
+	}
+
+	/**
+	 * @return true when the pending frame must be transmitted now
+	 */
+	bool Run(uint32_t nMicros);
+
+	uint32_t GetFps() const {
+		return m_nFps;
+	}
+
+	uint32_t GetLatched() const {
+		return m_nLatched;
+	}
+
+	uint32_t GetTransmitted() const {
+		return m_nTransmitted;
+	}
+
+	uint32_t GetCoalesced() const {
+		return m_nCoalesced;
+	}
+
+	void Print();
+
+	/**
+	 * @param nBufSize the driver's GetBufSize(), bits for the RTZ types, bytes for SPI
+	 */
+	static uint32_t GetFrameMicros(ws28xx::Type tLedType, uint32_t nBufSize, uint32_t nClockSpeedHz);
+
+private:
+	uint32_t m_nPeriodMicros { 1 };
+	uint32_t m_nNextMicros { 0 };
+	uint32_t m_nSecondMicros { 0 };
+	uint32_t m_nFrames { 0 };
+	uint32_t m_nFps { 0 };
+	uint32_t m_nLatched { 0 };
+	uint32_t m_nTransmitted { 0 };
+	uint32_t m_nCoalesced { 0 };
+	bool m_bPending { false };
+};
+
+#endif /* WS28XXDMXSCHEDULER_H_ */
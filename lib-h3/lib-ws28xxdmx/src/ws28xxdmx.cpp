@@ -24,6 +24,7 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 #include <algorithm>
 #include <cassert>
 
@@ -38,6 +39,8 @@
 
 #include "lightset.h"
 
+#include "hardware.h"
+
 using namespace ws28xx;
 
 WS28xxDmx::WS28xxDmx() {
@@ -45,6 +48,12 @@ WS28xxDmx::WS28xxDmx() {
 }
 
 WS28xxDmx::~WS28xxDmx() {
+	delete m_pDither;
+	m_pDither = nullptr;
+
+	delete m_pInterpolator;
+	m_pInterpolator = nullptr;
+
 	delete m_pWS28xx;
 	m_pWS28xx = nullptr;
 }
@@ -60,12 +69,25 @@ void WS28xxDmx::Start(__attribute__((unused)) uint8_t nPort) {
 		m_pWS28xx = new WS28xx(m_tLedType, m_nLedCount, m_tRGBMapping, m_nLowCode, m_nHighCode, m_nClockSpeedHz);
 		assert(m_pWS28xx != nullptr);
 		m_pWS28xx->SetGlobalBrightness(m_nGlobalBrightness);
+		m_pWS28xx->SetColourCorrection(m_ColourCorrection.IsIdentity() ? nullptr : &m_ColourCorrection);
 		m_pWS28xx->Initialize();
+		m_Scheduler.SetFrameMicros(WS28xxDmxScheduler::GetFrameMicros(m_tLedType, m_pWS28xx->GetBufSize(), m_pWS28xx->GetClockSpeedHz()));
+
+		if (m_bScheduled && m_bInterpolation && (m_pInterpolator == nullptr)) {
+			m_pInterpolator = new WS28xxDmxInterpolator(m_nLedCount * m_nChannelsPerLed);
+			assert(m_pInterpolator != nullptr);
+
+			if (m_bDither) {
+				m_pDither = new WS28xxDmxDither(m_pInterpolator->GetSize());
+				assert(m_pDither != nullptr);
+			}
+		}
 	} else {
 		while (m_pWS28xx->IsUpdating()) {
 			// wait for completion
 		}
 		m_pWS28xx->Update();
+		m_Scheduler.Cancel(Hardware::Get()->Micros());
 	}
 
 	if (m_pLightSetHandler != nullptr) {
@@ -84,6 +106,12 @@ void WS28xxDmx::Stop(__attribute__((unused)) uint8_t nPort) {
 		while (m_pWS28xx->IsUpdating()) {
 			// wait for completion
 		}
+		m_Scheduler.Cancel(Hardware::Get()->Micros());
+
+		if (m_pInterpolator != nullptr) {
+			m_pInterpolator->Stop();
+		}
+
 		m_pWS28xx->Blackout();
 	}
 
@@ -93,6 +121,11 @@ void WS28xxDmx::Stop(__attribute__((unused)) uint8_t nPort) {
 }
 
 void WS28xxDmx::SetData(uint8_t nPortId, const uint8_t *pData, uint16_t nLength) {
+	m_nFullRefresh |= (1U << (nPortId & 0x03));
+	SetDataRange(nPortId, pData, nLength, 0, nLength);
+}
+
+void WS28xxDmx::SetDataRange(uint8_t nPortId, const uint8_t *pData, uint16_t nLength, uint16_t nFirst, uint16_t nEnd) {
 	assert(pData != nullptr);
 	assert(nLength <= DMX_UNIVERSE_SIZE);
 
@@ -101,6 +134,7 @@ void WS28xxDmx::SetData(uint8_t nPortId, const uint8_t *pData, uint16_t nLength)
 
 	if (__builtin_expect((m_pWS28xx == nullptr), 0)) {
 		m_bIsStarted = false;
+		m_nFullRefresh = 0xF;
 		Start();
 	}
 
@@ -135,28 +169,110 @@ void WS28xxDmx::SetData(uint8_t nPortId, const uint8_t *pData, uint16_t nLength)
 #endif
 #endif
 
-	while (m_pWS28xx->IsUpdating()) {
-		// wait for completion
+	if ((m_nFullRefresh & (1U << (nPortId & 0x03))) == 0) {
+		// Only re-encode the LEDs covering the changed slots
+		if ((nFirst >= nEnd) || (nEnd <= i)) {
+			endIndex = beginIndex;
+		} else {
+			const uint32_t nFirstLed = (std::max(static_cast<uint32_t>(nFirst), i) - i) / m_nChannelsPerLed;
+			const uint32_t nLastLed = (nEnd - 1U - i) / m_nChannelsPerLed;
+
+			endIndex = std::min(endIndex, beginIndex + nLastLed + 1);
+			beginIndex = beginIndex + nFirstLed;
+			i = i + nFirstLed * m_nChannelsPerLed;
+		}
 	}
 
-	for (uint32_t j = beginIndex; j < endIndex; j++) {
-		__builtin_prefetch(&pData[i]);
-		if (m_tLedType == Type::SK6812W) {
-			if (i + 3 > nLength) {
-				break;
-			}
-			m_pWS28xx->SetLED(j, pData[i], pData[i + 1], pData[i + 2], pData[i + 3]);
-			i = i + 4;
-		} else {
-			if (i + 2 > nLength) {
-				break;
-			}
-			m_pWS28xx->SetLED(j, pData[i], pData[i + 1], pData[i + 2]);
-			i = i + 3;
+	m_nFullRefresh &= ~(1U << (nPortId & 0x03));
+
+	if (m_pInterpolator != nullptr) {
+		// The LEDs are set from Run(), only collect the frame
+		if ((endIndex > beginIndex) && (nLength > i)) {
+			const auto nLeds = std::min(endIndex - beginIndex, (nLength - i) / m_nChannelsPerLed);
+			memcpy(m_pInterpolator->GetInput() + (beginIndex * m_nChannelsPerLed), &pData[i], nLeds * m_nChannelsPerLed);
+		}
+	} else {
+		while (m_pWS28xx->IsUpdating()) {
+			// wait for completion
 		}
+
+		SetLEDs(pData, nLength, i, beginIndex, endIndex);
 	}
 
 	if (nPortId == m_nPortIdLast) {
+		if (m_bInFrame) {
+			m_bFrameLastPort = true;
+		} else {
+			Transmit();
+		}
+	}
+}
+
+void WS28xxDmx::SetLEDs(const uint8_t *pData, uint32_t nLength, uint32_t i, uint32_t beginIndex, uint32_t endIndex) {
+	if ((endIndex <= beginIndex) || (nLength <= i)) {
+		return;
+	}
+
+	const auto nCount = std::min(endIndex - beginIndex, (nLength - i) / m_nChannelsPerLed);
+
+	m_pWS28xx->SetLEDs(beginIndex, &pData[i], nCount);
+}
+
+void WS28xxDmx::BeginFrame() {
+	m_bInFrame = true;
+	m_bFrameLastPort = false;
+}
+
+void WS28xxDmx::CommitFrame() {
+	m_bInFrame = false;
+
+	if (m_bFrameLastPort) {
+		Transmit();
+	}
+}
+
+void WS28xxDmx::Transmit() {
+	if (m_bScheduled) {
+		if (m_pInterpolator != nullptr) {
+			m_pInterpolator->Latch(Hardware::Get()->Micros());
+		}
+		m_Scheduler.Latch();
+		return;
+	}
+
+	if (m_bBlackout) {
+		return;
+	}
+
+	while (m_pWS28xx->IsUpdating()) {
+		// wait for completion
+	}
+
+	m_pWS28xx->Update();
+}
+
+void WS28xxDmx::Run() {
+	if (__builtin_expect((m_pWS28xx == nullptr), 0) || m_pWS28xx->IsUpdating()) {
+		return;
+	}
+
+	// Stopped or blacked out, the strip stays dark
+	if (!m_bIsStarted || m_bBlackout) {
+		return;
+	}
+
+	const auto nMicros = Hardware::Get()->Micros();
+
+	if ((m_pInterpolator != nullptr) && m_pInterpolator->IsActive()) {
+		m_Scheduler.Refresh();
+	}
+
+	if (m_Scheduler.Run(nMicros)) {
+		if (m_pInterpolator != nullptr) {
+			const auto nSize = m_pInterpolator->GetSize();
+			const auto *pData = (m_pDither != nullptr) ? m_pDither->Run(m_pInterpolator->Run16(nMicros)) : m_pInterpolator->Run(nMicros);
+			SetLEDs(pData, nSize, 0, 0, m_nLedCount);
+		}
 		m_pWS28xx->Update();
 	}
 }
@@ -181,6 +297,16 @@ void WS28xxDmx::SetLEDCount(uint16_t nCount) {
 	UpdateMembers();
 }
 
+void WS28xxDmx::SetColourCorrection(const struct TColourCorrectionParams *pParams) {
+	m_ColourCorrection.Set(pParams);
+
+	if (m_pWS28xx != nullptr) {
+		m_pWS28xx->SetColourCorrection(m_ColourCorrection.IsIdentity() ? nullptr : &m_ColourCorrection);
+	}
+
+	m_nFullRefresh = 0xF;
+}
+
 void WS28xxDmx::UpdateMembers() {
 	m_nDmxFootprint = m_nLedCount * m_nChannelsPerLed;
 
@@ -198,7 +324,13 @@ void WS28xxDmx::Blackout(bool bBlackout) {
 		// wait for completion
 	}
 
+	m_Scheduler.Cancel(Hardware::Get()->Micros());
+
 	if (bBlackout) {
+		if (m_pInterpolator != nullptr) {
+			m_pInterpolator->Stop();
+		}
+
 		m_pWS28xx->Blackout();
 	} else {
 		m_pWS28xx->Update();
@@ -214,6 +346,7 @@ bool WS28xxDmx::SetDmxStartAddress(uint16_t nDmxStartAddress) {
 
 	if ((nDmxStartAddress != 0) && (nDmxStartAddress <= DMX_UNIVERSE_SIZE)) {
 		m_nDmxStartAddress = nDmxStartAddress;
+		m_nFullRefresh = 0xF;
 
 		if (m_pWS28xxDmxStore != nullptr) {
 			m_pWS28xxDmxStore->SaveDmxStartAddress(m_nDmxStartAddress);
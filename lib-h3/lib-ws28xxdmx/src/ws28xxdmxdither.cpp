@@ -0,0 +1,61 @@
+/**
+ * @file ws28xxdmxdither.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <cassert>
+
+#include "ws28xxdmxdither.h"
+
+WS28xxDmxDither::WS28xxDmxDither(uint32_t nSize): m_nSize(nSize) {
+	m_pResidual = new uint8_t[nSize];
+	assert(m_pResidual != nullptr);
+	m_pOutput = new uint8_t[nSize];
+	assert(m_pOutput != nullptr);
+
+	memset(m_pResidual, 0, nSize);
+}
+
+WS28xxDmxDither::~WS28xxDmxDither() {
+	delete[] m_pOutput;
+	delete[] m_pResidual;
+}
+
+const uint8_t *WS28xxDmxDither::Run(const uint16_t *pInput) {
+	for (uint32_t i = 0; i < m_nSize; i++) {
+		const uint32_t nValue = static_cast<uint32_t>(pInput[i]) + m_pResidual[i];
+
+		if (__builtin_expect((nValue > 0xFFFF), 0)) {
+			m_pOutput[i] = 0xFF;
+			m_pResidual[i] = 0;
+			continue;
+		}
+
+		m_pOutput[i] = static_cast<uint8_t>(nValue >> 8);
+		m_pResidual[i] = static_cast<uint8_t>(nValue);
+	}
+
+	return m_pOutput;
+}
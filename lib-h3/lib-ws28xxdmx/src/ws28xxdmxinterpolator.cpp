@@ -0,0 +1,141 @@
+/**
+ * @file ws28xxdmxinterpolator.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <cassert>
+
+#include "ws28xxdmxinterpolator.h"
+
+using namespace ws28xxdmxinterpolator;
+
+/*
+ * out = (from * (256 - f) + to * f) / 256 for the 4 bytes of a word,
+ * done as two 16-bit lanes for the even and the odd bytes. The lane
+ * maximum is 255 * 256, so there is no carry into the next lane.
+ */
+static void lerp(uint32_t *pOut, const uint32_t *pFrom, const uint32_t *pTo, uint32_t nWords, uint32_t f) {
+	const uint32_t g = 256U - f;
+
+	for (uint32_t i = 0; i < nWords; i++) {
+		const uint32_t nFrom = pFrom[i];
+		const uint32_t nTo = pTo[i];
+
+		const uint32_t nEven = (((nFrom & 0x00FF00FF) * g + (nTo & 0x00FF00FF) * f) >> 8) & 0x00FF00FF;
+		const uint32_t nOdd = (((nFrom >> 8) & 0x00FF00FF) * g + ((nTo >> 8) & 0x00FF00FF) * f) & 0xFF00FF00;
+
+		pOut[i] = nEven | nOdd;
+	}
+}
+
+/*
+ * As lerp(), also storing the 16-bit lanes before the shift
+ */
+static void lerp16(uint32_t *pOut16, uint32_t *pOut, const uint32_t *pFrom, const uint32_t *pTo, uint32_t nWords, uint32_t f) {
+	const uint32_t g = 256U - f;
+
+	for (uint32_t i = 0; i < nWords; i++) {
+		const uint32_t nFrom = pFrom[i];
+		const uint32_t nTo = pTo[i];
+
+		const uint32_t nEven = (nFrom & 0x00FF00FF) * g + (nTo & 0x00FF00FF) * f;
+		const uint32_t nOdd = ((nFrom >> 8) & 0x00FF00FF) * g + ((nTo >> 8) & 0x00FF00FF) * f;
+
+		pOut16[2 * i] = (nEven & 0xFFFF) | (nOdd << 16);
+		pOut16[2 * i + 1] = (nEven >> 16) | (nOdd & 0xFFFF0000);
+
+		pOut[i] = ((nEven >> 8) & 0x00FF00FF) | (nOdd & 0xFF00FF00);
+	}
+}
+
+WS28xxDmxInterpolator::WS28xxDmxInterpolator(uint32_t nSize): m_nSize(nSize), m_nWords((nSize + 3) / 4) {
+	m_pInput = new uint32_t[m_nWords];
+	assert(m_pInput != nullptr);
+	m_pFrom = new uint32_t[m_nWords];
+	assert(m_pFrom != nullptr);
+	m_pTo = new uint32_t[m_nWords];
+	assert(m_pTo != nullptr);
+	m_pOutput = new uint32_t[m_nWords];
+	assert(m_pOutput != nullptr);
+
+	memset(m_pInput, 0, m_nWords * 4);
+	memset(m_pOutput, 0, m_nWords * 4);
+}
+
+WS28xxDmxInterpolator::~WS28xxDmxInterpolator() {
+	delete[] m_pOutput16;
+	delete[] m_pOutput;
+	delete[] m_pTo;
+	delete[] m_pFrom;
+	delete[] m_pInput;
+}
+
+void WS28xxDmxInterpolator::Latch(uint32_t nMicros) {
+	const auto nPeriodMicros = nMicros - m_nLatchMicros;
+	m_nLatchMicros = nMicros;
+
+	if (nPeriodMicros < MAX_INPUT_PERIOD_MICROS) {
+		m_nInputPeriodMicros = ((3 * m_nInputPeriodMicros) + nPeriodMicros) / 4;
+	}
+
+	// Start from what is on the LEDs now, so there is no jump
+	memcpy(m_pFrom, m_pOutput, m_nWords * 4);
+	memcpy(m_pTo, m_pInput, m_nWords * 4);
+
+	m_bActive = true;
+}
+
+const uint8_t *WS28xxDmxInterpolator::Run(uint32_t nMicros) {
+	const auto nElapsedMicros = nMicros - m_nLatchMicros;
+
+	if ((nElapsedMicros >= m_nInputPeriodMicros) || (m_nInputPeriodMicros == 0)) {
+		memcpy(m_pOutput, m_pTo, m_nWords * 4);
+		m_bActive = false;
+	} else {
+		const auto f = (nElapsedMicros * 256U) / m_nInputPeriodMicros;
+		lerp(m_pOutput, m_pFrom, m_pTo, m_nWords, f);
+	}
+
+	return reinterpret_cast<const uint8_t *>(m_pOutput);
+}
+
+const uint16_t *WS28xxDmxInterpolator::Run16(uint32_t nMicros) {
+	if (__builtin_expect((m_pOutput16 == nullptr), 0)) {
+		m_pOutput16 = new uint32_t[2 * m_nWords];
+		assert(m_pOutput16 != nullptr);
+	}
+
+	const auto nElapsedMicros = nMicros - m_nLatchMicros;
+
+	if ((nElapsedMicros >= m_nInputPeriodMicros) || (m_nInputPeriodMicros == 0)) {
+		lerp16(m_pOutput16, m_pOutput, m_pFrom, m_pTo, m_nWords, 256);
+		m_bActive = false;
+	} else {
+		const auto f = (nElapsedMicros * 256U) / m_nInputPeriodMicros;
+		lerp16(m_pOutput16, m_pOutput, m_pFrom, m_pTo, m_nWords, f);
+	}
+
+	return reinterpret_cast<const uint16_t *>(m_pOutput16);
+}
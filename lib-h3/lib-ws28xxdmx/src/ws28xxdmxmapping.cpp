@@ -0,0 +1,229 @@
+/**
+ * @file ws28xxdmxmapping.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <cassert>
+
+#include "ws28xxdmxmapping.h"
+
+#include "debug.h"
+
+using namespace ws28xxdmxmapping;
+
+WS28xxDmxMapping::WS28xxDmxMapping(uint32_t nOutputs, uint32_t nLedCount, uint32_t nChannelsPerLed) :
+	m_nOutputs(nOutputs), m_nLedCount(nLedCount), m_nPixels(nOutputs * nLedCount)
+{
+	DEBUG_ENTRY
+	assert(m_nPixels < UNMAPPED);
+
+	m_pTable = new uint16_t[m_nPixels];
+	assert(m_pTable != nullptr);
+
+	m_pInput = new uint8_t[m_nPixels * nChannelsPerLed];
+	assert(m_pInput != nullptr);
+
+	memset(m_pInput, 0, m_nPixels * nChannelsPerLed);
+	memset(&m_tMapping, 0, sizeof(struct TWS28xxDmxMapping));
+
+	for (uint32_t i = 0; i < m_nPixels; i++) {
+		m_pTable[i] = static_cast<uint16_t>(i);
+	}
+
+	DEBUG_PRINTF("m_nOutputs=%d, m_nLedCount=%d", m_nOutputs, m_nLedCount);
+	DEBUG_EXIT
+}
+
+WS28xxDmxMapping::~WS28xxDmxMapping() {
+	delete[] m_pInput;
+	m_pInput = nullptr;
+
+	delete[] m_pTable;
+	m_pTable = nullptr;
+}
+
+void WS28xxDmxMapping::Compile(const struct TWS28xxDmxMapping *ptMapping) {
+	DEBUG_ENTRY
+	assert(ptMapping != nullptr);
+
+	memcpy(&m_tMapping, ptMapping, sizeof(struct TWS28xxDmxMapping));
+
+	const uint32_t nPanelWidth = m_tMapping.nPanelWidth;
+
+	if (nPanelWidth == 0) {
+		for (uint32_t i = 0; i < m_nPixels; i++) {
+			m_pTable[i] = static_cast<uint16_t>(i);
+		}
+		m_nMapped = m_nPixels;
+		DEBUG_EXIT
+		return;
+	}
+
+	const uint32_t nPanelColumns = (m_tMapping.nPanelColumns == 0) ? 1 : m_tMapping.nPanelColumns;
+	const uint32_t nPanelRows = (m_tMapping.nPanelRows == 0) ? 1 : m_tMapping.nPanelRows;
+	uint32_t nPanelHeight = m_tMapping.nPanelHeight;
+
+	if (nPanelHeight == 0) {
+		nPanelHeight = m_nPixels / (nPanelWidth * nPanelColumns * nPanelRows);
+	}
+
+	const auto nPanelPixels = nPanelWidth * nPanelHeight;
+	const auto nPanels = nPanelColumns * nPanelRows;
+	const auto nWidth = nPanelWidth * nPanelColumns;
+	const auto nHeight = nPanelHeight * nPanelRows;
+	const auto nRotation = (m_tMapping.nFlags & flags::ROTATION_MASK) >> flags::ROTATION_SHIFT;
+	const auto isSerpentine = (m_tMapping.nFlags & flags::SERPENTINE) == flags::SERPENTINE;
+
+	m_nMapped = 0;
+
+	for (uint32_t nPixel = 0; nPixel < m_nPixels; nPixel++) {
+		const auto nPanel = (nPanelPixels == 0) ? nPanels : nPixel / nPanelPixels;
+
+		if (nPanel >= nPanels) {
+			m_pTable[nPixel] = UNMAPPED;
+			continue;
+		}
+
+		const auto nIndex = nPixel - (nPanel * nPanelPixels);
+		const auto nRow = nIndex / nPanelWidth;
+		auto nColumn = nIndex - (nRow * nPanelWidth);
+
+		if (isSerpentine && ((nRow & 1) == 1)) {
+			nColumn = nPanelWidth - 1 - nColumn;
+		}
+
+		const auto x = ((nPanel % nPanelColumns) * nPanelWidth) + nColumn;
+		const auto y = ((nPanel / nPanelColumns) * nPanelHeight) + nRow;
+
+		uint32_t nSource;
+
+		switch (nRotation) {
+		case 1:		// 90
+			nSource = ((nWidth - 1 - x) * nHeight) + y;
+			break;
+		case 2:		// 180
+			nSource = ((nHeight - 1 - y) * nWidth) + (nWidth - 1 - x);
+			break;
+		case 3:		// 270
+			nSource = (x * nHeight) + (nHeight - 1 - y);
+			break;
+		default:
+			nSource = (y * nWidth) + x;
+			break;
+		}
+
+		if (nSource < m_nPixels) {
+			m_pTable[nPixel] = static_cast<uint16_t>(nSource);
+			m_nMapped++;
+		} else {
+			m_pTable[nPixel] = UNMAPPED;
+		}
+	}
+
+	DEBUG_PRINTF("%dx%d, m_nMapped=%d", nWidth, nHeight, m_nMapped);
+	DEBUG_EXIT
+}
+
+/**
+ * The values are the DMX frame pixel index for the next physical pixel,
+ * separated by comma's or white space. Any other value leaves the pixel
+ * unmapped (off), a '#' starts a comment until the end of the line.
+ */
+bool WS28xxDmxMapping::LoadCsv(const char *pFileName) {
+	DEBUG_ENTRY
+	assert(pFileName != nullptr);
+
+	auto *fp = fopen(pFileName, "r");
+
+	if (fp == nullptr) {
+		DEBUG_EXIT
+		return false;
+	}
+
+	char aBuffer[128];
+	uint32_t nPixel = 0;
+	m_nMapped = 0;
+
+	while ((nPixel < m_nPixels) && (fgets(aBuffer, static_cast<int>(sizeof(aBuffer)), fp) == aBuffer)) {
+		const char *p = aBuffer;
+
+		while ((*p != '\0') && (*p != '#') && (nPixel < m_nPixels)) {
+			if ((*p == ',') || (*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n')) {
+				p++;
+				continue;
+			}
+
+			uint32_t nValue = 0;
+			bool isValid = true;
+
+			while ((*p != '\0') && (*p != ',') && (*p != ' ') && (*p != '\t') && (*p != '\r') && (*p != '\n') && (*p != '#')) {
+				if ((*p >= '0') && (*p <= '9') && (nValue < m_nPixels)) {
+					nValue = (nValue * 10) + static_cast<uint32_t>(*p - '0');
+				} else {
+					isValid = false;
+				}
+				p++;
+			}
+
+			if (isValid && (nValue < m_nPixels)) {
+				m_pTable[nPixel] = static_cast<uint16_t>(nValue);
+				m_nMapped++;
+			} else {
+				m_pTable[nPixel] = UNMAPPED;
+			}
+
+			nPixel++;
+		}
+	}
+
+	fclose(fp);
+
+	for (; nPixel < m_nPixels; nPixel++) {
+		m_pTable[nPixel] = UNMAPPED;
+	}
+
+	m_tMapping.nFlags |= flags::CSV;
+
+	DEBUG_PRINTF("m_nMapped=%d", m_nMapped);
+	DEBUG_EXIT
+	return true;
+}
+
+void WS28xxDmxMapping::Print() {
+	printf(" Mapping : ");
+
+	if (m_tMapping.nFlags & flags::CSV) {
+		printf("%s", CSV_FILE_NAME);
+	} else {
+		printf("%dx%d panels of %dx%d", m_tMapping.nPanelColumns, m_tMapping.nPanelRows, m_tMapping.nPanelWidth, m_tMapping.nPanelHeight);
+		if (m_tMapping.nFlags & flags::SERPENTINE) {
+			printf(", serpentine");
+		}
+		printf(", rotation %d", 90 * ((m_tMapping.nFlags & flags::ROTATION_MASK) >> flags::ROTATION_SHIFT));
+	}
+
+	printf(" [%d/%d]\n", m_nMapped, m_nPixels);
+}
@@ -25,6 +25,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <algorithm>
 #include <cassert>
 
@@ -35,6 +36,7 @@
 
 #include "rgbmapping.h"
 
+#include "hardware.h"
 #include "debug.h"
 
 using namespace ws28xxdmxmulti;
@@ -57,6 +59,15 @@ WS28xxDmxMulti::WS28xxDmxMulti() {
 }
 
 WS28xxDmxMulti::~WS28xxDmxMulti() {
+	delete m_pMapping;
+	m_pMapping = nullptr;
+
+	delete m_pDither;
+	m_pDither = nullptr;
+
+	delete m_pInterpolator;
+	m_pInterpolator = nullptr;
+
 	delete m_pLEDStripe;
 	m_pLEDStripe = nullptr;
 }
@@ -73,12 +84,39 @@ void WS28xxDmxMulti::Initialize() {
 	}
 
 	m_pLEDStripe->Blackout();
+
+	m_nFullRefresh = ~0U;
+
+	// All ports are clocked out in parallel, the frame time is that of one port
+	m_Scheduler.SetFrameMicros(WS28xxDmxScheduler::GetFrameMicros(m_tLedType, m_pLEDStripe->GetBufSize(), 0));
+	m_Scheduler.Cancel(Hardware::Get()->Micros());
 }
 
 void WS28xxDmxMulti::Start(uint8_t nPortId) {
 	DEBUG_PRINTF("%d", static_cast<int>(nPortId));
 
 	if (m_bIsStarted == 0) {
+		if (m_bScheduled && m_bInterpolation && (m_pInterpolator == nullptr)) {
+			m_pInterpolator = new WS28xxDmxInterpolator(m_nActiveOutputs * m_nLedCount * m_nChannelsPerLed);
+			assert(m_pInterpolator != nullptr);
+
+			if (m_bDither) {
+				m_pDither = new WS28xxDmxDither(m_pInterpolator->GetSize());
+				assert(m_pDither != nullptr);
+			}
+		}
+
+		if (m_bMapping && (m_pMapping == nullptr)) {
+			m_pMapping = new WS28xxDmxMapping(m_nActiveOutputs, m_nLedCount, m_nChannelsPerLed);
+			assert(m_pMapping != nullptr);
+
+			m_pMapping->Compile(&m_tMapping);
+
+			if (m_tMapping.nFlags & ws28xxdmxmapping::flags::CSV) {
+				m_pMapping->LoadCsv();
+			}
+		}
+
 		if (m_pLightSetHandler != nullptr) {
 			m_pLightSetHandler->Start();
 		}
@@ -95,6 +133,7 @@ void WS28xxDmxMulti::Stop(uint8_t nPortId) {
 	if (m_bIsStarted & (1U << nPortId)) {
 		SetData(nPortId, s_StopBuffer, sizeof(s_StopBuffer));
 		m_bIsStarted &= ~(1U << nPortId);
+		m_nFullRefresh |= (1U << nPortId);
 	}
 
 	if ((m_bIsStarted == 0) & (m_pLightSetHandler != nullptr)) {
@@ -103,6 +142,12 @@ void WS28xxDmxMulti::Stop(uint8_t nPortId) {
 }
 
 void WS28xxDmxMulti::SetData(uint8_t nPortId, const uint8_t* pData, uint16_t nLength) {
+	m_nFullRefresh |= (1U << nPortId);
+	SetDataRange(nPortId, pData, nLength, 0, nLength);
+}
+
+void WS28xxDmxMulti::SetDataRange(uint8_t nPortId, const uint8_t* pData, uint16_t nLength, uint16_t nFirst, uint16_t nEnd) {
+	assert(nPortId < 32);
 	assert(pData != nullptr);
 	assert(nLength <= DMX_UNIVERSE_SIZE);
 	assert(m_pLEDStripe != nullptr);
@@ -146,28 +191,165 @@ void WS28xxDmxMulti::SetData(uint8_t nPortId, const uint8_t* pData, uint16_t nLe
 			static_cast<int>(nSwitch), static_cast<int>(beginIndex), static_cast<int>(endIndex));
 #endif
 
-	while (m_pLEDStripe->IsUpdating()) {
-		// wait for completion
+	if ((m_nFullRefresh & (1U << nPortId)) == 0) {
+		// Only re-encode the LEDs covering the changed slots
+		if ((nFirst >= nEnd) || (nEnd <= i)) {
+			endIndex = beginIndex;
+		} else {
+			const uint32_t nFirstLed = (std::max(static_cast<uint32_t>(nFirst), i) - i) / m_nChannelsPerLed;
+			const uint32_t nLastLed = (nEnd - 1U - i) / m_nChannelsPerLed;
+
+			endIndex = std::min(endIndex, beginIndex + nLastLed + 1);
+			beginIndex = beginIndex + nFirstLed;
+			i = i + nFirstLed * m_nChannelsPerLed;
+		}
 	}
 
-	for (uint32_t j = beginIndex; j < endIndex; j++) {
-		__builtin_prefetch(&pData[i]);
-		if (m_tLedType == Type::SK6812W) {
-			if (i + 3 > nLength) {
-				break;
-			}
-			m_pLEDStripe->SetLED(nOutIndex, j, pData[i], pData[i + 1], pData[i + 2], pData[i + 3]);
-			i = i + 4;
+	m_nFullRefresh &= ~(1U << nPortId);
+
+	uint8_t *pFrame = nullptr;
+
+	if (m_pInterpolator != nullptr) {
+		pFrame = m_pInterpolator->GetInput();
+	} else if (m_pMapping != nullptr) {
+		pFrame = m_pMapping->GetInput();
+	}
+
+	if (pFrame != nullptr) {
+		// The LEDs are set from Transmit() or Run(), only collect the frame
+		if ((nOutIndex < m_nActiveOutputs) && (endIndex > beginIndex) && (nLength > i)) {
+			const auto nLeds = std::min(endIndex - beginIndex, (nLength - i) / m_nChannelsPerLed);
+			memcpy(pFrame + ((nOutIndex * m_nLedCount) + beginIndex) * m_nChannelsPerLed, &pData[i], nLeds * m_nChannelsPerLed);
+		}
+	} else {
+		while (m_pLEDStripe->IsUpdating()) {
+			// wait for completion
+		}
+
+		SetLEDs(nOutIndex, pData, nLength, i, beginIndex, endIndex);
+	}
+
+	if (nPortId == m_nPortIdLast) {
+		if (m_bInFrame) {
+			m_bFrameLastPort = true;
 		} else {
-			if (i + 2 > nLength) {
-				break;
+			Transmit();
+		}
+	}
+}
+
+void WS28xxDmxMulti::SetLEDs(uint32_t nOutIndex, const uint8_t *pData, uint32_t nLength, uint32_t i, uint32_t beginIndex, uint32_t endIndex) {
+	if ((endIndex <= beginIndex) || (nLength <= i)) {
+		return;
+	}
+
+	const auto nCount = std::min(endIndex - beginIndex, (nLength - i) / m_nChannelsPerLed);
+
+	m_pLEDStripe->SetLEDs(nOutIndex, beginIndex, &pData[i], nCount);
+}
+
+/**
+ * Gather, one table load per physical pixel
+ */
+void WS28xxDmxMulti::SetLEDsMapped(const uint8_t *pFrame) {
+	assert(m_pMapping != nullptr);
+
+	const auto *pTable = m_pMapping->GetTable();
+
+	for (uint32_t nOutIndex = 0; nOutIndex < m_nActiveOutputs; nOutIndex++) {
+		for (uint32_t j = 0; j < m_nLedCount; j++) {
+			const auto nSource = *pTable++;
+
+			if (__builtin_expect((nSource == ws28xxdmxmapping::UNMAPPED), 0)) {
+				if (m_tLedType == Type::SK6812W) {
+					m_pLEDStripe->SetLED(nOutIndex, j, 0, 0, 0, 0);
+				} else {
+					m_pLEDStripe->SetLED(nOutIndex, j, 0, 0, 0);
+				}
+				continue;
+			}
+
+			const auto *p = &pFrame[nSource * m_nChannelsPerLed];
+
+			if (m_tLedType == Type::SK6812W) {
+				m_pLEDStripe->SetLED(nOutIndex, j, p[0], p[1], p[2], p[3]);
+			} else {
+				m_pLEDStripe->SetLED(nOutIndex, j, p[0], p[1], p[2]);
 			}
-			m_pLEDStripe->SetLED(nOutIndex, j, pData[i], pData[i + 1], pData[i + 2]);
-			i = i + 3;
 		}
 	}
+}
 
-	if (nPortId == m_nPortIdLast) {
+void WS28xxDmxMulti::BeginFrame() {
+	m_bInFrame = true;
+	m_bFrameLastPort = false;
+}
+
+void WS28xxDmxMulti::CommitFrame() {
+	m_bInFrame = false;
+
+	if (m_bFrameLastPort) {
+		Transmit();
+	}
+}
+
+void WS28xxDmxMulti::Transmit() {
+	if ((m_pMapping != nullptr) && (m_pInterpolator == nullptr)) {
+		while (m_pLEDStripe->IsUpdating()) {
+			// wait for completion
+		}
+
+		SetLEDsMapped(m_pMapping->GetInput());
+	}
+
+	if (m_bScheduled) {
+		if (m_pInterpolator != nullptr) {
+			m_pInterpolator->Latch(Hardware::Get()->Micros());
+		}
+		m_Scheduler.Latch();
+		return;
+	}
+
+	if (m_bBlackout) {
+		return;
+	}
+
+	while (m_pLEDStripe->IsUpdating()) {
+		// wait for completion
+	}
+
+	m_pLEDStripe->Update();
+}
+
+void WS28xxDmxMulti::Run() {
+	if (__builtin_expect((m_pLEDStripe == nullptr), 0) || m_pLEDStripe->IsUpdating()) {
+		return;
+	}
+
+	// Blacked out, the strips stay dark. Stop() clears a port with a scheduled frame.
+	if (m_bBlackout) {
+		return;
+	}
+
+	const auto nMicros = Hardware::Get()->Micros();
+
+	if ((m_pInterpolator != nullptr) && m_pInterpolator->IsActive()) {
+		m_Scheduler.Refresh();
+	}
+
+	if (m_Scheduler.Run(nMicros)) {
+		if (m_pInterpolator != nullptr) {
+			const auto *pData = (m_pDither != nullptr) ? m_pDither->Run(m_pInterpolator->Run16(nMicros)) : m_pInterpolator->Run(nMicros);
+			if (m_pMapping != nullptr) {
+				SetLEDsMapped(pData);
+			} else {
+				const auto nSize = m_nLedCount * m_nChannelsPerLed;
+
+				for (uint32_t nOutIndex = 0; nOutIndex < m_nActiveOutputs; nOutIndex++) {
+					SetLEDs(nOutIndex, &pData[nOutIndex * nSize], nSize, 0, 0, m_nLedCount);
+				}
+			}
+		}
 		m_pLEDStripe->Update();
 	}
 }
@@ -179,7 +361,13 @@ void WS28xxDmxMulti::Blackout(bool bBlackout) {
 		// wait for completion
 	}
 
+	m_Scheduler.Cancel(Hardware::Get()->Micros());
+
 	if (bBlackout) {
+		if (m_pInterpolator != nullptr) {
+			m_pInterpolator->Stop();
+		}
+
 		m_pLEDStripe->Blackout();
 	} else {
 		m_pLEDStripe->Update();
@@ -226,6 +414,30 @@ void WS28xxDmxMulti::SetActivePorts(uint8_t nActiveOutputs) {
 	DEBUG_EXIT
 }
 
+void WS28xxDmxMulti::SetColourCorrection(const struct TColourCorrectionParams *pParams) {
+	assert(m_pLEDStripe != nullptr);
+
+	m_ColourCorrection.Set(pParams);
+	m_pLEDStripe->SetColourCorrection(m_ColourCorrection.IsIdentity() ? nullptr : &m_ColourCorrection);
+
+	m_nFullRefresh = ~0U;
+}
+
+void WS28xxDmxMulti::SetMapping(const struct TWS28xxDmxMapping *ptMapping) {
+	assert(ptMapping != nullptr);
+
+	memcpy(&m_tMapping, ptMapping, sizeof(struct TWS28xxDmxMapping));
+	m_bMapping = (m_tMapping.nPanelWidth != 0) || ((m_tMapping.nFlags & ws28xxdmxmapping::flags::CSV) != 0);
+
+	if (m_pMapping != nullptr) {
+		m_pMapping->Compile(&m_tMapping);
+
+		if (m_tMapping.nFlags & ws28xxdmxmapping::flags::CSV) {
+			m_pMapping->LoadCsv();
+		}
+	}
+}
+
 void WS28xxDmxMulti::UpdateMembers() {
 	m_nUniverses = 1 + (m_nLedCount / (1 + m_nBeginIndexPortId1));
 
@@ -252,6 +464,16 @@ void WS28xxDmxMulti::Print() {
 	if (m_pLEDStripe->GetBoard() == ws28xxmulti::Board::X4) {
 		printf("  SI5351A : %c\n", m_bUseSI5351A ? 'Y' : 'N');
 	}
+
+	m_ColourCorrection.Print();
+
+	if (m_pMapping != nullptr) {
+		m_pMapping->Print();
+	}
+
+	if (m_bScheduled) {
+		m_Scheduler.Print();
+	}
 }
 
 void WS28xxDmxMulti::SetTestPattern(pixelpatterns::Pattern TestPattern) {
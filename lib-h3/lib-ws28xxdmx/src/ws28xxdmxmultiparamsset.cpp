@@ -58,4 +58,15 @@ void WS28xxDmxParams::Set(WS28xxDmxMulti *pWS28xxDmxMulti) {
 	if (isMaskSet(WS28xxDmxParamsMask::USE_SI5351A)) {
 		pWS28xxDmxMulti->SetUseSI5351A(isMaskSet(WS28xxDmxParamsMask::USE_SI5351A));
 	}
+
+	pWS28xxDmxMulti->SetInterpolation(isMaskSet(WS28xxDmxParamsMask::INTERPOLATION));
+	pWS28xxDmxMulti->SetDither(isMaskSet(WS28xxDmxParamsMask::DITHER));
+
+	if (isMaskSet(WS28xxDmxParamsMask::COLOUR_CORRECTION)) {
+		pWS28xxDmxMulti->SetColourCorrection(&m_tWS28xxParams.tColourCorrection);
+	}
+
+	if (isMaskSet(WS28xxDmxParamsMask::MAPPING)) {
+		pWS28xxDmxMulti->SetMapping(&m_tWS28xxParams.tMapping);
+	}
 }
@@ -78,6 +78,8 @@ WS28xxDmxParams::WS28xxDmxParams(WS28xxDmxParamsStore *pWS28XXStripeParamsStore)
 		nStartUniverse += 4;
 	}
 	m_tWS28xxParams.nTestPattern = 0;
+	ColourCorrection::SetDefaults(&m_tWS28xxParams.tColourCorrection);
+	memset(&m_tWS28xxParams.tMapping, 0, sizeof(struct TWS28xxDmxMapping));
 }
 
 bool WS28xxDmxParams::Load() {
@@ -244,6 +246,82 @@ void WS28xxDmxParams::callbackFunction(const char *pLine) {
 		return;
 	}
 
+	if (Sscan::Uint8(pLine, DevicesParamsConst::LED_INTERPOLATION, nValue8) == Sscan::OK) {
+		if (nValue8 != 0) {
+			m_tWS28xxParams.nSetList |= WS28xxDmxParamsMask::INTERPOLATION;
+		} else {
+			m_tWS28xxParams.nSetList &= ~WS28xxDmxParamsMask::INTERPOLATION;
+		}
+		return;
+	}
+
+	auto& tMapping = m_tWS28xxParams.tMapping;
+
+	if (Sscan::Uint8(pLine, DevicesParamsConst::MAP_PANEL_WIDTH, nValue8) == Sscan::OK) {
+		tMapping.nPanelWidth = nValue8;
+		m_tWS28xxParams.nSetList |= WS28xxDmxParamsMask::MAPPING;
+		return;
+	}
+
+	if (Sscan::Uint8(pLine, DevicesParamsConst::MAP_PANEL_HEIGHT, nValue8) == Sscan::OK) {
+		tMapping.nPanelHeight = nValue8;
+		m_tWS28xxParams.nSetList |= WS28xxDmxParamsMask::MAPPING;
+		return;
+	}
+
+	if (Sscan::Uint8(pLine, DevicesParamsConst::MAP_PANEL_COLUMNS, nValue8) == Sscan::OK) {
+		tMapping.nPanelColumns = nValue8;
+		m_tWS28xxParams.nSetList |= WS28xxDmxParamsMask::MAPPING;
+		return;
+	}
+
+	if (Sscan::Uint8(pLine, DevicesParamsConst::MAP_PANEL_ROWS, nValue8) == Sscan::OK) {
+		tMapping.nPanelRows = nValue8;
+		m_tWS28xxParams.nSetList |= WS28xxDmxParamsMask::MAPPING;
+		return;
+	}
+
+	if (Sscan::Uint8(pLine, DevicesParamsConst::MAP_SERPENTINE, nValue8) == Sscan::OK) {
+		if (nValue8 != 0) {
+			tMapping.nFlags |= ws28xxdmxmapping::flags::SERPENTINE;
+		} else {
+			tMapping.nFlags &= static_cast<uint8_t>(~ws28xxdmxmapping::flags::SERPENTINE);
+		}
+		m_tWS28xxParams.nSetList |= WS28xxDmxParamsMask::MAPPING;
+		return;
+	}
+
+	if (Sscan::Uint16(pLine, DevicesParamsConst::MAP_ROTATION, nValue16) == Sscan::OK) {
+		tMapping.nFlags &= static_cast<uint8_t>(~ws28xxdmxmapping::flags::ROTATION_MASK);
+		tMapping.nFlags |= static_cast<uint8_t>(((nValue16 / 90U) & 3U) << ws28xxdmxmapping::flags::ROTATION_SHIFT);
+		m_tWS28xxParams.nSetList |= WS28xxDmxParamsMask::MAPPING;
+		return;
+	}
+
+	if (Sscan::Uint8(pLine, DevicesParamsConst::MAP_CSV, nValue8) == Sscan::OK) {
+		if (nValue8 != 0) {
+			tMapping.nFlags |= ws28xxdmxmapping::flags::CSV;
+		} else {
+			tMapping.nFlags &= static_cast<uint8_t>(~ws28xxdmxmapping::flags::CSV);
+		}
+		m_tWS28xxParams.nSetList |= WS28xxDmxParamsMask::MAPPING;
+		return;
+	}
+
+	if (ColourCorrection::Scan(pLine, &m_tWS28xxParams.tColourCorrection)) {
+		m_tWS28xxParams.nSetList |= WS28xxDmxParamsMask::COLOUR_CORRECTION;
+		return;
+	}
+
+	if (Sscan::Uint8(pLine, DevicesParamsConst::LED_DITHER, nValue8) == Sscan::OK) {
+		if (nValue8 != 0) {
+			m_tWS28xxParams.nSetList |= WS28xxDmxParamsMask::DITHER;
+		} else {
+			m_tWS28xxParams.nSetList &= ~WS28xxDmxParamsMask::DITHER;
+		}
+		return;
+	}
+
 	if (Sscan::Uint16(pLine, DevicesParamsConst::LED_GROUP_COUNT, nValue16) == Sscan::OK) {
 		if (nValue16 > 1 && nValue16 <= (4 * 170)) {
 			m_tWS28xxParams.nLedGroupCount = nValue16;
@@ -104,6 +104,29 @@ void WS28xxDmxParams::Dump() {
 		printf(" %s=%d\n", LightSetConst::PARAMS_DMX_START_ADDRESS, m_tWS28xxParams.nDmxStartAddress);
 	}
 
+	if(isMaskSet(WS28xxDmxParamsMask::INTERPOLATION)) {
+		printf(" %s=1 [Yes]\n", DevicesParamsConst::LED_INTERPOLATION);
+	}
+
+	if(isMaskSet(WS28xxDmxParamsMask::DITHER)) {
+		printf(" %s=1 [Yes]\n", DevicesParamsConst::LED_DITHER);
+	}
+
+	if (isMaskSet(WS28xxDmxParamsMask::COLOUR_CORRECTION)) {
+		ColourCorrection::Dump(&m_tWS28xxParams.tColourCorrection);
+	}
+
+	if (isMaskSet(WS28xxDmxParamsMask::MAPPING)) {
+		const auto& tMapping = m_tWS28xxParams.tMapping;
+		printf(" %s=%d\n", DevicesParamsConst::MAP_PANEL_WIDTH, tMapping.nPanelWidth);
+		printf(" %s=%d\n", DevicesParamsConst::MAP_PANEL_HEIGHT, tMapping.nPanelHeight);
+		printf(" %s=%d\n", DevicesParamsConst::MAP_PANEL_COLUMNS, tMapping.nPanelColumns);
+		printf(" %s=%d\n", DevicesParamsConst::MAP_PANEL_ROWS, tMapping.nPanelRows);
+		printf(" %s=%d\n", DevicesParamsConst::MAP_SERPENTINE, (tMapping.nFlags & ws28xxdmxmapping::flags::SERPENTINE) ? 1 : 0);
+		printf(" %s=%d\n", DevicesParamsConst::MAP_ROTATION, 90 * ((tMapping.nFlags & ws28xxdmxmapping::flags::ROTATION_MASK) >> ws28xxdmxmapping::flags::ROTATION_SHIFT));
+		printf(" %s=%d\n", DevicesParamsConst::MAP_CSV, (tMapping.nFlags & ws28xxdmxmapping::flags::CSV) ? 1 : 0);
+	}
+
 	if (isMaskSet(WS28xxDmxParamsMask::TEST_PATTERN)) {
 		printf(" %s=%d\n", LightSetConst::PARAMS_TEST_PATTERN, m_tWS28xxParams.nTestPattern);
 	}
@@ -108,6 +108,25 @@ void WS28xxDmxParams::Builder(const struct TWS28xxDmxParams *ptWS28xxParams, cha
 	builder.AddComment("4x only");
 	builder.Add(DevicesParamsConst::USE_SI5351A, isMaskSet(WS28xxDmxParamsMask::USE_SI5351A));
 
+	builder.AddComment("Frame interpolation and dithering");
+	builder.Add(DevicesParamsConst::LED_INTERPOLATION, isMaskSet(WS28xxDmxParamsMask::INTERPOLATION));
+	builder.Add(DevicesParamsConst::LED_DITHER, isMaskSet(WS28xxDmxParamsMask::DITHER));
+
+	const auto& tMapping = m_tWS28xxParams.tMapping;
+	const auto isMapping = isMaskSet(WS28xxDmxParamsMask::MAPPING);
+
+	builder.AddComment("Pixel mapping (multi)");
+	builder.Add(DevicesParamsConst::MAP_PANEL_WIDTH, tMapping.nPanelWidth, isMapping);
+	builder.Add(DevicesParamsConst::MAP_PANEL_HEIGHT, tMapping.nPanelHeight, isMapping);
+	builder.Add(DevicesParamsConst::MAP_PANEL_COLUMNS, tMapping.nPanelColumns, isMapping);
+	builder.Add(DevicesParamsConst::MAP_PANEL_ROWS, tMapping.nPanelRows, isMapping);
+	builder.Add(DevicesParamsConst::MAP_SERPENTINE, (tMapping.nFlags & ws28xxdmxmapping::flags::SERPENTINE) ? 1 : 0, isMapping);
+	builder.Add(DevicesParamsConst::MAP_ROTATION, 90 * ((tMapping.nFlags & ws28xxdmxmapping::flags::ROTATION_MASK) >> ws28xxdmxmapping::flags::ROTATION_SHIFT), isMapping);
+	builder.Add(DevicesParamsConst::MAP_CSV, (tMapping.nFlags & ws28xxdmxmapping::flags::CSV) ? 1 : 0, isMapping);
+
+	builder.AddComment("Colour correction");
+	ColourCorrection::Builder(builder, &m_tWS28xxParams.tColourCorrection, isMaskSet(WS28xxDmxParamsMask::COLOUR_CORRECTION));
+
 	builder.AddComment("Test pattern");
 	builder.Add(LightSetConst::PARAMS_TEST_PATTERN, m_tWS28xxParams.nTestPattern, isMaskSet(WS28xxDmxParamsMask::TEST_PATTERN));
 
@@ -62,4 +62,11 @@ void WS28xxDmxParams::Set(WS28xxDmx *pWS28xxDmx) {
 	if (isMaskSet(WS28xxDmxParamsMask::GLOBAL_BRIGHTNESS)) {
 		pWS28xxDmx->SetGlobalBrightness(m_tWS28xxParams.nGlobalBrightness);
 	}
+
+	pWS28xxDmx->SetInterpolation(isMaskSet(WS28xxDmxParamsMask::INTERPOLATION));
+	pWS28xxDmx->SetDither(isMaskSet(WS28xxDmxParamsMask::DITHER));
+
+	if (isMaskSet(WS28xxDmxParamsMask::COLOUR_CORRECTION)) {
+		pWS28xxDmx->SetColourCorrection(&m_tWS28xxParams.tColourCorrection);
+	}
 }
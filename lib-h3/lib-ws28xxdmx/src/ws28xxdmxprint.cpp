@@ -46,4 +46,10 @@ void WS28xxDmx::Print() {
 			printf(" GlbBr : %d\n", m_nGlobalBrightness);
 		}
 	}
+
+	m_ColourCorrection.Print();
+
+	if (m_bScheduled) {
+		m_Scheduler.Print();
+	}
 }
@@ -0,0 +1,86 @@
+/**
+ * @file ws28xxdmxscheduler.cpp
+ *
+ */
+/* Copyright (C) 2021 by Arjan van Vught mailto:info@orangepi-dmx.nl
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "ws28xxdmxscheduler.h"
+#include "ws28xx.h"
+
+using namespace ws28xx;
+using namespace ws28xxdmxscheduler;
+
+bool WS28xxDmxScheduler::Run(uint32_t nMicros) {
+	if ((nMicros - m_nSecondMicros) >= 1000000U) {
+		m_nSecondMicros = nMicros;
+		m_nFps = m_nFrames;
+		m_nFrames = 0;
+	}
+
+	if (!m_bPending) {
+		return false;
+	}
+
+	if (static_cast<int32_t>(nMicros - m_nNextMicros) < 0) {
+		return false;
+	}
+
+	m_nNextMicros += m_nPeriodMicros;
+
+	// Idle for more than a period, restart the cadence from now
+	if (static_cast<int32_t>(nMicros - m_nNextMicros) >= 0) {
+		m_nNextMicros = nMicros + m_nPeriodMicros;
+	}
+
+	m_bPending = false;
+	m_nFrames++;
+	m_nTransmitted++;
+
+	return true;
+}
+
+uint32_t WS28xxDmxScheduler::GetFrameMicros(Type tLedType, uint32_t nBufSize, uint32_t nClockSpeedHz) {
+	if ((tLedType == Type::WS2801) || (tLedType == Type::APA102) || (tLedType == Type::P9813)) {
+		if (nClockSpeedHz == 0) {
+			nClockSpeedHz = spi::speed::ws2801::default_hz;
+		}
+
+		const uint32_t nBits = nBufSize * 8;
+		const uint32_t nLatchMicros = (tLedType == Type::WS2801) ? SPI_LATCH_MICROS : 0;
+
+		return ((nBits * 1000U) / (nClockSpeedHz / 1000U)) + nLatchMicros;
+	}
+
+	return ((nBufSize * RTZ_BIT_NANOS) / 1000U) + RTZ_RESET_MICROS;
+}
+
+void WS28xxDmxScheduler::Print() {
+	printf("Frame scheduler\n");
+	printf(" Period      : %d us (%d fps max)\n", static_cast<int>(m_nPeriodMicros), static_cast<int>(GetMaxFps()));
+	printf(" Fps         : %d\n", static_cast<int>(m_nFps));
+	printf(" Latched     : %d\n", static_cast<int>(m_nLatched));
+	printf(" Transmitted : %d\n", static_cast<int>(m_nTransmitted));
+	printf(" Coalesced   : %d\n", static_cast<int>(m_nCoalesced));
+}
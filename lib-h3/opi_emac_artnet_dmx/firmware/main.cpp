@@ -219,7 +219,7 @@ void notmain(void) {
 
 	for (;;) {
 		hw.WatchdogFeed();
-		nw.Run();
+		nw.Poll();
 		node.Run();
 		remoteConfig.Run();
 		spiFlashStore.Flash();
@@ -189,7 +189,7 @@ void notmain(void) {
 
 	for (;;) {
 		hw.WatchdogFeed();
-		nw.Run();
+		nw.Poll();
 		node.Run();
 		remoteConfig.Run();
 		spiFlashStore.Flash();
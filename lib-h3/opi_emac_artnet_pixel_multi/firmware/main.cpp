@@ -119,6 +119,7 @@ void notmain(void) {
 	}
 
 	ws28xxDmxMulti.Initialize();
+	ws28xxDmxMulti.SetScheduled(true);
 	ws28xxDmxMulti.SetLightSetHandler(new WS28xxDmxStartSop);
 
 	const auto nActivePorts = ws28xxDmxMulti.GetActivePorts();
@@ -242,7 +243,7 @@ void notmain(void) {
 
 	for (;;) {
 		hw.WatchdogFeed();
-		nw.Run();
+		nw.Poll();
 		node.Run();
 		remoteConfig.Run();
 		llrpOnlyDevice.Run();
@@ -251,6 +252,8 @@ void notmain(void) {
 		display.Run();
 		if (__builtin_expect((bRunTestPattern), 0)) {
 			ws28xxDmxMulti.RunTestPattern();
+		} else {
+			ws28xxDmxMulti.Run();
 		}
 	}
 }
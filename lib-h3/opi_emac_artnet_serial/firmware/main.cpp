@@ -209,7 +209,7 @@ void notmain(void) {
 
 	for (;;) {
 		hw.WatchdogFeed();
-		nw.Run();
+		nw.Poll();
 		//
 		node.Run();
 		dmxSerial.Run();
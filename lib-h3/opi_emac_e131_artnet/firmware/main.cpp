@@ -217,7 +217,7 @@ void notmain(void) {
 
 	for (;;) {
 		hw.WatchdogFeed();
-		nw.Run();
+		nw.Poll();
 		//
 		bridge.Run();
 		controller.Run();
@@ -61,9 +61,14 @@
 #include "displayudfnetworkhandler.h"
 #include "displayhandler.h"
 
+#include "trace.h"
+
 extern "C" {
 
 void notmain(void) {
+#if defined (ENABLE_TRACE)
+	trace_init();
+#endif
 	Hardware hw;
 	NetworkH3emac nw;
 	LedBlink lb;
@@ -234,12 +239,15 @@ void notmain(void) {
 
 	for (;;) {
 		hw.WatchdogFeed();
-		nw.Run();
+		nw.Poll();
 		bridge.Run();
 		remoteConfig.Run();
 		spiFlashStore.Flash();
 		lb.Run();
 		display.Run();
+#if defined (ENABLE_TRACE)
+		trace_drain(4);
+#endif
 	}
 }
 
@@ -171,7 +171,7 @@ void notmain(void) {
 
 	for (;;) {
 		hw.WatchdogFeed();
-		nw.Run();
+		nw.Poll();
 		bridge.Run();
 		remoteConfig.Run();
 		spiFlashStore.Flash();
@@ -157,6 +157,7 @@ void notmain(void) {
 			pWS28xxDmx = new WS28xxDmx;
 			assert(pWS28xxDmx != nullptr);
 			ws28xxparms.Set(pWS28xxDmx);
+			pWS28xxDmx->SetScheduled(true);
 			pSpi = pWS28xxDmx;
 			display.Printf(7, "%s:%d", WS28xx::GetLedTypeString(pWS28xxDmx->GetLEDType()), pWS28xxDmx->GetLEDCount());
 
@@ -247,7 +248,7 @@ void notmain(void) {
 
 	for (;;) {
 		hw.WatchdogFeed();
-		nw.Run();
+		nw.Poll();
 		bridge.Run();
 		remoteConfig.Run();
 		spiFlashStore.Flash();
@@ -255,6 +256,8 @@ void notmain(void) {
 		display.Run();
 		if (__builtin_expect((bRunTestPattern), 0)) {
 			pWS28xxDmx->RunTestPattern();
+		} else if (pWS28xxDmx != nullptr) {
+			pWS28xxDmx->Run();
 		}
 	}
 }
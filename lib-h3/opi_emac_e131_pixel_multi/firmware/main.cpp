@@ -125,6 +125,7 @@ void notmain(void) {
 	}
 
 	ws28xxDmxMulti.Initialize();
+	ws28xxDmxMulti.SetScheduled(true);
 	ws28xxDmxMulti.SetLightSetHandler(new WS28xxDmxStartSop);
 
 	bridge.SetDirectUpdate(true);
@@ -229,7 +230,7 @@ void notmain(void) {
 
 	for (;;) {
 		hw.WatchdogFeed();
-		nw.Run();
+		nw.Poll();
 		bridge.Run();
 		remoteConfig.Run();
 		llrpOnlyDevice.Run();
@@ -238,6 +239,8 @@ void notmain(void) {
 		display.Run();
 		if (__builtin_expect((bRunTestPattern), 0)) {
 			ws28xxDmxMulti.RunTestPattern();
+		} else {
+			ws28xxDmxMulti.Run();
 		}
 	}
 }
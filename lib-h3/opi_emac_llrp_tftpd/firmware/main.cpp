@@ -135,7 +135,7 @@ void notmain(void) {
 	lb.SetMode(ledblink::Mode::NORMAL);
 
 	for (;;) {
-		nw.Run();
+		nw.Poll();
 		mDns.Run();
 		device.Run();
 		remoteConfig.Run();
@@ -200,7 +200,7 @@ void notmain(void) {
 
 	if (sourceSelect.Check() && !IsAutoStart) {
 		while (sourceSelect.Wait(ltcSource, tStartTimeCode, tStopTimeCode)) {
-			nw.Run();
+			nw.Poll();
 			lb.Run();
 		}
 	}
@@ -489,7 +489,7 @@ void notmain(void) {
 
 	for (;;) {
 		hw.WatchdogFeed();
-		nw.Run();
+		nw.Poll();
 
 		// Run the reader
 		switch (ltcSource) {
@@ -159,7 +159,7 @@ void notmain(void) {
 
 	for (;;) {
 		hw.WatchdogFeed();
-		nw.Run();
+		nw.Poll();
 		client.Run();
 		pButtonsSet->Run();
 		remoteConfig.Run();
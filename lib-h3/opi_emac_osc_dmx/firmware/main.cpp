@@ -151,7 +151,7 @@ void notmain(void) {
 
 	for (;;) {
 		hw.WatchdogFeed();
-		nw.Run();
+		nw.Poll();
 		server.Run();
 		remoteConfig.Run();
 		spiFlashStore.Flash();
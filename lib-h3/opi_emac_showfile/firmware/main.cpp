@@ -198,7 +198,7 @@ void notmain(void) {
 
 	for (;;) {
 		hw.WatchdogFeed();
-		nw.Run();
+		nw.Poll();
 		//
 		pShowFile->Run();
 		pShowFileProtocolHandler->Run();
@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+#
+# Decode a binary dump of the lib-debug trace rings (trace_get_rings())
+# with the format strings from the trace_fmt section of the firmware ELF.
+#
+# Usage: trace_decode.py <firmware.elf> <dump.bin>
+#
+
+import re
+import struct
+import sys
+
+TRACE_MAGIC = 0x43525454
+RING_HEADER = '<8I'
+FORMAT_SPEC = re.compile(r'%[-+ #0]*\d*(?:\.\d+)?(?:hh|h|ll|l|z|t|j)?([diouxXc%])')
+
+
+def trace_fmt_section(path):
+    with open(path, 'rb') as f:
+        elf = f.read()
+    if elf[:4] != b'\x7fELF':
+        sys.exit('%s: not an ELF file' % path)
+    is64 = elf[4] == 2
+    if is64:
+        shoff, = struct.unpack_from('<Q', elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from('<HHH', elf, 0x3A)
+        sh = '<IIQQQQIIQQ'
+    else:
+        shoff, = struct.unpack_from('<I', elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from('<HHH', elf, 0x2E)
+        sh = '<IIIIIIIIII'
+    sections = [struct.unpack_from(sh, elf, shoff + i * shentsize) for i in range(shnum)]
+    strtab = sections[shstrndx]
+    for s in sections:
+        name = elf[strtab[4] + s[0]:].split(b'\0', 1)[0]
+        if name == b'trace_fmt':
+            return elf[s[4]:s[4] + s[5]]
+    sys.exit('%s: no trace_fmt section' % path)
+
+
+def c_format(fmt, args):
+    values = iter(args)
+
+    def convert(m):
+        if m.group(1) == '%':
+            return '%'
+        value = next(values, 0)
+        spec = re.sub(r'(hh|h|ll|l|z|t|j)', '', m.group(0))
+        if m.group(1) in 'di' and value & 0x80000000:
+            value -= 1 << 32
+        if m.group(1) == 'c':
+            return chr(value & 0xFF)
+        return spec.replace('i', 'd').replace('u', 'd') % value
+
+    return FORMAT_SPEC.sub(convert, fmt)
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit('Usage: trace_decode.py <firmware.elf> <dump.bin>')
+
+    formats = trace_fmt_section(sys.argv[1])
+
+    with open(sys.argv[2], 'rb') as f:
+        dump = f.read()
+
+    records = []
+    offset = 0
+
+    while offset + struct.calcsize(RING_HEADER) <= len(dump):
+        magic, core, entries, entry_size, head, _, dropped, _ = struct.unpack_from(RING_HEADER, dump, offset)
+        if magic != TRACE_MAGIC:
+            sys.exit('offset %d: bad magic 0x%08x' % (offset, magic))
+        base = offset + struct.calcsize(RING_HEADER)
+        nargs_max = entry_size // 4 - 3
+        for i in range(entries):
+            fields = struct.unpack_from('<%dI' % (entry_size // 4), dump, base + i * entry_size)
+            sequence, format_, micros = fields[:3]
+            if sequence == 0 or sequence > head or head - sequence >= entries:
+                continue
+            nargs = min(format_ >> 24, nargs_max)
+            fmt = formats[format_ & 0xFFFFFF:].split(b'\0', 1)[0].decode('latin-1')
+            records.append((micros, core, sequence, c_format(fmt, fields[3:3 + nargs])))
+        if dropped:
+            print('core %d: %d entries dropped' % (core, dropped), file=sys.stderr)
+        offset = base + entries * entry_size
+
+    for micros, core, _, text in sorted(records):
+        print('%u.%06u %u %s' % (micros // 1000000, micros % 1000000, core, text))
+
+
+if __name__ == '__main__':
+    main()
@@ -1,13 +1,279 @@
 #include <stdint.h>
 
-#include <arm/synchronize.h>
 #include "mmu.h"
+
+#if defined(__linux__)
+// Host build for testing the page table code: the table is an array, cache
+// maintenance does nothing and the test provides the TLB and barrier hooks.
+uint32_t mmu_host_table[MMU_TABLE_ENTRIES];
+
+void mmu_host_tlbimvais(uint32_t mva);
+void mmu_host_dsb(void);
+
+#define MMU_TABLE mmu_host_table
+
+static inline void mmu_tlbimvais(uint32_t mva)
+{
+  mmu_host_tlbimvais(mva);
+}
+
+static inline void mmu_barrier(void)
+{
+  mmu_host_dsb();
+}
+
+static inline void mmu_invalidate_bp(void)
+{
+}
+
+static inline uint32_t mmu_irq_save(void)
+{
+  return 0;
+}
+
+static inline void mmu_irq_restore(uint32_t cpsr)
+{
+  (void)cpsr;
+}
+
+void mmu_clean_dcache_range(const void *start, uint32_t size)
+{
+  (void)start;
+  (void)size;
+}
+
+void mmu_flush_dcache_range(const void *start, uint32_t size)
+{
+  (void)start;
+  (void)size;
+}
+#else
+#include <arm/synchronize.h>
+#include "smp.h"
 #include "uart.h"
 
+#define MMU_TABLE ((uint32_t *)MMU_TABLE_BASE)
+
+// TLBIMVAIS reaches the other cores, too.
+static inline void mmu_tlbimvais(uint32_t mva)
+{
+  asm volatile("mcr p15, 0, %0, c8, c3, 1" : : "r"(mva & ~0xfff) : "memory");
+}
+
+static inline void mmu_barrier(void)
+{
+  asm volatile("dsb; isb" : : : "memory");
+}
+
+// BPIALLIS
+static inline void mmu_invalidate_bp(void)
+{
+  asm volatile("mcr p15, 0, %0, c7, c1, 6; dsb; isb" : : "r"(0) : "memory");
+}
+
+static inline uint32_t mmu_irq_save(void)
+{
+  uint32_t cpsr;
+  asm volatile("mrs %0, cpsr; cpsid if" : "=r"(cpsr) : : "memory");
+  return cpsr;
+}
+
+static inline void mmu_irq_restore(uint32_t cpsr)
+{
+  asm volatile("msr cpsr_c, %0" : : "r"(cpsr) : "memory");
+}
+#endif
+
 #define DRAM_START 0x40000000
 #define DRAM_MAX   0xc0000000
 #define DRAM_STEP  0x02000000
 
+#define SECTION          2
+#define SECTION_SUPER    (1 << 18)
+#define SECTION_AP_RW    (3 << 10)
+#define SECTION_ATTRS    0x000fffff
+
+// Everything not listed is strongly ordered.
+static const struct mmu_region mmu_default_regions[] = {
+  // SRAM.
+  { 0x00000000, MMU_SECTION_SIZE, MMU_WRITE_BACK },
+  // Code, data and BSS.
+  { DRAM_START, 0x01000000, MMU_WRITE_BACK },
+  // UNCACHED section: DMA descriptors and such.
+  { 0x41000000, 0x01000000, MMU_WRITE_COMBINE },
+  // Heap and the rest of DRAM.
+  { 0x42000000, DRAM_MAX - 0x42000000, MMU_WRITE_BACK },
+};
+
+static uint32_t mmu_section_attrs(enum mmu_attr attr)
+{
+  switch (attr) {
+    case MMU_DEVICE:
+      // TEX 000, C 0, B 1
+      return SECTION_AP_RW | (1 << 2) | SECTION;
+    case MMU_WRITE_COMBINE:
+      // Shareable, TEX 001, C 0, B 0
+      return (1 << 16) | (1 << 12) | SECTION_AP_RW | SECTION;
+    case MMU_WRITE_THROUGH:
+      // Shareable, TEX 000, C 1, B 0
+      return (1 << 16) | SECTION_AP_RW | (2 << 2) | SECTION;
+    case MMU_WRITE_BACK:
+      // Shareable, TEX 001, C 1, B 1
+      return (1 << 16) | (1 << 12) | SECTION_AP_RW | (3 << 2) | SECTION;
+    case MMU_STRONGLY_ORDERED:
+    default:
+      // TEX 000, C 0, B 0
+      return SECTION_AP_RW | SECTION;
+  }
+}
+
+// Turns a supersection group back into 16 sections.
+static void mmu_split_group(uint32_t *group, uint32_t g)
+{
+  uint32_t desc = group[0];
+  if (!(desc & SECTION_SUPER))
+    return;
+
+  desc &= SECTION_ATTRS & ~SECTION_SUPER;
+  for (uint32_t i = 0; i < 16; i++)
+    group[i] = ((g * 16 + i) << 20) | desc;
+}
+
+// Turns a group of 16 sections that map the same attributes into a
+// supersection. Returns 1 if the group is a supersection.
+static int mmu_merge_group(uint32_t *group, uint32_t g)
+{
+  uint32_t desc = group[0];
+  if (desc & SECTION_SUPER)
+    return 1;
+
+  uint32_t attrs = desc & SECTION_ATTRS;
+  for (uint32_t i = 0; i < 16; i++) {
+    if (group[i] != (((g * 16 + i) << 20) | attrs))
+      return 0;
+  }
+
+  // The descriptor is replicated into all 16 entries.
+  for (uint32_t i = 0; i < 16; i++)
+    group[i] = (g << 24) | SECTION_SUPER | attrs;
+  return 1;
+}
+
+static void mmu_map_sections(uint32_t *table, uint32_t first, uint32_t count,
+                             enum mmu_attr attr)
+{
+  uint32_t attrs = mmu_section_attrs(attr);
+
+  for (uint32_t g = first / 16; g <= (first + count - 1) / 16; g++)
+    mmu_split_group(&table[g * 16], g);
+  for (uint32_t n = first; n < first + count; n++)
+    table[n] = (n << 20) | attrs;
+}
+
+static int mmu_region_valid(uint32_t start, uint32_t size)
+{
+  return size != 0 && ((start | size) & (MMU_SECTION_SIZE - 1)) == 0 &&
+         (start >> 20) + (size >> 20) <= MMU_TABLE_ENTRIES;
+}
+
+int mmu_build_table(uint32_t *table, const struct mmu_region *regions,
+                    int count)
+{
+  for (int i = 0; i < count; i++) {
+    if (!mmu_region_valid(regions[i].start, regions[i].size))
+      return -1;
+  }
+
+  for (uint32_t n = 0; n < MMU_TABLE_ENTRIES; n++)
+    table[n] = (n << 20) | mmu_section_attrs(MMU_STRONGLY_ORDERED);
+
+  for (int i = 0; i < count; i++) {
+    mmu_map_sections(table, regions[i].start >> 20, regions[i].size >> 20,
+                     regions[i].attr);
+  }
+
+  int supersections = 0;
+  for (uint32_t g = 0; g < MMU_TABLE_ENTRIES / 16; g++)
+    supersections += mmu_merge_group(&table[g * 16], g);
+
+  return supersections;
+}
+
+// Writes new descriptors into a live group, break-before-make: the entries
+// that change are made invalid and dropped from the TLBs of all cores before
+// the new ones are written. Splitting or merging a supersection changes all
+// 16 entries.
+static void mmu_replace_group(uint32_t *group, const uint32_t *next, uint32_t g)
+{
+  uint32_t changed = 0;
+  uint32_t cpsr    = mmu_irq_save();
+
+  for (uint32_t i = 0; i < 16; i++) {
+    if (group[i] != next[i]) {
+      group[i] = 0;
+      changed |= 1u << i;
+    }
+  }
+
+  if (changed) {
+    // Table walks do not look into the D-cache.
+    mmu_clean_dcache_range(group, 16 * sizeof(uint32_t));
+    for (uint32_t i = 0; i < 16; i++) {
+      if (changed & (1u << i))
+        mmu_tlbimvais((g * 16 + i) << 20);
+    }
+    mmu_barrier();
+
+    for (uint32_t i = 0; i < 16; i++)
+      group[i] = next[i];
+    mmu_clean_dcache_range(group, 16 * sizeof(uint32_t));
+    mmu_barrier();
+  }
+
+  mmu_irq_restore(cpsr);
+}
+
+int mmu_set_region(void *start, uint32_t size, enum mmu_attr attr)
+{
+  uint32_t *table = MMU_TABLE;
+  uint32_t first  = (uint32_t)(uintptr_t)start >> 20;
+  uint32_t last   = first + (size >> 20) - 1;
+  uint32_t attrs  = mmu_section_attrs(attr);
+
+  if (!mmu_region_valid((uint32_t)(uintptr_t)start, size))
+    return -1;
+
+  mmu_flush_dcache_range(start, size);
+
+  for (uint32_t g = first / 16; g <= last / 16; g++) {
+    uint32_t next[16];
+
+    for (uint32_t i = 0; i < 16; i++)
+      next[i] = table[g * 16 + i];
+    mmu_split_group(next, g);
+    for (uint32_t n = g * 16; n < g * 16 + 16; n++) {
+      if (n >= first && n <= last)
+        next[n - g * 16] = (n << 20) | attrs;
+    }
+    mmu_merge_group(next, g);
+
+    mmu_replace_group(&table[g * 16], next, g);
+  }
+  mmu_invalidate_bp();
+
+  // Drop lines that were speculatively refilled under the old attributes.
+  mmu_flush_dcache_range(start, size);
+
+  return 0;
+}
+
+#if defined(__linux__)
+void mmu_init(void)
+{
+  mmu_build_table(MMU_TABLE, mmu_default_regions,
+                  sizeof(mmu_default_regions) / sizeof(mmu_default_regions[0]));
+}
+#else
 void *mmu_detect_dram_end(void)
 {
   volatile uint32_t *dram_start = (uint32_t *)DRAM_START;
@@ -38,7 +304,50 @@ void *mmu_detect_dram_end(void)
   return (void *)dram_end;
 }
 
-void mmu_init()
+static uint32_t mmu_dcache_line_size(void)
+{
+  uint32_t ctr;
+  asm volatile("mrc p15, 0, %0, c0, c0, 1" : "=r"(ctr));
+  return 4 << ((ctr >> 16) & 0xf);
+}
+
+void mmu_clean_dcache_range(const void *start, uint32_t size)
+{
+  uint32_t line = mmu_dcache_line_size();
+  uint32_t end  = (uint32_t)start + size;
+
+  for (uint32_t addr = (uint32_t)start & ~(line - 1); addr < end; addr += line)
+    asm volatile("mcr p15, 0, %0, c7, c10, 1" : : "r"(addr) : "memory");
+  asm volatile("dsb" : : : "memory");
+}
+
+void mmu_flush_dcache_range(const void *start, uint32_t size)
+{
+  uint32_t line = mmu_dcache_line_size();
+  uint32_t end  = (uint32_t)start + size;
+
+  for (uint32_t addr = (uint32_t)start & ~(line - 1); addr < end; addr += line)
+    asm volatile("mcr p15, 0, %0, c7, c14, 1" : : "r"(addr) : "memory");
+  asm volatile("dsb" : : : "memory");
+}
+
+void mmu_invalidate_dcache_range(void *start, uint32_t size)
+{
+  uint32_t line = mmu_dcache_line_size();
+  uint32_t addr = (uint32_t)start & ~(line - 1);
+  uint32_t end  = (uint32_t)start + size;
+
+  for (; addr < end; addr += line) {
+    // Lines only partially covered may hold unrelated dirty data.
+    if (addr < (uint32_t)start || addr + line > end)
+      asm volatile("mcr p15, 0, %0, c7, c14, 1" : : "r"(addr) : "memory");
+    else
+      asm volatile("mcr p15, 0, %0, c7, c6, 1" : : "r"(addr) : "memory");
+  }
+  asm volatile("dsb" : : : "memory");
+}
+
+void mmu_init(void)
 {
   // Disable MMU
   asm("ldr r8, =0x0;    mcr p15, 0, r8, c1, c0, 0;" : : : "r8");
@@ -50,29 +359,15 @@ void mmu_init()
     "mcr p15, 0, r8, c1, c0, 1;" ::
       : "r8");
 
-  // Populate the pagetable
-  volatile uint32_t *pagetable = (volatile uint32_t *)0xc000;
-  for (uint32_t n = 0; n < 0x1000; n++) {
-    if (n == 0) {
-      // SRAM.  Write back.
-      pagetable[n] = (n << 20) | (1 << 16) | (1 << 12) | (3 << 10) | (3 << 2) | 2;
-    } else if (n >= 0x400 && n < 0x410) {
-      // First half of DRAM. Write back.
-      pagetable[n] = (n << 20) | (1 << 16) | (1 << 12) | (3 << 10) | (3 << 2) | 2;
-    } else if (n >= 0x410 && n < 0x420) {
-      // DMA buffers and such. Normal uncached.
-      pagetable[n] = (n << 20) | (1 << 16) | (1 << 12) | (3 << 10) | (0 << 2) | 2;
-    } else if (n >= 0x420 && n < 0xc00) {
-      // Second half of DRAM. Write back.
-      pagetable[n] = (n << 20) | (1 << 16) | (1 << 12) | (3 << 10) | (3 << 2) | 2;
-    } else {
-      // Other stuff. Strictly ordered for safety.
-      pagetable[n] = (n << 20) | (0 << 12) | (3 << 10) | (0 << 2) | 2;
-    }
-  }
+  // Populate the pagetable. Secondary cores come up while core 0 is running
+  // on the live table, possibly with regions changed by mmu_set_region(),
+  // so they only switch it on.
+  if (smp_get_core_id() == 0)
+    mmu_build_table((uint32_t *)MMU_TABLE_BASE, mmu_default_regions,
+                    sizeof(mmu_default_regions) / sizeof(mmu_default_regions[0]));
 
   // Set up the pagetable
-  asm("ldr r8, =0xc000; mcr p15, 0, r8, c2, c0, 0" : : : "r8");
+  asm volatile("ldr r8, =0xc000; mcr p15, 0, r8, c2, c0, 0" : : : "r8", "memory");
   asm("ldr r8, =0x0;    mcr p15, 0, r8, c2, c0, 2" : : : "r8");
   asm("ldr r8, =0x3;    mcr p15, 0, r8, c3, c0, 0" : : : "r8");
 
@@ -98,3 +393,4 @@ void mmu_init()
     :
     : "r8");
 }
+#endif
@@ -2,10 +2,55 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+
+#define MMU_TABLE_BASE        0xc000
+#define MMU_TABLE_ENTRIES     4096
+#define MMU_SECTION_SIZE      0x00100000
+#define MMU_SUPERSECTION_SIZE 0x01000000
+
+// Memory types, in terms of the ARMv7 short-descriptor TEX/C/B encoding
+// (TEX remap disabled).
+enum mmu_attr {
+  MMU_STRONGLY_ORDERED,  // peripherals and unmapped space
+  MMU_DEVICE,            // shareable device, posted writes
+  MMU_WRITE_COMBINE,     // normal non-cacheable: framebuffers, DMA buffers
+  MMU_WRITE_THROUGH,     // normal, inner/outer write-through
+  MMU_WRITE_BACK,        // normal, write-back write-allocate: code, heap
+};
+
+// A flat-mapped region; start and size must be multiples of 1 MiB.
+struct mmu_region {
+  uint32_t start;
+  uint32_t size;
+  enum mmu_attr attr;
+};
+
 void mmu_init(void);
 void mmu_flush_dcache(void);
 void *mmu_detect_dram_end(void);
 
+// Fills a 4096-entry first-level table. Everything not covered by a region
+// is strongly ordered; later regions override earlier ones. Aligned 16 MiB
+// runs with identical attributes become supersections. Returns the number of
+// supersections, or -1 if a region is not section-aligned.
+int mmu_build_table(uint32_t *table, const struct mmu_region *regions,
+                    int count);
+
+// Changes the attributes of a live mapping. The range must be section-aligned
+// and not share sections with unrelated data; its cache lines are cleaned and
+// invalidated first. The descriptors are replaced break-before-make, so when
+// a supersection is split or merged its whole 16 MiB is unmapped for a
+// moment: no code, stack or data used meanwhile by other cores may live there.
+int mmu_set_region(void *start, uint32_t size, enum mmu_attr attr);
+
+// D-cache maintenance by address, to the point of coherency. Use these
+// before handing a buffer to DMA or the display engine (clean or flush) and
+// before reading a buffer a device has written (invalidate).
+void mmu_clean_dcache_range(const void *start, uint32_t size);
+void mmu_flush_dcache_range(const void *start, uint32_t size);
+void mmu_invalidate_dcache_range(void *start, uint32_t size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -5,6 +5,7 @@
 #include "lwip/netif.h"
 #include "lwip/etharp.h"
 #include "lwip/timeouts.h"
+#include "lwip/memp.h"
 
 #include "ccu.h"
 #include "network.h"
@@ -15,37 +16,79 @@
 
 #include <string.h>
 
-extern void emac_eth_send(void*, int);
+extern uint8_t *emac_eth_send_get_dma_buffer(void);
+extern void emac_eth_send_now(int);
 extern int emac_eth_recv(uint8_t **);
 extern void emac_free_pkt(void);
+extern uint8_t *emac_eth_hold_pkt(void);
+extern void emac_eth_release_pkt(uint8_t *);
 
 // used by the lib-h3 EMAC driver
 uint8_t libh3_coherent_region[1048576]  __attribute__ ((section ("UNCACHED")));
 
+// Received frames are passed to lwIP in place, wrapped in a PBUF_REF that
+// owns the EMAC RX buffer until it is freed. The EMAC swaps a spare buffer
+// into the descriptor, so the RX ring keeps running while frames are held.
+// When lwIP keeps more frames than there are spares (queued TCP segments,
+// IP reassembly), we fall back to copying into a PBUF_POOL pbuf.
+#define RX_ZERO_COPY_MAX 24
+
+struct rx_pbuf {
+  struct pbuf_custom p;
+  uint8_t *buffer;
+};
+
+LWIP_MEMPOOL_DECLARE(RX_POOL, RX_ZERO_COPY_MAX, sizeof(struct rx_pbuf), "Zero-copy RX");
+
+static void rx_pbuf_free(struct pbuf *p)
+{
+  struct rx_pbuf *rx = (struct rx_pbuf *)p;
+
+  emac_eth_release_pkt(rx->buffer);
+  LWIP_MEMPOOL_FREE(RX_POOL, rx);
+}
+
 static struct pbuf *eth_recv_pbuf(void)
 {
   uint8_t *eth_data;
   int eth_data_count = emac_eth_recv(&eth_data);
-  if (!eth_data_count)
+  if (eth_data_count <= 0)
     return NULL;
 
-  struct pbuf* p = pbuf_alloc(PBUF_RAW, eth_data_count, PBUF_POOL);
+  struct rx_pbuf *rx = (struct rx_pbuf *)LWIP_MEMPOOL_ALLOC(RX_POOL);
+
+  if (rx != NULL) {
+    rx->buffer = emac_eth_hold_pkt();
+
+    if (rx->buffer == NULL) {
+      LWIP_MEMPOOL_FREE(RX_POOL, rx);
+      rx = NULL;
+    }
+  }
+
+  if (rx == NULL) {
+    struct pbuf* p = pbuf_alloc(PBUF_RAW, eth_data_count, PBUF_POOL);
+
+    if(p != NULL)
+      pbuf_take(p, eth_data, eth_data_count);
+
+    emac_free_pkt();
 
-  if(p != NULL)
-    pbuf_take(p, eth_data, eth_data_count);
+    return p;
+  }
 
-  emac_free_pkt();
+  rx->p.custom_free_function = rx_pbuf_free;
 
-  return p;
+  return pbuf_alloced_custom(PBUF_RAW, eth_data_count, PBUF_REF, &rx->p,
+                             eth_data, eth_data_count);
 }
 
 static err_t netif_output(struct netif *netif, struct pbuf *p)
 {
   (void)netif;
-  // XXX: This is a lot of copying. (emac_eth_send() copies the buffer, too.)
-  uint8_t send_buffer[p->tot_len];
-  pbuf_copy_partial(p, send_buffer, p->tot_len, 0);
-  emac_eth_send(send_buffer, p->tot_len);
+  // Gather the pbuf chain straight into the (uncached) EMAC TX buffer.
+  pbuf_copy_partial(p, emac_eth_send_get_dma_buffer(), p->tot_len, 0);
+  emac_eth_send_now(p->tot_len);
 
   return ERR_OK;
 }
@@ -139,6 +182,7 @@ void network_init(void)
 
   // initialize IP stack
   lwip_init();
+  LWIP_MEMPOOL_INIT(RX_POOL);
 
   // create interface
   netif_add(&netif_eth0, IP4_ADDR_ANY, IP4_ADDR_ANY, IP4_ADDR_ANY, NULL, _netif_init, netif_input);
@@ -3,6 +3,17 @@
 
 #include "spinlock.h"
 
+#if defined(__arm__)
+#define spin_wait()   asm volatile("wfe")
+#define spin_wake()   asm volatile("dsb; sev" ::: "memory")
+#else
+// Host build (tests and benchmarks): plain C11-style atomics
+#include <sched.h>
+#define spin_wait()   sched_yield()
+#define spin_wake()   do { } while (0)
+#endif
+
+#if defined(__arm__)
 void spin_lock(spinlock_t *lock)
 {
   int tmp;
@@ -31,3 +42,150 @@ void spin_unlock(spinlock_t *lock)
     : "cc"
   );
 }
+#else
+void spin_lock(spinlock_t *lock)
+{
+  while (__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE))
+    spin_wait();
+}
+
+void spin_unlock(spinlock_t *lock)
+{
+  __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
+#endif
+
+#ifdef SPINLOCK_STATS
+static inline uint32_t spin_cycles(void)
+{
+#if defined(__arm__)
+  uint32_t val;
+
+  // Enable the cycle counter of this core on first use
+  asm volatile("mrc p15, 0, %0, c9, c12, 1" : "=r" (val));
+  if (!(val & (1U << 31))) {
+    asm volatile("mrc p15, 0, %0, c9, c12, 0" : "=r" (val));
+    asm volatile("mcr p15, 0, %0, c9, c12, 0" :: "r" (val | 1));
+    asm volatile("mcr p15, 0, %0, c9, c12, 1" :: "r" (1U << 31));
+  }
+  asm volatile("mrc p15, 0, %0, c9, c13, 0" : "=r" (val));
+  return val;
+#elif defined(__x86_64__) || defined(__i386__)
+  return (uint32_t)__builtin_ia32_rdtsc();
+#else
+  return 0;
+#endif
+}
+
+// Called with the lock held
+static void spin_stats_update(struct spin_stats *stats, int contended,
+                              uint32_t start)
+{
+  stats->acquisitions++;
+  if (contended) {
+    uint32_t wait = spin_cycles() - start;
+    stats->contended++;
+    stats->total_wait_cycles += wait;
+    if (wait > stats->max_wait_cycles)
+      stats->max_wait_cycles = wait;
+  }
+}
+#endif
+
+void ticket_lock(ticket_lock_t *lock)
+{
+  uint32_t old = __atomic_fetch_add(&lock->slock, 1U << 16, __ATOMIC_ACQUIRE);
+  uint16_t ticket = (uint16_t)(old >> 16);
+
+  if ((uint16_t)old == ticket) {
+#ifdef SPINLOCK_STATS
+    spin_stats_update(&lock->stats, 0, 0);
+#endif
+    return;
+  }
+
+#ifdef SPINLOCK_STATS
+  uint32_t start = spin_cycles();
+#endif
+
+  while (__atomic_load_n(&lock->tickets.owner, __ATOMIC_ACQUIRE) != ticket)
+    spin_wait();
+
+#ifdef SPINLOCK_STATS
+  spin_stats_update(&lock->stats, 1, start);
+#endif
+}
+
+int ticket_trylock(ticket_lock_t *lock)
+{
+  uint32_t old = __atomic_load_n(&lock->slock, __ATOMIC_RELAXED);
+
+  if ((old >> 16) != (old & 0xffff))
+    return 0;
+
+  if (!__atomic_compare_exchange_n(&lock->slock, &old, old + (1U << 16), 0,
+                                   __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    return 0;
+
+#ifdef SPINLOCK_STATS
+  spin_stats_update(&lock->stats, 0, 0);
+#endif
+  return 1;
+}
+
+void ticket_unlock(ticket_lock_t *lock)
+{
+  // Only the holder writes owner, a halfword store is enough
+  __atomic_store_n(&lock->tickets.owner, (uint16_t)(lock->tickets.owner + 1),
+                   __ATOMIC_RELEASE);
+  spin_wake();
+}
+
+void mcs_lock(mcs_lock_t *lock, struct mcs_node *node)
+{
+  struct mcs_node *prev;
+
+  node->next = 0;
+  node->locked = 1;
+
+  prev = __atomic_exchange_n(&lock->tail, node, __ATOMIC_ACQ_REL);
+  if (!prev) {
+#ifdef SPINLOCK_STATS
+    spin_stats_update(&lock->stats, 0, 0);
+#endif
+    return;
+  }
+
+#ifdef SPINLOCK_STATS
+  uint32_t start = spin_cycles();
+#endif
+
+  __atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+  spin_wake();
+
+  while (__atomic_load_n(&node->locked, __ATOMIC_ACQUIRE))
+    spin_wait();
+
+#ifdef SPINLOCK_STATS
+  spin_stats_update(&lock->stats, 1, start);
+#endif
+}
+
+void mcs_unlock(mcs_lock_t *lock, struct mcs_node *node)
+{
+  struct mcs_node *next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE);
+
+  if (!next) {
+    struct mcs_node *expected = node;
+    if (__atomic_compare_exchange_n(&lock->tail, &expected, 0, 0,
+                                    __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+      return;
+
+    // A waiter swapped itself in but has not linked to us yet
+    while (!(next = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE)))
+      spin_wait();
+  }
+
+  __atomic_store_n(&next->locked, 0, __ATOMIC_RELEASE);
+  spin_wake();
+}
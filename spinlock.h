@@ -1,15 +1,70 @@
 // SPDX-License-Identifier: MIT
 // Copyright (c) 2021 Ulrich Hecht
 
+#ifndef SPINLOCK_H_
+#define SPINLOCK_H_
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#include <stdint.h>
+
 typedef int spinlock_t;
 
 void spin_lock(spinlock_t *lock);
 void spin_unlock(spinlock_t *lock);
 
+// Contention counters, kept per lock when built with SPINLOCK_STATS.
+// Wait times are CPU cycles (PMU cycle counter) on ARM.
+struct spin_stats {
+  uint32_t acquisitions;
+  uint32_t contended;
+  uint32_t max_wait_cycles;
+  uint64_t total_wait_cycles;
+};
+
+// Ticket lock: cores get the lock in the order they asked for it.
+typedef struct {
+  union {
+    volatile uint32_t slock;
+    struct {
+      volatile uint16_t owner;
+      volatile uint16_t next;
+    } tickets;
+  };
+#ifdef SPINLOCK_STATS
+  struct spin_stats stats;
+#endif
+} ticket_lock_t;
+
+#define TICKET_LOCK_INIT { { 0 } }
+
+void ticket_lock(ticket_lock_t *lock);
+int ticket_trylock(ticket_lock_t *lock);
+void ticket_unlock(ticket_lock_t *lock);
+
+// MCS queue lock: every waiter spins on its own node, which the caller
+// provides (usually on the stack) and keeps until mcs_unlock().
+struct mcs_node {
+  struct mcs_node *volatile next;
+  volatile uint32_t locked;
+};
+
+typedef struct {
+  struct mcs_node *volatile tail;
+#ifdef SPINLOCK_STATS
+  struct spin_stats stats;
+#endif
+} mcs_lock_t;
+
+#define MCS_LOCK_INIT { 0 }
+
+void mcs_lock(mcs_lock_t *lock, struct mcs_node *node);
+void mcs_unlock(mcs_lock_t *lock, struct mcs_node *node);
+
 #ifdef __cplusplus
 }
 #endif
+
+#endif // SPINLOCK_H_
@@ -1,4 +1,5 @@
 #include "audio.h"
+#include "bootseq.h"
 #include "ccu.h"
 #include "display.h"
 #include "dma.h"
@@ -38,28 +39,22 @@ void main(int argc, char **argv);
 void h3_timer_init(void);
 void h3_hs_timer_init(void);
 
-void startup()
+enum {
+  BOOT_MMU,
+  BOOT_GPIO,
+  BOOT_DMA,
+  BOOT_TIMERS,
+  BOOT_DISPLAY,
+  BOOT_SYS_TIMER,
+  BOOT_NETWORK,
+  BOOT_I2C,
+  BOOT_SPI,
+  BOOT_USB,
+  BOOT_NUM_STEPS
+};
+
+static void boot_gpio(void)
 {
-  init_sp_irq(0x2000);
-
-  // detect memory size
-#ifdef GDBSTUB
-  libc_set_heap((void *)0x42000000, (void *)0x60000000);
-#else
-  // XXX: check why this doesn't work with the stub enabled
-  libc_set_heap((void *)0x42000000, mmu_detect_dram_end());
-#endif
-
-  install_ivt();
-
-  uart_init(0);
-#ifdef GDBSTUB
-  gdbstub_init();
-#endif
-
-  // Set up MMU and paging configuration
-  mmu_init();
-
   // Enble all GPIO
   gpio_init();
 
@@ -76,10 +71,17 @@ void startup()
   gpio_irq_enable(PORTL, 3, GPIO_IRQ_ENABLE);
   irq_enable(77);  // PORT L interrupt (R_PL_EINT)
 
-  dma_init();
+  set_pin_mode(PORTF, 6, GPIO_MODE_INPUT);  // SD CD pin
+}
+
+static void boot_timers(void)
+{
   h3_timer_init();
   h3_hs_timer_init();
+}
 
+static void boot_display(void)
+{
   // Configure display; try HDMI/DVI first, fall back to analog if it fails to initialize
   // XXX: We have to init the display because the system timer
   // initialization uses it for calibration.
@@ -87,20 +89,55 @@ void startup()
     tve_init(TVE_NORM_NTSC);
   else
     audio_hdmi_init();
+}
 
-  sys_init_timer();
+// USB takes the longest (PHY reset delay, three host controllers) and
+// nothing before main() needs it, so it runs on core 1. It comes after the
+// other steps that read-modify-write the CCU bus clock gating and reset
+// registers. usb_task() does nothing until it is done.
+static const struct boot_step boot_steps[BOOT_NUM_STEPS] = {
+  [BOOT_MMU]       = { "mmu", mmu_init, 0, 0 },
+  [BOOT_GPIO]      = { "gpio", boot_gpio, BOOT_STEP(BOOT_MMU), 0 },
+  [BOOT_DMA]       = { "dma", dma_init, BOOT_STEP(BOOT_MMU), 0 },
+  [BOOT_TIMERS]    = { "timers", boot_timers, BOOT_STEP(BOOT_MMU), 0 },
+  [BOOT_DISPLAY]   = { "display", boot_display, BOOT_STEP(BOOT_TIMERS) | BOOT_STEP(BOOT_GPIO), 0 },
+  [BOOT_SYS_TIMER] = { "sys timer", sys_init_timer, BOOT_STEP(BOOT_DISPLAY), 0 },
+  [BOOT_NETWORK]   = { "network", network_init, BOOT_STEP(BOOT_SYS_TIMER), 0 },
+  [BOOT_I2C]       = { "i2c", h3_i2c_begin, BOOT_STEP(BOOT_GPIO), 0 },
+  [BOOT_SPI]       = { "spi", h3_spi_begin, BOOT_STEP(BOOT_GPIO), 0 },
+  [BOOT_USB]       = { "usb", usb_init,
+                       BOOT_STEP(BOOT_DMA) | BOOT_STEP(BOOT_DISPLAY) | BOOT_STEP(BOOT_SYS_TIMER) |
+                       BOOT_STEP(BOOT_NETWORK) | BOOT_STEP(BOOT_SPI),
+                       BOOT_ASYNC },
+};
+
+void startup()
+{
+  init_sp_irq(0x2000);
+  boot_mark("startup");
+
+  // detect memory size
+#ifdef GDBSTUB
+  libc_set_heap((void *)0x42000000, (void *)0x60000000);
+#else
+  // XXX: check why this doesn't work with the stub enabled
+  libc_set_heap((void *)0x42000000, mmu_detect_dram_end());
+#endif
 
-  // USB
-  usb_init();
+  install_ivt();
 
-  network_init();
+  uart_init(0);
+#ifdef GDBSTUB
+  gdbstub_init();
+#endif
 
-  h3_i2c_begin();
-  h3_spi_begin();
+  // Set up MMU and paging configuration, then everything else in
+  // dependency order
+  boot_run(boot_steps, BOOT_NUM_STEPS);
 
   uart_print("Ready!\r\n");
-
-  set_pin_mode(PORTF, 6, GPIO_MODE_INPUT);  // SD CD pin
+  boot_mark("ready");
+  boot_report();
 
   __libc_init_array();
 
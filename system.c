@@ -31,6 +31,11 @@ uint64_t sys_get_tick(void)
   return tick;
 }
 
+uint64_t sys_tick_to_usec(uint64_t tick)
+{
+  return sys_per_usec ? tick / sys_per_usec : 0;
+}
+
 uint64_t sys_get_usec(void)
 {
   return sys_get_tick() / sys_per_usec;
@@ -20,6 +20,8 @@ extern volatile uint32_t tick_counter;
 void sys_init_timer(void);
 uint64_t sys_get_tick(void);
 uint64_t sys_get_usec(void);
+// Valid once sys_init_timer() has calibrated the arch timer
+uint64_t sys_tick_to_usec(uint64_t tick);
 uint64_t sys_get_msec(void);
 
 uint32_t sys_mem_free(void);
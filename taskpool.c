@@ -0,0 +1,277 @@
+// SPDX-License-Identifier: MIT
+// Run-to-completion task pool with per-core deques and work stealing.
+
+#include <stdint.h>
+#include <string.h>
+
+#include "taskpool.h"
+
+#if defined(__linux__)
+// Host build for testing and benchmarks: cores are threads
+#include <pthread.h>
+#include <sched.h>
+
+static __thread int host_core_id;
+
+static int smp_get_core_id(void)
+{
+  return host_core_id;
+}
+
+#define smp_send_event()     do { } while (0)
+#define smp_wait_for_event() sched_yield()
+#else
+#include "smp.h"
+#endif
+
+#include "spinlock.h"
+
+struct task {
+  task_fn_t fn;
+  void *arg;
+  struct task_group *group;
+};
+
+struct task_deque {
+  ticket_lock_t lock;
+  uint32_t top;      // steal end
+  uint32_t bottom;   // owner end
+  struct task tasks[TASKPOOL_DEQUE_SIZE];
+} __attribute__((aligned(64)));
+
+struct range_chunk {
+  task_range_fn_t fn;
+  void *arg;
+  uint32_t begin;
+  uint32_t end;
+};
+
+#define MAX_CHUNKS (TASKPOOL_MAX_CORES * 8)
+
+static struct task_deque deques[TASKPOOL_MAX_CORES];
+static struct taskpool_stats stats;
+static int num_cores = 1;
+static volatile uint32_t workers_started;
+
+static int deque_push(struct task_deque *dq, const struct task *t)
+{
+  int ok = 0;
+
+  ticket_lock(&dq->lock);
+  if (dq->bottom - dq->top < TASKPOOL_DEQUE_SIZE) {
+    dq->tasks[dq->bottom & (TASKPOOL_DEQUE_SIZE - 1)] = *t;
+    dq->bottom++;
+    ok = 1;
+  }
+  ticket_unlock(&dq->lock);
+
+  return ok;
+}
+
+static int deque_pop(struct task_deque *dq, struct task *t)
+{
+  int ok = 0;
+
+  ticket_lock(&dq->lock);
+  if (dq->bottom != dq->top) {
+    dq->bottom--;
+    *t = dq->tasks[dq->bottom & (TASKPOOL_DEQUE_SIZE - 1)];
+    ok = 1;
+  }
+  ticket_unlock(&dq->lock);
+
+  return ok;
+}
+
+static int deque_steal(struct task_deque *dq, struct task *t)
+{
+  int ok = 0;
+
+  // Unlocked peek, so idle cores do not hammer the victim's lock
+  if (__atomic_load_n(&dq->bottom, __ATOMIC_RELAXED) ==
+      __atomic_load_n(&dq->top, __ATOMIC_RELAXED))
+    return 0;
+
+  ticket_lock(&dq->lock);
+  if (dq->bottom != dq->top) {
+    *t = dq->tasks[dq->top & (TASKPOOL_DEQUE_SIZE - 1)];
+    dq->top++;
+    ok = 1;
+  }
+  ticket_unlock(&dq->lock);
+
+  return ok;
+}
+
+static void task_run(const struct task *t, int core)
+{
+  t->fn(t->arg);
+  stats.executed[core]++;
+
+  if (__atomic_sub_fetch(&t->group->pending, 1, __ATOMIC_ACQ_REL) == 0)
+    smp_send_event();
+}
+
+// One task from the own deque, else one stolen from the others
+static int task_run_one(int core)
+{
+  struct task t;
+  int i;
+
+  if (deque_pop(&deques[core], &t)) {
+    task_run(&t, core);
+    return 1;
+  }
+
+  for (i = 1; i < num_cores; i++) {
+    int victim = (core + i) % num_cores;
+    if (deque_steal(&deques[victim], &t)) {
+      stats.stolen[core]++;
+      task_run(&t, core);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+static void taskpool_worker(void)
+{
+  int core = smp_get_core_id();
+
+  __atomic_add_fetch(&workers_started, 1, __ATOMIC_RELEASE);
+
+  for (;;) {
+    if (!task_run_one(core))
+      smp_wait_for_event();
+  }
+}
+
+#if defined(__linux__)
+static void *host_worker(void *arg)
+{
+  host_core_id = (int)(intptr_t)arg;
+  taskpool_worker();
+  return 0;
+}
+#else
+static uint8_t worker_stacks[TASKPOOL_MAX_CORES - 1][TASKPOOL_STACK_SIZE]
+  __attribute__((aligned(8)));
+#endif
+
+void taskpool_init(int cores)
+{
+  int i;
+
+  if (cores < 1)
+    cores = 1;
+  if (cores > TASKPOOL_MAX_CORES)
+    cores = TASKPOOL_MAX_CORES;
+
+  memset(deques, 0, sizeof(deques));
+  memset(&stats, 0, sizeof(stats));
+  num_cores = cores;
+
+  for (i = 1; i < cores; i++) {
+#if defined(__linux__)
+    pthread_t thread;
+    pthread_create(&thread, 0, host_worker, (void *)(intptr_t)i);
+    pthread_detach(thread);
+#else
+    smp_start_secondary_core(i, taskpool_worker, worker_stacks[i - 1],
+                             TASKPOOL_STACK_SIZE);
+#endif
+    // The secondary boot path takes its stack from one shared variable,
+    // so start the next core only after this one is running.
+    while (__atomic_load_n(&workers_started, __ATOMIC_ACQUIRE) != (uint32_t)i)
+      ;
+  }
+}
+
+int taskpool_get_cores(void)
+{
+  return num_cores;
+}
+
+void task_group_init(struct task_group *group)
+{
+  group->pending = 0;
+}
+
+void task_spawn(struct task_group *group, task_fn_t fn, void *arg)
+{
+  int core = smp_get_core_id();
+  struct task t = { fn, arg, group };
+
+  __atomic_add_fetch(&group->pending, 1, __ATOMIC_RELAXED);
+
+  if (num_cores > 1 && deque_push(&deques[core], &t)) {
+    smp_send_event();
+    return;
+  }
+
+  stats.inlined[core]++;
+  task_run(&t, core);
+}
+
+void task_group_wait(struct task_group *group)
+{
+  int core = smp_get_core_id();
+
+  while (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE) != 0) {
+    if (!task_run_one(core) &&
+        __atomic_load_n(&group->pending, __ATOMIC_ACQUIRE) != 0)
+      smp_wait_for_event();
+  }
+}
+
+static void range_task(void *arg)
+{
+  const struct range_chunk *chunk = arg;
+  chunk->fn(chunk->arg, chunk->begin, chunk->end);
+}
+
+void parallel_for(task_range_fn_t fn, void *arg, uint32_t begin, uint32_t end,
+                  uint32_t grain)
+{
+  struct range_chunk chunks[MAX_CHUNKS];
+  struct task_group group;
+  uint32_t count = end > begin ? end - begin : 0;
+  uint32_t n = 0;
+
+  if (count == 0)
+    return;
+
+  if (grain == 0)
+    grain = (count + (uint32_t)num_cores * 4 - 1) / ((uint32_t)num_cores * 4);
+  if ((count + grain - 1) / grain > MAX_CHUNKS)
+    grain = (count + MAX_CHUNKS - 1) / MAX_CHUNKS;
+
+  if (num_cores == 1 || grain >= count) {
+    fn(arg, begin, end);
+    return;
+  }
+
+  task_group_init(&group);
+
+  // Spawn all but the first chunk, which the caller runs itself
+  while (begin < end) {
+    uint32_t chunk_end = end - begin > grain ? begin + grain : end;
+    chunks[n].fn = fn;
+    chunks[n].arg = arg;
+    chunks[n].begin = begin;
+    chunks[n].end = chunk_end;
+    if (n != 0)
+      task_spawn(&group, range_task, &chunks[n]);
+    begin = chunk_end;
+    n++;
+  }
+
+  range_task(&chunks[0]);
+  task_group_wait(&group);
+}
+
+void taskpool_get_stats(struct taskpool_stats *out)
+{
+  *out = stats;
+}
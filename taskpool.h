@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: MIT
+// Run-to-completion task pool for the four Cortex-A7 cores.
+//
+// Every core owns a deque: it pushes and pops its own tasks at the bottom,
+// idle cores steal from the top. Cores 1-3 run taskpool_worker(); core 0
+// takes part in the work while it waits for a task group.
+//
+// Tasks must not block on anything but task_group_wait(). They may spawn
+// more tasks. When a deque is full the task is run inline.
+
+#ifndef TASKPOOL_H_
+#define TASKPOOL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define TASKPOOL_MAX_CORES   4
+#define TASKPOOL_DEQUE_SIZE  64   // per core, power of 2
+#define TASKPOOL_STACK_SIZE  0x8000
+
+typedef void (*task_fn_t)(void *arg);
+typedef void (*task_range_fn_t)(void *arg, uint32_t begin, uint32_t end);
+
+struct task_group {
+  volatile uint32_t pending;
+};
+
+struct taskpool_stats {
+  uint32_t executed[TASKPOOL_MAX_CORES];
+  uint32_t stolen[TASKPOOL_MAX_CORES];
+  uint32_t inlined[TASKPOOL_MAX_CORES];
+};
+
+// Starts workers on cores 1 .. cores - 1. Call once from core 0.
+void taskpool_init(int cores);
+int taskpool_get_cores(void);
+
+void task_group_init(struct task_group *group);
+void task_spawn(struct task_group *group, task_fn_t fn, void *arg);
+// Runs (and steals) tasks until all tasks of the group are done
+void task_group_wait(struct task_group *group);
+
+// Calls fn for [begin, end) split in chunks of at most grain indices,
+// grain 0 picks a size that gives every core a few chunks.
+void parallel_for(task_range_fn_t fn, void *arg, uint32_t begin, uint32_t end,
+                  uint32_t grain);
+
+void taskpool_get_stats(struct taskpool_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TASKPOOL_H_
@@ -68,6 +68,9 @@ void usb3_tusb_task(void);
 #define SCLK_GATING_OHCI2 (1 << 18)
 #define SCLK_GATING_OHCI3 (1 << 19)
 
+static volatile int usb_ready;
+
+// May run on core 1 while main() already calls usb_task(), see startup.c
 void usb_init() {
   // Disable clocks and wait a moment. This helps with devices not connecting on boot.
   BUS_CLK_GATING0 &= ~(USBOHCI3_GATING | USBOHCI2_GATING | USBOHCI1_GATING |
@@ -103,6 +106,8 @@ void usb_init() {
   usb1_diskio_init();
   usb2_diskio_init();
   usb3_diskio_init();
+
+  __atomic_store_n(&usb_ready, 1, __ATOMIC_RELEASE);
 }
 
 #include <common/binary.h>
@@ -290,6 +295,9 @@ void usb3_tuh_hid_mouse_isr(uint8_t dev_addr, xfer_result_t event) { mouse_isr(3
 
 void usb_task(void)
 {
+  if (!__atomic_load_n(&usb_ready, __ATOMIC_ACQUIRE))
+    return;
+
   usb1_tusb_task();
   usb2_tusb_task();
   usb3_tusb_task();